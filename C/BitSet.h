@@ -3,924 +3,9049 @@
 #include <stdint.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdio.h>
 #include <string.h>
 
+// every function is defined in the header, static in C (each translation unit gets its own copy, no external definition is needed) and inline in C++
+#ifndef BITSET_API
+#ifdef __cplusplus
+#define BITSET_API inline
+#else
+#define BITSET_API static inline
+#endif
+#endif
+
 #ifndef BITSET_SIZE
 #define BITSET_SIZE 1 // to avoid compilation errors
 #endif
 
+#ifndef BITSET_BLOCK_TYPE
+#define BITSET_BLOCK_TYPE uint8_t // define to uint16_t, uint32_t or uint64_t to process the bitset word-at-a-time
+#endif
+
+/**
+ * Type of a single storage block (unsigned integer type selected with BITSET_BLOCK_TYPE)
+ */
+typedef BITSET_BLOCK_TYPE bitset_block_t;
+
+/**
+ * Number of bits in a single storage block
+ */
+#define BITSET_BLOCK_BITS (sizeof(bitset_block_t) * 8u)
+
+/**
+ * Block with all of the bits set
+ */
+#define BITSET_BLOCK_MAX ((bitset_block_t)~(bitset_block_t)0u)
+
+/**
+ * Number of blocks in a 64-bit word (word-at-a-time scans assemble words from blocks)
+ */
+#define BITSET_BLOCKS_PER_WORD (64u / BITSET_BLOCK_BITS)
+
+/**
+ * Index returned by the find functions when no matching bit exists
+ */
+#define BITSET_NPOS UINT64_MAX
+
+/**
+ * Number of blocks needed to store BITSET_SIZE bits
+ */
+#define BITSET_STORAGE_SIZE ((BITSET_SIZE) / BITSET_BLOCK_BITS + ((BITSET_SIZE) % BITSET_BLOCK_BITS ? 1 : 0))
+
+#ifndef BITSET_SIMD_THRESHOLD
+#define BITSET_SIMD_THRESHOLD 256 // minimal number of bytes for which the SIMD kernels are used
+#endif
+
+#ifndef BITSET_NONTEMPORAL_THRESHOLD
+#define BITSET_NONTEMPORAL_THRESHOLD (4u << 20) // minimal number of bytes for which fills bypass the cache with non-temporal stores
+#endif
+
+// x86 SIMD kernels are selected at runtime on GCC/Clang (define BITSET_NO_SIMD to disable them)
+#if !defined(BITSET_NO_SIMD) && (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define BITSET_X86_DISPATCH 1
+#define BITSET_TARGET(features) __attribute__((target(features)))
+#include <immintrin.h>
+#elif defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+#if defined(_MSC_VER) || (defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#define BITSET_LITTLE_ENDIAN 1
+#endif
+
+#ifndef BITSET_PREFETCH_DISTANCE
+#define BITSET_PREFETCH_DISTANCE 16u // number of indices the batched get/set functions prefetch ahead
+#endif
+
+// software prefetch of the block an index lands in (write is 0 for reads and 1 for writes)
+#if defined(__GNUC__) || defined(__clang__)
+#define BITSET_PREFETCH(address, write) __builtin_prefetch((const void*)(address), write, 3)
+#elif defined(_MSC_VER) && defined(_M_X64)
+#define BITSET_PREFETCH(address, write) _mm_prefetch((const char*)(address), _MM_HINT_T0)
+#else
+#define BITSET_PREFETCH(address, write) ((void)(address))
+#endif
+
+// reference counts of the CowBitSet pages, atomic so a snapshot can be released by another thread than its bitset
+#if defined(__GNUC__) || defined(__clang__)
+#define BITSET_REFERENCE_INCREMENT(counter) ((void)__atomic_add_fetch(counter, 1u, __ATOMIC_RELAXED))
+#define BITSET_REFERENCE_DECREMENT(counter) __atomic_sub_fetch(counter, 1u, __ATOMIC_ACQ_REL)
+#define BITSET_REFERENCE_LOAD(counter) __atomic_load_n(counter, __ATOMIC_ACQUIRE)
+#elif defined(_MSC_VER) && defined(_M_X64)
+#define BITSET_REFERENCE_INCREMENT(counter) ((void)_InterlockedIncrement64((volatile __int64*)(counter)))
+#define BITSET_REFERENCE_DECREMENT(counter) ((uint64_t)_InterlockedDecrement64((volatile __int64*)(counter)))
+#define BITSET_REFERENCE_LOAD(counter) ((uint64_t)_InterlockedOr64((volatile __int64*)(counter), 0))
+#else
+// not thread safe, keep a bitset and its snapshots on one thread
+#define BITSET_REFERENCE_INCREMENT(counter) ((void)++*(counter))
+#define BITSET_REFERENCE_DECREMENT(counter) (--*(counter))
+#define BITSET_REFERENCE_LOAD(counter) (*(counter))
+#endif
+
+#ifndef BITSET_CACHE_LINE_SIZE
+#define BITSET_CACHE_LINE_SIZE 64u // the parallel chunks start on cache line boundaries, so threads never share a written line
+#endif
+
+#ifndef BITSET_PARALLEL_CHUNK_SIZE
+#define BITSET_PARALLEL_CHUNK_SIZE (1024u * 1024u) // bytes processed by a single task of the bitset_parallel_* functions (multiple of BITSET_CACHE_LINE_SIZE)
+#endif
+
+// bitset_parallel_* functions use OpenMP when compiled with it (-fopenmp, /openmp), otherwise they run on the calling thread
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#ifndef BITSET_ALIGNMENT
+#define BITSET_ALIGNMENT 64u // alignment (in bytes) of the blocks allocated by the default allocator, a power of two
+#endif
+
+// the default allocator uses _aligned_malloc on MSVC, aligned_alloc in C11/C++17, posix_memalign on POSIX and over-allocates with malloc otherwise
+#if defined(_MSC_VER)
+#include <malloc.h>
+#define BITSET_ALIGNED_MSVC 1
+#elif (defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L) || (defined(__cplusplus) && __cplusplus >= 201703L)
+#define BITSET_ALIGNED_C11 1
+#elif (defined(_POSIX_C_SOURCE) && _POSIX_C_SOURCE >= 200112L) || (defined(_XOPEN_SOURCE) && _XOPEN_SOURCE >= 600) || defined(__APPLE__)
+#define BITSET_ALIGNED_POSIX 1
+#endif
+
+// huge page allocator for multi-GB bitsets (Linux, needs mmap and MAP_ANONYMOUS, e.g. _DEFAULT_SOURCE in strict C modes)
+#if defined(__linux__)
+#include <sys/mman.h>
+#if defined(MAP_ANONYMOUS)
+#define BITSET_HUGE_PAGES 1
+#ifndef BITSET_HUGE_PAGE_SIZE
+#define BITSET_HUGE_PAGE_SIZE (2u * 1024u * 1024u)
+#endif
+#endif
+#endif
+
+// memory-mapped bitset files (POSIX mmap)
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define BITSET_MAPPED_FILES 1
+// shared memory bitsets (POSIX shm_open, needs ftruncate, e.g. _DEFAULT_SOURCE in strict C modes)
+#if defined(__APPLE__) || (defined(_POSIX_C_SOURCE) && _POSIX_C_SOURCE >= 200112L) || defined(_XOPEN_SOURCE)
+#define BITSET_SHARED_MEMORY 1
+#ifndef BITSET_SHARED_MODE
+#define BITSET_SHARED_MODE 0600 // permissions of the shared memory segments created by bitset_dynamic_create_shared
+#endif
+#endif
+#endif
+
+// opt-in operation counters and trace markers (define BITSET_ENABLE_STATS), every hook compiles to nothing otherwise
+// C programs define BITSET_STATS_IMPLEMENTATION in exactly one translation unit, which then holds bitset_global_stats
+#ifdef BITSET_ENABLE_STATS
+#ifndef BITSET_TRACE_THRESHOLD
+#define BITSET_TRACE_THRESHOLD (64u * 1024u) // minimal number of bytes for which the bulk operations emit trace markers
+#endif
+// Intel ITT tasks (VTune) around the bulk operations, needs ittnotify.h and libittnotify
+#ifdef BITSET_ENABLE_ITT
+#include <ittnotify.h>
+#endif
+// USDT probes bitset:kernel_begin and bitset:kernel_end around the bulk operations (perf, bpftrace), needs sys/sdt.h
+#ifdef BITSET_ENABLE_SDT
+#include <sys/sdt.h>
+#endif
+#if defined(__GNUC__) || defined(__clang__)
+#define BITSET_STATS_ADD(counter, value) ((void)__atomic_fetch_add(counter, value, __ATOMIC_RELAXED))
+#elif defined(_MSC_VER) && defined(_M_X64)
+#define BITSET_STATS_ADD(counter, value) ((void)_InterlockedExchangeAdd64((volatile __int64*)(counter), (__int64)(value)))
+#else
+// not thread safe, the counters may lose updates of concurrent calls
+#define BITSET_STATS_ADD(counter, value) ((void)(*(counter) += (value)))
+#endif
+#define BITSET_STATS_RECORD(family, bits, bytes) bitset_stats_record(family, bits, bytes)
+#define BITSET_STATS_REALLOCATION(family, old_size, new_size) bitset_stats_reallocation(family, old_size, new_size)
+#define BITSET_TRACE_BEGIN(name, bytes) do { if ((uint64_t)(bytes) >= BITSET_TRACE_THRESHOLD) bitset_trace_begin(name, bytes); } while (0)
+#define BITSET_TRACE_END(name, bytes) do { if ((uint64_t)(bytes) >= BITSET_TRACE_THRESHOLD) bitset_trace_end(name, bytes); } while (0)
+#else
+#define BITSET_STATS_RECORD(family, bits, bytes) ((void)0)
+#define BITSET_STATS_REALLOCATION(family, old_size, new_size) ((void)0)
+#define BITSET_TRACE_BEGIN(name, bytes) ((void)0)
+#define BITSET_TRACE_END(name, bytes) ((void)0)
+#endif
+
+#ifndef BITSET_POOL_CLASSES
+#define BITSET_POOL_CLASSES 16 // size classes cached by bitset_pool, BITSET_ALIGNMENT << k bytes for k < BITSET_POOL_CLASSES (64 B to 2 MiB by default)
+#endif
+
+/**
+ * Allocator used by DynamicBitSet for its blocks (NULL selects the default 64-byte aligned allocator)
+ * The sizes passed to reallocate and deallocate are the sizes the memory was (re)allocated with
+ */
+typedef struct
+{
+    /**
+     * Allocates size bytes (uninitialized), aligned at least for bitset_block_t, returns NULL on failure
+     */
+    void* (*allocate)(const uint64_t size, void* const context);
+    /**
+     * Resizes the allocation, keeping the first min(old_size, new_size) bytes, returns NULL on failure (the old memory stays valid)
+     */
+    void* (*reallocate)(void* const pointer, const uint64_t old_size, const uint64_t new_size, void* const context);
+    /**
+     * Releases the allocation (pointer may be NULL)
+     */
+    void (*deallocate)(void* const pointer, const uint64_t size, void* const context);
+    /**
+     * Pointer passed to the functions above
+     */
+    void* context;
+} bitset_allocator;
+
+/**
+ * Initializer of the default 64-byte aligned allocator, e.g. static const bitset_allocator allocator = BITSET_DEFAULT_ALLOCATOR;
+ */
+#define BITSET_DEFAULT_ALLOCATOR { bitset_aligned_allocate, bitset_aligned_reallocate, bitset_aligned_deallocate, NULL }
+
+#ifdef BITSET_HUGE_PAGES
+/**
+ * Initializer of the huge page allocator (MAP_HUGETLB, falls back to madvise(MADV_HUGEPAGE)), sizes are rounded up to BITSET_HUGE_PAGE_SIZE
+ */
+#define BITSET_HUGE_PAGE_ALLOCATOR { bitset_huge_page_allocate, bitset_huge_page_reallocate, bitset_huge_page_deallocate, NULL }
+#endif
+
+/**
+ * Pool of released allocations for short-lived bitsets (not thread safe, use one pool per thread)
+ * Pass &pool->allocator to bitset_dynamic_init_allocator, allocations above the largest size class go straight to upstream
+ */
+typedef struct
+{
+    /**
+     * Allocator serving from the pool (context points to the pool)
+     */
+    bitset_allocator allocator;
+    /**
+     * Allocator the pool gets its memory from (NULL for the default allocator)
+     */
+    const bitset_allocator* upstream;
+    /**
+     * Released allocations of every size class, linked through their first bytes
+     */
+    void* free_lists[BITSET_POOL_CLASSES];
+} bitset_pool;
+
 /**
  * A dynamic bitset structure (for C API bitset)
  */
-typedef struct 
+typedef struct
 {
 	/**
-	 * Underlying array of bytes containing the bits
+	 * Underlying array of blocks containing the bits
 	 */
-	uint8_t* data;
+	bitset_block_t* data;
     /**
      * Size of bitset in bits
      */
     uint64_t size;
     /**
-     * Size of bitset in bytes
+     * Size of bitset in blocks
      */
 	uint64_t storage_size;
+    /**
+     * Number of allocated blocks (at least storage_size)
+     */
+    uint64_t capacity;
+    /**
+     * Allocator of the blocks (NULL for the default 64-byte aligned allocator)
+     */
+    const bitset_allocator* allocator;
 } DynamicBitSet;
 
 /**
- * A bitset structure (for C API bitset)
- * To use, define BITSET_SIZE to the size of the bitset you want to use
+ * A bitset structure (for C API bitset)
+ * To use, define BITSET_SIZE to the size of the bitset you want to use
+ * The first three members are laid out exactly like DynamicBitSet, so both types can be passed to the bitset_* functions
+ * Note: data points into the structure itself, so copy it with bitset_copy instead of assignment
+ */
+typedef struct
+{
+    /**
+     * Pointer to the underlying array of blocks containing the bits (points to storage)
+     */
+    bitset_block_t* data;
+    /**
+     * Size of bitset in bits
+     */
+    uint64_t size;
+    /**
+     * Size of bitset in blocks
+    */
+    uint64_t storage_size;
+    /**
+     * Underlying array of blocks containing the bits
+     */
+    bitset_block_t storage[BITSET_STORAGE_SIZE];
+} BitSet;
+
+/**
+ * Casts the bitset to the universal bitset type (used with dynamic bitset)
+ * @param bitset The bitset to cast
+ */
+#define UNIVERSAL_BITSET(bitset) (BitSet*)(bitset)
+
+/**
+ * A non-owning view of bits [begin, begin + size) of a bitset, no bits are copied
+ * The first three members are laid out like BitSet, so a view with offset 0 (block aligned begin) can be passed to the bitset_* functions
+ * and the bitset_view_* functions forward such views to the same block-at-a-time (vectorized) paths as whole bitsets
+ * The bits outside of the view are never modified, the viewed bitset has to outlive the view
+ */
+typedef struct
+{
+    /**
+     * Pointer to the block holding the first bit of the view (points into the viewed bitset)
+     */
+    bitset_block_t* data;
+    /**
+     * Size of view in bits
+     */
+    uint64_t size;
+    /**
+     * Number of blocks the view spans, from data on
+     */
+    uint64_t storage_size;
+    /**
+     * Index of the first bit of the view within the first block, in range [0, BITSET_BLOCK_BITS) (bit index within block)
+     */
+    uint64_t offset;
+} BitSetView;
+
+/**
+ * Bitwise operations used by the bulk set algebra functions
+ */
+typedef enum
+{
+    /**
+     * left & right (intersection)
+     */
+    BITSET_OPERATION_AND,
+    /**
+     * left | right (union)
+     */
+    BITSET_OPERATION_OR,
+    /**
+     * left ^ right (symmetric difference)
+     */
+    BITSET_OPERATION_XOR,
+    /**
+     * left & ~right (difference)
+     */
+    BITSET_OPERATION_ANDNOT
+} bitset_operation;
+
+/**
+ * Callback invoked by bitset_for_each_set_bit
+ * @param index Index of the set bit (bit index)
+ * @param context The context pointer passed to bitset_for_each_set_bit
+ */
+typedef void (*bitset_index_callback)(const uint64_t index, void* const context);
+
+/**
+ * Callback invoked by bitset_for_each_run
+ * @param begin Index of the first bit of the run (bit index)
+ * @param end Index past the last bit of the run, exclusive (bit index)
+ * @param context The context pointer passed to bitset_for_each_run
+ */
+typedef void (*bitset_run_callback)(const uint64_t begin, const uint64_t end, void* const context);
+
+/**
+ * Operation families counted by the statistics (BITSET_ENABLE_STATS)
+ */
+typedef enum
+{
+    /**
+     * Single and batched bit reads and writes (get, set, clear, flip, *_many)
+     */
+    BITSET_STATS_ACCESS,
+    /**
+     * Fills and flips of ranges, steps and patterns
+     */
+    BITSET_STATS_FILL,
+    /**
+     * Counts of set bits and runs
+     */
+    BITSET_STATS_COUNT,
+    /**
+     * Set algebra between bitsets (and, or, xor, andnot, fused counts)
+     */
+    BITSET_STATS_ALGEBRA,
+    /**
+     * Searches and set bit iteration (find, extract_indices, for_each_set_bit)
+     */
+    BITSET_STATS_FIND,
+    /**
+     * Shifts and rotations
+     */
+    BITSET_STATS_SHIFT,
+    /**
+     * Size changes of dynamic bitsets (push_back, pop_back, resize, reserve, shrink_to_fit)
+     */
+    BITSET_STATS_RESIZE,
+    /**
+     * Number of families
+     */
+    BITSET_STATS_FAMILIES
+} bitset_stats_family;
+
+/**
+ * Counters of a single operation family
+ */
+typedef struct
+{
+    /**
+     * Number of calls
+     */
+    uint64_t calls;
+    /**
+     * Number of bits read or written
+     */
+    uint64_t bits;
+    /**
+     * Number of bytes of blocks scanned
+     */
+    uint64_t bytes;
+    /**
+     * Number of reallocations of the blocks
+     */
+    uint64_t reallocations;
+    /**
+     * Number of bytes the reallocations moved to (sum of the new sizes)
+     */
+    uint64_t reallocated_bytes;
+} bitset_stats_counters;
+
+/**
+ * Callback invoked around the bulk operations when the statistics are enabled
+ * @param name Name of the operation (string literal)
+ * @param bytes Number of bytes the operation processes
+ * @param context The trace_context pointer of bitset_global_stats
+ */
+typedef void (*bitset_trace_callback)(const char* const name, const uint64_t bytes, void* const context);
+
+/**
+ * Operation statistics collected with BITSET_ENABLE_STATS (see bitset_global_stats), the counters are updated with relaxed atomics
+ */
+typedef struct
+{
+    /**
+     * Counters of every operation family, indexed by bitset_stats_family
+     */
+    bitset_stats_counters families[BITSET_STATS_FAMILIES];
+    /**
+     * Histogram of the new sizes of the reallocations, bucket k counts sizes in range [2^(k - 1), 2^k) bytes
+     */
+    uint64_t reallocation_sizes[65];
+    /**
+     * Called before every bulk operation of at least BITSET_TRACE_THRESHOLD bytes (NULL for none), set before the bitsets are used
+     */
+    bitset_trace_callback trace_begin;
+    /**
+     * Called after every bulk operation of at least BITSET_TRACE_THRESHOLD bytes (NULL for none), set before the bitsets are used
+     */
+    bitset_trace_callback trace_end;
+    /**
+     * Pointer passed to the trace callbacks
+     */
+    void* trace_context;
+} bitset_stats;
+
+#ifdef BITSET_ENABLE_STATS
+#ifdef __cplusplus
+inline bitset_stats bitset_global_stats = {};
+#else
+/**
+ * Statistics of all of the bitsets of the program
+ */
+extern bitset_stats bitset_global_stats;
+#ifdef BITSET_STATS_IMPLEMENTATION
+bitset_stats bitset_global_stats;
+#endif
+#endif
+#endif
+
+// the atomic bitset of the C API needs C11 atomics, C++ code uses CAtomicBitSet from BitSet.hpp instead
+#if !defined(__cplusplus) && defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L && !defined(__STDC_NO_ATOMICS__)
+#define BITSET_ATOMICS 1
+#include <stdatomic.h>
+
+/**
+ * A dynamic bitset with atomic 64-bit blocks, safe to modify from multiple threads without locking
+ * Bit i is bit i % 64 of block i / 64 (independent of BITSET_BLOCK_TYPE)
+ */
+typedef struct
+{
+    /**
+     * Underlying array of atomic words containing the bits
+     */
+    _Atomic uint64_t* data;
+    /**
+     * Size of bitset in bits
+     */
+    uint64_t size;
+    /**
+     * Size of bitset in 64-bit words
+     */
+    uint64_t storage_size;
+} AtomicBitSet;
+
+BITSET_API void bitset_atomic_init(AtomicBitSet* const bitset, const uint64_t size);
+BITSET_API void bitset_atomic_destroy(AtomicBitSet* const bitset);
+BITSET_API bool bitset_atomic_get(const AtomicBitSet* const bitset, const uint64_t index, const memory_order order);
+BITSET_API void bitset_atomic_set(AtomicBitSet* const bitset, const uint64_t index, const memory_order order);
+BITSET_API void bitset_atomic_clear(AtomicBitSet* const bitset, const uint64_t index, const memory_order order);
+BITSET_API void bitset_atomic_flip(AtomicBitSet* const bitset, const uint64_t index, const memory_order order);
+BITSET_API bool bitset_atomic_test_and_set(AtomicBitSet* const bitset, const uint64_t index, const memory_order order);
+BITSET_API bool bitset_atomic_test_and_clear(AtomicBitSet* const bitset, const uint64_t index, const memory_order order);
+BITSET_API bool bitset_atomic_test_and_flip(AtomicBitSet* const bitset, const uint64_t index, const memory_order order);
+BITSET_API uint64_t bitset_atomic_load_block(const AtomicBitSet* const bitset, const uint64_t index, const memory_order order);
+BITSET_API void bitset_atomic_store_block(AtomicBitSet* const bitset, const uint64_t block, const uint64_t index, const memory_order order);
+BITSET_API uint64_t bitset_atomic_fetch_or_block(AtomicBitSet* const bitset, const uint64_t mask, const uint64_t index, const memory_order order);
+BITSET_API uint64_t bitset_atomic_fetch_and_block(AtomicBitSet* const bitset, const uint64_t mask, const uint64_t index, const memory_order order);
+BITSET_API uint64_t bitset_atomic_fetch_xor_block(AtomicBitSet* const bitset, const uint64_t mask, const uint64_t index, const memory_order order);
+BITSET_API void bitset_atomic_set_many(AtomicBitSet* const bitset, const uint64_t* const indices, const uint64_t count, const memory_order order);
+BITSET_API void bitset_atomic_clear_many(AtomicBitSet* const bitset, const uint64_t* const indices, const uint64_t count, const memory_order order);
+BITSET_API void bitset_atomic_flip_many(AtomicBitSet* const bitset, const uint64_t* const indices, const uint64_t count, const memory_order order);
+BITSET_API void bitset_atomic_get_many(const AtomicBitSet* const bitset, const uint64_t* const indices, const uint64_t count, bool* const values, const memory_order order);
+BITSET_API void bitset_atomic_fill_all(AtomicBitSet* const bitset, const bool value);
+BITSET_API uint64_t bitset_atomic_count(const AtomicBitSet* const bitset);
+BITSET_API uint64_t bitset_atomic_find_next_value(const AtomicBitSet* const bitset, const bool value, const uint64_t begin);
+#endif
+
+/**
+ * Number of bits covered by a single container of CompressedBitSet
+ */
+#define BITSET_CONTAINER_BITS 65536u
+
+/**
+ * Number of 64-bit words of a bitmap container
+ */
+#define BITSET_CONTAINER_WORDS (BITSET_CONTAINER_BITS / 64u)
+
+#ifndef BITSET_ARRAY_CONTAINER_MAX
+#define BITSET_ARRAY_CONTAINER_MAX 4096u // above this many set bits a sorted array is larger than a bitmap container (8 KiB)
+#endif
+
+/**
+ * Representation of the bits of a single container of CompressedBitSet
+ */
+typedef enum
+{
+    /**
+     * Sorted array of the set bits (uint16_t values), at most BITSET_ARRAY_CONTAINER_MAX of them
+     */
+    BITSET_CONTAINER_ARRAY,
+    /**
+     * Plain bitmap (BITSET_CONTAINER_WORDS uint64_t words)
+     */
+    BITSET_CONTAINER_BITMAP,
+    /**
+     * Sorted runs of set bits (uint16_t pairs of start and length - 1)
+     */
+    BITSET_CONTAINER_RUN
+} bitset_container_type;
+
+/**
+ * A container of CompressedBitSet, holds the bits [key * BITSET_CONTAINER_BITS, (key + 1) * BITSET_CONTAINER_BITS)
+ */
+typedef struct
+{
+    /**
+     * The values, words or runs (depending on type)
+     */
+    void* data;
+    /**
+     * Index of the container (bit index / BITSET_CONTAINER_BITS)
+     */
+    uint32_t key;
+    /**
+     * Number of set bits
+     */
+    uint32_t cardinality;
+    /**
+     * Number of values (array), runs (run) or words (bitmap)
+     */
+    uint32_t length;
+    /**
+     * Number of allocated values, runs or words
+     */
+    uint32_t capacity;
+    /**
+     * Representation of the bits
+     */
+    bitset_container_type type;
+} bitset_container;
+
+/**
+ * A compressed bitset (Roaring-style), memory scales with the set bits instead of the size
+ * Every 65536-bit chunk with at least one set bit is stored as its own array, bitmap or run container, empty chunks take no memory
+ * Indices up to 2^48 are supported, call bitset_compressed_optimize after bulk updates to pick the smallest containers
+ */
+typedef struct
+{
+    /**
+     * Non-empty containers sorted by key
+     */
+    bitset_container* containers;
+    /**
+     * Number of containers
+     */
+    uint64_t container_count;
+    /**
+     * Number of allocated containers
+     */
+    uint64_t container_capacity;
+    /**
+     * Size of bitset in bits
+     */
+    uint64_t size;
+    /**
+     * Allocator of the container array (NULL for the default allocator), the data of the containers is allocated with malloc
+     */
+    const bitset_allocator* allocator;
+} CompressedBitSet;
+
+BITSET_API uint64_t bitset_container_element_size(const bitset_container_type type);
+BITSET_API void bitset_container_init(bitset_container* const container, const uint32_t key);
+BITSET_API void bitset_container_destroy(bitset_container* const container);
+BITSET_API void bitset_container_copy(bitset_container* const destination, const bitset_container* const source);
+BITSET_API void bitset_container_reserve(bitset_container* const container, const uint32_t capacity);
+BITSET_API void bitset_container_replace(bitset_container* const container, const bitset_container_type type, void* const data, const uint32_t length, const uint32_t capacity, const uint32_t cardinality);
+BITSET_API uint32_t bitset_container_lower_bound(const uint16_t* const values, const uint32_t length, const uint16_t value);
+BITSET_API uint32_t bitset_container_find_run(const uint16_t* const runs, const uint32_t length, const uint16_t value);
+BITSET_API uint64_t bitset_container_apply_word(const uint64_t word, const uint64_t mask, const bitset_operation operation);
+BITSET_API void bitset_container_words_apply(uint64_t* const words, const uint32_t begin, const uint32_t end, const bitset_operation operation);
+BITSET_API uint32_t bitset_container_words_count(const uint64_t* const words, const uint32_t begin, const uint32_t end);
+BITSET_API uint32_t bitset_container_words_count_runs(const uint64_t* const words);
+BITSET_API void bitset_container_to_words(const bitset_container* const container, uint64_t* const words);
+BITSET_API void bitset_container_set_words(bitset_container* const container, const uint64_t* const words, const uint32_t cardinality);
+BITSET_API void bitset_container_set_runs(bitset_container* const container, const uint64_t* const words, const uint32_t runs);
+BITSET_API void bitset_container_to_bitmap(bitset_container* const container);
+BITSET_API void bitset_container_optimize(bitset_container* const container);
+BITSET_API bool bitset_container_get(const bitset_container* const container, const uint16_t value);
+BITSET_API void bitset_container_set(bitset_container* const container, const uint16_t value);
+BITSET_API void bitset_container_clear(bitset_container* const container, const uint16_t value);
+BITSET_API void bitset_container_update_range(bitset_container* const container, const uint32_t begin, const uint32_t end, const bitset_operation operation);
+BITSET_API void bitset_container_binary_operation(bitset_container* const result, const bitset_container* const left, const bitset_container* const right, const bitset_operation operation);
+BITSET_API uint32_t bitset_container_and_count(const bitset_container* const left, const bitset_container* const right);
+BITSET_API void bitset_compressed_init(CompressedBitSet* const bitset, const uint64_t size);
+BITSET_API void bitset_compressed_init_allocator(CompressedBitSet* const bitset, const uint64_t size, const bitset_allocator* const allocator);
+BITSET_API void bitset_compressed_init_bitset(CompressedBitSet* const bitset, const BitSet* const source);
+BITSET_API void bitset_compressed_destroy(CompressedBitSet* const bitset);
+BITSET_API void bitset_compressed_copy(CompressedBitSet* const destination, const CompressedBitSet* const source);
+BITSET_API void bitset_compressed_reserve(CompressedBitSet* const bitset, const uint64_t capacity);
+BITSET_API uint64_t bitset_compressed_lower_bound(const CompressedBitSet* const bitset, const uint32_t key);
+BITSET_API bitset_container* bitset_compressed_find_container(const CompressedBitSet* const bitset, const uint32_t key);
+BITSET_API bitset_container* bitset_compressed_insert_container(CompressedBitSet* const bitset, const uint32_t key);
+BITSET_API void bitset_compressed_remove_container(CompressedBitSet* const bitset, const uint64_t position);
+BITSET_API bool bitset_compressed_get(const CompressedBitSet* const bitset, const uint64_t index);
+BITSET_API void bitset_compressed_set(CompressedBitSet* const bitset, const uint64_t index);
+BITSET_API void bitset_compressed_clear(CompressedBitSet* const bitset, const uint64_t index);
+BITSET_API void bitset_compressed_set_value(CompressedBitSet* const bitset, const bool value, const uint64_t index);
+BITSET_API void bitset_compressed_flip_bit(CompressedBitSet* const bitset, const uint64_t index);
+BITSET_API void bitset_compressed_update_range(CompressedBitSet* const bitset, const uint64_t begin, const uint64_t end, const bitset_operation operation);
+BITSET_API void bitset_compressed_fill_in_range_begin_end(CompressedBitSet* const bitset, const bool value, const uint64_t begin, const uint64_t end);
+BITSET_API void bitset_compressed_flip_in_range_begin_end(CompressedBitSet* const bitset, const uint64_t begin, const uint64_t end);
+BITSET_API uint64_t bitset_compressed_count(const CompressedBitSet* const bitset);
+BITSET_API bool bitset_compressed_any(const CompressedBitSet* const bitset);
+BITSET_API bool bitset_compressed_none(const CompressedBitSet* const bitset);
+BITSET_API void bitset_compressed_binary_operation(CompressedBitSet* const destination, const CompressedBitSet* const left, const CompressedBitSet* const right, const bitset_operation operation);
+BITSET_API uint64_t bitset_compressed_binary_count(const CompressedBitSet* const left, const CompressedBitSet* const right, const bitset_operation operation);
+BITSET_API void bitset_compressed_optimize(CompressedBitSet* const bitset);
+BITSET_API uint64_t bitset_compressed_memory_usage(const CompressedBitSet* const bitset);
+BITSET_API void bitset_compressed_for_each_set_bit(const CompressedBitSet* const bitset, const bitset_index_callback callback, void* const context);
+BITSET_API void bitset_compressed_to_bitset(const CompressedBitSet* const bitset, BitSet* const destination);
+
+/**
+ * Magic number at the start of a bitset file ("BITSETF" followed by a zero byte when stored little-endian)
+ */
+#define BITSET_FILE_MAGIC 0x0046544553544942ull
+
+/**
+ * Version of the bitset file format written by bitset_save_file
+ */
+#define BITSET_FILE_VERSION 1u
+
+/**
+ * Byte order marker of a bitset file, reads back differently on a machine of the other endianness
+ */
+#define BITSET_FILE_BYTE_ORDER 0x01020304u
+
+/**
+ * Header of a bitset file, followed by the blocks of the bitset exactly as they are laid out in memory
+ * The header is 64 bytes, so the blocks of a mapped file start on a cache line boundary
+ */
+typedef struct
+{
+    /**
+     * BITSET_FILE_MAGIC
+     */
+    uint64_t magic;
+    /**
+     * BITSET_FILE_VERSION of the writer
+     */
+    uint32_t version;
+    /**
+     * BITSET_FILE_BYTE_ORDER in the byte order of the writer
+     */
+    uint32_t byte_order;
+    /**
+     * Number of bits in a single block (BITSET_BLOCK_BITS of the writer)
+     */
+    uint32_t block_bits;
+    /**
+     * Offset of the blocks from the start of the file in bytes (size of the header)
+     */
+    uint32_t header_size;
+    /**
+     * Size of bitset in bits
+     */
+    uint64_t size;
+    /**
+     * Size of bitset in blocks
+     */
+    uint64_t storage_size;
+    /**
+     * bitset_checksum_bytes of the blocks
+     */
+    uint64_t checksum;
+    /**
+     * Zero, reserved for later versions
+     */
+    uint8_t reserved[16];
+} bitset_file_header;
+
+/**
+ * Flags of bitset_dynamic_map_file
+ */
+typedef enum
+{
+    /**
+     * The blocks are shared with the file and must not be modified (writes fault)
+     */
+    BITSET_MAP_READ_ONLY = 0,
+    /**
+     * The blocks may be modified, the modified pages are private copies and never reach the file
+     */
+    BITSET_MAP_COPY_ON_WRITE = 1,
+    /**
+     * The checksum of the blocks is verified (reads the whole file, skip it for instant warm restarts)
+     */
+    BITSET_MAP_VERIFY = 2,
+    /**
+     * The blocks may be modified and the writes are seen by every process (shared memory segments only, see bitset_dynamic_attach_shared)
+     */
+    BITSET_MAP_SHARED_WRITE = 4
+} bitset_map_flags;
+
+BITSET_API uint64_t bitset_checksum_bytes(const uint8_t* const data, const uint64_t size);
+BITSET_API void bitset_file_header_init(bitset_file_header* const header, const BitSet* const bitset);
+BITSET_API bool bitset_file_header_check(const bitset_file_header* const header, const uint64_t file_size);
+BITSET_API bool bitset_save_file(const BitSet* const bitset, const char* const path);
+BITSET_API bool bitset_dynamic_load_file(DynamicBitSet* const bitset, const char* const path);
+#ifdef BITSET_MAPPED_FILES
+BITSET_API void* bitset_mapped_allocate(const uint64_t size, void* const context);
+BITSET_API void* bitset_mapped_reallocate(void* const pointer, const uint64_t old_size, const uint64_t new_size, void* const context);
+BITSET_API void bitset_mapped_deallocate(void* const pointer, const uint64_t size, void* const context);
+BITSET_API const bitset_allocator* bitset_mapped_allocator(void);
+BITSET_API bool bitset_dynamic_map_file(DynamicBitSet* const bitset, const char* const path, const uint32_t flags);
+#endif
+#ifdef BITSET_SHARED_MEMORY
+BITSET_API uint64_t bitset_shared_segment_size(const uint64_t storage_size);
+BITSET_API void bitset_shared_deallocate(void* const pointer, const uint64_t size, void* const context);
+BITSET_API const bitset_allocator* bitset_shared_allocator(void);
+BITSET_API bitset_file_header* bitset_shared_map(const char* const name, const uint32_t flags);
+BITSET_API bool bitset_dynamic_create_shared(DynamicBitSet* const bitset, const char* const name, const BitSet* const source);
+BITSET_API bool bitset_dynamic_attach_shared(DynamicBitSet* const bitset, const char* const name, const uint32_t flags);
+BITSET_API bool bitset_unlink_shared(const char* const name);
+#ifdef BITSET_ATOMICS
+BITSET_API bool bitset_atomic_attach_shared(AtomicBitSet* const bitset, const char* const name);
+BITSET_API void bitset_atomic_detach_shared(AtomicBitSet* const bitset);
+#endif
+#endif
+
+#ifndef BITSET_STREAM_CHUNK_SIZE
+#define BITSET_STREAM_CHUNK_SIZE 8192u // bytes passed to a stream sink or requested from a stream source at once (multiple of 8)
+#endif
+
+/**
+ * Magic number at the start of a bitset stream ("BITSETS" followed by a zero byte)
+ */
+#define BITSET_STREAM_MAGIC 0x0053544553544942ull
+
+/**
+ * Version of the bitset stream format written by bitset_write
+ */
+#define BITSET_STREAM_VERSION 1u
+
+/**
+ * Size of the header of a bitset stream in bytes (magic, version, encoding and size, little-endian)
+ */
+#define BITSET_STREAM_HEADER_SIZE 24u
+
+/**
+ * Encoding of the 64-bit words of a bitset stream (always little-endian, independent of BITSET_BLOCK_TYPE)
+ */
+typedef enum
+{
+    /**
+     * All of the words as they are
+     */
+    BITSET_STREAM_RAW = 0,
+    /**
+     * Word-aligned hybrid, every marker word (run length in bits 0-31, fill value in bit 32, literal count in bits 33-63)
+     * is followed by its literal words, so runs of empty or full words take a single marker
+     */
+    BITSET_STREAM_WAH = 1
+} bitset_stream_encoding;
+
+/**
+ * Callback receiving the bytes written by bitset_write, at most BITSET_STREAM_CHUNK_SIZE at a time
+ * @param data The bytes to write
+ * @param size Number of bytes
+ * @param context The context pointer passed to bitset_write
+ * @return Whether the bytes were written (false aborts the stream)
+ */
+typedef bool (*bitset_stream_sink)(const void* const data, const uint64_t size, void* const context);
+
+/**
+ * Callback providing the bytes read by bitset_read, at most BITSET_STREAM_CHUNK_SIZE at a time
+ * @param data Where to store the bytes (may point straight into the blocks of the bitset)
+ * @param size Number of bytes to read, all of them have to be provided
+ * @param context The context pointer passed to bitset_read
+ * @return Whether all of the bytes were read (false aborts the stream)
+ */
+typedef bool (*bitset_stream_source)(void* const data, const uint64_t size, void* const context);
+
+/**
+ * Buffered writer of bitset_write, collects the encoded words into chunks for the sink
+ */
+typedef struct
+{
+    bitset_stream_sink sink;
+    void* context;
+    uint64_t used;
+    bool valid;
+    uint8_t buffer[BITSET_STREAM_CHUNK_SIZE];
+} bitset_stream_writer;
+
+BITSET_API void bitset_store_le64(uint8_t* const bytes, const uint64_t value);
+BITSET_API uint64_t bitset_load_le64(const uint8_t* const bytes);
+BITSET_API void bitset_stream_flush(bitset_stream_writer* const writer);
+BITSET_API void bitset_stream_put(bitset_stream_writer* const writer, const uint8_t* const data, const uint64_t size);
+BITSET_API void bitset_stream_put_word(bitset_stream_writer* const writer, const uint64_t word);
+BITSET_API uint64_t bitset_stream_word(const BitSet* const bitset, const uint64_t index);
+BITSET_API bool bitset_write(const BitSet* const bitset, const bitset_stream_sink sink, void* const context, const bitset_stream_encoding encoding);
+BITSET_API bool bitset_stream_read_words(BitSet* const bitset, const uint64_t first, const uint64_t count, const bitset_stream_source source, void* const context);
+BITSET_API bool bitset_stream_read_header(uint64_t* const size, bitset_stream_encoding* const encoding, const bitset_stream_source source, void* const context);
+BITSET_API bool bitset_stream_read_payload(BitSet* const bitset, const bitset_stream_encoding encoding, const bitset_stream_source source, void* const context);
+BITSET_API bool bitset_read(BitSet* const bitset, const bitset_stream_source source, void* const context);
+BITSET_API bool bitset_dynamic_read(DynamicBitSet* const bitset, const bitset_stream_source source, void* const context);
+BITSET_API bool bitset_stream_file_sink(const void* const data, const uint64_t size, void* const context);
+BITSET_API bool bitset_stream_file_source(void* const data, const uint64_t size, void* const context);
+
+/**
+ * Number of bits covered by one entry of the rank index (4 sub-blocks of 512 bits)
+ */
+#define BITSET_RANK_BLOCK_BITS 2048u
+
+/**
+ * Number of bits of a sub-block of the rank index, rank popcounts at most BITSET_RANK_SUBBLOCK_BITS / 64 words
+ */
+#define BITSET_RANK_SUBBLOCK_BITS 512u
+
+/**
+ * Number of blocks of the rank index counted relative to the same 64-bit base (2^32 bits, so the relative counts fit 32 bits)
+ */
+#define BITSET_RANK_REGION_BLOCKS (1u << 21)
+
+/**
+ * Every BITSET_SELECT_SAMPLE-th set bit has the block holding it sampled, select searches only between two samples
+ */
+#define BITSET_SELECT_SAMPLE 8192u
+
+/**
+ * Rank/select index over a bitset that is not modified anymore (poppy layout), the bits are not copied
+ * One 64-bit entry per BITSET_RANK_BLOCK_BITS bits holds the count before the block (32 bits, relative to its region)
+ * and the counts of its first three sub-blocks (10 bits each), so rank is two lookups and at most 7 popcounts
+ * The entries take 3.2% of the size of the bitset, the select samples at most 0.8% more
+ */
+typedef struct
+{
+    /**
+     * The indexed bitset, has to outlive the index and must not be modified while indexed
+     */
+    const BitSet* bitset;
+    /**
+     * Count of the set bits before every region of BITSET_RANK_REGION_BLOCKS blocks
+     */
+    uint64_t* regions;
+    /**
+     * Packed entry of every block (low 32 bits: count before the block within its region, then 3 x 10-bit sub-block counts)
+     */
+    uint64_t* blocks;
+    /**
+     * Index of the block holding set bit number k * BITSET_SELECT_SAMPLE, for every k
+     */
+    uint64_t* samples;
+    /**
+     * Number of blocks
+     */
+    uint64_t block_count;
+    /**
+     * Number of regions
+     */
+    uint64_t region_count;
+    /**
+     * Number of select samples
+     */
+    uint64_t sample_count;
+    /**
+     * Number of set bits of the bitset
+     */
+    uint64_t count;
+} BitSetRankIndex;
+
+BITSET_API uint64_t bitset_select_word(uint64_t word, uint64_t rank);
+BITSET_API bool bitset_rank_index_init(BitSetRankIndex* const index, const BitSet* const bitset);
+BITSET_API void bitset_rank_index_destroy(BitSetRankIndex* const index);
+BITSET_API uint64_t bitset_rank_index_block_rank(const BitSetRankIndex* const index, const uint64_t block);
+BITSET_API uint64_t bitset_rank(const BitSetRankIndex* const index, const uint64_t position);
+BITSET_API uint64_t bitset_select(const BitSetRankIndex* const index, const uint64_t rank);
+BITSET_API uint64_t bitset_rank_index_memory_usage(const BitSetRankIndex* const index);
+
+/**
+ * Number of bits of a block of BloomFilter, all the bits of a key lie in one block (one cache line)
+ */
+#define BITSET_BLOOM_BLOCK_BITS 512u
+
+/**
+ * Maximal number of bits set per key in a BloomFilter
+ */
+#define BITSET_BLOOM_MAX_HASHES 16u
+
+/**
+ * Blocked Bloom filter stored in a DynamicBitSet, every key sets hash_count bits of a single BITSET_BLOOM_BLOCK_BITS-bit block
+ * so an insert or a query costs one cache miss instead of hash_count
+ * Keys are 64-bit values (hash longer keys first), they are mixed before use, so sequential keys are fine
+ */
+typedef struct
+{
+    /**
+     * The bits of the filter (block_count * BITSET_BLOOM_BLOCK_BITS bits, aligned by the default allocator)
+     */
+    DynamicBitSet bits;
+    /**
+     * Number of blocks
+     */
+    uint64_t block_count;
+    /**
+     * Number of bits set per key (1 - BITSET_BLOOM_MAX_HASHES)
+     */
+    uint64_t hash_count;
+} BloomFilter;
+
+BITSET_API double bitset_log2_double(const double value);
+BITSET_API double bitset_exp2_double(const double value);
+BITSET_API uint64_t bitset_bloom_hash(const uint64_t key);
+BITSET_API uint64_t bitset_bloom_block_index(const uint64_t hash, const uint64_t block_count);
+BITSET_API void bitset_bloom_block_mask(const uint64_t hash, const uint64_t hash_count, uint64_t* const mask);
+BITSET_API double bitset_bloom_false_positive_rate(const uint64_t block_count, const uint64_t hash_count, const uint64_t items);
+BITSET_API void bitset_bloom_geometry(const uint64_t expected_items, const double false_positive_rate, uint64_t* const block_count, uint64_t* const hash_count);
+BITSET_API void bitset_bloom_init_blocks(BloomFilter* const filter, const uint64_t block_count, const uint64_t hash_count);
+BITSET_API void bitset_bloom_init(BloomFilter* const filter, const uint64_t expected_items, const double false_positive_rate);
+BITSET_API void bitset_bloom_destroy(BloomFilter* const filter);
+BITSET_API void bitset_bloom_clear(BloomFilter* const filter);
+BITSET_API void bitset_bloom_insert(BloomFilter* const filter, const uint64_t key);
+BITSET_API bool bitset_bloom_contains(const BloomFilter* const filter, const uint64_t key);
+BITSET_API void bitset_bloom_insert_many(BloomFilter* const filter, const uint64_t* const keys, const uint64_t count);
+BITSET_API void bitset_bloom_contains_many(const BloomFilter* const filter, const uint64_t* const keys, const uint64_t count, bool* const results);
+BITSET_API bool bitset_bloom_union(BloomFilter* const destination, const BloomFilter* const source);
+BITSET_API bool bitset_bloom_intersection(BloomFilter* const destination, const BloomFilter* const source);
+
+#ifndef BITSET_COW_PAGE_SIZE
+#define BITSET_COW_PAGE_SIZE 65536u // bytes of bits per page of CowBitSet (multiple of 8), the unit copied by the first write after a snapshot
+#endif
+
+/**
+ * Number of bits per page of CowBitSet
+ */
+#define BITSET_COW_PAGE_BITS ((uint64_t)BITSET_COW_PAGE_SIZE * 8u)
+
+/**
+ * Reference counted page of a CowBitSet, its BITSET_COW_PAGE_SIZE bytes of blocks follow at offset BITSET_ALIGNMENT
+ */
+typedef struct
+{
+    /**
+     * Number of bitsets sharing the page (updated atomically)
+     */
+    uint64_t references;
+} bitset_cow_page;
+
+/**
+ * A copy-on-write bitset split into reference counted pages of BITSET_COW_PAGE_SIZE bytes
+ * bitset_cow_snapshot shares all of the pages (O(pages) pointer work, no bits are copied) and a shared page is copied
+ * on the first write to it, so a writer only pays for the pages it touches and every snapshot keeps a consistent view
+ * A bitset and its snapshots may be used by different threads (each one by a single thread at a time), the allocator has to be thread safe then
+ * Pages that were never written are NULL and read as cleared
+ */
+typedef struct
+{
+    /**
+     * Pointers to the pages (NULL for pages with all of the bits cleared)
+     */
+    bitset_cow_page** pages;
+    /**
+     * Number of pages
+     */
+    uint64_t page_count;
+    /**
+     * Size of bitset in bits
+     */
+    uint64_t size;
+    /**
+     * Allocator of the pages and of the page table (NULL for the default allocator), shared with the snapshots
+     */
+    const bitset_allocator* allocator;
+} CowBitSet;
+
+BITSET_API bitset_block_t* bitset_cow_page_blocks(const bitset_cow_page* const page);
+BITSET_API BitSet* bitset_cow_page_bitset(const CowBitSet* const bitset, const uint64_t page, DynamicBitSet* const view);
+BITSET_API void bitset_cow_release_page(const bitset_allocator* const allocator, bitset_cow_page* const page);
+BITSET_API bitset_cow_page* bitset_cow_writable_page(CowBitSet* const bitset, const uint64_t page, const bool preserve);
+BITSET_API bool bitset_cow_init(CowBitSet* const bitset, const uint64_t size);
+BITSET_API bool bitset_cow_init_allocator(CowBitSet* const bitset, const uint64_t size, const bitset_allocator* const allocator);
+BITSET_API bool bitset_cow_init_bitset(CowBitSet* const bitset, const BitSet* const source);
+BITSET_API void bitset_cow_destroy(CowBitSet* const bitset);
+BITSET_API bool bitset_cow_snapshot(CowBitSet* const snapshot, const CowBitSet* const source);
+BITSET_API bool bitset_cow_get(const CowBitSet* const bitset, const uint64_t index);
+BITSET_API void bitset_cow_set(CowBitSet* const bitset, const uint64_t index);
+BITSET_API void bitset_cow_clear(CowBitSet* const bitset, const uint64_t index);
+BITSET_API void bitset_cow_set_value(CowBitSet* const bitset, const bool value, const uint64_t index);
+BITSET_API void bitset_cow_flip_bit(CowBitSet* const bitset, const uint64_t index);
+BITSET_API void bitset_cow_fill_in_range_begin_end(CowBitSet* const bitset, const bool value, const uint64_t begin, const uint64_t end);
+BITSET_API void bitset_cow_flip_in_range_begin_end(CowBitSet* const bitset, const uint64_t begin, const uint64_t end);
+BITSET_API void bitset_cow_fill_all(CowBitSet* const bitset, const bool value);
+BITSET_API uint64_t bitset_cow_count(const CowBitSet* const bitset);
+BITSET_API uint64_t bitset_cow_shared_pages(const CowBitSet* const bitset);
+BITSET_API void bitset_cow_to_bitset(const CowBitSet* const bitset, BitSet* const destination);
+
+#ifndef BITSET_MATRIX_ROW_ALIGNMENT
+#define BITSET_MATRIX_ROW_ALIGNMENT (BITSET_ALIGNMENT > 8u ? BITSET_ALIGNMENT : 8u) // bytes every row of a BitMatrix is padded to (a multiple of 8 and of the block size)
+#endif
+
+/**
+ * A rows x columns bit matrix, every row is a bitset of columns bits
+ * The rows are stored contiguously in a single DynamicBitSet, each one padded to BITSET_MATRIX_ROW_ALIGNMENT bytes,
+ * so every row starts aligned (with the default allocator) and is a whole number of 64-bit words
+ * A column becomes a row of the transposed matrix (bitset_matrix_transpose), so a column query is one contiguous read
+ */
+typedef struct
+{
+    /**
+     * The rows (rows * row_stride blocks), the padding past the columns of every row is ignored
+     */
+    DynamicBitSet bits;
+    /**
+     * Number of rows
+     */
+    uint64_t rows;
+    /**
+     * Number of columns (bits per row)
+     */
+    uint64_t columns;
+    /**
+     * Distance between the starts of two rows (block size)
+     */
+    uint64_t row_stride;
+} BitMatrix;
+
+BITSET_API uint64_t bitset_matrix_row_stride(const uint64_t columns);
+BITSET_API void bitset_matrix_init(BitMatrix* const matrix, const uint64_t rows, const uint64_t columns);
+BITSET_API void bitset_matrix_init_rows(BitMatrix* const matrix, const BitSet* const* const rows, const uint64_t count);
+BITSET_API void bitset_matrix_destroy(BitMatrix* const matrix);
+BITSET_API BitSet* bitset_matrix_row(const BitMatrix* const matrix, const uint64_t row, DynamicBitSet* const view);
+BITSET_API bool bitset_matrix_get(const BitMatrix* const matrix, const uint64_t row, const uint64_t column);
+BITSET_API void bitset_matrix_set_value(BitMatrix* const matrix, const bool value, const uint64_t row, const uint64_t column);
+BITSET_API bool bitset_matrix_transpose(BitMatrix* const destination, const BitMatrix* const source);
+BITSET_API void bitset_matrix_extract_column(const BitMatrix* const matrix, const uint64_t column, BitSet* const destination);
+BITSET_API void bitset_matrix_rows_operation(BitMatrix* const matrix, const BitSet* const other, const bitset_operation operation);
+BITSET_API void bitset_matrix_reduce_rows(const BitMatrix* const matrix, const uint64_t* const rows, const uint64_t count, const bitset_operation operation, BitSet* const destination);
+BITSET_API void bitset_matrix_count_rows(const BitMatrix* const matrix, uint64_t* const counts);
+BITSET_API void bitset_matrix_binary_count_rows(const BitMatrix* const matrix, const BitSet* const other, const bitset_operation operation, uint64_t* const counts);
+
+#ifdef BITSET_ENABLE_STATS
+BITSET_API void bitset_stats_record(const bitset_stats_family family, const uint64_t bits, const uint64_t bytes);
+BITSET_API void bitset_stats_reallocation(const bitset_stats_family family, const uint64_t old_size, const uint64_t new_size);
+BITSET_API void bitset_trace_begin(const char* const name, const uint64_t bytes);
+BITSET_API void bitset_trace_end(const char* const name, const uint64_t bytes);
+BITSET_API const char* bitset_stats_family_name(const bitset_stats_family family);
+BITSET_API void bitset_stats_reset(void);
+BITSET_API void bitset_stats_print(FILE* const stream);
+#endif
+BITSET_API void* bitset_aligned_allocate(const uint64_t size, void* const context);
+BITSET_API void* bitset_aligned_reallocate(void* const pointer, const uint64_t old_size, const uint64_t new_size, void* const context);
+BITSET_API void bitset_aligned_deallocate(void* const pointer, const uint64_t size, void* const context);
+#ifdef BITSET_HUGE_PAGES
+BITSET_API void* bitset_huge_page_allocate(const uint64_t size, void* const context);
+BITSET_API void* bitset_huge_page_reallocate(void* const pointer, const uint64_t old_size, const uint64_t new_size, void* const context);
+BITSET_API void bitset_huge_page_deallocate(void* const pointer, const uint64_t size, void* const context);
+#endif
+BITSET_API uint64_t bitset_pool_class(const uint64_t size);
+BITSET_API void* bitset_pool_allocate(const uint64_t size, void* const context);
+BITSET_API void* bitset_pool_reallocate(void* const pointer, const uint64_t old_size, const uint64_t new_size, void* const context);
+BITSET_API void bitset_pool_deallocate(void* const pointer, const uint64_t size, void* const context);
+BITSET_API void bitset_pool_init(bitset_pool* const pool, const bitset_allocator* const upstream);
+BITSET_API void bitset_pool_destroy(bitset_pool* const pool);
+BITSET_API void* bitset_allocate(const bitset_allocator* const allocator, const uint64_t size);
+BITSET_API void* bitset_reallocate(const bitset_allocator* const allocator, void* const pointer, const uint64_t old_size, const uint64_t new_size);
+BITSET_API void bitset_deallocate(const bitset_allocator* const allocator, void* const pointer, const uint64_t size);
+BITSET_API void bitset_dynamic_init(DynamicBitSet* const bitset, const uint64_t size);
+BITSET_API void bitset_dynamic_init_allocator(DynamicBitSet* const bitset, const uint64_t size, const bitset_allocator* const allocator);
+BITSET_API void bitset_init(BitSet* const bitset);
+BITSET_API void bitset_dynamic_init_block(DynamicBitSet* const bitset, const uint64_t size, const bitset_block_t block);
+BITSET_API void bitset_init_block(BitSet* const bitset, const bitset_block_t block);
+BITSET_API void bitset_dynamic_destroy(DynamicBitSet* const bitset);
+BITSET_API void bitset_copy(BitSet* const destination, const BitSet* const source);
+BITSET_API void bitset_dynamic_move(DynamicBitSet* const destination, DynamicBitSet* const source);
+BITSET_API bool bitset_get(const BitSet* const bitset, const uint64_t index);
+BITSET_API void bitset_set_value(BitSet* const bitset, const uint64_t value, const uint64_t index);
+BITSET_API void bitset_set(BitSet* const bitset, const uint64_t index);
+BITSET_API void bitset_clear(BitSet* const bitset, const uint64_t index);
+BITSET_API void bitset_fill_all(BitSet* const bitset, const bool value);
+BITSET_API void bitset_clear_all(BitSet* const bitset);
+BITSET_API void bitset_set_all(BitSet* const bitset);
+BITSET_API void bitset_fill_in_range_end(BitSet* const bitset, const bool value, const uint64_t end);
+BITSET_API void bitset_clear_in_range_end(BitSet* const bitset, const uint64_t end);
+BITSET_API void bitset_set_in_range_end(BitSet* const bitset, const uint64_t end);
+BITSET_API void bitset_fill_in_range_begin_end(BitSet* const bitset, const bool value, const uint64_t begin, const uint64_t end);
+BITSET_API void bitset_clear_in_range_begin_end(BitSet* const bitset, const uint64_t begin, const uint64_t end);
+BITSET_API void bitset_set_in_range_begin_end(BitSet* const bitset, const uint64_t begin, const uint64_t end);
+BITSET_API void bitset_update_word(BitSet* const bitset, const uint64_t index, const uint64_t clear_mask, const uint64_t toggle_mask);
+BITSET_API void bitset_update_in_range_begin_end_step(BitSet* const bitset, const uint64_t begin, const uint64_t end, const uint64_t step, const uint64_t width, const uint64_t clear_value, const uint64_t toggle_value);
+BITSET_API void bitset_fill_in_range_begin_end_step(BitSet* const bitset, const bool value, const uint64_t begin, const uint64_t end, const uint64_t step);
+BITSET_API void bitset_clear_in_range_begin_end_step(BitSet* const bitset, const uint64_t begin, const uint64_t end, const uint64_t step);
+BITSET_API void bitset_set_in_range_begin_end_step(BitSet* const bitset, const uint64_t begin, const uint64_t end, const uint64_t step);
+BITSET_API void bitset_set_block(BitSet* const bitset, const bitset_block_t block, const uint64_t index);
+BITSET_API void bitset_fill_all_blocks(BitSet* const bitset, const bitset_block_t value);
+BITSET_API void bitset_fill_block_in_range_end(BitSet* const bitset, const bitset_block_t block, const uint64_t end);
+BITSET_API void bitset_fill_block_in_range_begin_end(BitSet* const bitset, const bitset_block_t block, const uint64_t begin, const uint64_t end);
+BITSET_API void bitset_fill_block_in_range_begin_end_step(BitSet* const bitset, const bitset_block_t block, const uint64_t begin, const uint64_t end, const uint64_t step);
+BITSET_API void bitset_fill_pattern_in_range_begin_end(BitSet* const bitset, const uint64_t pattern, const uint64_t pattern_bits, const uint64_t begin, const uint64_t end);
+BITSET_API void bitset_flip_bit(BitSet* const bitset, const uint64_t index);
+BITSET_API void bitset_update_many(BitSet* const bitset, const uint64_t* const indices, const uint64_t count, const bool clear, const bool toggle);
+BITSET_API void bitset_set_many(BitSet* const bitset, const uint64_t* const indices, const uint64_t count);
+BITSET_API void bitset_clear_many(BitSet* const bitset, const uint64_t* const indices, const uint64_t count);
+BITSET_API void bitset_flip_many(BitSet* const bitset, const uint64_t* const indices, const uint64_t count);
+BITSET_API void bitset_get_many(const BitSet* const bitset, const uint64_t* const indices, const uint64_t count, bool* const values);
+BITSET_API void bitset_flip_all(BitSet* const bitset);
+BITSET_API void bitset_flip_in_range_end(BitSet* const bitset, const uint64_t end);
+BITSET_API void bitset_flip_in_range_begin_end(BitSet* const bitset, const uint64_t begin, const uint64_t end);
+BITSET_API void bitset_flip_in_range_begin_end_step(BitSet* const bitset, const uint64_t begin, const uint64_t end, const uint64_t step);
+BITSET_API void bitset_flip_block(BitSet* const bitset, const uint64_t index);
+BITSET_API void bitset_flip_block_all(BitSet* const bitset);
+BITSET_API void bitset_flip_block_in_range_end(BitSet* const bitset, const uint64_t end);
+BITSET_API void bitset_flip_block_in_range_begin_end(BitSet* const bitset, const uint64_t begin, const uint64_t end);
+BITSET_API void bitset_flip_block_in_range_begin_end_step(BitSet* const bitset, const uint64_t begin, const uint64_t end, const uint64_t step);
+BITSET_API bitset_block_t bitset_get_block(const BitSet* const bitset, const uint64_t index);
+BITSET_API bool bitset_all(const BitSet* const bitset);
+BITSET_API bool bitset_any(const BitSet* const bitset);
+BITSET_API bool bitset_none(const BitSet* const bitset);
+BITSET_API bool bitset_all_cleared(const BitSet* const bitset);
+BITSET_API bool bitset_all_in_range(const BitSet* const bitset, const uint64_t begin, const uint64_t end);
+BITSET_API bool bitset_any_in_range(const BitSet* const bitset, const uint64_t begin, const uint64_t end);
+BITSET_API uint64_t bitset_count(const BitSet* const bitset);
+BITSET_API bool bitset_empty(const BitSet* const bitset);
+BITSET_API void bitset_dynamic_push_back(DynamicBitSet* const bitset, const bool value);
+BITSET_API void bitset_dynamic_pop_back(DynamicBitSet* const bitset);
+BITSET_API void bitset_dynamic_push_back_block(DynamicBitSet* const bitset, const bitset_block_t block);
+BITSET_API void bitset_dynamic_pop_back_block(DynamicBitSet* const bitset);
+BITSET_API void bitset_dynamic_resize(DynamicBitSet* const bitset, const uint64_t new_size);
+BITSET_API void bitset_dynamic_resize_value(DynamicBitSet* const bitset, const uint64_t new_size, const bool value);
+BITSET_API void bitset_dynamic_reserve(DynamicBitSet* const bitset, const uint64_t capacity);
+BITSET_API void bitset_dynamic_shrink_to_fit(DynamicBitSet* const bitset);
+BITSET_API void bitset_dynamic_grow(DynamicBitSet* const bitset);
+BITSET_API uint64_t bitset_calculate_storage_size(const uint64_t size);
+BITSET_API bitset_block_t bitset_create_filled_block(const bool value);
+BITSET_API bitset_block_t bitset_create_mask_from(const uint64_t bit);
+BITSET_API bitset_block_t bitset_create_mask_to(const uint64_t bit);
+BITSET_API uint64_t bitset_popcount64(const uint64_t value);
+BITSET_API uint64_t bitset_popcount_bytes(const uint8_t* const data, const uint64_t size);
+BITSET_API uint64_t bitset_count_in_range(const BitSet* const bitset, const uint64_t begin, const uint64_t end);
+BITSET_API void bitset_binary_bytes(uint8_t* const destination, const uint8_t* const left, const uint8_t* const right, const uint64_t size, const bitset_operation operation);
+BITSET_API uint64_t bitset_binary_count_bytes(const uint8_t* const left, const uint8_t* const right, const uint64_t size, const bitset_operation operation);
+BITSET_API bool bitset_binary_any_bytes(const uint8_t* const left, const uint8_t* const right, const uint64_t size, const bitset_operation operation);
+BITSET_API void bitset_and_or_count_bytes(const uint8_t* const left, const uint8_t* const right, const uint64_t size, uint64_t* const and_count, uint64_t* const or_count);
+BITSET_API void bitset_binary_operation(BitSet* const destination, const BitSet* const left, const BitSet* const right, const bitset_operation operation);
+BITSET_API uint64_t bitset_binary_count(const BitSet* const left, const BitSet* const right, const bitset_operation operation);
+BITSET_API bool bitset_binary_any(const BitSet* const left, const BitSet* const right, const bitset_operation operation);
+BITSET_API bool bitset_intersects(const BitSet* const left, const BitSet* const right);
+BITSET_API bool bitset_is_subset(const BitSet* const left, const BitSet* const right);
+BITSET_API void bitset_and(BitSet* const destination, const BitSet* const source);
+BITSET_API void bitset_or(BitSet* const destination, const BitSet* const source);
+BITSET_API void bitset_xor(BitSet* const destination, const BitSet* const source);
+BITSET_API void bitset_andnot(BitSet* const destination, const BitSet* const source);
+BITSET_API void bitset_and_into(BitSet* const destination, const BitSet* const left, const BitSet* const right);
+BITSET_API void bitset_or_into(BitSet* const destination, const BitSet* const left, const BitSet* const right);
+BITSET_API void bitset_xor_into(BitSet* const destination, const BitSet* const left, const BitSet* const right);
+BITSET_API void bitset_andnot_into(BitSet* const destination, const BitSet* const left, const BitSet* const right);
+BITSET_API uint64_t bitset_and_count(const BitSet* const left, const BitSet* const right);
+BITSET_API uint64_t bitset_or_count(const BitSet* const left, const BitSet* const right);
+BITSET_API uint64_t bitset_xor_count(const BitSet* const left, const BitSet* const right);
+BITSET_API uint64_t bitset_andnot_count(const BitSet* const left, const BitSet* const right);
+BITSET_API bitset_block_t bitset_apply_operation(const bitset_block_t left, const bitset_block_t right, const bitset_operation operation);
+BITSET_API double bitset_jaccard(const BitSet* const left, const BitSet* const right);
+BITSET_API uint64_t bitset_ctz64(const uint64_t value);
+BITSET_API uint64_t bitset_clz64(const uint64_t value);
+BITSET_API uint64_t bitset_get_word(const BitSet* const bitset, const uint64_t index);
+BITSET_API uint64_t bitset_calculate_word_count(const uint64_t size);
+BITSET_API uint64_t bitset_find_next_value(const BitSet* const bitset, const bool value, const uint64_t begin);
+BITSET_API uint64_t bitset_find_prev_value(const BitSet* const bitset, const bool value, const uint64_t end);
+BITSET_API uint64_t bitset_find_first(const BitSet* const bitset);
+BITSET_API uint64_t bitset_find_next(const BitSet* const bitset, const uint64_t index);
+BITSET_API uint64_t bitset_find_last(const BitSet* const bitset);
+BITSET_API uint64_t bitset_find_prev(const BitSet* const bitset, const uint64_t index);
+BITSET_API uint64_t bitset_find_first_unset(const BitSet* const bitset);
+BITSET_API uint64_t bitset_find_next_unset(const BitSet* const bitset, const uint64_t index);
+BITSET_API uint64_t bitset_find_last_unset(const BitSet* const bitset);
+BITSET_API uint64_t bitset_find_prev_unset(const BitSet* const bitset, const uint64_t index);
+BITSET_API uint64_t bitset_extract_word(uint64_t word, const uint64_t base, uint64_t* const indices);
+BITSET_API bool bitset_extract_word_compress_supported(void);
+BITSET_API uint64_t bitset_extract_indices(const BitSet* const bitset, const uint64_t begin, uint64_t* const indices, const uint64_t capacity);
+BITSET_API void bitset_for_each_set_bit(const BitSet* const bitset, const bitset_index_callback callback, void* const context);
+BITSET_API uint64_t bitset_find_next_run(const BitSet* const bitset, const uint64_t begin, const uint64_t min_length, const bool value);
+BITSET_API void bitset_for_each_run(const BitSet* const bitset, const bool value, const bitset_run_callback callback, void* const context);
+BITSET_API uint64_t bitset_count_runs(const BitSet* const bitset, const bool value);
+BITSET_API uint64_t bitset_get_word_below(const BitSet* const bitset, const uint64_t index, const uint64_t end);
+BITSET_API void bitset_shift_left_or_into(BitSet* const destination, const BitSet* const source, const uint64_t shift, const uint64_t bits);
+BITSET_API void bitset_shift_left_into(BitSet* const destination, const BitSet* const source, const uint64_t shift);
+BITSET_API void bitset_shift_left(BitSet* const bitset, const uint64_t shift);
+BITSET_API void bitset_shift_left_or(BitSet* const bitset, const uint64_t shift, const uint64_t bits);
+BITSET_API void bitset_shift_right_into(BitSet* const destination, const BitSet* const source, const uint64_t shift);
+BITSET_API void bitset_shift_right(BitSet* const bitset, const uint64_t shift);
+BITSET_API void bitset_rotate_left_into(BitSet* const destination, const BitSet* const source, const uint64_t shift);
+BITSET_API void bitset_rotate_right_into(BitSet* const destination, const BitSet* const source, const uint64_t shift);
+BITSET_API void bitset_rotate_left(BitSet* const bitset, const uint64_t shift);
+BITSET_API void bitset_rotate_right(BitSet* const bitset, const uint64_t shift);
+BITSET_API uint64_t bitset_apply_operation64(const uint64_t left, const uint64_t right, const bitset_operation operation);
+BITSET_API void bitset_view_init(BitSetView* const view, const BitSet* const bitset, const uint64_t begin, const uint64_t size);
+BITSET_API uint64_t bitset_view_get_word(const BitSetView* const view, const uint64_t index);
+BITSET_API void bitset_view_update_word(BitSetView* const view, const uint64_t index, const uint64_t clear_mask, const uint64_t toggle_mask);
+BITSET_API bool bitset_view_get(const BitSetView* const view, const uint64_t index);
+BITSET_API void bitset_view_set_value(BitSetView* const view, const bool value, const uint64_t index);
+BITSET_API void bitset_view_fill(BitSetView* const view, const bool value);
+BITSET_API void bitset_view_flip(BitSetView* const view);
+BITSET_API uint64_t bitset_view_count(const BitSetView* const view);
+BITSET_API bool bitset_view_any(const BitSetView* const view);
+BITSET_API bool bitset_view_all(const BitSetView* const view);
+BITSET_API bool bitset_view_none(const BitSetView* const view);
+BITSET_API uint64_t bitset_view_find_next_value(const BitSetView* const view, const bool value, const uint64_t begin);
+BITSET_API uint64_t bitset_view_find_first(const BitSetView* const view);
+BITSET_API uint64_t bitset_view_find_next(const BitSetView* const view, const uint64_t index);
+BITSET_API void bitset_view_for_each_set_bit(const BitSetView* const view, const bitset_index_callback callback, void* const context);
+BITSET_API void bitset_view_binary_operation(BitSetView* const destination, const BitSetView* const left, const BitSetView* const right, const bitset_operation operation);
+BITSET_API uint64_t bitset_view_binary_count(const BitSetView* const left, const BitSetView* const right, const bitset_operation operation);
+BITSET_API void bitset_view_copy(BitSetView* const destination, const BitSetView* const source);
+BITSET_API uint64_t bitset_parallel_threads(void);
+BITSET_API uint64_t bitset_parallel_chunk_count(const void* const data, const uint64_t size);
+BITSET_API uint64_t bitset_parallel_chunk_offset(const void* const data, const uint64_t size, const uint64_t chunk);
+BITSET_API void bitset_flip_bytes(uint8_t* const data, const uint64_t size);
+BITSET_API uint64_t bitset_rotate_pattern_bytes(const uint64_t pattern, const uint64_t offset);
+BITSET_API void bitset_fill_pattern_bytes(uint8_t* const data, const uint64_t pattern, const uint64_t size);
+BITSET_API void bitset_get_many_bytes(const uint8_t* const data, const uint64_t size, const uint64_t* const indices, const uint64_t count, bool* const values);
+BITSET_API uint64_t bitset_find_byte_not(const uint8_t* const data, const uint64_t size, const uint8_t skip);
+BITSET_API uint64_t bitset_count_run_starts_bytes(const uint8_t* const data, const uint64_t size, const uint64_t invert);
+BITSET_API void bitset_transpose64(uint64_t* const words);
+BITSET_API uint64_t bitset_parallel_popcount_bytes(const uint8_t* const data, const uint64_t size);
+BITSET_API void bitset_parallel_fill_bytes(uint8_t* const data, const uint8_t value, const uint64_t size);
+BITSET_API void bitset_parallel_flip_bytes(uint8_t* const data, const uint64_t size);
+BITSET_API void bitset_parallel_binary_bytes(uint8_t* const destination, const uint8_t* const left, const uint8_t* const right, const uint64_t size, const bitset_operation operation);
+BITSET_API uint64_t bitset_parallel_binary_count_bytes(const uint8_t* const left, const uint8_t* const right, const uint64_t size, const bitset_operation operation);
+BITSET_API uint64_t bitset_parallel_find_byte_not(const uint8_t* const data, const uint64_t size, const uint8_t skip);
+BITSET_API uint64_t bitset_parallel_count(const BitSet* const bitset);
+BITSET_API void bitset_parallel_fill_all(BitSet* const bitset, const bool value);
+BITSET_API void bitset_parallel_fill_in_range_begin_end(BitSet* const bitset, const bool value, const uint64_t begin, const uint64_t end);
+BITSET_API void bitset_parallel_flip_all(BitSet* const bitset);
+BITSET_API void bitset_parallel_binary_operation(BitSet* const destination, const BitSet* const left, const BitSet* const right, const bitset_operation operation);
+BITSET_API uint64_t bitset_parallel_binary_count(const BitSet* const left, const BitSet* const right, const bitset_operation operation);
+BITSET_API uint64_t bitset_parallel_find_next_value(const BitSet* const bitset, const bool value, const uint64_t begin);
+
+#ifdef BITSET_ENABLE_STATS
+/**
+ * Counts a call of an operation family
+ * @param family The family of the operation
+ * @param bits Number of bits the operation read or wrote
+ * @param bytes Number of bytes of blocks the operation scanned
+ */
+BITSET_API void bitset_stats_record(const bitset_stats_family family, const uint64_t bits, const uint64_t bytes)
+{
+    bitset_stats_counters* const counters = &bitset_global_stats.families[family];
+    BITSET_STATS_ADD(&counters->calls, 1u);
+    BITSET_STATS_ADD(&counters->bits, bits);
+    BITSET_STATS_ADD(&counters->bytes, bytes);
+}
+
+/**
+ * Counts a reallocation of the blocks by an operation family
+ * @param family The family of the operation
+ * @param old_size Size of the blocks before the reallocation (bytes)
+ * @param new_size Size of the blocks after the reallocation (bytes)
+ */
+BITSET_API void bitset_stats_reallocation(const bitset_stats_family family, const uint64_t old_size, const uint64_t new_size)
+{
+    (void)old_size;
+    bitset_stats_counters* const counters = &bitset_global_stats.families[family];
+    BITSET_STATS_ADD(&counters->reallocations, 1u);
+    BITSET_STATS_ADD(&counters->reallocated_bytes, new_size);
+    BITSET_STATS_ADD(&bitset_global_stats.reallocation_sizes[new_size ? 64u - bitset_clz64(new_size) : 0u], 1u);
+}
+
+/**
+ * Marks the beginning of a bulk operation for the trace callbacks, ITT and USDT probes
+ * @param name Name of the operation (string literal)
+ * @param bytes Number of bytes the operation processes
+ */
+BITSET_API void bitset_trace_begin(const char* const name, const uint64_t bytes)
+{
+#ifdef BITSET_ENABLE_ITT
+    __itt_task_begin(__itt_domain_create("bitset"), __itt_null, __itt_null, __itt_string_handle_create(name));
+#endif
+#ifdef BITSET_ENABLE_SDT
+    DTRACE_PROBE2(bitset, kernel_begin, name, bytes);
+#endif
+    if (bitset_global_stats.trace_begin)
+        bitset_global_stats.trace_begin(name, bytes, bitset_global_stats.trace_context);
+}
+
+/**
+ * Marks the end of a bulk operation for the trace callbacks, ITT and USDT probes
+ * @param name Name of the operation (string literal)
+ * @param bytes Number of bytes the operation processed
+ */
+BITSET_API void bitset_trace_end(const char* const name, const uint64_t bytes)
+{
+#ifdef BITSET_ENABLE_ITT
+    __itt_task_end(__itt_domain_create("bitset"));
+#endif
+#ifdef BITSET_ENABLE_SDT
+    DTRACE_PROBE2(bitset, kernel_end, name, bytes);
+#endif
+    if (bitset_global_stats.trace_end)
+        bitset_global_stats.trace_end(name, bytes, bitset_global_stats.trace_context);
+}
+
+/**
+ * @param family The operation family
+ * @return Lowercase name of the family
+ */
+BITSET_API const char* bitset_stats_family_name(const bitset_stats_family family)
+{
+    static const char* const names[BITSET_STATS_FAMILIES] = { "access", "fill", "count", "algebra", "find", "shift", "resize" };
+    return family < BITSET_STATS_FAMILIES ? names[family] : "unknown";
+}
+
+/**
+ * Zeroes all of the counters (the trace callbacks are kept), not synchronized with concurrent operations
+ */
+BITSET_API void bitset_stats_reset(void)
+{
+    memset(bitset_global_stats.families, 0, sizeof(bitset_global_stats.families));
+    memset(bitset_global_stats.reallocation_sizes, 0, sizeof(bitset_global_stats.reallocation_sizes));
+}
+
+/**
+ * Writes the counters as a table, one line per family followed by the non-empty reallocation size buckets
+ * @param stream The stream to write to
+ */
+BITSET_API void bitset_stats_print(FILE* const stream)
+{
+    fprintf(stream, "%-8s %14s %20s %20s %14s %20s\n", "family", "calls", "bits", "bytes", "reallocations", "reallocated_bytes");
+    for (uint32_t family = 0; family < BITSET_STATS_FAMILIES; ++family)
+    {
+        const bitset_stats_counters* const counters = &bitset_global_stats.families[family];
+        fprintf(stream, "%-8s %14llu %20llu %20llu %14llu %20llu\n", bitset_stats_family_name((bitset_stats_family)family),
+                (unsigned long long)counters->calls, (unsigned long long)counters->bits, (unsigned long long)counters->bytes,
+                (unsigned long long)counters->reallocations, (unsigned long long)counters->reallocated_bytes);
+    }
+    for (uint32_t k = 0; k < 65u; ++k)
+    {
+        if (bitset_global_stats.reallocation_sizes[k])
+            fprintf(stream, "reallocations to [%llu, %llu) bytes: %llu\n", k ? 1ull << (k - 1u) : 0ull, k < 64u ? 1ull << k : 0ull,
+                    (unsigned long long)bitset_global_stats.reallocation_sizes[k]);
+    }
+}
+#endif
+
+/**
+ * Counts the set bits of a 64-bit word (POPCNT instruction where available)
+ * @param value The word to count the bits of
+ * @return The number of set bits
+ */
+BITSET_API uint64_t bitset_popcount64(const uint64_t value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return (uint64_t)__builtin_popcountll(value);
+#elif defined(_MSC_VER) && defined(_M_X64) && defined(__AVX__)
+    return __popcnt64(value);
+#else
+    uint64_t x = value - ((value >> 1) & 0x5555555555555555ull);
+    x = (x & 0x3333333333333333ull) + ((x >> 2) & 0x3333333333333333ull);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+    return (x * 0x0101010101010101ull) >> 56;
+#endif
+}
+
+/**
+ * Counts the set bits of a byte array word-at-a-time (portable kernel)
+ * @param data Pointer to the bytes to count
+ * @param size Number of bytes to count
+ * @return The number of set bits
+ */
+BITSET_API uint64_t bitset_popcount_bytes_generic(const uint8_t* const data, const uint64_t size)
+{
+    uint64_t count = 0, i = 0, word;
+    for (; i + 8u <= size; i += 8u)
+    {
+        memcpy(&word, data + i, 8u);
+        count += bitset_popcount64(word);
+    }
+    for (; i < size; ++i)
+        count += bitset_popcount64(*(data + i));
+    return count;
+}
+
+#ifdef BITSET_X86_DISPATCH
+/**
+ * Counts the set bits of a byte array with the POPCNT instruction
+ * @param data Pointer to the bytes to count
+ * @param size Number of bytes to count
+ * @return The number of set bits
+ */
+BITSET_TARGET("popcnt") BITSET_API uint64_t bitset_popcount_bytes_popcnt(const uint8_t* const data, const uint64_t size)
+{
+    uint64_t count0 = 0, count1 = 0, i = 0, word0, word1;
+    // two independent accumulators to keep both popcnt ports busy
+    for (; i + 16u <= size; i += 16u)
+    {
+        memcpy(&word0, data + i, 8u);
+        memcpy(&word1, data + i + 8u, 8u);
+        count0 += (uint64_t)__builtin_popcountll(word0);
+        count1 += (uint64_t)__builtin_popcountll(word1);
+    }
+    for (; i < size; ++i)
+        count0 += (uint64_t)__builtin_popcountll(*(data + i));
+    return count0 + count1;
+}
+
+/**
+ * Counts the set bits of every byte of an AVX2 vector (nibble lookup with vpshufb)
+ * @param vector The vector to count the bits of
+ * @return Vector of per-byte bit counts (0 - 8)
+ */
+BITSET_TARGET("avx2") BITSET_API __m256i bitset_popcount_epi8_avx2(const __m256i vector)
+{
+    const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low_mask = _mm256_set1_epi8(0x0f);
+    const __m256i low = _mm256_and_si256(vector, low_mask);
+    const __m256i high = _mm256_and_si256(_mm256_srli_epi16(vector, 4), low_mask);
+    return _mm256_add_epi8(_mm256_shuffle_epi8(lookup, low), _mm256_shuffle_epi8(lookup, high));
+}
+
+/**
+ * Sums the four 64-bit lanes of an AVX2 vector
+ * @param vector The vector to sum
+ * @return The sum of the lanes
+ */
+BITSET_TARGET("avx2") BITSET_API uint64_t bitset_sum_epi64_avx2(const __m256i vector)
+{
+    return (uint64_t)_mm256_extract_epi64(vector, 0) + (uint64_t)_mm256_extract_epi64(vector, 1)
+         + (uint64_t)_mm256_extract_epi64(vector, 2) + (uint64_t)_mm256_extract_epi64(vector, 3);
+}
+
+/**
+ * Sums the eight 64-bit lanes of an AVX-512 vector
+ * @param vector The vector to sum
+ * @return The sum of the lanes
+ */
+BITSET_TARGET("avx512f") BITSET_API uint64_t bitset_sum_epi64_avx512(const __m512i vector)
+{
+    uint64_t lanes[8], sum = 0;
+    _mm512_storeu_si512((void*)lanes, vector);
+    for (uint32_t k = 0; k < 8u; ++k)
+        sum += lanes[k];
+    return sum;
+}
+
+/**
+ * Counts the set bits of a byte array with AVX2 (nibble lookup with vpshufb, summed with vpsadbw)
+ * @param data Pointer to the bytes to count
+ * @param size Number of bytes to count
+ * @return The number of set bits
+ */
+BITSET_TARGET("avx2,popcnt") BITSET_API uint64_t bitset_popcount_bytes_avx2(const uint8_t* const data, const uint64_t size)
+{
+    __m256i total = _mm256_setzero_si256();
+    uint64_t i = 0;
+    while (i + 32u <= size)
+    {
+        // byte counters hold at most 8 per iteration, so flush them every 31 iterations
+        __m256i local = _mm256_setzero_si256();
+        for (uint32_t k = 0; k < 31u && i + 32u <= size; ++k, i += 32u)
+            local = _mm256_add_epi8(local, bitset_popcount_epi8_avx2(_mm256_loadu_si256((const __m256i*)(data + i))));
+        total = _mm256_add_epi64(total, _mm256_sad_epu8(local, _mm256_setzero_si256()));
+    }
+    return bitset_sum_epi64_avx2(total) + bitset_popcount_bytes_popcnt(data + i, size - i);
+}
+
+/**
+ * Counts the set bits of a byte array with AVX-512 VPOPCNTQ
+ * @param data Pointer to the bytes to count
+ * @param size Number of bytes to count
+ * @return The number of set bits
+ */
+BITSET_TARGET("avx512f,avx512vpopcntdq,popcnt") BITSET_API uint64_t bitset_popcount_bytes_avx512(const uint8_t* const data, const uint64_t size)
+{
+    __m512i total0 = _mm512_setzero_si512(), total1 = _mm512_setzero_si512();
+    uint64_t i = 0;
+    for (; i + 128u <= size; i += 128u)
+    {
+        total0 = _mm512_add_epi64(total0, _mm512_popcnt_epi64(_mm512_loadu_si512((const void*)(data + i))));
+        total1 = _mm512_add_epi64(total1, _mm512_popcnt_epi64(_mm512_loadu_si512((const void*)(data + i + 64u))));
+    }
+    for (; i + 64u <= size; i += 64u)
+        total0 = _mm512_add_epi64(total0, _mm512_popcnt_epi64(_mm512_loadu_si512((const void*)(data + i))));
+    return bitset_sum_epi64_avx512(_mm512_add_epi64(total0, total1)) + bitset_popcount_bytes_popcnt(data + i, size - i);
+}
+#endif
+
+/**
+ * Counts the set bits of a byte array, picking the fastest kernel supported by the CPU
+ * @param data Pointer to the bytes to count
+ * @param size Number of bytes to count
+ * @return The number of set bits
+ */
+BITSET_API uint64_t bitset_popcount_bytes(const uint8_t* const data, const uint64_t size)
+{
+#ifdef BITSET_X86_DISPATCH
+    if (size >= BITSET_SIMD_THRESHOLD)
+    {
+        if (__builtin_cpu_supports("avx512vpopcntdq"))
+            return bitset_popcount_bytes_avx512(data, size);
+        if (__builtin_cpu_supports("avx2"))
+            return bitset_popcount_bytes_avx2(data, size);
+    }
+    if (__builtin_cpu_supports("popcnt"))
+        return bitset_popcount_bytes_popcnt(data, size);
+#endif
+    return bitset_popcount_bytes_generic(data, size);
+}
+
+// scalar and vector forms of the bulk operations, used to generate the kernels below
+#define BITSET_AND(left, right) ((left) & (right))
+#define BITSET_OR(left, right) ((left) | (right))
+#define BITSET_XOR(left, right) ((left) ^ (right))
+#define BITSET_ANDNOT(left, right) ((left) & ~(right))
+#define BITSET_ANDNOT_SSE2(left, right) _mm_andnot_si128(right, left)
+#define BITSET_ANDNOT_AVX2(left, right) _mm256_andnot_si256(right, left)
+#define BITSET_ANDNOT_AVX512(left, right) _mm512_ternarylogic_epi64(left, right, right, 0x30) // left & ~right (vpandnq intrinsics trip -Wmaybe-uninitialized in GCC headers)
+
+/**
+ * Body of the word-at-a-time kernel computing destination = left op right over a byte array
+ */
+#define BITSET_BINARY_BYTES_BODY(scalar_op) \
+    uint64_t i = 0, word_left, word_right; \
+    for (; i + 8u <= size; i += 8u) \
+    { \
+        memcpy(&word_left, left + i, 8u); \
+        memcpy(&word_right, right + i, 8u); \
+        word_left = scalar_op(word_left, word_right); \
+        memcpy(destination + i, &word_left, 8u); \
+    } \
+    for (; i < size; ++i) \
+        *(destination + i) = (uint8_t)scalar_op(*(left + i), *(right + i));
+
+/**
+ * Body of the word-at-a-time kernel counting the set bits of left op right over a byte array
+ */
+#define BITSET_BINARY_COUNT_BYTES_BODY(scalar_op) \
+    uint64_t count = 0, i = 0, word_left, word_right; \
+    for (; i + 8u <= size; i += 8u) \
+    { \
+        memcpy(&word_left, left + i, 8u); \
+        memcpy(&word_right, right + i, 8u); \
+        count += bitset_popcount64(scalar_op(word_left, word_right)); \
+    } \
+    for (; i < size; ++i) \
+        count += bitset_popcount64((uint8_t)scalar_op(*(left + i), *(right + i))); \
+    return count;
+
+#ifdef BITSET_X86_DISPATCH
+/**
+ * Generates the SSE2, AVX2 and AVX-512 kernels of a bulk operation and the dispatching bitset_<name>_bytes function
+ */
+#define BITSET_DEFINE_BINARY_KERNELS_X86(name, scalar_op, sse2_op, avx2_op, avx512_op) \
+BITSET_TARGET("sse2") BITSET_API void bitset_##name##_bytes_sse2(uint8_t* const destination, const uint8_t* const left, const uint8_t* const right, const uint64_t size) \
+{ \
+    uint64_t i = 0; \
+    for (; i + 16u <= size; i += 16u) \
+        _mm_storeu_si128((__m128i*)(destination + i), sse2_op(_mm_loadu_si128((const __m128i*)(left + i)), _mm_loadu_si128((const __m128i*)(right + i)))); \
+    bitset_##name##_bytes_generic(destination + i, left + i, right + i, size - i); \
+} \
+BITSET_TARGET("avx2") BITSET_API void bitset_##name##_bytes_avx2(uint8_t* const destination, const uint8_t* const left, const uint8_t* const right, const uint64_t size) \
+{ \
+    uint64_t i = 0; \
+    for (; i + 64u <= size; i += 64u) \
+    { \
+        const __m256i result0 = avx2_op(_mm256_loadu_si256((const __m256i*)(left + i)), _mm256_loadu_si256((const __m256i*)(right + i))); \
+        const __m256i result1 = avx2_op(_mm256_loadu_si256((const __m256i*)(left + i + 32u)), _mm256_loadu_si256((const __m256i*)(right + i + 32u))); \
+        _mm256_storeu_si256((__m256i*)(destination + i), result0); \
+        _mm256_storeu_si256((__m256i*)(destination + i + 32u), result1); \
+    } \
+    bitset_##name##_bytes_sse2(destination + i, left + i, right + i, size - i); \
+} \
+BITSET_TARGET("avx512f") BITSET_API void bitset_##name##_bytes_avx512(uint8_t* const destination, const uint8_t* const left, const uint8_t* const right, const uint64_t size) \
+{ \
+    uint64_t i = 0; \
+    for (; i + 64u <= size; i += 64u) \
+        _mm512_storeu_si512((void*)(destination + i), avx512_op(_mm512_loadu_si512((const void*)(left + i)), _mm512_loadu_si512((const void*)(right + i)))); \
+    bitset_##name##_bytes_sse2(destination + i, left + i, right + i, size - i); \
+} \
+BITSET_TARGET("popcnt") BITSET_API uint64_t bitset_##name##_count_bytes_popcnt(const uint8_t* const left, const uint8_t* const right, const uint64_t size) \
+{ \
+    BITSET_BINARY_COUNT_BYTES_BODY(scalar_op) \
+} \
+BITSET_TARGET("avx2,popcnt") BITSET_API uint64_t bitset_##name##_count_bytes_avx2(const uint8_t* const left, const uint8_t* const right, const uint64_t size) \
+{ \
+    __m256i total = _mm256_setzero_si256(); \
+    uint64_t i = 0; \
+    while (i + 32u <= size) \
+    { \
+        __m256i local = _mm256_setzero_si256(); \
+        for (uint32_t k = 0; k < 31u && i + 32u <= size; ++k, i += 32u) \
+            local = _mm256_add_epi8(local, bitset_popcount_epi8_avx2(avx2_op(_mm256_loadu_si256((const __m256i*)(left + i)), _mm256_loadu_si256((const __m256i*)(right + i))))); \
+        total = _mm256_add_epi64(total, _mm256_sad_epu8(local, _mm256_setzero_si256())); \
+    } \
+    return bitset_sum_epi64_avx2(total) + bitset_##name##_count_bytes_popcnt(left + i, right + i, size - i); \
+} \
+BITSET_TARGET("avx512f,avx512vpopcntdq,popcnt") BITSET_API uint64_t bitset_##name##_count_bytes_avx512(const uint8_t* const left, const uint8_t* const right, const uint64_t size) \
+{ \
+    __m512i total = _mm512_setzero_si512(); \
+    uint64_t i = 0; \
+    for (; i + 64u <= size; i += 64u) \
+        total = _mm512_add_epi64(total, _mm512_popcnt_epi64(avx512_op(_mm512_loadu_si512((const void*)(left + i)), _mm512_loadu_si512((const void*)(right + i))))); \
+    return bitset_sum_epi64_avx512(total) + bitset_##name##_count_bytes_popcnt(left + i, right + i, size - i); \
+} \
+BITSET_API void bitset_##name##_bytes(uint8_t* const destination, const uint8_t* const left, const uint8_t* const right, const uint64_t size) \
+{ \
+    if (size >= BITSET_SIMD_THRESHOLD) \
+    { \
+        if (__builtin_cpu_supports("avx512f")) \
+        { \
+            bitset_##name##_bytes_avx512(destination, left, right, size); \
+            return; \
+        } \
+        if (__builtin_cpu_supports("avx2")) \
+        { \
+            bitset_##name##_bytes_avx2(destination, left, right, size); \
+            return; \
+        } \
+    } \
+    if (__builtin_cpu_supports("sse2")) \
+        bitset_##name##_bytes_sse2(destination, left, right, size); \
+    else \
+        bitset_##name##_bytes_generic(destination, left, right, size); \
+} \
+BITSET_API uint64_t bitset_##name##_count_bytes(const uint8_t* const left, const uint8_t* const right, const uint64_t size) \
+{ \
+    if (size >= BITSET_SIMD_THRESHOLD) \
+    { \
+        if (__builtin_cpu_supports("avx512vpopcntdq")) \
+            return bitset_##name##_count_bytes_avx512(left, right, size); \
+        if (__builtin_cpu_supports("avx2")) \
+            return bitset_##name##_count_bytes_avx2(left, right, size); \
+    } \
+    if (__builtin_cpu_supports("popcnt")) \
+        return bitset_##name##_count_bytes_popcnt(left, right, size); \
+    return bitset_##name##_count_bytes_generic(left, right, size); \
+}
+#else
+#define BITSET_DEFINE_BINARY_KERNELS_X86(name, scalar_op, sse2_op, avx2_op, avx512_op) \
+BITSET_API void bitset_##name##_bytes(uint8_t* const destination, const uint8_t* const left, const uint8_t* const right, const uint64_t size) \
+{ \
+    bitset_##name##_bytes_generic(destination, left, right, size); \
+} \
+BITSET_API uint64_t bitset_##name##_count_bytes(const uint8_t* const left, const uint8_t* const right, const uint64_t size) \
+{ \
+    return bitset_##name##_count_bytes_generic(left, right, size); \
+}
+#endif
+
+/**
+ * Generates all of the kernels of a bulk operation:
+ * bitset_<name>_bytes(destination, left, right, size) computing destination = left op right
+ * and bitset_<name>_count_bytes(left, right, size) counting the set bits of left op right without storing it
+ */
+#define BITSET_DEFINE_BINARY_KERNELS(name, scalar_op, sse2_op, avx2_op, avx512_op) \
+BITSET_API void bitset_##name##_bytes_generic(uint8_t* const destination, const uint8_t* const left, const uint8_t* const right, const uint64_t size) \
+{ \
+    BITSET_BINARY_BYTES_BODY(scalar_op) \
+} \
+BITSET_API uint64_t bitset_##name##_count_bytes_generic(const uint8_t* const left, const uint8_t* const right, const uint64_t size) \
+{ \
+    BITSET_BINARY_COUNT_BYTES_BODY(scalar_op) \
+} \
+BITSET_DEFINE_BINARY_KERNELS_X86(name, scalar_op, sse2_op, avx2_op, avx512_op)
+
+BITSET_DEFINE_BINARY_KERNELS(and, BITSET_AND, _mm_and_si128, _mm256_and_si256, _mm512_and_si512)
+BITSET_DEFINE_BINARY_KERNELS(or, BITSET_OR, _mm_or_si128, _mm256_or_si256, _mm512_or_si512)
+BITSET_DEFINE_BINARY_KERNELS(xor, BITSET_XOR, _mm_xor_si128, _mm256_xor_si256, _mm512_xor_si512)
+BITSET_DEFINE_BINARY_KERNELS(andnot, BITSET_ANDNOT, BITSET_ANDNOT_SSE2, BITSET_ANDNOT_AVX2, BITSET_ANDNOT_AVX512)
+
+/**
+ * Computes destination = left op right over byte arrays, picking the fastest kernel supported by the CPU
+ * destination may be the same array as left or right, but must not partially overlap them
+ * @param destination Pointer to the bytes to store the result to
+ * @param left Pointer to the bytes of the left operand
+ * @param right Pointer to the bytes of the right operand
+ * @param size Number of bytes to process
+ * @param operation The operation to apply
+ */
+BITSET_API void bitset_binary_bytes(uint8_t* const destination, const uint8_t* const left, const uint8_t* const right, const uint64_t size, const bitset_operation operation)
+{
+    switch (operation)
+    {
+    case BITSET_OPERATION_AND:
+        bitset_and_bytes(destination, left, right, size);
+        break;
+    case BITSET_OPERATION_OR:
+        bitset_or_bytes(destination, left, right, size);
+        break;
+    case BITSET_OPERATION_XOR:
+        bitset_xor_bytes(destination, left, right, size);
+        break;
+    case BITSET_OPERATION_ANDNOT:
+        bitset_andnot_bytes(destination, left, right, size);
+        break;
+    }
+}
+
+/**
+ * Counts the set bits of left op right over byte arrays without storing the result
+ * @param left Pointer to the bytes of the left operand
+ * @param right Pointer to the bytes of the right operand
+ * @param size Number of bytes to process
+ * @param operation The operation to apply
+ * @return The number of set bits of the result
+ */
+BITSET_API uint64_t bitset_binary_count_bytes(const uint8_t* const left, const uint8_t* const right, const uint64_t size, const bitset_operation operation)
+{
+    switch (operation)
+    {
+    case BITSET_OPERATION_AND:
+        return bitset_and_count_bytes(left, right, size);
+    case BITSET_OPERATION_OR:
+        return bitset_or_count_bytes(left, right, size);
+    case BITSET_OPERATION_XOR:
+        return bitset_xor_count_bytes(left, right, size);
+    case BITSET_OPERATION_ANDNOT:
+        return bitset_andnot_count_bytes(left, right, size);
+    }
+    return 0;
+}
+
+/**
+ * Checks if left op right has any set bit over byte arrays, stopping at the first non-zero word (portable kernel)
+ * @param left Pointer to the bytes of the left operand
+ * @param right Pointer to the bytes of the right operand
+ * @param size Number of bytes to process
+ * @param operation The operation to apply
+ * @return True if any bit of the result is set, false otherwise
+ */
+BITSET_API bool bitset_binary_any_bytes_generic(const uint8_t* const left, const uint8_t* const right, const uint64_t size, const bitset_operation operation)
+{
+    uint64_t i = 0, word_left, word_right;
+    for (; i + 8u <= size; i += 8u)
+    {
+        memcpy(&word_left, left + i, 8u);
+        memcpy(&word_right, right + i, 8u);
+        if (bitset_apply_operation64(word_left, word_right, operation))
+            return true;
+    }
+    for (; i < size; ++i)
+    {
+        if ((uint8_t)bitset_apply_operation64(*(left + i), *(right + i), operation))
+            return true;
+    }
+    return false;
+}
+
+#ifdef BITSET_X86_DISPATCH
+/**
+ * Checks if left op right has any set bit over byte arrays with AVX2 (vptest on 64 bytes per iteration)
+ * @param left Pointer to the bytes of the left operand
+ * @param right Pointer to the bytes of the right operand
+ * @param size Number of bytes to process
+ * @param operation The operation to apply
+ * @return True if any bit of the result is set, false otherwise
+ */
+BITSET_TARGET("avx2") BITSET_API bool bitset_binary_any_bytes_avx2(const uint8_t* const left, const uint8_t* const right, const uint64_t size, const bitset_operation operation)
+{
+    uint64_t i = 0;
+    for (; i + 64u <= size; i += 64u)
+    {
+        const __m256i left0 = _mm256_loadu_si256((const __m256i*)(left + i)), left1 = _mm256_loadu_si256((const __m256i*)(left + i + 32u));
+        const __m256i right0 = _mm256_loadu_si256((const __m256i*)(right + i)), right1 = _mm256_loadu_si256((const __m256i*)(right + i + 32u));
+        bool found = false;
+        switch (operation)
+        {
+        case BITSET_OPERATION_AND:
+            found = !_mm256_testz_si256(left0, right0) || !_mm256_testz_si256(left1, right1);
+            break;
+        case BITSET_OPERATION_OR:
+        {
+            const __m256i result = _mm256_or_si256(_mm256_or_si256(left0, right0), _mm256_or_si256(left1, right1));
+            found = !_mm256_testz_si256(result, result);
+            break;
+        }
+        case BITSET_OPERATION_XOR:
+        {
+            const __m256i result = _mm256_or_si256(_mm256_xor_si256(left0, right0), _mm256_xor_si256(left1, right1));
+            found = !_mm256_testz_si256(result, result);
+            break;
+        }
+        case BITSET_OPERATION_ANDNOT:
+            // testc(right, left) checks left & ~right == 0
+            found = !_mm256_testc_si256(right0, left0) || !_mm256_testc_si256(right1, left1);
+            break;
+        }
+        if (found)
+            return true;
+    }
+    return bitset_binary_any_bytes_generic(left + i, right + i, size - i, operation);
+}
+#endif
+
+/**
+ * Checks if left op right has any set bit over byte arrays without storing the result, stopping at the first set bit
+ * @param left Pointer to the bytes of the left operand
+ * @param right Pointer to the bytes of the right operand
+ * @param size Number of bytes to process
+ * @param operation The operation to apply
+ * @return True if any bit of the result is set, false otherwise
+ */
+BITSET_API bool bitset_binary_any_bytes(const uint8_t* const left, const uint8_t* const right, const uint64_t size, const bitset_operation operation)
+{
+#ifdef BITSET_X86_DISPATCH
+    if (size >= BITSET_SIMD_THRESHOLD && __builtin_cpu_supports("avx2"))
+        return bitset_binary_any_bytes_avx2(left, right, size, operation);
+#endif
+    return bitset_binary_any_bytes_generic(left, right, size, operation);
+}
+
+/**
+ * Body of the word-at-a-time kernel counting the set bits of both left & right and left | right
+ */
+#define BITSET_AND_OR_COUNT_BYTES_BODY \
+    uint64_t i = 0, word_left, word_right; \
+    for (; i + 8u <= size; i += 8u) \
+    { \
+        memcpy(&word_left, left + i, 8u); \
+        memcpy(&word_right, right + i, 8u); \
+        *and_count += bitset_popcount64(word_left & word_right); \
+        *or_count += bitset_popcount64(word_left | word_right); \
+    } \
+    for (; i < size; ++i) \
+    { \
+        *and_count += bitset_popcount64(*(left + i) & *(right + i)); \
+        *or_count += bitset_popcount64(*(left + i) | *(right + i)); \
+    }
+
+#ifdef BITSET_X86_DISPATCH
+/**
+ * Counts the set bits of both left & right and left | right with the POPCNT instruction
+ */
+BITSET_TARGET("popcnt") BITSET_API void bitset_and_or_count_bytes_popcnt(const uint8_t* const left, const uint8_t* const right, const uint64_t size, uint64_t* const and_count, uint64_t* const or_count)
+{
+    BITSET_AND_OR_COUNT_BYTES_BODY
+}
+
+/**
+ * Counts the set bits of both left & right and left | right with AVX2
+ */
+BITSET_TARGET("avx2,popcnt") BITSET_API void bitset_and_or_count_bytes_avx2(const uint8_t* const left, const uint8_t* const right, const uint64_t size, uint64_t* const and_count, uint64_t* const or_count)
+{
+    __m256i and_total = _mm256_setzero_si256(), or_total = _mm256_setzero_si256();
+    uint64_t i = 0;
+    while (i + 32u <= size)
+    {
+        __m256i and_local = _mm256_setzero_si256(), or_local = _mm256_setzero_si256();
+        for (uint32_t k = 0; k < 31u && i + 32u <= size; ++k, i += 32u)
+        {
+            const __m256i vector_left = _mm256_loadu_si256((const __m256i*)(left + i));
+            const __m256i vector_right = _mm256_loadu_si256((const __m256i*)(right + i));
+            and_local = _mm256_add_epi8(and_local, bitset_popcount_epi8_avx2(_mm256_and_si256(vector_left, vector_right)));
+            or_local = _mm256_add_epi8(or_local, bitset_popcount_epi8_avx2(_mm256_or_si256(vector_left, vector_right)));
+        }
+        and_total = _mm256_add_epi64(and_total, _mm256_sad_epu8(and_local, _mm256_setzero_si256()));
+        or_total = _mm256_add_epi64(or_total, _mm256_sad_epu8(or_local, _mm256_setzero_si256()));
+    }
+    *and_count += bitset_sum_epi64_avx2(and_total);
+    *or_count += bitset_sum_epi64_avx2(or_total);
+    bitset_and_or_count_bytes_popcnt(left + i, right + i, size - i, and_count, or_count);
+}
+
+/**
+ * Counts the set bits of both left & right and left | right with AVX-512 VPOPCNTQ
+ */
+BITSET_TARGET("avx512f,avx512vpopcntdq,popcnt") BITSET_API void bitset_and_or_count_bytes_avx512(const uint8_t* const left, const uint8_t* const right, const uint64_t size, uint64_t* const and_count, uint64_t* const or_count)
+{
+    __m512i and_total = _mm512_setzero_si512(), or_total = _mm512_setzero_si512();
+    uint64_t i = 0;
+    for (; i + 64u <= size; i += 64u)
+    {
+        const __m512i vector_left = _mm512_loadu_si512((const void*)(left + i));
+        const __m512i vector_right = _mm512_loadu_si512((const void*)(right + i));
+        and_total = _mm512_add_epi64(and_total, _mm512_popcnt_epi64(_mm512_and_si512(vector_left, vector_right)));
+        or_total = _mm512_add_epi64(or_total, _mm512_popcnt_epi64(_mm512_or_si512(vector_left, vector_right)));
+    }
+    *and_count += bitset_sum_epi64_avx512(and_total);
+    *or_count += bitset_sum_epi64_avx512(or_total);
+    bitset_and_or_count_bytes_popcnt(left + i, right + i, size - i, and_count, or_count);
+}
+#endif
+
+/**
+ * Counts the set bits of both left & right and left | right in a single pass over byte arrays
+ * @param left Pointer to the bytes of the left operand
+ * @param right Pointer to the bytes of the right operand
+ * @param size Number of bytes to process
+ * @param and_count Pointer to the counter the intersection count is added to
+ * @param or_count Pointer to the counter the union count is added to
+ */
+BITSET_API void bitset_and_or_count_bytes(const uint8_t* const left, const uint8_t* const right, const uint64_t size, uint64_t* const and_count, uint64_t* const or_count)
+{
+#ifdef BITSET_X86_DISPATCH
+    if (size >= BITSET_SIMD_THRESHOLD && __builtin_cpu_supports("avx512vpopcntdq"))
+        bitset_and_or_count_bytes_avx512(left, right, size, and_count, or_count);
+    else if (size >= BITSET_SIMD_THRESHOLD && __builtin_cpu_supports("avx2"))
+        bitset_and_or_count_bytes_avx2(left, right, size, and_count, or_count);
+    else if (__builtin_cpu_supports("popcnt"))
+        bitset_and_or_count_bytes_popcnt(left, right, size, and_count, or_count);
+    else
+#endif
+    {
+        BITSET_AND_OR_COUNT_BYTES_BODY
+    }
+}
+
+/**
+ * Counts the trailing zero bits of a 64-bit word (TZCNT/BSF where available)
+ * @param value The word to scan, must not be zero
+ * @return Index of the lowest set bit
+ */
+BITSET_API uint64_t bitset_ctz64(const uint64_t value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return (uint64_t)__builtin_ctzll(value);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    unsigned long index;
+    _BitScanForward64(&index, value);
+    return index;
+#else
+    return bitset_popcount64((value & (0u - value)) - 1u);
+#endif
+}
+
+/**
+ * Counts the leading zero bits of a 64-bit word (LZCNT/BSR where available)
+ * @param value The word to scan, must not be zero
+ * @return 63 - index of the highest set bit
+ */
+BITSET_API uint64_t bitset_clz64(const uint64_t value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return (uint64_t)__builtin_clzll(value);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return 63u - index;
+#else
+    uint64_t x = value;
+    x |= x >> 1;
+    x |= x >> 2;
+    x |= x >> 4;
+    x |= x >> 8;
+    x |= x >> 16;
+    x |= x >> 32;
+    return 64u - bitset_popcount64(x);
+#endif
+}
+
+/**
+ * Writes the indices of the set bits of a 64-bit word, lowest first
+ * @param word The word to extract the bits of
+ * @param base Index of the lowest bit of the word (bit index)
+ * @param indices Pointer to the buffer to write the indices to (room for popcount(word) indices)
+ * @return Number of indices written
+ */
+BITSET_API uint64_t bitset_extract_word(uint64_t word, const uint64_t base, uint64_t* const indices)
+{
+    uint64_t count = 0;
+    while (word)
+    {
+        *(indices + count++) = base + bitset_ctz64(word);
+        word &= word - 1u;
+    }
+    return count;
+}
+
+#ifdef BITSET_X86_DISPATCH
+/**
+ * Writes the indices of the set bits of a 64-bit word, lowest first, with AVX-512 VBMI2 vpcompressb
+ * @param word The word to extract the bits of
+ * @param base Index of the lowest bit of the word (bit index)
+ * @param indices Pointer to the buffer to write the indices to (room for popcount(word) indices)
+ * @return Number of indices written
+ */
+BITSET_TARGET("avx512f,avx512bw,avx512vbmi2,popcnt") BITSET_API uint64_t bitset_extract_word_compress(const uint64_t word, const uint64_t base, uint64_t* const indices)
+{
+    const uint64_t count = (uint64_t)__builtin_popcountll(word);
+    const __m512i positions = _mm512_set_epi64(0x3f3e3d3c3b3a3938ll, 0x3736353433323130ll, 0x2f2e2d2c2b2a2928ll, 0x2726252423222120ll,
+                                               0x1f1e1d1c1b1a1918ll, 0x1716151413121110ll, 0x0f0e0d0c0b0a0908ll, 0x0706050403020100ll);
+    uint8_t compressed[64];
+    // positions of the set bits packed into the lowest bytes
+    _mm512_storeu_si512((void*)compressed, _mm512_maskz_compress_epi8((__mmask64)word, positions));
+    const __m512i base_vector = _mm512_set1_epi64((long long)base);
+    for (uint64_t i = 0; i < count; i += 8u)
+    {
+        const __m512i lanes = _mm512_add_epi64(_mm512_maskz_cvtepu8_epi64((__mmask8)0xff, _mm_loadl_epi64((const __m128i*)(compressed + i))), base_vector);
+        const __mmask8 mask = count - i >= 8u ? (__mmask8)0xff : (__mmask8)((1u << (count - i)) - 1u);
+        _mm512_mask_storeu_epi64((void*)(indices + i), mask, lanes);
+    }
+    return count;
+}
+#endif
+
+/**
+ * Checks if the vpcompressb based bitset_extract_word_compress can be used on this CPU
+ * @return True if AVX-512 VBMI2 is supported, false otherwise
+ */
+BITSET_API bool bitset_extract_word_compress_supported(void)
+{
+#ifdef BITSET_X86_DISPATCH
+    return __builtin_cpu_supports("avx512vbmi2") && __builtin_cpu_supports("avx512bw");
+#else
+    return false;
+#endif
+}
+
+/**
+ * @return The number of threads used by the bitset_parallel_* functions (1 without OpenMP)
+ */
+BITSET_API uint64_t bitset_parallel_threads(void)
+{
+#ifdef _OPENMP
+    return (uint64_t)omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+
+/**
+ * Calculates the number of parallel chunks the byte array is split into
+ * The first chunk ends on a cache line boundary, all the others span BITSET_PARALLEL_CHUNK_SIZE bytes (the last one may be shorter)
+ * @param data The array to split
+ * @param size Number of bytes in the array
+ * @return The number of chunks
+ */
+BITSET_API uint64_t bitset_parallel_chunk_count(const void* const data, const uint64_t size)
+{
+    const uint64_t misalignment = (BITSET_CACHE_LINE_SIZE - (uintptr_t)data % BITSET_CACHE_LINE_SIZE) % BITSET_CACHE_LINE_SIZE;
+    if (!size)
+        return 0;
+    if (size <= misalignment)
+        return 1;
+    return (size - misalignment + BITSET_PARALLEL_CHUNK_SIZE - 1u) / BITSET_PARALLEL_CHUNK_SIZE;
+}
+
+/**
+ * Calculates the offset of the specified parallel chunk (see bitset_parallel_chunk_count)
+ * @param data The array to split
+ * @param size Number of bytes in the array
+ * @param chunk Index of the chunk, offset of chunk + 1 is the end of the chunk
+ * @return Offset of the chunk in bytes
+ */
+BITSET_API uint64_t bitset_parallel_chunk_offset(const void* const data, const uint64_t size, const uint64_t chunk)
+{
+    const uint64_t misalignment = (BITSET_CACHE_LINE_SIZE - (uintptr_t)data % BITSET_CACHE_LINE_SIZE) % BITSET_CACHE_LINE_SIZE;
+    if (!chunk)
+        return 0;
+    const uint64_t offset = misalignment + chunk * BITSET_PARALLEL_CHUNK_SIZE;
+    return offset < size ? offset : size;
+}
+
+/**
+ * Inverts every byte of the array
+ * @param data The array to flip
+ * @param size Number of bytes in the array
+ */
+BITSET_API void bitset_flip_bytes(uint8_t* const data, const uint64_t size)
+{
+    uint64_t i = 0;
+    for (; i + 8u <= size; i += 8u)
+    {
+        uint64_t word;
+        memcpy(&word, data + i, sizeof(uint64_t));
+        word = ~word;
+        memcpy(data + i, &word, sizeof(uint64_t));
+    }
+    for (; i < size; ++i)
+        *(data + i) = (uint8_t)~*(data + i);
+}
+
+/**
+ * Shifts an 8-byte memory pattern so that it starts at the specified byte of the original one
+ * @param pattern The pattern as stored in memory (native 64-bit word)
+ * @param offset Byte of the pattern the result starts with (taken modulo 8)
+ * @return The pattern starting at byte offset
+ */
+BITSET_API uint64_t bitset_rotate_pattern_bytes(const uint64_t pattern, const uint64_t offset)
+{
+    uint8_t bytes[16];
+    uint64_t result;
+    memcpy(bytes, &pattern, 8u);
+    memcpy(bytes + 8u, &pattern, 8u);
+    memcpy(&result, bytes + offset % 8u, 8u);
+    return result;
+}
+
+/**
+ * Fills the byte array with a repeating 8-byte pattern (portable kernel)
+ * @param data The array to fill
+ * @param pattern The pattern as stored in memory, data[i] receives byte i % 8 of it
+ * @param size Number of bytes in the array
+ */
+BITSET_API void bitset_fill_pattern_bytes_generic(uint8_t* const data, const uint64_t pattern, const uint64_t size)
+{
+    uint8_t bytes[8];
+    uint64_t i = 0;
+    for (; i + 8u <= size; i += 8u)
+        memcpy(data + i, &pattern, 8u);
+    memcpy(bytes, &pattern, 8u);
+    for (; i < size; ++i)
+        *(data + i) = bytes[i % 8u];
+}
+
+#ifdef BITSET_X86_DISPATCH
+/**
+ * Fills the byte array with a repeating 8-byte pattern with AVX2
+ * Arrays of at least BITSET_NONTEMPORAL_THRESHOLD bytes are written with non-temporal stores, so they do not evict the cache
+ * @param data The array to fill
+ * @param pattern The pattern as stored in memory, data[i] receives byte i % 8 of it
+ * @param size Number of bytes in the array
+ */
+BITSET_TARGET("avx2") BITSET_API void bitset_fill_pattern_bytes_avx2(uint8_t* const data, const uint64_t pattern, const uint64_t size)
+{
+    // align the stores to the vector width, the pattern is rotated to keep its phase
+    const uint64_t head = (32u - (uintptr_t)data % 32u) % 32u;
+    bitset_fill_pattern_bytes_generic(data, pattern, head);
+    const __m256i vector = _mm256_set1_epi64x((long long)bitset_rotate_pattern_bytes(pattern, head));
+    uint64_t i = head;
+    if (size >= BITSET_NONTEMPORAL_THRESHOLD)
+    {
+        for (; i + 64u <= size; i += 64u)
+        {
+            _mm256_stream_si256((__m256i*)(data + i), vector);
+            _mm256_stream_si256((__m256i*)(data + i + 32u), vector);
+        }
+        _mm_sfence();
+    }
+    else
+    {
+        for (; i + 64u <= size; i += 64u)
+        {
+            _mm256_store_si256((__m256i*)(data + i), vector);
+            _mm256_store_si256((__m256i*)(data + i + 32u), vector);
+        }
+    }
+    bitset_fill_pattern_bytes_generic(data + i, bitset_rotate_pattern_bytes(pattern, i), size - i);
+}
+#endif
+
+/**
+ * Fills the byte array with a repeating 8-byte pattern, picking the fastest kernel supported by the CPU
+ * @param data The array to fill
+ * @param pattern The pattern as stored in memory, data[i] receives byte i % 8 of it
+ * @param size Number of bytes in the array
+ */
+BITSET_API void bitset_fill_pattern_bytes(uint8_t* const data, const uint64_t pattern, const uint64_t size)
+{
+#ifdef BITSET_X86_DISPATCH
+    if (size >= BITSET_SIMD_THRESHOLD && __builtin_cpu_supports("avx2"))
+    {
+        bitset_fill_pattern_bytes_avx2(data, pattern, size);
+        return;
+    }
+#endif
+    bitset_fill_pattern_bytes_generic(data, pattern, size);
+}
+
+/**
+ * Reads the bits at the specified indices of a little-endian bit array (bit i is bit i % 8 of byte i / 8), prefetching ahead
+ * @param data The array to read from
+ * @param size Number of bytes in the array
+ * @param indices The indices of the bits to read (bit index, each lower than size * 8)
+ * @param count Number of indices
+ * @param values Array receiving the value of every bit (count values)
+ */
+BITSET_API void bitset_get_many_bytes_generic(const uint8_t* const data, const uint64_t size, const uint64_t* const indices, const uint64_t count, bool* const values)
+{
+    (void)size;
+    for (uint64_t i = 0; i < count; ++i)
+    {
+        if (i + BITSET_PREFETCH_DISTANCE < count)
+            BITSET_PREFETCH(data + *(indices + i + BITSET_PREFETCH_DISTANCE) / 8u, 0);
+        *(values + i) = (*(data + *(indices + i) / 8u) >> *(indices + i) % 8u) & 1u;
+    }
+}
+
+#ifdef BITSET_X86_DISPATCH
+/**
+ * Reads the bits at the specified indices of a little-endian bit array with AVX2, gathering 4 bits per vpgatherqd
+ * @param data The array to read from
+ * @param size Number of bytes in the array
+ * @param indices The indices of the bits to read (bit index, each lower than size * 8)
+ * @param count Number of indices
+ * @param values Array receiving the value of every bit (count values)
+ */
+BITSET_TARGET("avx2") BITSET_API void bitset_get_many_bytes_avx2(const uint8_t* const data, const uint64_t size, const uint64_t* const indices, const uint64_t count, bool* const values)
+{
+    // the gathered 32-bit words must not reach past the array, indices in its last 3 bytes take the scalar path
+    const __m256i limit = _mm256_set1_epi64x(size >= 4u ? (long long)((size - 3u) * 8u) : 0);
+    const __m256i bit_mask = _mm256_set1_epi64x(7);
+    const __m256i low_halves = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6);
+    const __m128i low_bytes = _mm_setr_epi8(0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    uint64_t i = 0;
+    for (; i + 4u <= count; i += 4u)
+    {
+        for (uint64_t k = 0; k < 4u && i + k + BITSET_PREFETCH_DISTANCE < count; ++k)
+            BITSET_PREFETCH(data + *(indices + i + k + BITSET_PREFETCH_DISTANCE) / 8u, 0);
+        const __m256i index = _mm256_loadu_si256((const __m256i*)(indices + i));
+        // indices are unsigned, so compare them with the sign bit flipped
+        const __m256i sign = _mm256_set1_epi64x(INT64_MIN);
+        if (_mm256_movemask_epi8(_mm256_cmpgt_epi64(_mm256_xor_si256(limit, sign), _mm256_xor_si256(index, sign))) != -1)
+        {
+            bitset_get_many_bytes_generic(data, size, indices + i, 4u, values + i);
+            continue;
+        }
+        const __m128i words = _mm256_i64gather_epi32((const int*)data, _mm256_srli_epi64(index, 3), 1);
+        const __m128i shifts = _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(_mm256_and_si256(index, bit_mask), low_halves));
+        const __m128i bits = _mm_and_si128(_mm_srlv_epi32(words, shifts), _mm_set1_epi32(1));
+        const int packed = _mm_cvtsi128_si32(_mm_shuffle_epi8(bits, low_bytes));
+        memcpy(values + i, &packed, 4u);
+    }
+    bitset_get_many_bytes_generic(data, size, indices + i, count - i, values + i);
+}
+#endif
+
+/**
+ * Reads the bits at the specified indices of a little-endian bit array, picking the fastest kernel supported by the CPU
+ * @param data The array to read from
+ * @param size Number of bytes in the array
+ * @param indices The indices of the bits to read (bit index, each lower than size * 8)
+ * @param count Number of indices
+ * @param values Array receiving the value of every bit (count values)
+ */
+BITSET_API void bitset_get_many_bytes(const uint8_t* const data, const uint64_t size, const uint64_t* const indices, const uint64_t count, bool* const values)
+{
+#ifdef BITSET_X86_DISPATCH
+    if (sizeof(bool) == 1u && __builtin_cpu_supports("avx2"))
+    {
+        bitset_get_many_bytes_avx2(data, size, indices, count, values);
+        return;
+    }
+#endif
+    bitset_get_many_bytes_generic(data, size, indices, count, values);
+}
+
+/**
+ * Finds the first byte of the array that differs from the specified one (portable kernel)
+ * @param data The array to search
+ * @param size Number of bytes in the array
+ * @param skip The byte value to skip
+ * @return Offset of the found byte, size if every byte equals skip
+ */
+BITSET_API uint64_t bitset_find_byte_not_generic(const uint8_t* const data, const uint64_t size, const uint8_t skip)
+{
+    const uint64_t pattern = 0x0101010101010101ull * skip;
+    uint64_t i = 0;
+    for (; i + 8u <= size; i += 8u)
+    {
+        uint64_t word;
+        memcpy(&word, data + i, sizeof(uint64_t));
+        if (word != pattern)
+            break;
+    }
+    for (; i < size; ++i)
+    {
+        if (*(data + i) != skip)
+            return i;
+    }
+    return size;
+}
+
+#ifdef BITSET_X86_DISPATCH
+/**
+ * Finds the first byte of the array that differs from the specified one with AVX2 (vptest on 64 bytes per iteration)
+ * @param data The array to search
+ * @param size Number of bytes in the array
+ * @param skip The byte value to skip
+ * @return Offset of the found byte, size if every byte equals skip
+ */
+BITSET_TARGET("avx2") BITSET_API uint64_t bitset_find_byte_not_avx2(const uint8_t* const data, const uint64_t size, const uint8_t skip)
+{
+    const __m256i pattern = _mm256_set1_epi8((char)skip);
+    uint64_t i = 0;
+    for (; i + 64u <= size; i += 64u)
+    {
+        const __m256i difference = _mm256_or_si256(_mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(data + i)), pattern),
+                                                   _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(data + i + 32u)), pattern));
+        if (!_mm256_testz_si256(difference, difference))
+            break;
+    }
+    return i + bitset_find_byte_not_generic(data + i, size - i, skip);
+}
+#endif
+
+/**
+ * Finds the first byte of the array that differs from the specified one, picking the fastest kernel supported by the CPU
+ * @param data The array to search
+ * @param size Number of bytes in the array
+ * @param skip The byte value to skip
+ * @return Offset of the found byte, size if every byte equals skip
+ */
+BITSET_API uint64_t bitset_find_byte_not(const uint8_t* const data, const uint64_t size, const uint8_t skip)
+{
+#ifdef BITSET_X86_DISPATCH
+    if (size >= BITSET_SIMD_THRESHOLD && __builtin_cpu_supports("avx2"))
+        return bitset_find_byte_not_avx2(data, size, skip);
+#endif
+    return bitset_find_byte_not_generic(data, size, skip);
+}
+
+/**
+ * Counts the runs of set bits starting in a byte array (portable kernel)
+ * A run starts at every set bit whose lower neighbour is cleared (word & ~(word << 1 | carry)), the bit before data reads as cleared
+ * @param data The array to scan, read as little-endian 64-bit words
+ * @param size Number of bytes in the array (multiple of 8)
+ * @param invert UINT64_MAX to count the runs of cleared bits instead, 0 otherwise
+ * @return The number of runs
+ */
+BITSET_API uint64_t bitset_count_run_starts_bytes_generic(const uint8_t* const data, const uint64_t size, const uint64_t invert)
+{
+    uint64_t count = 0, carry = 0, word;
+    for (uint64_t i = 0; i + 8u <= size; i += 8u)
+    {
+        memcpy(&word, data + i, sizeof(uint64_t));
+        word ^= invert;
+        count += bitset_popcount64(word & ~(word << 1 | carry));
+        carry = word >> 63;
+    }
+    return count;
+}
+
+#ifdef BITSET_X86_DISPATCH
+/**
+ * Counts the runs of set bits starting in a byte array with AVX2
+ * The carry of every 64-bit lane comes from an unaligned load 8 bytes back, so the lanes need no cross-lane shuffles
+ * @param data The array to scan, read as little-endian 64-bit words
+ * @param size Number of bytes in the array (multiple of 8)
+ * @param invert UINT64_MAX to count the runs of cleared bits instead, 0 otherwise
+ * @return The number of runs
+ */
+BITSET_TARGET("avx2,popcnt") BITSET_API uint64_t bitset_count_run_starts_bytes_avx2(const uint8_t* const data, const uint64_t size, const uint64_t invert)
+{
+    // the first word has no previous word to load, count it on its own
+    uint64_t count = bitset_count_run_starts_bytes_generic(data, 8u, invert), i = 8u;
+    const __m256i inverted = _mm256_set1_epi64x((long long)invert);
+    __m256i total = _mm256_setzero_si256();
+    while (i + 32u <= size)
+    {
+        // byte counters hold at most 8 per iteration, so flush them every 31 iterations
+        __m256i local = _mm256_setzero_si256();
+        for (uint32_t k = 0; k < 31u && i + 32u <= size; ++k, i += 32u)
+        {
+            const __m256i words = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(data + i)), inverted);
+            const __m256i previous = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(data + i - 8u)), inverted);
+            const __m256i neighbours = _mm256_or_si256(_mm256_slli_epi64(words, 1), _mm256_srli_epi64(previous, 63));
+            local = _mm256_add_epi8(local, bitset_popcount_epi8_avx2(_mm256_andnot_si256(neighbours, words)));
+        }
+        total = _mm256_add_epi64(total, _mm256_sad_epu8(local, _mm256_setzero_si256()));
+    }
+    uint64_t word;
+    memcpy(&word, data + i - 8u, sizeof(uint64_t));
+    uint64_t carry = (word ^ invert) >> 63;
+    for (; i + 8u <= size; i += 8u)
+    {
+        memcpy(&word, data + i, sizeof(uint64_t));
+        word ^= invert;
+        count += bitset_popcount64(word & ~(word << 1 | carry));
+        carry = word >> 63;
+    }
+    return count + bitset_sum_epi64_avx2(total);
+}
+#endif
+
+/**
+ * Counts the runs of set bits starting in a byte array, picking the fastest kernel supported by the CPU
+ * @param data The array to scan, read as little-endian 64-bit words
+ * @param size Number of bytes in the array (multiple of 8)
+ * @param invert UINT64_MAX to count the runs of cleared bits instead, 0 otherwise
+ * @return The number of runs
+ */
+BITSET_API uint64_t bitset_count_run_starts_bytes(const uint8_t* const data, const uint64_t size, const uint64_t invert)
+{
+#ifdef BITSET_X86_DISPATCH
+    if (size >= BITSET_SIMD_THRESHOLD && __builtin_cpu_supports("avx2"))
+        return bitset_count_run_starts_bytes_avx2(data, size, invert);
+#endif
+    return bitset_count_run_starts_bytes_generic(data, size, invert);
+}
+
+/**
+ * Transposes a 64x64 bit matrix in place (portable kernel), bit j of word i moves to bit i of word j
+ * Swaps the off-diagonal halves of ever smaller blocks (32x32 down to 1x1), 6 passes of 32 masked word swaps
+ * @param words The matrix, 64 words of 64 bits (word index = row, bit index = column)
+ */
+BITSET_API void bitset_transpose64_generic(uint64_t* const words)
+{
+    uint64_t mask = 0x00000000FFFFFFFFull;
+    for (uint64_t j = 32u; j; j >>= 1u, mask ^= mask << j)
+    {
+        for (uint64_t k = 0; k < 64u; k = (k + j + 1u) & ~j)
+        {
+            const uint64_t swap = ((*(words + k) >> j) ^ *(words + k + j)) & mask;
+            *(words + k + j) ^= swap;
+            *(words + k) ^= swap << j;
+        }
+    }
+}
+
+#ifdef BITSET_X86_DISPATCH
+/**
+ * Transposes a 64x64 bit matrix in place with AVX2 (4 words per swap, the 2x2 and 1x1 passes swap within the registers)
+ * @param words The matrix, 64 words of 64 bits (word index = row, bit index = column)
+ */
+BITSET_TARGET("avx2") BITSET_API void bitset_transpose64_avx2(uint64_t* const words)
+{
+    uint64_t mask = 0x00000000FFFFFFFFull;
+    for (uint64_t j = 32u; j >= 4u; j >>= 1u, mask ^= mask << j)
+    {
+        const __m256i masks = _mm256_set1_epi64x((long long)mask);
+        const __m128i shift = _mm_cvtsi32_si128((int)j);
+        for (uint64_t k = 0; k < 64u; k = (k + j + 4u) & ~j)
+        {
+            __m256i low = _mm256_loadu_si256((const __m256i*)(words + k));
+            __m256i high = _mm256_loadu_si256((const __m256i*)(words + k + j));
+            const __m256i swap = _mm256_and_si256(_mm256_xor_si256(_mm256_srl_epi64(low, shift), high), masks);
+            high = _mm256_xor_si256(high, swap);
+            low = _mm256_xor_si256(low, _mm256_sll_epi64(swap, shift));
+            _mm256_storeu_si256((__m256i*)(words + k), low);
+            _mm256_storeu_si256((__m256i*)(words + k + j), high);
+        }
+    }
+
+    // the pairs of the last two passes share a register: the swap is computed in every lane and moved to the partner lane
+    const __m256i masks2 = _mm256_set1_epi64x(0x3333333333333333ll), masks1 = _mm256_set1_epi64x(0x5555555555555555ll);
+    for (uint64_t k = 0; k < 64u; k += 4u)
+    {
+        __m256i vector = _mm256_loadu_si256((const __m256i*)(words + k));
+        __m256i swap = _mm256_and_si256(_mm256_xor_si256(_mm256_srli_epi64(vector, 2), _mm256_permute4x64_epi64(vector, 0x4E)), masks2);
+        vector = _mm256_blend_epi32(_mm256_xor_si256(vector, _mm256_slli_epi64(swap, 2)), _mm256_xor_si256(vector, _mm256_permute4x64_epi64(swap, 0x4E)), 0xF0);
+        swap = _mm256_and_si256(_mm256_xor_si256(_mm256_srli_epi64(vector, 1), _mm256_permute4x64_epi64(vector, 0xB1)), masks1);
+        vector = _mm256_blend_epi32(_mm256_xor_si256(vector, _mm256_slli_epi64(swap, 1)), _mm256_xor_si256(vector, _mm256_permute4x64_epi64(swap, 0xB1)), 0xCC);
+        _mm256_storeu_si256((__m256i*)(words + k), vector);
+    }
+}
+#endif
+
+/**
+ * Transposes a 64x64 bit matrix in place, picking the fastest kernel supported by the CPU
+ * @param words The matrix, 64 words of 64 bits (word index = row, bit index = column)
+ */
+BITSET_API void bitset_transpose64(uint64_t* const words)
+{
+#ifdef BITSET_X86_DISPATCH
+    if (__builtin_cpu_supports("avx2"))
+    {
+        bitset_transpose64_avx2(words);
+        return;
+    }
+#endif
+    bitset_transpose64_generic(words);
+}
+
+/**
+ * Counts the set bits of the byte array using all the threads (see bitset_popcount_bytes)
+ * @param data The array to count the bits of
+ * @param size Number of bytes in the array
+ * @return The number of set bits
+ */
+BITSET_API uint64_t bitset_parallel_popcount_bytes(const uint8_t* const data, const uint64_t size)
+{
+    const int64_t chunks = (int64_t)bitset_parallel_chunk_count(data, size);
+    uint64_t count = 0;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) reduction(+:count) if(chunks > 1)
+#endif
+    for (int64_t chunk = 0; chunk < chunks; ++chunk)
+    {
+        const uint64_t begin = bitset_parallel_chunk_offset(data, size, (uint64_t)chunk), end = bitset_parallel_chunk_offset(data, size, (uint64_t)chunk + 1u);
+        count += bitset_popcount_bytes(data + begin, end - begin);
+    }
+    return count;
+}
+
+/**
+ * Fills the byte array with the specified value using all the threads
+ * @param data The array to fill
+ * @param value The byte to fill the array with
+ * @param size Number of bytes in the array
+ */
+BITSET_API void bitset_parallel_fill_bytes(uint8_t* const data, const uint8_t value, const uint64_t size)
+{
+    const int64_t chunks = (int64_t)bitset_parallel_chunk_count(data, size);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) if(chunks > 1)
+#endif
+    for (int64_t chunk = 0; chunk < chunks; ++chunk)
+    {
+        const uint64_t begin = bitset_parallel_chunk_offset(data, size, (uint64_t)chunk), end = bitset_parallel_chunk_offset(data, size, (uint64_t)chunk + 1u);
+        memset(data + begin, value, end - begin);
+    }
+}
+
+/**
+ * Inverts every byte of the array using all the threads
+ * @param data The array to flip
+ * @param size Number of bytes in the array
+ */
+BITSET_API void bitset_parallel_flip_bytes(uint8_t* const data, const uint64_t size)
+{
+    const int64_t chunks = (int64_t)bitset_parallel_chunk_count(data, size);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) if(chunks > 1)
+#endif
+    for (int64_t chunk = 0; chunk < chunks; ++chunk)
+    {
+        const uint64_t begin = bitset_parallel_chunk_offset(data, size, (uint64_t)chunk), end = bitset_parallel_chunk_offset(data, size, (uint64_t)chunk + 1u);
+        bitset_flip_bytes(data + begin, end - begin);
+    }
+}
+
+/**
+ * Computes destination = left op right over the byte arrays using all the threads (see bitset_binary_bytes)
+ * The chunks are aligned to the destination, so no two threads write the same cache line
+ * @param destination The array to store the result to (may be the same as left or right)
+ * @param left The left operand
+ * @param right The right operand
+ * @param size Number of bytes to process
+ * @param operation The operation to apply
+ */
+BITSET_API void bitset_parallel_binary_bytes(uint8_t* const destination, const uint8_t* const left, const uint8_t* const right, const uint64_t size, const bitset_operation operation)
+{
+    const int64_t chunks = (int64_t)bitset_parallel_chunk_count(destination, size);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) if(chunks > 1)
+#endif
+    for (int64_t chunk = 0; chunk < chunks; ++chunk)
+    {
+        const uint64_t begin = bitset_parallel_chunk_offset(destination, size, (uint64_t)chunk), end = bitset_parallel_chunk_offset(destination, size, (uint64_t)chunk + 1u);
+        bitset_binary_bytes(destination + begin, left + begin, right + begin, end - begin, operation);
+    }
+}
+
+/**
+ * Counts the set bits of left op right over the byte arrays using all the threads (see bitset_binary_count_bytes)
+ * @param left The left operand
+ * @param right The right operand
+ * @param size Number of bytes to process
+ * @param operation The operation to apply
+ * @return The number of set bits of the result
+ */
+BITSET_API uint64_t bitset_parallel_binary_count_bytes(const uint8_t* const left, const uint8_t* const right, const uint64_t size, const bitset_operation operation)
+{
+    const int64_t chunks = (int64_t)bitset_parallel_chunk_count(left, size);
+    uint64_t count = 0;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) reduction(+:count) if(chunks > 1)
+#endif
+    for (int64_t chunk = 0; chunk < chunks; ++chunk)
+    {
+        const uint64_t begin = bitset_parallel_chunk_offset(left, size, (uint64_t)chunk), end = bitset_parallel_chunk_offset(left, size, (uint64_t)chunk + 1u);
+        count += bitset_binary_count_bytes(left + begin, right + begin, end - begin, operation);
+    }
+    return count;
+}
+
+/**
+ * Finds the first byte of the array that differs from the specified one using all the threads
+ * The array is scanned in windows of one chunk per thread, so the scan stops shortly after the first match
+ * @param data The array to search
+ * @param size Number of bytes in the array
+ * @param skip The byte value to skip
+ * @return Offset of the found byte, size if every byte equals skip
+ */
+BITSET_API uint64_t bitset_parallel_find_byte_not(const uint8_t* const data, const uint64_t size, const uint8_t skip)
+{
+#if defined(_OPENMP) && _OPENMP >= 201107 // min reductions need OpenMP 3.1
+    const uint64_t window = bitset_parallel_threads() * BITSET_PARALLEL_CHUNK_SIZE;
+    for (uint64_t base = 0; base < size; base += window)
+    {
+        const uint64_t length = size - base < window ? size - base : window;
+        const int64_t chunks = (int64_t)bitset_parallel_chunk_count(data + base, length);
+        uint64_t found = length;
+#pragma omp parallel for schedule(static) reduction(min:found) if(chunks > 1)
+        for (int64_t chunk = 0; chunk < chunks; ++chunk)
+        {
+            const uint64_t begin = bitset_parallel_chunk_offset(data + base, length, (uint64_t)chunk), end = bitset_parallel_chunk_offset(data + base, length, (uint64_t)chunk + 1u);
+            const uint64_t offset = begin + bitset_find_byte_not(data + base + begin, end - begin, skip);
+            if (offset < end && offset < found)
+                found = offset;
+        }
+        if (found < length)
+            return base + found;
+    }
+    return size;
+#else
+    return bitset_find_byte_not(data, size, skip);
+#endif
+}
+
+/**
+ * Allocates size bytes aligned to BITSET_ALIGNMENT (the size is rounded up to a multiple of the alignment)
+ * @param size Number of bytes to allocate
+ * @param context Unused
+ * @return The allocated memory, NULL on failure or for size 0
+ */
+BITSET_API void* bitset_aligned_allocate(const uint64_t size, void* const context)
+{
+    (void)context;
+    if (!size)
+        return NULL;
+    const uint64_t rounded = (size + BITSET_ALIGNMENT - 1u) / BITSET_ALIGNMENT * BITSET_ALIGNMENT;
+#if defined(BITSET_ALIGNED_MSVC)
+    return _aligned_malloc((size_t)rounded, BITSET_ALIGNMENT);
+#elif defined(BITSET_ALIGNED_C11)
+    return aligned_alloc(BITSET_ALIGNMENT, (size_t)rounded);
+#elif defined(BITSET_ALIGNED_POSIX)
+    void* pointer;
+    return posix_memalign(&pointer, BITSET_ALIGNMENT < sizeof(void*) ? sizeof(void*) : BITSET_ALIGNMENT, (size_t)rounded) ? NULL : pointer;
+#else
+    // the pointer returned by malloc is stored right before the aligned memory
+    unsigned char* const raw = (unsigned char*)malloc((size_t)rounded + BITSET_ALIGNMENT + sizeof(void*));
+    if (!raw)
+        return NULL;
+    unsigned char* const aligned = raw + sizeof(void*) + (BITSET_ALIGNMENT - (uintptr_t)(raw + sizeof(void*)) % BITSET_ALIGNMENT) % BITSET_ALIGNMENT;
+    memcpy(aligned - sizeof(void*), &raw, sizeof(void*));
+    return aligned;
+#endif
+}
+
+/**
+ * Resizes memory from bitset_aligned_allocate, in place while the rounded size does not grow
+ * @param pointer The memory to resize (may be NULL)
+ * @param old_size Size the memory was allocated with
+ * @param new_size The new size
+ * @param context Unused
+ * @return The resized memory, NULL on failure (the old memory stays valid)
+ */
+BITSET_API void* bitset_aligned_reallocate(void* const pointer, const uint64_t old_size, const uint64_t new_size, void* const context)
+{
+    if (pointer && (new_size + BITSET_ALIGNMENT - 1u) / BITSET_ALIGNMENT <= (old_size + BITSET_ALIGNMENT - 1u) / BITSET_ALIGNMENT)
+        return new_size ? pointer : NULL;
+    void* const new_pointer = bitset_aligned_allocate(new_size, context);
+    if (!new_pointer)
+        return NULL;
+    if (pointer)
+    {
+        memcpy(new_pointer, pointer, old_size < new_size ? old_size : new_size);
+        bitset_aligned_deallocate(pointer, old_size, context);
+    }
+    return new_pointer;
+}
+
+/**
+ * Releases memory from bitset_aligned_allocate
+ * @param pointer The memory to release (may be NULL)
+ * @param size Size the memory was allocated with
+ * @param context Unused
+ */
+BITSET_API void bitset_aligned_deallocate(void* const pointer, const uint64_t size, void* const context)
+{
+    (void)size;
+    (void)context;
+#if defined(BITSET_ALIGNED_MSVC)
+    _aligned_free(pointer);
+#elif defined(BITSET_ALIGNED_C11) || defined(BITSET_ALIGNED_POSIX)
+    free(pointer);
+#else
+    if (pointer)
+    {
+        void* raw;
+        memcpy(&raw, (unsigned char*)pointer - sizeof(void*), sizeof(void*));
+        free(raw);
+    }
+#endif
+}
+
+#ifdef BITSET_HUGE_PAGES
+/**
+ * Maps size bytes backed by huge pages, explicit MAP_HUGETLB pages if the system has them reserved, transparent huge pages otherwise
+ * @param size Number of bytes to allocate (rounded up to BITSET_HUGE_PAGE_SIZE)
+ * @param context Unused
+ * @return The mapped memory (zeroed), NULL on failure or for size 0
+ */
+BITSET_API void* bitset_huge_page_allocate(const uint64_t size, void* const context)
+{
+    (void)context;
+    if (!size)
+        return NULL;
+    const uint64_t length = (size + BITSET_HUGE_PAGE_SIZE - 1u) / BITSET_HUGE_PAGE_SIZE * BITSET_HUGE_PAGE_SIZE;
+    void* pointer = MAP_FAILED;
+#ifdef MAP_HUGETLB
+    pointer = mmap(NULL, (size_t)length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+#endif
+    if (pointer == MAP_FAILED)
+    {
+        pointer = mmap(NULL, (size_t)length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (pointer == MAP_FAILED)
+            return NULL;
+#ifdef MADV_HUGEPAGE
+        madvise(pointer, (size_t)length, MADV_HUGEPAGE);
+#endif
+    }
+    return pointer;
+}
+
+/**
+ * Releases memory from bitset_huge_page_allocate
+ * @param pointer The memory to release (may be NULL)
+ * @param size Size the memory was allocated with
+ * @param context Unused
+ */
+BITSET_API void bitset_huge_page_deallocate(void* const pointer, const uint64_t size, void* const context)
+{
+    (void)context;
+    if (pointer)
+        munmap(pointer, (size_t)((size + BITSET_HUGE_PAGE_SIZE - 1u) / BITSET_HUGE_PAGE_SIZE * BITSET_HUGE_PAGE_SIZE));
+}
+
+/**
+ * Resizes memory from bitset_huge_page_allocate, in place while the rounded size does not grow (the pages past a smaller rounded size are unmapped)
+ * @param pointer The memory to resize (may be NULL)
+ * @param old_size Size the memory was allocated with
+ * @param new_size The new size
+ * @param context Unused
+ * @return The resized memory, NULL on failure (the old memory stays valid)
+ */
+BITSET_API void* bitset_huge_page_reallocate(void* const pointer, const uint64_t old_size, const uint64_t new_size, void* const context)
+{
+    const uint64_t old_length = (old_size + BITSET_HUGE_PAGE_SIZE - 1u) / BITSET_HUGE_PAGE_SIZE * BITSET_HUGE_PAGE_SIZE;
+    const uint64_t new_length = (new_size + BITSET_HUGE_PAGE_SIZE - 1u) / BITSET_HUGE_PAGE_SIZE * BITSET_HUGE_PAGE_SIZE;
+    if (pointer && new_length <= old_length)
+    {
+        if (!new_size)
+            return NULL; // nothing is unmapped, the old memory stays valid
+        if (new_length < old_length)
+            munmap((uint8_t*)pointer + new_length, (size_t)(old_length - new_length));
+        return pointer;
+    }
+    void* const new_pointer = bitset_huge_page_allocate(new_size, context);
+    if (!new_pointer)
+        return NULL;
+    if (pointer)
+    {
+        memcpy(new_pointer, pointer, old_size < new_size ? old_size : new_size);
+        bitset_huge_page_deallocate(pointer, old_size, context);
+    }
+    return new_pointer;
+}
+#endif
+
+/**
+ * Calculates the size class of the pool serving the specified size
+ * @param size Number of bytes
+ * @return k with BITSET_ALIGNMENT << k the smallest class holding size, BITSET_POOL_CLASSES if it is too large for the pool
+ */
+BITSET_API uint64_t bitset_pool_class(const uint64_t size)
+{
+    uint64_t k = 0;
+    while (k < BITSET_POOL_CLASSES && ((uint64_t)BITSET_ALIGNMENT << k) < size)
+        ++k;
+    return k;
+}
+
+/**
+ * Allocates from the pool, reusing a released allocation of the same size class if there is one
+ * @param size Number of bytes to allocate
+ * @param context Pointer to the bitset_pool
+ * @return The allocated memory, NULL on failure or for size 0
+ */
+BITSET_API void* bitset_pool_allocate(const uint64_t size, void* const context)
+{
+    bitset_pool* const pool = (bitset_pool*)context;
+    if (!size)
+        return NULL;
+    const uint64_t k = bitset_pool_class(size);
+    if (k == BITSET_POOL_CLASSES)
+        return bitset_allocate(pool->upstream, size);
+
+    void* const pointer = pool->free_lists[k];
+    if (pointer)
+    {
+        memcpy(&pool->free_lists[k], pointer, sizeof(void*));
+        return pointer;
+    }
+    return bitset_allocate(pool->upstream, (uint64_t)BITSET_ALIGNMENT << k);
+}
+
+/**
+ * Returns the allocation to the pool (sizes above the largest class are released to upstream)
+ * @param pointer The memory to release (may be NULL)
+ * @param size Size the memory was allocated with
+ * @param context Pointer to the bitset_pool
+ */
+BITSET_API void bitset_pool_deallocate(void* const pointer, const uint64_t size, void* const context)
+{
+    bitset_pool* const pool = (bitset_pool*)context;
+    if (!pointer)
+        return;
+    const uint64_t k = bitset_pool_class(size);
+    if (k == BITSET_POOL_CLASSES)
+    {
+        bitset_deallocate(pool->upstream, pointer, size);
+        return;
+    }
+    memcpy(pointer, &pool->free_lists[k], sizeof(void*));
+    pool->free_lists[k] = pointer;
+}
+
+/**
+ * Resizes memory from the pool, in place while the size class does not change
+ * @param pointer The memory to resize (may be NULL)
+ * @param old_size Size the memory was allocated with
+ * @param new_size The new size
+ * @param context Pointer to the bitset_pool
+ * @return The resized memory, NULL on failure (the old memory stays valid)
+ */
+BITSET_API void* bitset_pool_reallocate(void* const pointer, const uint64_t old_size, const uint64_t new_size, void* const context)
+{
+    const uint64_t k = bitset_pool_class(new_size);
+    if (pointer && new_size && k < BITSET_POOL_CLASSES && k == bitset_pool_class(old_size))
+        return pointer;
+    void* const new_pointer = bitset_pool_allocate(new_size, context);
+    if (!new_pointer)
+        return NULL;
+    if (pointer)
+    {
+        memcpy(new_pointer, pointer, old_size < new_size ? old_size : new_size);
+        bitset_pool_deallocate(pointer, old_size, context);
+    }
+    return new_pointer;
+}
+
+/**
+ * Initializes an empty pool
+ * @param pool Pointer to pool to initialize
+ * @param upstream Allocator the pool gets its memory from (NULL for the default allocator), has to outlive the pool
+ */
+BITSET_API void bitset_pool_init(bitset_pool* const pool, const bitset_allocator* const upstream)
+{
+    pool->allocator.allocate = bitset_pool_allocate;
+    pool->allocator.reallocate = bitset_pool_reallocate;
+    pool->allocator.deallocate = bitset_pool_deallocate;
+    pool->allocator.context = pool;
+    pool->upstream = upstream;
+    for (uint64_t k = 0; k < BITSET_POOL_CLASSES; ++k)
+        pool->free_lists[k] = NULL;
+}
+
+/**
+ * Releases all the cached allocations to upstream (bitsets still using the pool have to be destroyed first)
+ * @param pool Pointer to pool to destroy
+ */
+BITSET_API void bitset_pool_destroy(bitset_pool* const pool)
+{
+    for (uint64_t k = 0; k < BITSET_POOL_CLASSES; ++k)
+    {
+        while (pool->free_lists[k])
+        {
+            void* const pointer = pool->free_lists[k];
+            memcpy(&pool->free_lists[k], pointer, sizeof(void*));
+            bitset_deallocate(pool->upstream, pointer, (uint64_t)BITSET_ALIGNMENT << k);
+        }
+    }
+}
+
+/**
+ * Allocates with the specified allocator
+ * @param allocator The allocator (NULL for the default allocator)
+ * @param size Number of bytes to allocate
+ * @return The allocated memory, NULL on failure or for size 0
+ */
+BITSET_API void* bitset_allocate(const bitset_allocator* const allocator, const uint64_t size)
+{
+    return allocator ? allocator->allocate(size, allocator->context) : bitset_aligned_allocate(size, NULL);
+}
+
+/**
+ * Resizes memory with the specified allocator
+ * @param allocator The allocator (NULL for the default allocator)
+ * @param pointer The memory to resize (may be NULL)
+ * @param old_size Size the memory was allocated with
+ * @param new_size The new size
+ * @return The resized memory, NULL on failure (the old memory stays valid)
+ */
+BITSET_API void* bitset_reallocate(const bitset_allocator* const allocator, void* const pointer, const uint64_t old_size, const uint64_t new_size)
+{
+    return allocator ? allocator->reallocate(pointer, old_size, new_size, allocator->context) : bitset_aligned_reallocate(pointer, old_size, new_size, NULL);
+}
+
+/**
+ * Releases memory with the specified allocator
+ * @param allocator The allocator (NULL for the default allocator)
+ * @param pointer The memory to release (may be NULL)
+ * @param size Size the memory was allocated with
+ */
+BITSET_API void bitset_deallocate(const bitset_allocator* const allocator, void* const pointer, const uint64_t size)
+{
+    if (allocator)
+        allocator->deallocate(pointer, size, allocator->context);
+    else
+        bitset_aligned_deallocate(pointer, size, NULL);
+}
+
+/**
+ * Size initialization
+ * @param bitset Pointer to bitset to initialize
+ * @param size The size of the bitset to be initialized
+ * @memberof DynamicBitSet
+ */
+BITSET_API void bitset_dynamic_init(DynamicBitSet* const bitset, const uint64_t size)
+{
+    bitset_dynamic_init_allocator(bitset, size, NULL);
+}
+
+/**
+ * Size and allocator initialization, all of the bits are cleared
+ * @param bitset Pointer to bitset to initialize
+ * @param size The size of the bitset to be initialized
+ * @param allocator The allocator of the blocks (NULL for the default allocator), has to outlive the bitset
+ * @memberof DynamicBitSet
+ */
+BITSET_API void bitset_dynamic_init_allocator(DynamicBitSet* const bitset, const uint64_t size, const bitset_allocator* const allocator)
+{
+    bitset->size = size;
+    bitset->storage_size = bitset->capacity = bitset_calculate_storage_size(size);
+    bitset->allocator = allocator;
+    bitset->data = (bitset_block_t*)bitset_allocate(allocator, bitset->storage_size * sizeof(bitset_block_t));
+    if (bitset->data)
+        memset(bitset->data, 0, bitset->storage_size * sizeof(bitset_block_t));
+}
+
+/**
+ * Size initialization
+ * @param bitset Pointer to bitset to initialize
+ * @param size The size of the bitset to be initialized
+ * @memberof BitSet
+ */
+BITSET_API void bitset_init(BitSet* const bitset)
+{
+    bitset->data = bitset->storage;
+    bitset->size = BITSET_SIZE;
+    bitset->storage_size = BITSET_STORAGE_SIZE;
+    memset(bitset->storage, 0, BITSET_STORAGE_SIZE * sizeof(bitset_block_t));
+}
+
+/**
+ * Size and value initialization
+ * @param bitset Pointer to bitset to initialize
+ * @param size The size of the bitset to be initialized
+ * @param block The block to fill the bitset with (block value)
+ * @memberof DynamicBitSet
+ */
+BITSET_API void bitset_dynamic_init_block(DynamicBitSet* const bitset, const uint64_t size, const bitset_block_t block)
+{
+    bitset->size = size;
+    bitset->storage_size = bitset->capacity = bitset_calculate_storage_size(size);
+    bitset->allocator = NULL;
+    bitset->data = (bitset_block_t*)bitset_allocate(NULL, bitset->storage_size * sizeof(bitset_block_t));
+    if (bitset->data)
+        bitset_fill_all_blocks(UNIVERSAL_BITSET(bitset), block);
+}
+
+/**
+ * Size and value initialization
+ * @param bitset Pointer to bitset to initialize
+ * @param size The size of the bitset to be initialized
+ * @param block The block to fill the bitset with (block value)
+ * @memberof BitSet
+ */
+BITSET_API void bitset_init_block(BitSet* const bitset, const bitset_block_t block)
+{
+    bitset->data = bitset->storage;
+    bitset->size = BITSET_SIZE;
+    bitset->storage_size = BITSET_STORAGE_SIZE;
+    bitset_fill_all_blocks(bitset, block);
+}
+
+/**
+ * Destroys the bitset (frees the memory)
+ * @param bitset Pointer to bitset to destroy
+ * @memberof BitSet
+ */
+BITSET_API void bitset_dynamic_destroy(DynamicBitSet* const bitset)
+{
+    bitset_deallocate(bitset->allocator, bitset->data, bitset->capacity * sizeof(bitset_block_t));
+}
+
+/**
+ * Copies the data from one bitset to another (copies as many blocks as the destination holds)
+ * @param destination Pointer to bitset to copy to
+ * @param source Pointer to bitset to copy from
+ * @memberof BitSet
+ */
+BITSET_API void bitset_copy(BitSet* const destination, const BitSet* const source)
+{
+    memcpy(destination->data, source->data, destination->storage_size * sizeof(bitset_block_t));
+}
+
+/**
+ * Moves the data from one bitset to another
+ * @param destination Pointer to bitset to move to
+ * @param source Pointer to bitset to move from
+ * @memberof BitSet
+ */
+BITSET_API void bitset_dynamic_move(DynamicBitSet* const destination, DynamicBitSet* const source)
+{
+    destination->size = source->size;
+    destination->storage_size = source->storage_size;
+    destination->capacity = source->capacity;
+    destination->allocator = source->allocator;
+    destination->data = source->data;
+    source->size = 0;
+    source->storage_size = 0;
+    source->capacity = 0;
+    source->data = NULL;
+}
+
+/**
+ * Sets the value of a bit at a specified index
+ * @param bitset Pointer to bitset to modify
+ * @param value The value to set the bit to
+ * @param index The index of the bit to modify (bit index)
+ * @memberof BitSet
+ */
+BITSET_API void bitset_set_value(BitSet* const bitset, const uint64_t value, const uint64_t index)
+{
+    BITSET_STATS_RECORD(BITSET_STATS_ACCESS, 1u, sizeof(bitset_block_t));
+    if (value)
+        *(bitset->data + index / BITSET_BLOCK_BITS) |= (bitset_block_t)1u << index % BITSET_BLOCK_BITS;
+    else
+        *(bitset->data + index / BITSET_BLOCK_BITS) &= ~((bitset_block_t)1u << index % BITSET_BLOCK_BITS);
+}
+
+/**
+ * Retrieves the value of a bit at a specified index
+ * @param bitset Pointer to bitset to read from
+ * @param index The index of the bit to read (bit index)
+ * @return The value of the bit at the specified index
+ * @memberof BitSet
+ */
+BITSET_API bool bitset_get(const BitSet* const bitset, const uint64_t index) {
+    BITSET_STATS_RECORD(BITSET_STATS_ACCESS, 1u, sizeof(bitset_block_t));
+    return (*(bitset->data + index / BITSET_BLOCK_BITS) >> index % BITSET_BLOCK_BITS) & 1u;
+}
+
+/**
+ * Sets the value of a bit at a specified index to 1 (true)
+ * @param bitset Pointer to bitset to modify
+ * @param index The index of the bit to set (bit index)
+ * @memberof BitSet
+ */
+BITSET_API void bitset_set(BitSet* const bitset, const uint64_t index) {
+    BITSET_STATS_RECORD(BITSET_STATS_ACCESS, 1u, sizeof(bitset_block_t));
+    *(bitset->data + index / BITSET_BLOCK_BITS) |= (bitset_block_t)1u << index % BITSET_BLOCK_BITS;
+}
+
+/**
+ * Sets the value of a bit at a specified index to 0 (false)
+ * @param bitset Pointer to bitset to modify
+ * @param index The index of the bit to clear (bit index)
+ * @memberof BitSet
+ */
+BITSET_API void bitset_clear(BitSet* const bitset, const uint64_t index) {
+    BITSET_STATS_RECORD(BITSET_STATS_ACCESS, 1u, sizeof(bitset_block_t));
+    *(bitset->data + index / BITSET_BLOCK_BITS) &= ~((bitset_block_t)1u << index % BITSET_BLOCK_BITS);
+}
+
+/**
+ * Fills the bitset with a specified value
+ * @param bitset Pointer to bitset to modify
+ * @param value The value to fill the bitset with
+ * @memberof BitSet
+ */
+BITSET_API void bitset_fill_all(BitSet* const bitset, const bool value) {
+    BITSET_STATS_RECORD(BITSET_STATS_FILL, bitset->size, bitset->storage_size * sizeof(bitset_block_t));
+    BITSET_TRACE_BEGIN("fill", bitset->storage_size * sizeof(bitset_block_t));
+    memset(bitset->data, value ? 255u : 0u, bitset->storage_size * sizeof(bitset_block_t));
+    BITSET_TRACE_END("fill", bitset->storage_size * sizeof(bitset_block_t));
+}
+
+/**
+ * Clears all the bits (sets all bits to 0)
+ * @param bitset Pointer to bitset to modify
+ * @memberof BitSet
+ */
+BITSET_API void bitset_clear_all(BitSet* const bitset) {
+    memset(bitset->data, 0, bitset->storage_size * sizeof(bitset_block_t));
+}
+
+/**
+ * Sets all the bits (sets all bits to 1)
+ * @param bitset Pointer to bitset to modify
+ * @memberof BitSet
+ */
+BITSET_API void bitset_set_all(BitSet* const bitset) {
+    memset(bitset->data, 255, bitset->storage_size * sizeof(bitset_block_t));
+}
+
+/**
+ * Fills all the bits in the specified range with the specified value
+ * @param bitset Pointer to bitset to modify
+ * @param value The value to fill the bits with (bit value)
+ * @param end End of the range to fill (bit index)
+ * @memberof BitSet
+ */
+BITSET_API void bitset_fill_in_range_end(BitSet* const bitset, const bool value, const uint64_t end) {
+    bitset_fill_in_range_begin_end(bitset, value, 0, end);
+}
+
+/**
+ * Fills all the bits in the specified range with 0 (false)
+ * @param bitset Pointer to bitset to modify
+ * @param end End of the range to fill (bit index)
+ * @memberof BitSet
+ */
+BITSET_API void bitset_clear_in_range_end(BitSet* const bitset, const uint64_t end)
+{
+    bitset_fill_in_range_begin_end(bitset, false, 0, end);
+}
+
+/**
+ * Fills all the bits in the specified range with 1 (true)
+ * @param bitset Pointer to bitset to modify
+ * @param end End of the range to fill (bit index)
+ * @memberof BitSet
+ */
+BITSET_API void bitset_set_in_range_end(BitSet* const bitset, const uint64_t end)
+{
+    bitset_fill_in_range_begin_end(bitset, true, 0, end);
+}
+
+/**
+ * Fills all the bits in the specified range with the specified value
+ * @param bitset Pointer to bitset to modify
+ * @param value Value to fill the bits with (bit value)
+ * @param begin Begin of the range to fill (bit index)
+ * @param end End of the range to fill (bit index)
+ * @memberof BitSet
+ */
+BITSET_API void bitset_fill_in_range_begin_end(BitSet* const bitset, const bool value, const uint64_t begin, const uint64_t end)
+{
+    if (begin >= end)
+        return;
+
+    const uint64_t first = begin / BITSET_BLOCK_BITS, last = (end - 1) / BITSET_BLOCK_BITS;
+    bitset_block_t first_mask = bitset_create_mask_from(begin % BITSET_BLOCK_BITS);
+    const bitset_block_t last_mask = bitset_create_mask_to((end - 1) % BITSET_BLOCK_BITS + 1);
+    BITSET_STATS_RECORD(BITSET_STATS_FILL, end - begin, (last - first + 1u) * sizeof(bitset_block_t));
+
+    // both ends in the same block, only the bits in between are touched
+    if (first == last)
+        first_mask &= last_mask;
+
+    if (value)
+        *(bitset->data + first) |= first_mask;
+    else
+        *(bitset->data + first) &= ~first_mask;
+
+    if (first != last)
+    {
+        // whole blocks in between
+        BITSET_TRACE_BEGIN("fill", (last - first - 1) * sizeof(bitset_block_t));
+        memset(bitset->data + first + 1, value ? 255u : 0u, (last - first - 1) * sizeof(bitset_block_t));
+        BITSET_TRACE_END("fill", (last - first - 1) * sizeof(bitset_block_t));
+
+        if (value)
+            *(bitset->data + last) |= last_mask;
+        else
+            *(bitset->data + last) &= ~last_mask;
+    }
+}
+
+/**
+ * Fills all the bits in the specified range with 0 (false)
+ * @param bitset Pointer to bitset to modify
+ * @param begin Begin of the range to fill (bit index)
+ * @param end End of the range to fill (bit index)
+ * @memberof BitSet
+ */
+BITSET_API void bitset_clear_in_range_begin_end(BitSet* const bitset, const uint64_t begin, const uint64_t end)
+{
+    bitset_fill_in_range_begin_end(bitset, false, begin, end);
+}
+
+/**
+ * Fills all the bits in the specified range with 1 (true)
+ * @param bitset Pointer to bitset to modify
+ * @param begin Begin of the range to fill (bit index)
+ * @param end End of the range to fill (bit index)
+ * @memberof BitSet
+ */
+BITSET_API void bitset_set_in_range_begin_end(BitSet* const bitset, const uint64_t begin, const uint64_t end)
+{
+    bitset_fill_in_range_begin_end(bitset, true, begin, end);
+}
+
+/**
+ * Updates the 64-bit word at the specified index as word = (word & ~clear_mask) ^ toggle_mask
+ * Only the blocks covered by the masks have to exist (the last word may be partial)
+ * @param bitset Pointer to bitset to modify
+ * @param index Index of the word to update (word index, bits [index * 64, index * 64 + 64))
+ * @param clear_mask Bits to clear
+ * @param toggle_mask Bits to flip after clearing (clear + toggle = set)
+ * @memberof BitSet
+ */
+BITSET_API void bitset_update_word(BitSet* const bitset, const uint64_t index, const uint64_t clear_mask, const uint64_t toggle_mask)
+{
+    const uint64_t first_block = index * BITSET_BLOCKS_PER_WORD;
+    if (BITSET_BLOCKS_PER_WORD == 1)
+    {
+        *(bitset->data + first_block) = (bitset_block_t)((*(bitset->data + first_block) & ~clear_mask) ^ toggle_mask);
+        return;
+    }
+
+    const uint64_t blocks = bitset->storage_size - first_block < BITSET_BLOCKS_PER_WORD ? bitset->storage_size - first_block : BITSET_BLOCKS_PER_WORD;
+#ifdef BITSET_LITTLE_ENDIAN
+    uint64_t word = 0;
+    if (blocks == BITSET_BLOCKS_PER_WORD)
+    {
+        memcpy(&word, bitset->data + first_block, sizeof(uint64_t));
+        word = (word & ~clear_mask) ^ toggle_mask;
+        memcpy(bitset->data + first_block, &word, sizeof(uint64_t));
+        return;
+    }
+    memcpy(&word, bitset->data + first_block, blocks * sizeof(bitset_block_t));
+    word = (word & ~clear_mask) ^ toggle_mask;
+    memcpy(bitset->data + first_block, &word, blocks * sizeof(bitset_block_t));
+#else
+    for (uint64_t i = 0; i < blocks; ++i)
+    {
+        const uint64_t shift = i * BITSET_BLOCK_BITS % 64u;
+        *(bitset->data + first_block + i) = (bitset_block_t)((*(bitset->data + first_block + i) & ~(bitset_block_t)(clear_mask >> shift)) ^ (bitset_block_t)(toggle_mask >> shift));
+    }
+#endif
+}
+
+/**
+ * Strided update engine behind the *_in_range_begin_end_step functions
+ * Updates runs of width bits starting at begin, begin + step, ... (below end), every run as bits = (bits & ~clear_value) ^ toggle_value
+ * Runs must not straddle 64-bit words (width is 1 or BITSET_BLOCK_BITS with block aligned runs)
+ * Steps below 64 bits are applied word-at-a-time with precomputed masks, which repeat every lcm(step, 64) bits,
+ * larger steps touch one block per run
+ * @param bitset Pointer to bitset to modify
+ * @param begin Begin of the range to update (bit index)
+ * @param end End of the range to update (bit index)
+ * @param step Distance between the starts of two runs (bit step)
+ * @param width Width of a single run (bit size)
+ * @param clear_value Bits to clear inside the runs (replicated across the word, e.g. UINT64_MAX)
+ * @param toggle_value Bits to flip inside the runs after clearing (replicated across the word)
+ * @memberof BitSet
+ */
+BITSET_API void bitset_update_in_range_begin_end_step(BitSet* const bitset, const uint64_t begin, const uint64_t end, const uint64_t step, const uint64_t width, const uint64_t clear_value, const uint64_t toggle_value)
+{
+    if (begin >= end || !step)
+        return;
+    BITSET_STATS_RECORD(BITSET_STATS_FILL, end - begin, ((end - 1) / BITSET_BLOCK_BITS - begin / BITSET_BLOCK_BITS + 1u) * sizeof(bitset_block_t));
+
+    if (step >= 64u)
+    {
+        // BITSET_BLOCK_BITS is a power of two, so the block index and bit offset are a shift and a mask
+        const bitset_block_t run = (bitset_block_t)(BITSET_BLOCK_MAX >> (BITSET_BLOCK_BITS - width));
+        for (uint64_t i = begin; i < end; i += step)
+        {
+            const bitset_block_t mask = (bitset_block_t)(run << i % BITSET_BLOCK_BITS);
+            bitset_block_t* const block = bitset->data + i / BITSET_BLOCK_BITS;
+            *block = (bitset_block_t)((*block & ~(mask & (bitset_block_t)clear_value)) ^ (mask & (bitset_block_t)toggle_value));
+        }
+        return;
+    }
+
+    const uint64_t first = begin / 64u, last = (end - 1) / 64u;
+    const uint64_t last_mask = UINT64_MAX >> (63u - (end - 1) % 64u);
+    const uint64_t run = width < 64u ? ((uint64_t)1u << width) - 1u : UINT64_MAX;
+    uint64_t base = 0;
+    for (uint64_t bit = 0; bit < 64u; bit += step)
+        base |= run << bit;
+
+    uint64_t mask = base << begin % 64u;
+    if (first == last)
+    {
+        mask &= last_mask;
+        bitset_update_word(bitset, first, mask & clear_value, mask & toggle_value);
+        return;
+    }
+    bitset_update_word(bitset, first, mask & clear_value, mask & toggle_value);
+
+    // masks of the following words, the pattern repeats every step / gcd(step, 64) words
+    uint64_t masks[64];
+    const uint64_t full_period = step >> bitset_ctz64(step);
+    const uint64_t period = full_period < last - first ? full_period : last - first;
+    const uint64_t advance = step - 64u % step;
+    uint64_t offset = begin % 64u % step;
+    for (uint64_t k = 0; k < period; ++k)
+    {
+        offset += advance;
+        if (offset >= step)
+            offset -= step;
+        masks[k] = base << offset;
+    }
+
+    uint64_t k = 0;
+    for (uint64_t i = first + 1; i < last; ++i)
+    {
+        bitset_update_word(bitset, i, masks[k] & clear_value, masks[k] & toggle_value);
+        if (++k == period)
+            k = 0;
+    }
+    mask = masks[k] & last_mask;
+    bitset_update_word(bitset, last, mask & clear_value, mask & toggle_value);
+}
+
+/**
+ * Fills all the bits in the specified range with the specified value
+ * @param bitset Pointer to bitset to modify
+ * @param value Value to fill the bits with (bit value)
+ * @param begin Begin of the range to fill (bit index)
+ * @param end End of the range to fill (bit index)
+ * @param step Step size between the bits to fill (bit step)
+ * @memberof BitSet
+ */
+BITSET_API void bitset_fill_in_range_begin_end_step(BitSet* const bitset, const bool value, const uint64_t begin, const uint64_t end, const uint64_t step)
+{
+    if (step == 1)
+        bitset_fill_in_range_begin_end(bitset, value, begin, end);
+    else
+        bitset_update_in_range_begin_end_step(bitset, begin, end, step, 1, UINT64_MAX, value ? UINT64_MAX : 0u);
+}
+
+/**
+ * Fills all the bits in the specified range with 0 (false)
+ * @param bitset Pointer to bitset to modify
+ * @param begin Begin of the range to fill (bit index)
+ * @param end End of the range to fill (bit index)
+ * @param step Step size between the bits to fill (bit step)
+ * @memberof BitSet
+ */
+BITSET_API void bitset_clear_in_range_begin_end_step(BitSet* const bitset, const uint64_t begin, const uint64_t end, const uint64_t step)
+{
+    bitset_fill_in_range_begin_end_step(bitset, false, begin, end, step);
+}
+
+/**
+ * Fills all the bits in the specified range with 1 (true)
+ * @param bitset Pointer to bitset to modify
+ * @param begin Begin of the range to fill (bit index)
+ * @param end End of the range to fill (bit index)
+ * @param step Step size between the bits to fill (bit step)
+ * @memberof BitSet
+ */
+BITSET_API void bitset_set_in_range_begin_end_step(BitSet* const bitset, const uint64_t begin, const uint64_t end, const uint64_t step)
+{
+    bitset_fill_in_range_begin_end_step(bitset, true, begin, end, step);
+}
+
+/**
+ * Sets the block at the specified index to the specified value
+ * @param bitset Pointer to bitset to modify
+ * @param block The block to set (block value)
+ * @param index The index of the block to set (block index)
+ * @memberof BitSet
+ */
+BITSET_API void bitset_set_block(BitSet* const bitset, const bitset_block_t block, const uint64_t index)
+{
+    *(bitset->data + index) = block;
+}
+
+/**
+ * Fills all the blocks in the specified range with the specified value
+ * @param bitset Pointer to bitset to modify
+ * @param value The value to fill the bits with (block value)
+ * @memberof BitSet
+ */
+BITSET_API void bitset_fill_all_blocks(BitSet* const bitset, const bitset_block_t value)
+{
+    bitset_fill_block_in_range_begin_end(bitset, value, 0, bitset->storage_size);
+}
+
+/**
+ * Fills all the bits in the specified range with the specified block
+ * @param bitset Pointer to bitset to modify
+ * @param block Chunk to fill the bits with (block value)
+ * @param end End of the range to fill (block index)
+ * @memberof BitSet
+ */
+BITSET_API void bitset_fill_block_in_range_end(BitSet* const bitset, const bitset_block_t block, const uint64_t end)
+{
+    bitset_fill_block_in_range_begin_end(bitset, block, 0, end);
+}
+
+/**
+ * Fills all the bits in the specified range with the specified block
+ * @param bitset Pointer to bitset to modify
+ * @param block Chunk to fill the bits with
+ * @param begin begin of the range to fill (block index)
+ * @param end End of the range to fill (block index)
+ * @memberof BitSet
+ */
+BITSET_API void bitset_fill_block_in_range_begin_end(BitSet* const bitset, const bitset_block_t block, const uint64_t begin, const uint64_t end)
+{
+    if (begin >= end)
+        return;
+    // the block repeated over a native word has the period of a block, so any block-aligned start keeps the phase
+    bitset_fill_pattern_bytes((uint8_t*)(bitset->data + begin), UINT64_MAX / BITSET_BLOCK_MAX * block, (end - begin) * sizeof(bitset_block_t));
+}
+
+/**
+ * Fills all the bits in the specified range with the specified block
+ * @param bitset Pointer to bitset to modify
+ * @param block Chunk to fill the bits with (block value)
+ * @param begin begin of the range to fill (block index)
+ * @param end End of the range to fill (block index)
+ * @param step Step size between the bits to fill (block step)
+ * @memberof BitSet
+ */
+BITSET_API void bitset_fill_block_in_range_begin_end_step(BitSet* const bitset, const bitset_block_t block, const uint64_t begin, const uint64_t end, const uint64_t step)
+{
+    if (step == 1)
+        bitset_fill_block_in_range_begin_end(bitset, block, begin, end);
+    else
+        bitset_update_in_range_begin_end_step(bitset, begin * BITSET_BLOCK_BITS, end * BITSET_BLOCK_BITS, step * BITSET_BLOCK_BITS, BITSET_BLOCK_BITS, UINT64_MAX, UINT64_MAX / BITSET_BLOCK_MAX * block);
+}
+
+/**
+ * Fills all the bits in the specified range with a repeating pattern, bit i receives bit i % pattern_bits of the pattern
+ * The pattern is anchored at bit 0 of the bitset, so consecutive calls over adjacent ranges continue it seamlessly
+ * @param bitset Pointer to bitset to modify
+ * @param pattern The pattern to fill the bits with (its lowest pattern_bits bits are used)
+ * @param pattern_bits Length of the pattern (8, 16, 32 or 64)
+ * @param begin Begin of the range to fill (bit index)
+ * @param end End of the range to fill (bit index)
+ * @memberof BitSet
+ */
+BITSET_API void bitset_fill_pattern_in_range_begin_end(BitSet* const bitset, const uint64_t pattern, const uint64_t pattern_bits, const uint64_t begin, const uint64_t end)
+{
+    if (begin >= end)
+        return;
+    // fail silently, throw exception in safe version
+    if (pattern_bits != 8u && pattern_bits != 16u && pattern_bits != 32u && pattern_bits != 64u)
+        return;
+    BITSET_STATS_RECORD(BITSET_STATS_FILL, end - begin, ((end - 1) / BITSET_BLOCK_BITS - begin / BITSET_BLOCK_BITS + 1u) * sizeof(bitset_block_t));
+
+    uint64_t word = pattern;
+    for (uint64_t bits = pattern_bits; bits < 64u; bits *= 2u)
+        word = (word & (UINT64_MAX >> (64u - bits))) * ((1ull << bits) + 1u);
+
+    // the memory image of a word of bits, block by block in native order
+    bitset_block_t blocks[BITSET_BLOCKS_PER_WORD];
+    uint64_t image;
+    for (uint64_t k = 0; k < BITSET_BLOCKS_PER_WORD; ++k)
+        blocks[k] = (bitset_block_t)(word >> k * BITSET_BLOCK_BITS);
+    memcpy(&image, blocks, sizeof(uint64_t));
+
+    const uint64_t first = begin / BITSET_BLOCK_BITS, last = (end - 1) / BITSET_BLOCK_BITS;
+    bitset_block_t first_mask = bitset_create_mask_from(begin % BITSET_BLOCK_BITS);
+    const bitset_block_t last_mask = bitset_create_mask_to((end - 1) % BITSET_BLOCK_BITS + 1);
+
+    // both ends in the same block, only the bits in between are touched
+    if (first == last)
+        first_mask &= last_mask;
+
+    *(bitset->data + first) = (bitset_block_t)((*(bitset->data + first) & ~first_mask) | (blocks[first % BITSET_BLOCKS_PER_WORD] & first_mask));
+
+    if (first != last)
+    {
+        // whole blocks in between, starting at the matching byte of the image
+        BITSET_TRACE_BEGIN("fill_pattern", (last - first - 1) * sizeof(bitset_block_t));
+        bitset_fill_pattern_bytes((uint8_t*)(bitset->data + first + 1), bitset_rotate_pattern_bytes(image, (first + 1) % BITSET_BLOCKS_PER_WORD * sizeof(bitset_block_t)), (last - first - 1) * sizeof(bitset_block_t));
+        BITSET_TRACE_END("fill_pattern", (last - first - 1) * sizeof(bitset_block_t));
+        *(bitset->data + last) = (bitset_block_t)((*(bitset->data + last) & ~last_mask) | (blocks[last % BITSET_BLOCKS_PER_WORD] & last_mask));
+    }
+}
+
+/**
+ * Flips the bit at the specified index
+ * @param bitset Pointer to bitset to modify
+ * @param index Index of the bit to flip (bit index)
+ * @memberof BitSet
+ */
+BITSET_API void bitset_flip_bit(BitSet* const bitset, const uint64_t index)
+{
+    BITSET_STATS_RECORD(BITSET_STATS_ACCESS, 1u, sizeof(bitset_block_t));
+    *(bitset->data + index / BITSET_BLOCK_BITS) ^= (bitset_block_t)1u << index % BITSET_BLOCK_BITS;
+}
+
+/**
+ * Updates the bits at the specified indices (block = (block & ~bit if clear) ^ bit if toggle), prefetching the blocks ahead
+ * @param bitset Pointer to bitset to modify
+ * @param indices The indices of the bits to update (bit index)
+ * @param count Number of indices
+ * @param clear Whether the bits are cleared first
+ * @param toggle Whether the bits are flipped afterwards
+ * @memberof BitSet
+ */
+BITSET_API void bitset_update_many(BitSet* const bitset, const uint64_t* const indices, const uint64_t count, const bool clear, const bool toggle)
+{
+    BITSET_STATS_RECORD(BITSET_STATS_ACCESS, count, count * sizeof(bitset_block_t));
+    for (uint64_t i = 0; i < count; ++i)
+    {
+        if (i + BITSET_PREFETCH_DISTANCE < count)
+            BITSET_PREFETCH(bitset->data + *(indices + i + BITSET_PREFETCH_DISTANCE) / BITSET_BLOCK_BITS, 1);
+        const uint64_t index = *(indices + i);
+        const bitset_block_t mask = (bitset_block_t)((bitset_block_t)1u << index % BITSET_BLOCK_BITS);
+        bitset_block_t* const block = bitset->data + index / BITSET_BLOCK_BITS;
+        *block = (bitset_block_t)((*block & ~(clear ? mask : 0u)) ^ (toggle ? mask : 0u));
+    }
+}
+
+/**
+ * Sets the bits at the specified indices to 1 (true), faster than separate bitset_set calls on random indices
+ * @param bitset Pointer to bitset to modify
+ * @param indices The indices of the bits to set (bit index)
+ * @param count Number of indices
+ * @memberof BitSet
+ */
+BITSET_API void bitset_set_many(BitSet* const bitset, const uint64_t* const indices, const uint64_t count)
+{
+    bitset_update_many(bitset, indices, count, true, true);
+}
+
+/**
+ * Sets the bits at the specified indices to 0 (false)
+ * @param bitset Pointer to bitset to modify
+ * @param indices The indices of the bits to clear (bit index)
+ * @param count Number of indices
+ * @memberof BitSet
+ */
+BITSET_API void bitset_clear_many(BitSet* const bitset, const uint64_t* const indices, const uint64_t count)
+{
+    bitset_update_many(bitset, indices, count, true, false);
+}
+
+/**
+ * Flips the bits at the specified indices (an index present twice is flipped twice)
+ * @param bitset Pointer to bitset to modify
+ * @param indices The indices of the bits to flip (bit index)
+ * @param count Number of indices
+ * @memberof BitSet
+ */
+BITSET_API void bitset_flip_many(BitSet* const bitset, const uint64_t* const indices, const uint64_t count)
+{
+    bitset_update_many(bitset, indices, count, false, true);
+}
+
+/**
+ * Retrieves the values of the bits at the specified indices, prefetching ahead (and with AVX2 gathers on little-endian x86)
+ * @param bitset Pointer to bitset to read from
+ * @param indices The indices of the bits to read (bit index)
+ * @param count Number of indices
+ * @param values Array receiving the value of every bit (count values)
+ * @memberof BitSet
+ */
+BITSET_API void bitset_get_many(const BitSet* const bitset, const uint64_t* const indices, const uint64_t count, bool* const values)
+{
+    BITSET_STATS_RECORD(BITSET_STATS_ACCESS, count, count * sizeof(bitset_block_t));
+#ifdef BITSET_LITTLE_ENDIAN
+    bitset_get_many_bytes((const uint8_t*)bitset->data, bitset->storage_size * sizeof(bitset_block_t), indices, count, values);
+#else
+    for (uint64_t i = 0; i < count; ++i)
+    {
+        if (i + BITSET_PREFETCH_DISTANCE < count)
+            BITSET_PREFETCH(bitset->data + *(indices + i + BITSET_PREFETCH_DISTANCE) / BITSET_BLOCK_BITS, 0);
+        *(values + i) = (*(bitset->data + *(indices + i) / BITSET_BLOCK_BITS) >> *(indices + i) % BITSET_BLOCK_BITS) & 1u;
+    }
+#endif
+}
+
+/**
+ * Flips all the bits
+ * @param bitset Pointer to bitset to modify
+ * @memberof BitSet
+ */
+BITSET_API void bitset_flip_all(BitSet* const bitset)
+{
+    BITSET_STATS_RECORD(BITSET_STATS_FILL, bitset->size, bitset->storage_size * sizeof(bitset_block_t));
+    BITSET_TRACE_BEGIN("flip", bitset->storage_size * sizeof(bitset_block_t));
+    for (uint64_t i = 0; i < bitset->storage_size; ++i)
+        *(bitset->data + i) = ~*(bitset->data + i);
+    BITSET_TRACE_END("flip", bitset->storage_size * sizeof(bitset_block_t));
+}
+
+/**
+ * Flips all the bits in the specified range
+ * @param bitset Pointer to bitset to modify
+ * @param end End of the range to flip (bit index)
+ * @memberof BitSet
+ */
+BITSET_API void bitset_flip_in_range_end(BitSet* const bitset, const uint64_t end)
+{
+    bitset_flip_in_range_begin_end(bitset, 0, end);
+}
+
+/**
+ * Flips all the bits in the specified range
+ * @param bitset Pointer to bitset to modify
+ * @param begin Begin of the range to flip (bit index)
+ * @param end End of the range to flip (bit index)
+ * @memberof BitSet
+ */
+BITSET_API void bitset_flip_in_range_begin_end(BitSet* const bitset, const uint64_t begin, const uint64_t end)
+{
+    if (begin >= end)
+        return;
+
+    const uint64_t first = begin / BITSET_BLOCK_BITS, last = (end - 1) / BITSET_BLOCK_BITS;
+    bitset_block_t first_mask = bitset_create_mask_from(begin % BITSET_BLOCK_BITS);
+    const bitset_block_t last_mask = bitset_create_mask_to((end - 1) % BITSET_BLOCK_BITS + 1);
+    BITSET_STATS_RECORD(BITSET_STATS_FILL, end - begin, (last - first + 1u) * sizeof(bitset_block_t));
+
+    if (first == last)
+    {
+        *(bitset->data + first) ^= first_mask & last_mask;
+        return;
+    }
+
+    *(bitset->data + first) ^= first_mask;
+    BITSET_TRACE_BEGIN("flip", (last - first - 1) * sizeof(bitset_block_t));
+    for (uint64_t i = first + 1; i < last; ++i)
+        *(bitset->data + i) = ~*(bitset->data + i);
+    BITSET_TRACE_END("flip", (last - first - 1) * sizeof(bitset_block_t));
+    *(bitset->data + last) ^= last_mask;
+}
+
+/**
+ * Flips all the bits in the specified range
+ * @param bitset Pointer to bitset to modify
+ * @param begin Begin of the range to flip (bit index)
+ * @param end End of the range to flip (bit index)
+ * @param step Step size between the bits to flip (bit step)
+ * @memberof BitSet
+ */
+BITSET_API void bitset_flip_in_range_begin_end_step(BitSet* const bitset, const uint64_t begin, const uint64_t end, const uint64_t step)
+{
+    if (step == 1)
+        bitset_flip_in_range_begin_end(bitset, begin, end);
+    else
+        bitset_update_in_range_begin_end_step(bitset, begin, end, step, 1, 0u, UINT64_MAX);
+}
+
+/**
+ * Flips the block at the specified index
+ * @param bitset Pointer to bitset to modify
+ * @param index Index of the block to flip (block index)
+ * @memberof BitSet
+ */
+BITSET_API void bitset_flip_block(BitSet* const bitset, const uint64_t index)
+{
+    *(bitset->data + index) = ~*(bitset->data + index);
+}
+
+/**
+ * Flips all the blocks (exactly the same as bitset_flip_all, just alias)
+ * @param bitset Pointer to bitset to modify
+ * @memberof BitSet
+ */
+BITSET_API void bitset_flip_block_all(BitSet* const bitset)
+{
+    bitset_flip_all(bitset);
+}
+
+/**
+ * Flips all the blocks in the specified range
+ * @param bitset Pointer to bitset to modify
+ * @param end End of the range to flip (block index)
+ * @memberof BitSet
+ */
+BITSET_API void bitset_flip_block_in_range_end(BitSet* const bitset, const uint64_t end)
+{
+    for (uint64_t i = 0; i < end; ++i)
+        *(bitset->data + i) = ~*(bitset->data + i);
+}
+
+/**
+ * Flips all the blocks in the specified range
+ * @param bitset Pointer to bitset to modify
+ * @param begin Begin of the range to flip (block index)
+ * @param end End of the range to flip (block index)
+ * @memberof BitSet
+ */
+BITSET_API void bitset_flip_block_in_range_begin_end(BitSet* const bitset, const uint64_t begin, const uint64_t end)
+{
+    for (uint64_t i = begin; i < end; ++i)
+        *(bitset->data + i) = ~*(bitset->data + i);
+}
+
+/**
+ * Flips all the blocks in the specified range
+ * @param bitset Pointer to bitset to modify
+ * @param begin Begin of the range to flip (block index)
+ * @param end End of the range to flip (block index)
+ * @param step Step size between the blocks to flip (block step)
+ * @memberof BitSet
+ */
+BITSET_API void bitset_flip_block_in_range_begin_end_step(BitSet* const bitset, const uint64_t begin, const uint64_t end, const uint64_t step)
+{
+    if (step == 1)
+        bitset_flip_block_in_range_begin_end(bitset, begin, end);
+    else
+        bitset_update_in_range_begin_end_step(bitset, begin * BITSET_BLOCK_BITS, end * BITSET_BLOCK_BITS, step * BITSET_BLOCK_BITS, BITSET_BLOCK_BITS, 0u, UINT64_MAX);
+}
+
+/**
+ * Retrieves the block at the specified index
+ * @memberof BitSet
+ * @param bitset Pointer to bitset to read from
+ * @param index Index of the block to read (block index)
+ * @return The block at the specified index
+ */
+BITSET_API bitset_block_t bitset_get_block(const BitSet* const bitset, const uint64_t index)
+{
+    return *(bitset->data + index);
+}
+
+/**
+ * Checks if all the bits are set
+ * @memberof BitSet
+ * @param bitset Pointer to bitset to check
+ * @return True if all the bits are set, false otherwise
+ */
+BITSET_API bool bitset_all(const BitSet* const bitset)
+{
+    const uint64_t full_blocks = bitset->size / BITSET_BLOCK_BITS;
+    if (bitset_find_byte_not((const uint8_t*)bitset->data, full_blocks * sizeof(bitset_block_t), UINT8_MAX) != full_blocks * sizeof(bitset_block_t))
+        return false;
+    if (bitset->size % BITSET_BLOCK_BITS)
+    {
+        const bitset_block_t tail_mask = bitset_create_mask_to(bitset->size % BITSET_BLOCK_BITS);
+        return (*(bitset->data + full_blocks) & tail_mask) == tail_mask;
+    }
+    return true;
+}
+
+/**
+ * Checks if any of the bits are set
+ * @memberof BitSet
+ * @param bitset Pointer to bitset to check
+ * @return True if any of the bits are set, false otherwise
+ */
+BITSET_API bool bitset_any(const BitSet* const bitset)
+{
+    const uint64_t full_blocks = bitset->size / BITSET_BLOCK_BITS;
+    if (bitset_find_byte_not((const uint8_t*)bitset->data, full_blocks * sizeof(bitset_block_t), 0u) != full_blocks * sizeof(bitset_block_t))
+        return true;
+    if (bitset->size % BITSET_BLOCK_BITS)
+        return (*(bitset->data + full_blocks) & bitset_create_mask_to(bitset->size % BITSET_BLOCK_BITS)) != 0;
+    return false;
+}
+
+/**
+ * Checks if none of the bits are set
+ * @memberof BitSet
+ * @param bitset Pointer to bitset to check
+ * @return True if none of the bits are set, false otherwise
+ */
+BITSET_API bool bitset_none(const BitSet* const bitset)
+{
+    return bitset_all_cleared(bitset);
+}
+
+/**
+ * Checks if all the bits are clear
+ * @memberof BitSet
+ * @param bitset Pointer to bitset to check
+ * @return True if all the bits are clear, false otherwise
+ */
+BITSET_API bool bitset_all_cleared(const BitSet* const bitset)
+{
+    return !bitset_any(bitset);
+}
+
+/**
+ * Checks if all the bits in the specified range are set
+ * @memberof BitSet
+ * @param bitset Pointer to bitset to check
+ * @param begin Begin of the range to check (bit index)
+ * @param end End of the range to check (bit index)
+ * @return True if all the bits in the range are set (also for an empty range), false otherwise
+ */
+BITSET_API bool bitset_all_in_range(const BitSet* const bitset, const uint64_t begin, const uint64_t end)
+{
+    if (begin >= end)
+        return true;
+
+    const uint64_t first = begin / BITSET_BLOCK_BITS, last = (end - 1) / BITSET_BLOCK_BITS;
+    const bitset_block_t first_mask = bitset_create_mask_from(begin % BITSET_BLOCK_BITS);
+    const bitset_block_t last_mask = bitset_create_mask_to((end - 1) % BITSET_BLOCK_BITS + 1);
+
+    if (first == last)
+        return (*(bitset->data + first) & first_mask & last_mask) == (bitset_block_t)(first_mask & last_mask);
+
+    return (*(bitset->data + first) & first_mask) == first_mask
+        && (*(bitset->data + last) & last_mask) == last_mask
+        && bitset_find_byte_not((const uint8_t*)(bitset->data + first + 1), (last - first - 1) * sizeof(bitset_block_t), UINT8_MAX) == (last - first - 1) * sizeof(bitset_block_t);
+}
+
+/**
+ * Checks if any of the bits in the specified range are set
+ * @memberof BitSet
+ * @param bitset Pointer to bitset to check
+ * @param begin Begin of the range to check (bit index)
+ * @param end End of the range to check (bit index)
+ * @return True if any of the bits in the range are set, false otherwise (also for an empty range)
+ */
+BITSET_API bool bitset_any_in_range(const BitSet* const bitset, const uint64_t begin, const uint64_t end)
+{
+    if (begin >= end)
+        return false;
+
+    const uint64_t first = begin / BITSET_BLOCK_BITS, last = (end - 1) / BITSET_BLOCK_BITS;
+    const bitset_block_t first_mask = bitset_create_mask_from(begin % BITSET_BLOCK_BITS);
+    const bitset_block_t last_mask = bitset_create_mask_to((end - 1) % BITSET_BLOCK_BITS + 1);
+
+    if (first == last)
+        return (*(bitset->data + first) & first_mask & last_mask) != 0;
+
+    return (*(bitset->data + first) & first_mask) != 0
+        || (*(bitset->data + last) & last_mask) != 0
+        || bitset_find_byte_not((const uint8_t*)(bitset->data + first + 1), (last - first - 1) * sizeof(bitset_block_t), 0u) != (last - first - 1) * sizeof(bitset_block_t);
+}
+
+/**
+ * @memberof BitSet
+ * @return the number of bits set in the bitset
+ */
+BITSET_API uint64_t bitset_count(const BitSet* const bitset)
+{
+    const uint64_t full_blocks = bitset->size / BITSET_BLOCK_BITS;
+    BITSET_STATS_RECORD(BITSET_STATS_COUNT, bitset->size, bitset->storage_size * sizeof(bitset_block_t));
+    BITSET_TRACE_BEGIN("count", full_blocks * sizeof(bitset_block_t));
+    uint64_t count = bitset_popcount_bytes((const uint8_t*)bitset->data, full_blocks * sizeof(bitset_block_t));
+    BITSET_TRACE_END("count", full_blocks * sizeof(bitset_block_t));
+    // bits past the end of the bitset are not counted
+    if (bitset->size % BITSET_BLOCK_BITS)
+        count += bitset_popcount64(*(bitset->data + full_blocks) & bitset_create_mask_to(bitset->size % BITSET_BLOCK_BITS));
+    return count;
+}
+
+/**
+ * Counts the set bits in the specified range
+ * @memberof BitSet
+ * @param bitset Pointer to bitset to check
+ * @param begin Begin of the range to count (bit index)
+ * @param end End of the range to count (bit index)
+ * @return The number of bits set in the range
+ */
+BITSET_API uint64_t bitset_count_in_range(const BitSet* const bitset, const uint64_t begin, const uint64_t end)
+{
+    if (begin >= end)
+        return 0;
+
+    const uint64_t first = begin / BITSET_BLOCK_BITS, last = (end - 1) / BITSET_BLOCK_BITS;
+    const bitset_block_t first_mask = bitset_create_mask_from(begin % BITSET_BLOCK_BITS);
+    const bitset_block_t last_mask = bitset_create_mask_to((end - 1) % BITSET_BLOCK_BITS + 1);
+    BITSET_STATS_RECORD(BITSET_STATS_COUNT, end - begin, (last - first + 1u) * sizeof(bitset_block_t));
+
+    if (first == last)
+        return bitset_popcount64(*(bitset->data + first) & first_mask & last_mask);
+
+    BITSET_TRACE_BEGIN("count", (last - first - 1) * sizeof(bitset_block_t));
+    const uint64_t count = bitset_popcount_bytes((const uint8_t*)(bitset->data + first + 1), (last - first - 1) * sizeof(bitset_block_t));
+    BITSET_TRACE_END("count", (last - first - 1) * sizeof(bitset_block_t));
+    return bitset_popcount64(*(bitset->data + first) & first_mask) + count + bitset_popcount64(*(bitset->data + last) & last_mask);
+}
+
+/**
+ * Applies the operation to a single block
+ * @param left The left operand (block value)
+ * @param right The right operand (block value)
+ * @param operation The operation to apply
+ * @return left op right
+ */
+BITSET_API bitset_block_t bitset_apply_operation(const bitset_block_t left, const bitset_block_t right, const bitset_operation operation)
+{
+    switch (operation)
+    {
+    case BITSET_OPERATION_AND:
+        return left & right;
+    case BITSET_OPERATION_OR:
+        return left | right;
+    case BITSET_OPERATION_XOR:
+        return left ^ right;
+    case BITSET_OPERATION_ANDNOT:
+        return left & ~right;
+    }
+    return 0;
+}
+
+/**
+ * Computes destination = left op right over the first destination->size bits
+ * Both operands have to hold at least destination->size bits, the bits of destination past its size are left unchanged
+ * destination may be the same bitset as left or right
+ * @memberof BitSet
+ * @param destination Pointer to bitset to store the result to
+ * @param left Pointer to the left operand
+ * @param right Pointer to the right operand
+ * @param operation The operation to apply
+ */
+BITSET_API void bitset_binary_operation(BitSet* const destination, const BitSet* const left, const BitSet* const right, const bitset_operation operation)
+{
+    const uint64_t full_blocks = destination->size / BITSET_BLOCK_BITS;
+    BITSET_STATS_RECORD(BITSET_STATS_ALGEBRA, destination->size, 3u * bitset_calculate_storage_size(destination->size) * sizeof(bitset_block_t));
+    BITSET_TRACE_BEGIN("binary_operation", full_blocks * sizeof(bitset_block_t));
+    bitset_binary_bytes((uint8_t*)destination->data, (const uint8_t*)left->data, (const uint8_t*)right->data, full_blocks * sizeof(bitset_block_t), operation);
+    BITSET_TRACE_END("binary_operation", full_blocks * sizeof(bitset_block_t));
+    if (destination->size % BITSET_BLOCK_BITS)
+    {
+        const bitset_block_t tail_mask = bitset_create_mask_to(destination->size % BITSET_BLOCK_BITS);
+        const bitset_block_t result = bitset_apply_operation(*(left->data + full_blocks), *(right->data + full_blocks), operation);
+        *(destination->data + full_blocks) = (*(destination->data + full_blocks) & ~tail_mask) | (result & tail_mask);
+    }
+}
+
+/**
+ * Counts the set bits of left op right over the first left->size bits, without storing the result
+ * right has to hold at least left->size bits
+ * @memberof BitSet
+ * @param left Pointer to the left operand
+ * @param right Pointer to the right operand
+ * @param operation The operation to apply
+ * @return The number of set bits of the result
+ */
+BITSET_API uint64_t bitset_binary_count(const BitSet* const left, const BitSet* const right, const bitset_operation operation)
+{
+    const uint64_t full_blocks = left->size / BITSET_BLOCK_BITS;
+    BITSET_STATS_RECORD(BITSET_STATS_ALGEBRA, left->size, 2u * bitset_calculate_storage_size(left->size) * sizeof(bitset_block_t));
+    BITSET_TRACE_BEGIN("binary_count", full_blocks * sizeof(bitset_block_t));
+    uint64_t count = bitset_binary_count_bytes((const uint8_t*)left->data, (const uint8_t*)right->data, full_blocks * sizeof(bitset_block_t), operation);
+    BITSET_TRACE_END("binary_count", full_blocks * sizeof(bitset_block_t));
+    if (left->size % BITSET_BLOCK_BITS)
+        count += bitset_popcount64(bitset_apply_operation(*(left->data + full_blocks), *(right->data + full_blocks), operation) & bitset_create_mask_to(left->size % BITSET_BLOCK_BITS));
+    return count;
+}
+
+/**
+ * Checks if left op right has any set bit over the first left->size bits, without storing the result
+ * Stops at the first set bit of the result, right has to hold at least left->size bits
+ * @memberof BitSet
+ * @param left Pointer to the left operand
+ * @param right Pointer to the right operand
+ * @param operation The operation to apply
+ * @return True if any bit of the result is set, false otherwise
+ */
+BITSET_API bool bitset_binary_any(const BitSet* const left, const BitSet* const right, const bitset_operation operation)
+{
+    const uint64_t full_blocks = left->size / BITSET_BLOCK_BITS;
+    BITSET_STATS_RECORD(BITSET_STATS_ALGEBRA, left->size, 2u * bitset_calculate_storage_size(left->size) * sizeof(bitset_block_t));
+    if (bitset_binary_any_bytes((const uint8_t*)left->data, (const uint8_t*)right->data, full_blocks * sizeof(bitset_block_t), operation))
+        return true;
+    if (left->size % BITSET_BLOCK_BITS)
+        return (bitset_apply_operation(*(left->data + full_blocks), *(right->data + full_blocks), operation) & bitset_create_mask_to(left->size % BITSET_BLOCK_BITS)) != 0;
+    return false;
+}
+
+/**
+ * Checks if the bitsets share any set bit, without computing the intersection
+ * @memberof BitSet
+ * @param left Pointer to the first bitset
+ * @param right Pointer to the second bitset (at least left->size bits)
+ * @return True if left & right has any set bit, false otherwise
+ */
+BITSET_API bool bitset_intersects(const BitSet* const left, const BitSet* const right)
+{
+    return bitset_binary_any(left, right, BITSET_OPERATION_AND);
+}
+
+/**
+ * Checks if every set bit of left is also set in right, without computing the difference
+ * @memberof BitSet
+ * @param left Pointer to the possible subset
+ * @param right Pointer to the possible superset (at least left->size bits)
+ * @return True if left & ~right has no set bit, false otherwise
+ */
+BITSET_API bool bitset_is_subset(const BitSet* const left, const BitSet* const right)
+{
+    return !bitset_binary_any(left, right, BITSET_OPERATION_ANDNOT);
+}
+
+/**
+ * Intersects the bitset with another one (destination &= source)
+ * @memberof BitSet
+ * @param destination Pointer to bitset to modify
+ * @param source Pointer to bitset to intersect with (at least destination->size bits)
+ */
+BITSET_API void bitset_and(BitSet* const destination, const BitSet* const source)
+{
+    bitset_binary_operation(destination, destination, source, BITSET_OPERATION_AND);
+}
+
+/**
+ * Unites the bitset with another one (destination |= source)
+ * @memberof BitSet
+ * @param destination Pointer to bitset to modify
+ * @param source Pointer to bitset to unite with (at least destination->size bits)
+ */
+BITSET_API void bitset_or(BitSet* const destination, const BitSet* const source)
+{
+    bitset_binary_operation(destination, destination, source, BITSET_OPERATION_OR);
+}
+
+/**
+ * Computes the symmetric difference with another bitset (destination ^= source)
+ * @memberof BitSet
+ * @param destination Pointer to bitset to modify
+ * @param source Pointer to the other bitset (at least destination->size bits)
+ */
+BITSET_API void bitset_xor(BitSet* const destination, const BitSet* const source)
+{
+    bitset_binary_operation(destination, destination, source, BITSET_OPERATION_XOR);
+}
+
+/**
+ * Removes the bits of another bitset (destination &= ~source)
+ * @memberof BitSet
+ * @param destination Pointer to bitset to modify
+ * @param source Pointer to bitset with the bits to remove (at least destination->size bits)
+ */
+BITSET_API void bitset_andnot(BitSet* const destination, const BitSet* const source)
+{
+    bitset_binary_operation(destination, destination, source, BITSET_OPERATION_ANDNOT);
+}
+
+/**
+ * Stores the intersection of two bitsets (destination = left & right)
+ * @memberof BitSet
+ * @param destination Pointer to bitset to store the result to
+ * @param left Pointer to the left operand (at least destination->size bits)
+ * @param right Pointer to the right operand (at least destination->size bits)
+ */
+BITSET_API void bitset_and_into(BitSet* const destination, const BitSet* const left, const BitSet* const right)
+{
+    bitset_binary_operation(destination, left, right, BITSET_OPERATION_AND);
+}
+
+/**
+ * Stores the union of two bitsets (destination = left | right)
+ * @memberof BitSet
+ * @param destination Pointer to bitset to store the result to
+ * @param left Pointer to the left operand (at least destination->size bits)
+ * @param right Pointer to the right operand (at least destination->size bits)
+ */
+BITSET_API void bitset_or_into(BitSet* const destination, const BitSet* const left, const BitSet* const right)
+{
+    bitset_binary_operation(destination, left, right, BITSET_OPERATION_OR);
+}
+
+/**
+ * Stores the symmetric difference of two bitsets (destination = left ^ right)
+ * @memberof BitSet
+ * @param destination Pointer to bitset to store the result to
+ * @param left Pointer to the left operand (at least destination->size bits)
+ * @param right Pointer to the right operand (at least destination->size bits)
+ */
+BITSET_API void bitset_xor_into(BitSet* const destination, const BitSet* const left, const BitSet* const right)
+{
+    bitset_binary_operation(destination, left, right, BITSET_OPERATION_XOR);
+}
+
+/**
+ * Stores the difference of two bitsets (destination = left & ~right)
+ * @memberof BitSet
+ * @param destination Pointer to bitset to store the result to
+ * @param left Pointer to the left operand (at least destination->size bits)
+ * @param right Pointer to the right operand (at least destination->size bits)
+ */
+BITSET_API void bitset_andnot_into(BitSet* const destination, const BitSet* const left, const BitSet* const right)
+{
+    bitset_binary_operation(destination, left, right, BITSET_OPERATION_ANDNOT);
+}
+
+/**
+ * Counts the bits set in both bitsets, without storing the intersection
+ * @memberof BitSet
+ * @param left Pointer to the left operand
+ * @param right Pointer to the right operand (at least left->size bits)
+ * @return The number of bits set in left & right
+ */
+BITSET_API uint64_t bitset_and_count(const BitSet* const left, const BitSet* const right)
+{
+    return bitset_binary_count(left, right, BITSET_OPERATION_AND);
+}
+
+/**
+ * Counts the bits set in any of the bitsets, without storing the union
+ * @memberof BitSet
+ * @param left Pointer to the left operand
+ * @param right Pointer to the right operand (at least left->size bits)
+ * @return The number of bits set in left | right
+ */
+BITSET_API uint64_t bitset_or_count(const BitSet* const left, const BitSet* const right)
+{
+    return bitset_binary_count(left, right, BITSET_OPERATION_OR);
+}
+
+/**
+ * Counts the bits set in exactly one of the bitsets (hamming distance), without storing the symmetric difference
+ * @memberof BitSet
+ * @param left Pointer to the left operand
+ * @param right Pointer to the right operand (at least left->size bits)
+ * @return The number of bits set in left ^ right
+ */
+BITSET_API uint64_t bitset_xor_count(const BitSet* const left, const BitSet* const right)
+{
+    return bitset_binary_count(left, right, BITSET_OPERATION_XOR);
+}
+
+/**
+ * Counts the bits set in left but not in right, without storing the difference
+ * @memberof BitSet
+ * @param left Pointer to the left operand
+ * @param right Pointer to the right operand (at least left->size bits)
+ * @return The number of bits set in left & ~right
+ */
+BITSET_API uint64_t bitset_andnot_count(const BitSet* const left, const BitSet* const right)
+{
+    return bitset_binary_count(left, right, BITSET_OPERATION_ANDNOT);
+}
+
+/**
+ * Computes the Jaccard index |left & right| / |left | right| in a single pass
+ * @memberof BitSet
+ * @param left Pointer to the left operand
+ * @param right Pointer to the right operand (at least left->size bits)
+ * @return The Jaccard index in range [0, 1], 1 if both bitsets are empty
+ */
+BITSET_API double bitset_jaccard(const BitSet* const left, const BitSet* const right)
+{
+    const uint64_t full_blocks = left->size / BITSET_BLOCK_BITS;
+    uint64_t and_count = 0, or_count = 0;
+    BITSET_STATS_RECORD(BITSET_STATS_ALGEBRA, left->size, 2u * bitset_calculate_storage_size(left->size) * sizeof(bitset_block_t));
+    bitset_and_or_count_bytes((const uint8_t*)left->data, (const uint8_t*)right->data, full_blocks * sizeof(bitset_block_t), &and_count, &or_count);
+    if (left->size % BITSET_BLOCK_BITS)
+    {
+        const bitset_block_t tail_mask = bitset_create_mask_to(left->size % BITSET_BLOCK_BITS);
+        and_count += bitset_popcount64(*(left->data + full_blocks) & *(right->data + full_blocks) & tail_mask);
+        or_count += bitset_popcount64((*(left->data + full_blocks) | *(right->data + full_blocks)) & tail_mask);
+    }
+    return or_count ? (double)and_count / (double)or_count : 1.0;
+}
+
+/**
+ * Retrieves the 64-bit word at the specified index, assembled from the blocks (bits past the storage read as 0)
+ * @memberof BitSet
+ * @param bitset Pointer to bitset to read from
+ * @param index Index of the word to read (word index, bits [index * 64, index * 64 + 64))
+ * @return The word at the specified index
+ */
+BITSET_API uint64_t bitset_get_word(const BitSet* const bitset, const uint64_t index)
+{
+    const uint64_t first_block = index * BITSET_BLOCKS_PER_WORD;
+    if (first_block >= bitset->storage_size)
+        return 0;
+    if (BITSET_BLOCKS_PER_WORD == 1)
+        return *(bitset->data + first_block);
+
+    const uint64_t blocks = bitset->storage_size - first_block < BITSET_BLOCKS_PER_WORD ? bitset->storage_size - first_block : BITSET_BLOCKS_PER_WORD;
+    uint64_t word = 0;
+#ifdef BITSET_LITTLE_ENDIAN
+    memcpy(&word, bitset->data + first_block, blocks * sizeof(bitset_block_t));
+#else
+    for (uint64_t i = 0; i < blocks; ++i)
+        word |= (uint64_t)*(bitset->data + first_block + i) << (i * BITSET_BLOCK_BITS % 64u);
+#endif
+    return word;
+}
+
+/**
+ * Calculates the number of 64-bit words spanned by the bitset
+ * @memberof BitSet
+ * @param size The size of the bitset (bit size)
+ * @return The number of words
+ */
+BITSET_API uint64_t bitset_calculate_word_count(const uint64_t size)
+{
+    return size / 64u + (size % 64u ? 1 : 0);
+}
+
+/**
+ * Finds the first bit with the specified value at or after the specified index
+ * @memberof BitSet
+ * @param bitset Pointer to bitset to search
+ * @param value The value of the bit to find
+ * @param begin Index to start the search from (bit index)
+ * @return Index of the found bit, BITSET_NPOS if there is none
+ */
+BITSET_API uint64_t bitset_find_next_value(const BitSet* const bitset, const bool value, const uint64_t begin)
+{
+    if (begin >= bitset->size)
+        return BITSET_NPOS;
+
+    const uint64_t words = bitset_calculate_word_count(bitset->size);
+    const uint64_t invert = value ? 0u : UINT64_MAX;
+    uint64_t index = begin / 64u;
+    uint64_t word = (bitset_get_word(bitset, index) ^ invert) & (UINT64_MAX << begin % 64u);
+    while (!word)
+    {
+        if (++index >= words)
+        {
+            BITSET_STATS_RECORD(BITSET_STATS_FIND, bitset->size - begin, (index - begin / 64u) * sizeof(uint64_t));
+            return BITSET_NPOS;
+        }
+        word = bitset_get_word(bitset, index) ^ invert;
+    }
+    BITSET_STATS_RECORD(BITSET_STATS_FIND, index * 64u + bitset_ctz64(word) + 1u - begin, (index - begin / 64u + 1u) * sizeof(uint64_t));
+    // matches past the size are bits of the last block that are not part of the bitset
+    index = index * 64u + bitset_ctz64(word);
+    return index < bitset->size ? index : BITSET_NPOS;
+}
+
+/**
+ * Finds the last bit with the specified value before the specified index
+ * @memberof BitSet
+ * @param bitset Pointer to bitset to search
+ * @param value The value of the bit to find
+ * @param end Index to search backwards from, exclusive (bit index)
+ * @return Index of the found bit, BITSET_NPOS if there is none
+ */
+BITSET_API uint64_t bitset_find_prev_value(const BitSet* const bitset, const bool value, const uint64_t end)
+{
+    const uint64_t last = (end < bitset->size ? end : bitset->size);
+    if (!last)
+        return BITSET_NPOS;
+
+    const uint64_t invert = value ? 0u : UINT64_MAX;
+    uint64_t index = (last - 1u) / 64u;
+    uint64_t word = (bitset_get_word(bitset, index) ^ invert) & (UINT64_MAX >> (63u - (last - 1u) % 64u));
+    while (!word)
+    {
+        if (!index--)
+        {
+            BITSET_STATS_RECORD(BITSET_STATS_FIND, last, ((last - 1u) / 64u + 1u) * sizeof(uint64_t));
+            return BITSET_NPOS;
+        }
+        word = bitset_get_word(bitset, index) ^ invert;
+    }
+    index = index * 64u + 63u - bitset_clz64(word);
+    BITSET_STATS_RECORD(BITSET_STATS_FIND, last - index, ((last - 1u) / 64u - index / 64u + 1u) * sizeof(uint64_t));
+    return index;
+}
+
+/**
+ * Finds the first set bit
+ * @memberof BitSet
+ * @param bitset Pointer to bitset to search
+ * @return Index of the first set bit, BITSET_NPOS if there is none
+ */
+BITSET_API uint64_t bitset_find_first(const BitSet* const bitset)
+{
+    return bitset_find_next_value(bitset, true, 0);
+}
+
+/**
+ * Finds the first set bit after the specified index
+ * @memberof BitSet
+ * @param bitset Pointer to bitset to search
+ * @param index Index to search after, exclusive (bit index)
+ * @return Index of the found bit, BITSET_NPOS if there is none
+ */
+BITSET_API uint64_t bitset_find_next(const BitSet* const bitset, const uint64_t index)
+{
+    return index == BITSET_NPOS ? BITSET_NPOS : bitset_find_next_value(bitset, true, index + 1u);
+}
+
+/**
+ * Finds the last set bit
+ * @memberof BitSet
+ * @param bitset Pointer to bitset to search
+ * @return Index of the last set bit, BITSET_NPOS if there is none
+ */
+BITSET_API uint64_t bitset_find_last(const BitSet* const bitset)
+{
+    return bitset_find_prev_value(bitset, true, bitset->size);
+}
+
+/**
+ * Finds the last set bit before the specified index
+ * @memberof BitSet
+ * @param bitset Pointer to bitset to search
+ * @param index Index to search before, exclusive (bit index)
+ * @return Index of the found bit, BITSET_NPOS if there is none
+ */
+BITSET_API uint64_t bitset_find_prev(const BitSet* const bitset, const uint64_t index)
+{
+    return bitset_find_prev_value(bitset, true, index);
+}
+
+/**
+ * Finds the first cleared bit
+ * @memberof BitSet
+ * @param bitset Pointer to bitset to search
+ * @return Index of the first cleared bit, BITSET_NPOS if there is none
+ */
+BITSET_API uint64_t bitset_find_first_unset(const BitSet* const bitset)
+{
+    return bitset_find_next_value(bitset, false, 0);
+}
+
+/**
+ * Finds the first cleared bit after the specified index
+ * @memberof BitSet
+ * @param bitset Pointer to bitset to search
+ * @param index Index to search after, exclusive (bit index)
+ * @return Index of the found bit, BITSET_NPOS if there is none
+ */
+BITSET_API uint64_t bitset_find_next_unset(const BitSet* const bitset, const uint64_t index)
+{
+    return index == BITSET_NPOS ? BITSET_NPOS : bitset_find_next_value(bitset, false, index + 1u);
+}
+
+/**
+ * Finds the last cleared bit
+ * @memberof BitSet
+ * @param bitset Pointer to bitset to search
+ * @return Index of the last cleared bit, BITSET_NPOS if there is none
+ */
+BITSET_API uint64_t bitset_find_last_unset(const BitSet* const bitset)
+{
+    return bitset_find_prev_value(bitset, false, bitset->size);
+}
+
+/**
+ * Finds the last cleared bit before the specified index
+ * @memberof BitSet
+ * @param bitset Pointer to bitset to search
+ * @param index Index to search before, exclusive (bit index)
+ * @return Index of the found bit, BITSET_NPOS if there is none
+ */
+BITSET_API uint64_t bitset_find_prev_unset(const BitSet* const bitset, const uint64_t index)
+{
+    return bitset_find_prev_value(bitset, false, index);
+}
+
+/**
+ * Writes the indices of the set bits, starting at the specified index, to a buffer
+ * To continue extracting after a full buffer, call again with begin set to the last written index + 1
+ * @memberof BitSet
+ * @param bitset Pointer to bitset to read from
+ * @param begin Index to start extracting from (bit index)
+ * @param indices Pointer to the buffer to write the indices to
+ * @param capacity Maximal number of indices to write
+ * @return Number of indices written
+ */
+BITSET_API uint64_t bitset_extract_indices(const BitSet* const bitset, const uint64_t begin, uint64_t* const indices, const uint64_t capacity)
+{
+    if (begin >= bitset->size || !capacity)
+        return 0;
+
+    const uint64_t words = bitset_calculate_word_count(bitset->size);
+    BITSET_STATS_RECORD(BITSET_STATS_FIND, bitset->size - begin, (words - begin / 64u) * sizeof(uint64_t));
+#ifdef BITSET_X86_DISPATCH
+    const bool compress = bitset_extract_word_compress_supported();
+#endif
+    uint64_t count = 0, index = begin / 64u;
+    uint64_t word = bitset_get_word(bitset, index) & (UINT64_MAX << begin % 64u);
+    for (;;)
+    {
+        if (index == words - 1u && bitset->size % 64u)
+            word &= UINT64_MAX >> (64u - bitset->size % 64u);
+
+        const uint64_t word_count = bitset_popcount64(word);
+        if (count + word_count > capacity)
+        {
+            // the buffer fills up inside this word
+            while (count < capacity)
+            {
+                *(indices + count++) = index * 64u + bitset_ctz64(word);
+                word &= word - 1u;
+            }
+            return count;
+        }
+#ifdef BITSET_X86_DISPATCH
+        // dense words are cheaper to compress than to walk bit by bit
+        if (compress && word_count >= 8u)
+            count += bitset_extract_word_compress(word, index * 64u, indices + count);
+        else
+#endif
+            count += bitset_extract_word(word, index * 64u, indices + count);
+
+        if (++index >= words)
+            return count;
+        word = bitset_get_word(bitset, index);
+    }
+}
+
+/**
+ * Calls the callback with the index of every set bit, in increasing order
+ * @memberof BitSet
+ * @param bitset Pointer to bitset to iterate
+ * @param callback The function to call
+ * @param context Pointer passed to the callback unchanged
+ */
+BITSET_API void bitset_for_each_set_bit(const BitSet* const bitset, const bitset_index_callback callback, void* const context)
+{
+    const uint64_t words = bitset_calculate_word_count(bitset->size);
+    BITSET_STATS_RECORD(BITSET_STATS_FIND, bitset->size, words * sizeof(uint64_t));
+    for (uint64_t index = 0; index < words; ++index)
+    {
+        uint64_t word = bitset_get_word(bitset, index);
+        if (index == words - 1u && bitset->size % 64u)
+            word &= UINT64_MAX >> (64u - bitset->size % 64u);
+        while (word)
+        {
+            callback(index * 64u + bitset_ctz64(word), context);
+            word &= word - 1u;
+        }
+    }
+}
+
+/**
+ * Finds the first run of at least min_length bits with the specified value at or after the specified index
+ * Runs are located with the word-skipping find functions, so long runs and long gaps cost one word per 64 bits
+ * @memberof BitSet
+ * @param bitset Pointer to bitset to search
+ * @param begin Index to start the search from, bits before it are not part of any run (bit index)
+ * @param min_length Minimal length of the run (bit count, 0 is treated as 1)
+ * @param value The value of the bits of the run
+ * @return Index of the first bit of the found run, BITSET_NPOS if there is none
+ */
+BITSET_API uint64_t bitset_find_next_run(const BitSet* const bitset, const uint64_t begin, const uint64_t min_length, const bool value)
+{
+    uint64_t run_begin = bitset_find_next_value(bitset, value, begin);
+    while (run_begin != BITSET_NPOS)
+    {
+        if (bitset->size - run_begin < min_length)
+            return BITSET_NPOS;
+        // the run is long enough if no opposite bit lies within its first min_length bits
+        const uint64_t run_end = bitset_find_next_value(bitset, !value, run_begin);
+        if (run_end == BITSET_NPOS || run_end - run_begin >= min_length)
+            return run_begin;
+        run_begin = bitset_find_next_value(bitset, value, run_end);
+    }
+    return BITSET_NPOS;
+}
+
+/**
+ * Calls the callback with the [begin, end) interval of every maximal run of bits with the specified value, in increasing order
+ * @memberof BitSet
+ * @param bitset Pointer to bitset to iterate
+ * @param value The value of the bits of the runs
+ * @param callback The function to call
+ * @param context Pointer passed to the callback unchanged
+ */
+BITSET_API void bitset_for_each_run(const BitSet* const bitset, const bool value, const bitset_run_callback callback, void* const context)
+{
+    uint64_t run_begin = bitset_find_next_value(bitset, value, 0);
+    while (run_begin != BITSET_NPOS)
+    {
+        uint64_t run_end = bitset_find_next_value(bitset, !value, run_begin);
+        if (run_end == BITSET_NPOS)
+            run_end = bitset->size;
+        callback(run_begin, run_end, context);
+        run_begin = bitset_find_next_value(bitset, value, run_end);
+    }
+}
+
+/**
+ * Counts the maximal runs of bits with the specified value (edge detection, see bitset_count_run_starts_bytes)
+ * @memberof BitSet
+ * @param bitset Pointer to bitset to count the runs of
+ * @param value The value of the bits of the runs
+ * @return The number of runs
+ */
+BITSET_API uint64_t bitset_count_runs(const BitSet* const bitset, const bool value)
+{
+    const uint64_t words = bitset_calculate_word_count(bitset->size);
+    const uint64_t invert = value ? 0u : UINT64_MAX;
+    uint64_t count = 0, index = 0, carry = 0;
+    BITSET_STATS_RECORD(BITSET_STATS_COUNT, bitset->size, words * sizeof(uint64_t));
+#ifdef BITSET_LITTLE_ENDIAN
+    // the full words are laid out as little-endian 64-bit words in memory whatever the block type
+    index = bitset->size / 64u;
+    if (index)
+    {
+        BITSET_TRACE_BEGIN("count_runs", index * 8u);
+        count = bitset_count_run_starts_bytes((const uint8_t*)bitset->data, index * 8u, invert);
+        BITSET_TRACE_END("count_runs", index * 8u);
+        carry = (bitset_get_word(bitset, index - 1u) ^ invert) >> 63;
+    }
+#endif
+    for (; index < words; ++index)
+    {
+        uint64_t word = bitset_get_word(bitset, index) ^ invert;
+        if (index == words - 1u && bitset->size % 64u)
+            word &= UINT64_MAX >> (64u - bitset->size % 64u);
+        count += bitset_popcount64(word & ~(word << 1 | carry));
+        carry = word >> 63;
+    }
+    return count;
+}
+
+/**
+ * Retrieves the 64-bit word at the specified index with the bits at and past end read as 0
+ * @memberof BitSet
+ * @param bitset Pointer to bitset to read
+ * @param index Index of the word to read (word index, bits [index * 64, index * 64 + 64))
+ * @param end Index of the first bit to read as 0 (bit index)
+ * @return The masked word at the specified index
+ */
+BITSET_API uint64_t bitset_get_word_below(const BitSet* const bitset, const uint64_t index, const uint64_t end)
+{
+    if (index >= end / 64u + (end % 64u ? 1 : 0))
+        return 0;
+    const uint64_t word = bitset_get_word(bitset, index);
+    return index == end / 64u ? word & (UINT64_MAX >> (64u - end % 64u)) : word;
+}
+
+/**
+ * Computes destination = (source << shift) | bits over the first destination->size bits (bit i moves to i + shift)
+ * Whole words are moved and a single pass funnels the carry between neighbouring words, block aligned shifts are a memmove
+ * source has to hold at least destination->size bits, the bits of destination past its size are left unchanged
+ * destination may be the same bitset as source (in place)
+ * @memberof BitSet
+ * @param destination Pointer to bitset to store the result to
+ * @param source Pointer to bitset to shift
+ * @param shift Number of bits to shift by (bit count, any value)
+ * @param bits Bits ORed into the lowest word after the shift, e.g. the newest slots of a sliding window
+ */
+BITSET_API void bitset_shift_left_or_into(BitSet* const destination, const BitSet* const source, const uint64_t shift, const uint64_t bits)
+{
+    const uint64_t size = destination->size;
+    const uint64_t words = bitset_calculate_word_count(size);
+    if (!words)
+        return;
+    BITSET_STATS_RECORD(BITSET_STATS_SHIFT, size, 2u * words * sizeof(uint64_t));
+    const uint64_t last_mask = size % 64u ? UINT64_MAX >> (64u - size % 64u) : UINT64_MAX;
+
+    if (shift >= size)
+        bitset_fill_in_range_begin_end(destination, false, 0, size);
+    else if (!(shift % BITSET_BLOCK_BITS))
+    {
+        const uint64_t block_shift = shift / BITSET_BLOCK_BITS;
+        const uint64_t tail = destination->storage_size - 1u;
+        // the bits past the size of the last block are restored after the move
+        const bitset_block_t kept = *(destination->data + tail);
+        memmove(destination->data + block_shift, source->data, (destination->storage_size - block_shift) * sizeof(bitset_block_t));
+        memset(destination->data, 0, block_shift * sizeof(bitset_block_t));
+        if (size % BITSET_BLOCK_BITS)
+        {
+            const bitset_block_t tail_mask = bitset_create_mask_to(size % BITSET_BLOCK_BITS);
+            *(destination->data + tail) = (*(destination->data + tail) & tail_mask) | (kept & ~tail_mask);
+        }
+    }
+    else
+    {
+        // not block aligned, so bit_shift is never 0
+        const uint64_t word_shift = shift / 64u, bit_shift = shift % 64u;
+        // descending, so every source word is read before the same index of destination is written
+        uint64_t upper = bitset_get_word(source, words - 1u - word_shift);
+        for (uint64_t i = words; i-- > word_shift;)
+        {
+            const uint64_t lower = i > word_shift ? bitset_get_word(source, i - word_shift - 1u) : 0;
+            const uint64_t word = upper << bit_shift | lower >> (64u - bit_shift);
+            const uint64_t mask = i == words - 1u ? last_mask : UINT64_MAX;
+            bitset_update_word(destination, i, mask, word & mask);
+            upper = lower;
+        }
+        for (uint64_t i = 0; i < word_shift; ++i)
+            bitset_update_word(destination, i, i == words - 1u ? last_mask : UINT64_MAX, 0);
+    }
+
+    if (bits)
+        bitset_update_word(destination, 0, bits & (words == 1u ? last_mask : UINT64_MAX), bits & (words == 1u ? last_mask : UINT64_MAX));
+}
+
+/**
+ * Computes destination = source << shift over the first destination->size bits (bit i moves to i + shift, the low bits are cleared)
+ * source has to hold at least destination->size bits, destination may be the same bitset as source
+ * @memberof BitSet
+ * @param destination Pointer to bitset to store the result to
+ * @param source Pointer to bitset to shift
+ * @param shift Number of bits to shift by (bit count, any value)
+ */
+BITSET_API void bitset_shift_left_into(BitSet* const destination, const BitSet* const source, const uint64_t shift)
+{
+    bitset_shift_left_or_into(destination, source, shift, 0);
+}
+
+/**
+ * Shifts the bitset towards the higher indices (bit i moves to i + shift, the low bits are cleared)
+ * @memberof BitSet
+ * @param bitset Pointer to bitset to shift
+ * @param shift Number of bits to shift by (bit count, any value)
+ */
+BITSET_API void bitset_shift_left(BitSet* const bitset, const uint64_t shift)
+{
+    bitset_shift_left_or_into(bitset, bitset, shift, 0);
+}
+
+/**
+ * Shifts the bitset towards the higher indices and ORs new bits into the freed low bits (bitset = (bitset << shift) | bits)
+ * A sliding window advances by shift slots and takes the newest ones in a single pass
+ * @memberof BitSet
+ * @param bitset Pointer to bitset to shift
+ * @param shift Number of bits to shift by (bit count, any value)
+ * @param bits Bits ORed into the lowest word after the shift
+ */
+BITSET_API void bitset_shift_left_or(BitSet* const bitset, const uint64_t shift, const uint64_t bits)
+{
+    bitset_shift_left_or_into(bitset, bitset, shift, bits);
+}
+
+/**
+ * Computes destination = source >> shift over the first destination->size bits (bit i moves to i - shift, the high bits are cleared)
+ * Whole words are moved and a single pass funnels the carry between neighbouring words, block aligned shifts are a memmove
+ * source has to hold at least destination->size bits (the bits past it are ignored), the bits of destination past its size are left unchanged
+ * destination may be the same bitset as source (in place)
+ * @memberof BitSet
+ * @param destination Pointer to bitset to store the result to
+ * @param source Pointer to bitset to shift
+ * @param shift Number of bits to shift by (bit count, any value)
+ */
+BITSET_API void bitset_shift_right_into(BitSet* const destination, const BitSet* const source, const uint64_t shift)
+{
+    const uint64_t size = destination->size;
+    const uint64_t words = bitset_calculate_word_count(size);
+    if (!words)
+        return;
+    BITSET_STATS_RECORD(BITSET_STATS_SHIFT, size, 2u * words * sizeof(uint64_t));
+
+    if (shift >= size)
+    {
+        bitset_fill_in_range_begin_end(destination, false, 0, size);
+        return;
+    }
+    if (!(shift % BITSET_BLOCK_BITS))
+    {
+        if (!shift)
+        {
+            if (destination != source)
+                bitset_shift_left_or_into(destination, source, 0, 0);
+            return;
+        }
+        // the blocks moved in stop below the last block, the bits past the size they carry are cleared with the vacated range
+        const uint64_t block_shift = shift / BITSET_BLOCK_BITS;
+        memmove(destination->data, source->data + block_shift, (destination->storage_size - block_shift) * sizeof(bitset_block_t));
+        bitset_fill_in_range_begin_end(destination, false, size - shift, size);
+        return;
+    }
+
+    // not block aligned, so bit_shift is never 0
+    const uint64_t word_shift = shift / 64u, bit_shift = shift % 64u;
+    const uint64_t last_mask = size % 64u ? UINT64_MAX >> (64u - size % 64u) : UINT64_MAX;
+    // ascending, so every source word is read before the same index of destination is written
+    uint64_t lower = bitset_get_word_below(source, word_shift, size);
+    for (uint64_t i = 0; i < words; ++i)
+    {
+        const uint64_t upper = bitset_get_word_below(source, i + word_shift + 1u, size);
+        const uint64_t word = lower >> bit_shift | upper << (64u - bit_shift);
+        const uint64_t mask = i == words - 1u ? last_mask : UINT64_MAX;
+        bitset_update_word(destination, i, mask, word & mask);
+        lower = upper;
+    }
+}
+
+/**
+ * Shifts the bitset towards the lower indices (bit i moves to i - shift, the high bits are cleared)
+ * @memberof BitSet
+ * @param bitset Pointer to bitset to shift
+ * @param shift Number of bits to shift by (bit count, any value)
+ */
+BITSET_API void bitset_shift_right(BitSet* const bitset, const uint64_t shift)
+{
+    bitset_shift_right_into(bitset, bitset, shift);
+}
+
+/**
+ * Computes destination = source rotated towards the higher indices over the first destination->size bits (bit i moves to (i + shift) % size)
+ * source has to hold at least destination->size bits, destination has to be a different bitset than source (see bitset_rotate_left)
+ * @memberof BitSet
+ * @param destination Pointer to bitset to store the result to
+ * @param source Pointer to bitset to rotate
+ * @param shift Number of bits to rotate by (bit count, any value)
+ */
+BITSET_API void bitset_rotate_left_into(BitSet* const destination, const BitSet* const source, const uint64_t shift)
+{
+    const uint64_t size = destination->size;
+    if (!size)
+        return;
+    const uint64_t offset = shift % size;
+    bitset_shift_left_or_into(destination, source, offset, 0);
+    if (!offset)
+        return;
+
+    // the top offset bits wrap around into the low bits cleared by the shift
+    const uint64_t begin = size - offset;
+    for (uint64_t i = 0; i * 64u < offset; ++i)
+    {
+        const uint64_t bit = begin + i * 64u;
+        uint64_t word = bitset_get_word_below(source, bit / 64u, size) >> bit % 64u;
+        if (bit % 64u)
+            word |= bitset_get_word_below(source, bit / 64u + 1u, size) << (64u - bit % 64u);
+        bitset_update_word(destination, i, word, word);
+    }
+}
+
+/**
+ * Computes destination = source rotated towards the lower indices over the first destination->size bits (bit i moves to (i - shift) % size)
+ * source has to hold at least destination->size bits, destination has to be a different bitset than source (see bitset_rotate_right)
+ * @memberof BitSet
+ * @param destination Pointer to bitset to store the result to
+ * @param source Pointer to bitset to rotate
+ * @param shift Number of bits to rotate by (bit count, any value)
+ */
+BITSET_API void bitset_rotate_right_into(BitSet* const destination, const BitSet* const source, const uint64_t shift)
+{
+    if (destination->size)
+        bitset_rotate_left_into(destination, source, destination->size - shift % destination->size);
+}
+
+/**
+ * Rotates the bitset towards the higher indices (bit i moves to (i + shift) % size)
+ * The blocks are copied to a temporary buffer from the default allocator first
+ * @memberof BitSet
+ * @param bitset Pointer to bitset to rotate
+ * @param shift Number of bits to rotate by (bit count, any value)
+ */
+BITSET_API void bitset_rotate_left(BitSet* const bitset, const uint64_t shift)
+{
+    if (!bitset->size || !(shift % bitset->size))
+        return;
+
+    DynamicBitSet copy;
+    copy.size = bitset->size;
+    copy.storage_size = copy.capacity = bitset->storage_size;
+    copy.allocator = NULL;
+    copy.data = (bitset_block_t*)bitset_allocate(NULL, copy.storage_size * sizeof(bitset_block_t));
+    // throw exception in safe version
+    if (!copy.data)
+        return;
+    memcpy(copy.data, bitset->data, copy.storage_size * sizeof(bitset_block_t));
+    bitset_rotate_left_into(bitset, UNIVERSAL_BITSET(&copy), shift);
+    bitset_dynamic_destroy(&copy);
+}
+
+/**
+ * Rotates the bitset towards the lower indices (bit i moves to (i - shift) % size)
+ * @memberof BitSet
+ * @param bitset Pointer to bitset to rotate
+ * @param shift Number of bits to rotate by (bit count, any value)
+ */
+BITSET_API void bitset_rotate_right(BitSet* const bitset, const uint64_t shift)
+{
+    if (bitset->size)
+        bitset_rotate_left(bitset, bitset->size - shift % bitset->size);
+}
+
+/**
+ * Applies the operation to a single 64-bit word
+ * @param left The left operand (word value)
+ * @param right The right operand (word value)
+ * @param operation The operation to apply
+ * @return left op right
+ */
+BITSET_API uint64_t bitset_apply_operation64(const uint64_t left, const uint64_t right, const bitset_operation operation)
+{
+    switch (operation)
+    {
+    case BITSET_OPERATION_AND:
+        return left & right;
+    case BITSET_OPERATION_OR:
+        return left | right;
+    case BITSET_OPERATION_XOR:
+        return left ^ right;
+    case BITSET_OPERATION_ANDNOT:
+        return left & ~right;
+    }
+    return 0;
+}
+
+/**
+ * Initializes a view of bits [begin, begin + size) of the bitset, no bits are copied
+ * @memberof BitSetView
+ * @param view Pointer to view to initialize
+ * @param bitset Pointer to bitset to view (has to outlive the view, it is modified through the view)
+ * @param begin Index of the first bit of the view (bit index)
+ * @param size Size of the view, begin + size has to be at most bitset->size (bit size)
+ */
+BITSET_API void bitset_view_init(BitSetView* const view, const BitSet* const bitset, const uint64_t begin, const uint64_t size)
+{
+    view->data = bitset->data + begin / BITSET_BLOCK_BITS;
+    view->size = size;
+    view->offset = begin % BITSET_BLOCK_BITS;
+    view->storage_size = bitset_calculate_storage_size(view->offset + size);
+}
+
+/**
+ * Retrieves the 64-bit word at the specified index of the view, the blocks are funneled by the offset (bits past the size read as 0)
+ * @memberof BitSetView
+ * @param view Pointer to view to read
+ * @param index Index of the word to read (word index, view bits [index * 64, index * 64 + 64))
+ * @return The word at the specified index
+ */
+BITSET_API uint64_t bitset_view_get_word(const BitSetView* const view, const uint64_t index)
+{
+    // the offset is below a block, so every word of the view starts offset bits into a word of the blocks
+    uint64_t word = bitset_get_word(UNIVERSAL_BITSET(view), index);
+    if (view->offset)
+        word = word >> view->offset | bitset_get_word(UNIVERSAL_BITSET(view), index + 1u) << (64u - view->offset);
+    if (index >= view->size / 64u)
+        word &= index == view->size / 64u && view->size % 64u ? UINT64_MAX >> (64u - view->size % 64u) : 0;
+    return word;
+}
+
+/**
+ * Updates the 64-bit word at the specified index of the view as word = (word & ~clear_mask) ^ toggle_mask
+ * The masks must not cover bits past the size of the view
+ * @memberof BitSetView
+ * @param view Pointer to view to modify
+ * @param index Index of the word to update (word index, view bits [index * 64, index * 64 + 64))
+ * @param clear_mask Bits to clear
+ * @param toggle_mask Bits to flip after clearing (clear + toggle = set)
+ */
+BITSET_API void bitset_view_update_word(BitSetView* const view, const uint64_t index, const uint64_t clear_mask, const uint64_t toggle_mask)
+{
+    if (!view->offset)
+    {
+        bitset_update_word(UNIVERSAL_BITSET(view), index, clear_mask, toggle_mask);
+        return;
+    }
+    bitset_update_word(UNIVERSAL_BITSET(view), index, clear_mask << view->offset, toggle_mask << view->offset);
+    // the high bits spill into the next word of the blocks, which only exists if the masks reach it
+    const uint64_t high_clear = clear_mask >> (64u - view->offset), high_toggle = toggle_mask >> (64u - view->offset);
+    if (high_clear | high_toggle)
+        bitset_update_word(UNIVERSAL_BITSET(view), index + 1u, high_clear, high_toggle);
+}
+
+/**
+ * Retrieves the value of a bit of the view
+ * @memberof BitSetView
+ * @param view Pointer to view to read
+ * @param index The index of the bit to read (bit index within the view)
+ * @return The value of the bit at the specified index
+ */
+BITSET_API bool bitset_view_get(const BitSetView* const view, const uint64_t index)
+{
+    return bitset_get(UNIVERSAL_BITSET(view), view->offset + index);
+}
+
+/**
+ * Sets the value of a bit of the view
+ * @memberof BitSetView
+ * @param view Pointer to view to modify
+ * @param value The value to set the bit to
+ * @param index The index of the bit to modify (bit index within the view)
+ */
+BITSET_API void bitset_view_set_value(BitSetView* const view, const bool value, const uint64_t index)
+{
+    bitset_set_value(UNIVERSAL_BITSET(view), value, view->offset + index);
+}
+
+/**
+ * Fills all the bits of the view with the specified value (the range fill of the blocks, memset in between)
+ * @memberof BitSetView
+ * @param view Pointer to view to modify
+ * @param value Value to fill the bits with (bit value)
+ */
+BITSET_API void bitset_view_fill(BitSetView* const view, const bool value)
+{
+    bitset_fill_in_range_begin_end(UNIVERSAL_BITSET(view), value, view->offset, view->offset + view->size);
+}
+
+/**
+ * Flips all the bits of the view
+ * @memberof BitSetView
+ * @param view Pointer to view to modify
+ */
+BITSET_API void bitset_view_flip(BitSetView* const view)
+{
+    bitset_flip_in_range_begin_end(UNIVERSAL_BITSET(view), view->offset, view->offset + view->size);
+}
+
+/**
+ * Counts the set bits of the view (the range count of the blocks, vectorized popcount in between)
+ * @memberof BitSetView
+ * @param view Pointer to view to check
+ * @return The number of bits set in the view
+ */
+BITSET_API uint64_t bitset_view_count(const BitSetView* const view)
+{
+    return bitset_count_in_range(UNIVERSAL_BITSET(view), view->offset, view->offset + view->size);
+}
+
+/**
+ * Checks if any of the bits of the view are set
+ * @memberof BitSetView
+ * @param view Pointer to view to check
+ * @return True if any of the bits are set, false otherwise
+ */
+BITSET_API bool bitset_view_any(const BitSetView* const view)
+{
+    if (!view->offset)
+        return bitset_any(UNIVERSAL_BITSET(view));
+
+    const uint64_t words = bitset_calculate_word_count(view->size);
+    for (uint64_t i = 0; i < words; ++i)
+    {
+        if (bitset_view_get_word(view, i))
+            return true;
+    }
+    return false;
+}
+
+/**
+ * Checks if all the bits of the view are set
+ * @memberof BitSetView
+ * @param view Pointer to view to check
+ * @return True if all the bits are set, false otherwise
+ */
+BITSET_API bool bitset_view_all(const BitSetView* const view)
+{
+    if (!view->offset)
+        return bitset_all(UNIVERSAL_BITSET(view));
+
+    const uint64_t words = bitset_calculate_word_count(view->size);
+    for (uint64_t i = 0; i < words; ++i)
+    {
+        const uint64_t mask = i == words - 1u && view->size % 64u ? UINT64_MAX >> (64u - view->size % 64u) : UINT64_MAX;
+        if (bitset_view_get_word(view, i) != mask)
+            return false;
+    }
+    return true;
+}
+
+/**
+ * Checks if none of the bits of the view are set
+ * @memberof BitSetView
+ * @param view Pointer to view to check
+ * @return True if none of the bits are set, false otherwise
+ */
+BITSET_API bool bitset_view_none(const BitSetView* const view)
+{
+    return !bitset_view_any(view);
+}
+
+/**
+ * Finds the first bit of the view with the specified value at or after the specified index
+ * @memberof BitSetView
+ * @param view Pointer to view to search
+ * @param value The value of the bit to find
+ * @param begin Index to start the search from (bit index within the view)
+ * @return Index of the found bit (within the view), BITSET_NPOS if there is none
+ */
+BITSET_API uint64_t bitset_view_find_next_value(const BitSetView* const view, const bool value, const uint64_t begin)
+{
+    if (!view->offset)
+        return bitset_find_next_value(UNIVERSAL_BITSET(view), value, begin);
+    if (begin >= view->size)
+        return BITSET_NPOS;
+
+    const uint64_t words = bitset_calculate_word_count(view->size);
+    const uint64_t invert = value ? 0u : UINT64_MAX;
+    uint64_t index = begin / 64u;
+    uint64_t word = (bitset_view_get_word(view, index) ^ invert) & (UINT64_MAX << begin % 64u);
+    while (!word)
+    {
+        if (++index >= words)
+            return BITSET_NPOS;
+        word = bitset_view_get_word(view, index) ^ invert;
+    }
+    // unset matches past the size are the bits read as 0
+    index = index * 64u + bitset_ctz64(word);
+    return index < view->size ? index : BITSET_NPOS;
+}
+
+/**
+ * @memberof BitSetView
+ * @param view Pointer to view to search
+ * @return Index of the first set bit of the view, BITSET_NPOS if there is none
+ */
+BITSET_API uint64_t bitset_view_find_first(const BitSetView* const view)
+{
+    return bitset_view_find_next_value(view, true, 0);
+}
+
+/**
+ * @memberof BitSetView
+ * @param view Pointer to view to search
+ * @param index Index to search after, exclusive (bit index within the view)
+ * @return Index of the first set bit of the view after index, BITSET_NPOS if there is none
+ */
+BITSET_API uint64_t bitset_view_find_next(const BitSetView* const view, const uint64_t index)
+{
+    return index == BITSET_NPOS ? BITSET_NPOS : bitset_view_find_next_value(view, true, index + 1u);
+}
+
+/**
+ * Calls the callback with the index (within the view) of every set bit of the view, in increasing order
+ * @memberof BitSetView
+ * @param view Pointer to view to iterate
+ * @param callback The function to call
+ * @param context The pointer passed to the callback
+ */
+BITSET_API void bitset_view_for_each_set_bit(const BitSetView* const view, const bitset_index_callback callback, void* const context)
+{
+    if (!view->offset)
+    {
+        bitset_for_each_set_bit(UNIVERSAL_BITSET(view), callback, context);
+        return;
+    }
+
+    const uint64_t words = bitset_calculate_word_count(view->size);
+    for (uint64_t index = 0; index < words; ++index)
+    {
+        for (uint64_t word = bitset_view_get_word(view, index); word; word &= word - 1u)
+            callback(index * 64u + bitset_ctz64(word), context);
+    }
+}
+
+/**
+ * Computes destination = left op right over the first destination->size bits of the views
+ * Both operands have to hold at least destination->size bits, block aligned views use bitset_binary_operation
+ * destination may be the same view as left or right, otherwise it must not overlap them
+ * @memberof BitSetView
+ * @param destination Pointer to view to store the result to
+ * @param left Pointer to the left operand
+ * @param right Pointer to the right operand
+ * @param operation The operation to apply
+ */
+BITSET_API void bitset_view_binary_operation(BitSetView* const destination, const BitSetView* const left, const BitSetView* const right, const bitset_operation operation)
+{
+    if (!destination->offset && !left->offset && !right->offset)
+    {
+        bitset_binary_operation(UNIVERSAL_BITSET(destination), UNIVERSAL_BITSET(left), UNIVERSAL_BITSET(right), operation);
+        return;
+    }
+
+    const uint64_t words = bitset_calculate_word_count(destination->size);
+    for (uint64_t i = 0; i < words; ++i)
+    {
+        const uint64_t mask = i == words - 1u && destination->size % 64u ? UINT64_MAX >> (64u - destination->size % 64u) : UINT64_MAX;
+        const uint64_t word = bitset_apply_operation64(bitset_view_get_word(left, i), bitset_view_get_word(right, i), operation);
+        bitset_view_update_word(destination, i, mask, word & mask);
+    }
+}
+
+/**
+ * Counts the set bits of left op right over the first left->size bits of the views, without storing the result
+ * right has to hold at least left->size bits, block aligned views use bitset_binary_count
+ * @memberof BitSetView
+ * @param left Pointer to the left operand
+ * @param right Pointer to the right operand
+ * @param operation The operation to apply
+ * @return The number of set bits of the result
+ */
+BITSET_API uint64_t bitset_view_binary_count(const BitSetView* const left, const BitSetView* const right, const bitset_operation operation)
+{
+    if (!left->offset && !right->offset)
+        return bitset_binary_count(UNIVERSAL_BITSET(left), UNIVERSAL_BITSET(right), operation);
+
+    const uint64_t words = bitset_calculate_word_count(left->size);
+    uint64_t count = 0;
+    for (uint64_t i = 0; i < words; ++i)
+    {
+        const uint64_t mask = i == words - 1u && left->size % 64u ? UINT64_MAX >> (64u - left->size % 64u) : UINT64_MAX;
+        count += bitset_popcount64(bitset_apply_operation64(bitset_view_get_word(left, i), bitset_view_get_word(right, i), operation) & mask);
+    }
+    return count;
+}
+
+/**
+ * Copies the first destination->size bits of source into destination
+ * source has to hold at least destination->size bits and must not overlap destination (unless it is the same view)
+ * @memberof BitSetView
+ * @param destination Pointer to view to store the bits to
+ * @param source Pointer to view to copy from
+ */
+BITSET_API void bitset_view_copy(BitSetView* const destination, const BitSetView* const source)
+{
+    bitset_view_binary_operation(destination, source, source, BITSET_OPERATION_OR);
+}
+
+/**
+ * Counts the set bits using all the threads (see bitset_count)
+ * @memberof BitSet
+ * @param bitset Pointer to bitset to check
+ * @return the number of bits set in the bitset
+ */
+BITSET_API uint64_t bitset_parallel_count(const BitSet* const bitset)
+{
+    const uint64_t full_blocks = bitset->size / BITSET_BLOCK_BITS;
+    uint64_t count = bitset_parallel_popcount_bytes((const uint8_t*)bitset->data, full_blocks * sizeof(bitset_block_t));
+    // bits past the end of the bitset are not counted
+    if (bitset->size % BITSET_BLOCK_BITS)
+        count += bitset_popcount64(*(bitset->data + full_blocks) & bitset_create_mask_to(bitset->size % BITSET_BLOCK_BITS));
+    return count;
+}
+
+/**
+ * Fills all the bits with the specified value using all the threads (see bitset_fill_all)
+ * @memberof BitSet
+ * @param bitset Pointer to bitset to modify
+ * @param value Value to fill the bits with (bit value)
+ */
+BITSET_API void bitset_parallel_fill_all(BitSet* const bitset, const bool value)
+{
+    bitset_parallel_fill_bytes((uint8_t*)bitset->data, value ? 255u : 0u, bitset->storage_size * sizeof(bitset_block_t));
+}
+
+/**
+ * Fills all the bits in the specified range with the specified value using all the threads (see bitset_fill_in_range_begin_end)
+ * @memberof BitSet
+ * @param bitset Pointer to bitset to modify
+ * @param value Value to fill the bits with (bit value)
+ * @param begin Begin of the range to fill (bit index)
+ * @param end End of the range to fill (bit index)
+ */
+BITSET_API void bitset_parallel_fill_in_range_begin_end(BitSet* const bitset, const bool value, const uint64_t begin, const uint64_t end)
+{
+    if (begin >= end)
+        return;
+
+    // only the whole blocks are filled in parallel, the partial ones at the edges are masked on this thread
+    const uint64_t first = (begin + BITSET_BLOCK_BITS - 1u) / BITSET_BLOCK_BITS, last = end / BITSET_BLOCK_BITS;
+    if (first >= last)
+    {
+        bitset_fill_in_range_begin_end(bitset, value, begin, end);
+        return;
+    }
+    bitset_fill_in_range_begin_end(bitset, value, begin, first * BITSET_BLOCK_BITS);
+    bitset_parallel_fill_bytes((uint8_t*)(bitset->data + first), value ? 255u : 0u, (last - first) * sizeof(bitset_block_t));
+    bitset_fill_in_range_begin_end(bitset, value, last * BITSET_BLOCK_BITS, end);
+}
+
+/**
+ * Flips all the bits using all the threads (see bitset_flip_all)
+ * @memberof BitSet
+ * @param bitset Pointer to bitset to modify
+ */
+BITSET_API void bitset_parallel_flip_all(BitSet* const bitset)
+{
+    bitset_parallel_flip_bytes((uint8_t*)bitset->data, bitset->storage_size * sizeof(bitset_block_t));
+}
+
+/**
+ * Computes destination = left op right using all the threads (see bitset_binary_operation)
+ * @memberof BitSet
+ * @param destination Pointer to bitset to store the result to
+ * @param left Pointer to the left operand
+ * @param right Pointer to the right operand
+ * @param operation The operation to apply
+ */
+BITSET_API void bitset_parallel_binary_operation(BitSet* const destination, const BitSet* const left, const BitSet* const right, const bitset_operation operation)
+{
+    const uint64_t full_blocks = destination->size / BITSET_BLOCK_BITS;
+    bitset_parallel_binary_bytes((uint8_t*)destination->data, (const uint8_t*)left->data, (const uint8_t*)right->data, full_blocks * sizeof(bitset_block_t), operation);
+    if (destination->size % BITSET_BLOCK_BITS)
+    {
+        const bitset_block_t tail_mask = bitset_create_mask_to(destination->size % BITSET_BLOCK_BITS);
+        const bitset_block_t result = bitset_apply_operation(*(left->data + full_blocks), *(right->data + full_blocks), operation);
+        *(destination->data + full_blocks) = (*(destination->data + full_blocks) & ~tail_mask) | (result & tail_mask);
+    }
+}
+
+/**
+ * Counts the set bits of left op right using all the threads, without storing the result (see bitset_binary_count)
+ * @memberof BitSet
+ * @param left Pointer to the left operand
+ * @param right Pointer to the right operand
+ * @param operation The operation to apply
+ * @return The number of set bits of the result
+ */
+BITSET_API uint64_t bitset_parallel_binary_count(const BitSet* const left, const BitSet* const right, const bitset_operation operation)
+{
+    const uint64_t full_blocks = left->size / BITSET_BLOCK_BITS;
+    uint64_t count = bitset_parallel_binary_count_bytes((const uint8_t*)left->data, (const uint8_t*)right->data, full_blocks * sizeof(bitset_block_t), operation);
+    if (left->size % BITSET_BLOCK_BITS)
+        count += bitset_popcount64(bitset_apply_operation(*(left->data + full_blocks), *(right->data + full_blocks), operation) & bitset_create_mask_to(left->size % BITSET_BLOCK_BITS));
+    return count;
+}
+
+/**
+ * Finds the first bit with the specified value at or after the specified index using all the threads (see bitset_find_next_value)
+ * @memberof BitSet
+ * @param bitset Pointer to bitset to search
+ * @param value The value of the bit to find
+ * @param begin Index to start the search from (bit index)
+ * @return Index of the found bit, BITSET_NPOS if there is none
+ */
+BITSET_API uint64_t bitset_parallel_find_next_value(const BitSet* const bitset, const bool value, const uint64_t begin)
+{
+    if (begin >= bitset->size)
+        return BITSET_NPOS;
+
+    // the block holding begin is checked on this thread
+    const uint64_t first = begin / BITSET_BLOCK_BITS;
+    const bitset_block_t block = (bitset_block_t)((value ? *(bitset->data + first) : ~*(bitset->data + first)) & bitset_create_mask_from(begin % BITSET_BLOCK_BITS));
+    if (block)
+    {
+        const uint64_t index = first * BITSET_BLOCK_BITS + bitset_ctz64(block);
+        return index < bitset->size ? index : BITSET_NPOS;
+    }
+    if (first + 1u >= bitset->storage_size)
+        return BITSET_NPOS;
+
+    // any block with a byte other than the skipped one holds a match
+    const uint64_t bytes = (bitset->storage_size - first - 1u) * sizeof(bitset_block_t);
+    const uint64_t offset = bitset_parallel_find_byte_not((const uint8_t*)(bitset->data + first + 1u), bytes, value ? 0u : 255u);
+    if (offset == bytes)
+        return BITSET_NPOS;
+    return bitset_find_next_value(bitset, value, (first + 1u + offset / sizeof(bitset_block_t)) * BITSET_BLOCK_BITS);
+}
+
+/**
+ * Check if bitset is empty
+ * @param bitset Pointer to bitset to check
+ * @return True if the bitset is empty, false otherwise
+ * @memberof BitSet
+*/
+BITSET_API bool bitset_empty(const BitSet* const bitset)
+{
+    return !bitset->size;
+}
+
+/**
+ * Ensures the bitset can hold at least the specified number of blocks without reallocating
+ * @memberof DynamicBitSet
+ * @param bitset Pointer to bitset to modify
+ * @param capacity The number of blocks to reserve (block size)
+ */
+BITSET_API void bitset_dynamic_reserve(DynamicBitSet* const bitset, const uint64_t capacity)
+{
+    if (capacity <= bitset->capacity)
+        return;
+
+    bitset_block_t* const new_data = (bitset_block_t*)bitset_reallocate(bitset->allocator, bitset->data, bitset->capacity * sizeof(bitset_block_t), capacity * sizeof(bitset_block_t));
+    if (!new_data)
+        return; // the old buffer is kept, throw exception in safe version
+    BITSET_STATS_REALLOCATION(BITSET_STATS_RESIZE, bitset->capacity * sizeof(bitset_block_t), capacity * sizeof(bitset_block_t));
+    bitset->data = new_data;
+    bitset->capacity = capacity;
+}
+
+/**
+ * Releases the reserved blocks past storage_size
+ * @memberof DynamicBitSet
+ * @param bitset Pointer to bitset to modify
+ */
+BITSET_API void bitset_dynamic_shrink_to_fit(DynamicBitSet* const bitset)
+{
+    if (bitset->capacity == bitset->storage_size)
+        return;
+    BITSET_STATS_RECORD(BITSET_STATS_RESIZE, 0u, 0u);
+
+    if (!bitset->storage_size)
+    {
+        bitset_deallocate(bitset->allocator, bitset->data, bitset->capacity * sizeof(bitset_block_t));
+        bitset->data = NULL;
+        bitset->capacity = 0;
+        return;
+    }
+
+    bitset_block_t* const new_data = (bitset_block_t*)bitset_reallocate(bitset->allocator, bitset->data, bitset->capacity * sizeof(bitset_block_t), bitset->storage_size * sizeof(bitset_block_t));
+    if (!new_data)
+        return; // the old (larger) buffer is still valid
+    BITSET_STATS_REALLOCATION(BITSET_STATS_RESIZE, bitset->capacity * sizeof(bitset_block_t), bitset->storage_size * sizeof(bitset_block_t));
+    bitset->data = new_data;
+    bitset->capacity = bitset->storage_size;
+}
+
+/**
+ * Grows the capacity geometrically so that one more block fits (amortized O(1) appends)
+ * @memberof DynamicBitSet
+ * @param bitset Pointer to bitset to modify
+ */
+BITSET_API void bitset_dynamic_grow(DynamicBitSet* const bitset)
+{
+    if (bitset->storage_size < bitset->capacity)
+        return;
+    bitset_dynamic_reserve(bitset, bitset->capacity ? bitset->capacity * 2u : BITSET_BLOCKS_PER_WORD);
+}
+
+/**
+ * Pushes back a bit to the bitset
+ * @param bitset Pointer to bitset to modify
+ * @param value Value of the bit to append (bit value)
+ * @memberof DynamicBitSet
+ */
+BITSET_API void bitset_dynamic_push_back(DynamicBitSet* const bitset, const bool value)
+{
+    BITSET_STATS_RECORD(BITSET_STATS_RESIZE, 1u, sizeof(bitset_block_t));
+	if (bitset->size % BITSET_BLOCK_BITS)
+	{
+		if (value)
+			*(bitset->data + bitset->size / BITSET_BLOCK_BITS) |= (bitset_block_t)1u << bitset->size % BITSET_BLOCK_BITS;
+		else
+			*(bitset->data + bitset->size / BITSET_BLOCK_BITS) &= ~((bitset_block_t)1u << bitset->size % BITSET_BLOCK_BITS);
+	}
+	else
+	{
+		bitset_dynamic_grow(bitset);
+		if (bitset->storage_size >= bitset->capacity)
+			return; // the bitset is left unchanged, throw exception in safe version
+		*(bitset->data + bitset->storage_size++) = value ? 1u : 0u;
+	}
+	++bitset->size;
+}
+
+/**
+ * Removes the last bit from the bitset (the memory is kept, see bitset_dynamic_shrink_to_fit)
+ * @param bitset Pointer to bitset to modify
+ * @memberof DynamicBitSet
+ */
+BITSET_API void bitset_dynamic_pop_back(DynamicBitSet* const bitset)
+{
+    BITSET_STATS_RECORD(BITSET_STATS_RESIZE, 1u, 0u);
+    if (bitset->size)
+    {
+        --bitset->size;
+        // the last block became unused
+        if (!(bitset->size % BITSET_BLOCK_BITS))
+            --bitset->storage_size;
+    }
+    // else throw exception in safe version
+}
+
+/**
+ * Pushes back a block to the bitset, adjusting the size to the nearest multiple of BITSET_BLOCK_BITS upwards. [e.g. for uint8_t blocks: 65 bits -> (+8 {block} +7 {expanded area} = +15) -> 80 bits]
+ * The bits in the expanded area may be initialized by previous calls, but their values are not explicitly defined by this function.
+ * @memberof DynamicBitSet
+ * @param bitset Pointer to bitset to modify
+ * @param block The block to push back (block value)
+ */
+BITSET_API void bitset_dynamic_push_back_block(DynamicBitSet* const bitset, const bitset_block_t block)
+{
+    BITSET_STATS_RECORD(BITSET_STATS_RESIZE, BITSET_BLOCK_BITS, sizeof(bitset_block_t));
+    bitset_dynamic_grow(bitset);
+    if (bitset->storage_size >= bitset->capacity)
+        return; // the bitset is left unchanged, throw exception in safe version
+    *(bitset->data + bitset->storage_size++) = block;
+    bitset->size = bitset->storage_size * BITSET_BLOCK_BITS;
+}
+
+/**
+ * Removes the last block from the bitset, adjusting the size to the nearest lower multiple of BITSET_BLOCK_BITS. [e.g. for uint8_t blocks: 65 bits -> 64 bits -> 56 bits]
+ * The memory is kept, see bitset_dynamic_shrink_to_fit
+ * @memberof DynamicBitSet
+ * @param bitset Pointer to bitset to modify
+ */
+BITSET_API void bitset_dynamic_pop_back_block(DynamicBitSet* const bitset)
+{
+    BITSET_STATS_RECORD(BITSET_STATS_RESIZE, BITSET_BLOCK_BITS, 0u);
+	if (bitset->storage_size)
+	{
+		--bitset->storage_size;
+		bitset->size = bitset->storage_size * BITSET_BLOCK_BITS;
+	}
+	// else throw exception in safe version
+}
+
+/**
+ * Resizes the bitset to the specified size, reallocating only if the capacity is exceeded (the new bits are cleared)
+ * @memberof DynamicBitSet
+ * @param bitset Pointer to bitset to resize
+ * @param new_size The new size of the bitset (bit size)
+ */
+BITSET_API void bitset_dynamic_resize(DynamicBitSet* const bitset, const uint64_t new_size)
+{
+    bitset_dynamic_resize_value(bitset, new_size, false);
+}
+
+/**
+ * Resizes the bitset to the specified size, filling the new bits with the specified value
+ * Grows in place within the capacity (realloc past it), only the newly exposed bits are written and shrinking never copies
+ * @memberof DynamicBitSet
+ * @param bitset Pointer to bitset to resize
+ * @param new_size The new size of the bitset (bit size)
+ * @param value The value of the new bits (bit value)
+ */
+BITSET_API void bitset_dynamic_resize_value(DynamicBitSet* const bitset, const uint64_t new_size, const bool value)
+{
+	if (new_size == bitset->size)
+		return;
+	BITSET_STATS_RECORD(BITSET_STATS_RESIZE, new_size > bitset->size ? new_size - bitset->size : bitset->size - new_size, 0u);
+
+	const uint64_t new_storage_size = bitset_calculate_storage_size(new_size);
+	if (new_size > bitset->size)
+	{
+		bitset_dynamic_reserve(bitset, new_storage_size);
+		if (bitset->capacity < new_storage_size)
+			return; // the bitset is left unchanged, throw exception in safe version
+
+		const bitset_block_t fill = bitset_create_filled_block(value);
+		// the bits past the old size in its last block may hold stale values (e.g. after pop_back)
+		if (bitset->size % BITSET_BLOCK_BITS)
+		{
+			const bitset_block_t mask = (bitset_block_t)(BITSET_BLOCK_MAX << bitset->size % BITSET_BLOCK_BITS);
+			*(bitset->data + bitset->storage_size - 1u) = (*(bitset->data + bitset->storage_size - 1u) & ~mask) | (fill & mask);
+		}
+		if (new_storage_size > bitset->storage_size)
+			memset(bitset->data + bitset->storage_size, value ? 255 : 0, (new_storage_size - bitset->storage_size) * sizeof(bitset_block_t));
+	}
+	bitset->storage_size = new_storage_size;
+	bitset->size = new_size;
+}
+
+/**
+ * Calculates the number of blocks required to store the bitset
+ * @memberof BitSet
+ * @param size The size of the bitset
+ * @return The number of blocks required to store the bitset
+ */
+BITSET_API uint64_t bitset_calculate_storage_size(const uint64_t size)
+{
+    return size / BITSET_BLOCK_BITS + (size % BITSET_BLOCK_BITS ? 1 : 0);
+}
+
+/**
+ * Creates a block of type bitset_block_t based on the given boolean value.
+ *
+ * @param value A boolean value indicating whether to create the block with the maximum value or zero.
+ * @return The created block of type bitset_block_t. If value is true, returns the maximum value representable by type bitset_block_t (BITSET_BLOCK_MAX),
+ *         otherwise returns zero.
+ */
+BITSET_API bitset_block_t bitset_create_filled_block(const bool value)
+{
+    return value ? BITSET_BLOCK_MAX : 0u;
+}
+
+/**
+ * Creates a block with all of the bits from the given bit upwards set
+ * @param bit Index of the lowest set bit, in range [0, BITSET_BLOCK_BITS) (bit index within block)
+ * @return The created mask, e.g. for uint8_t blocks and bit 3: 0b11111000
+ */
+BITSET_API bitset_block_t bitset_create_mask_from(const uint64_t bit)
+{
+    return (bitset_block_t)(BITSET_BLOCK_MAX << bit);
+}
+
+/**
+ * Creates a block with all of the bits below the given bit set
+ * @param bit Number of low bits to set, in range [0, BITSET_BLOCK_BITS] (bit index within block)
+ * @return The created mask, e.g. for uint8_t blocks and bit 3: 0b00000111
+ */
+BITSET_API bitset_block_t bitset_create_mask_to(const uint64_t bit)
+{
+    return bit ? (bitset_block_t)(BITSET_BLOCK_MAX >> (BITSET_BLOCK_BITS - bit)) : 0u;
+}
+
+#ifdef BITSET_ATOMICS
+/**
+ * Size initialization, all of the bits are cleared
+ * @memberof AtomicBitSet
+ * @param bitset Pointer to bitset to initialize (data is NULL and the size is 0 if the memory could not be allocated)
+ * @param size The size of the bitset to be initialized (bit size)
+ */
+BITSET_API void bitset_atomic_init(AtomicBitSet* const bitset, const uint64_t size)
+{
+    bitset->size = size;
+    bitset->storage_size = bitset_calculate_word_count(size);
+    bitset->data = (_Atomic uint64_t*)malloc(bitset->storage_size * sizeof(_Atomic uint64_t));
+    if (!bitset->data)
+    {
+        bitset->size = bitset->storage_size = 0; // the bitset is left empty, throw exception in safe version
+        return;
+    }
+    for (uint64_t i = 0; i < bitset->storage_size; ++i)
+        atomic_init(bitset->data + i, 0u);
+}
+
+/**
+ * Destroys the bitset (frees the memory), no other thread may access it anymore
+ * @memberof AtomicBitSet
+ * @param bitset Pointer to bitset to destroy
+ */
+BITSET_API void bitset_atomic_destroy(AtomicBitSet* const bitset)
+{
+    free((void*)bitset->data);
+}
+
+/**
+ * Retrieves the value of a bit at a specified index
+ * @memberof AtomicBitSet
+ * @param bitset Pointer to bitset to read from
+ * @param index The index of the bit to read (bit index)
+ * @param order Memory order of the load (memory_order_relaxed, memory_order_acquire, ...)
+ * @return The value of the bit at the specified index
+ */
+BITSET_API bool bitset_atomic_get(const AtomicBitSet* const bitset, const uint64_t index, const memory_order order)
+{
+    return (atomic_load_explicit(bitset->data + index / 64u, order) >> index % 64u) & 1u;
+}
+
+/**
+ * Sets the bit at the specified index to 1 (true)
+ * @memberof AtomicBitSet
+ * @param bitset Pointer to bitset to modify
+ * @param index The index of the bit to set (bit index)
+ * @param order Memory order of the read-modify-write (memory_order_relaxed, memory_order_acq_rel, ...)
+ */
+BITSET_API void bitset_atomic_set(AtomicBitSet* const bitset, const uint64_t index, const memory_order order)
+{
+    atomic_fetch_or_explicit(bitset->data + index / 64u, (uint64_t)1u << index % 64u, order);
+}
+
+/**
+ * Sets the bit at the specified index to 0 (false)
+ * @memberof AtomicBitSet
+ * @param bitset Pointer to bitset to modify
+ * @param index The index of the bit to clear (bit index)
+ * @param order Memory order of the read-modify-write
+ */
+BITSET_API void bitset_atomic_clear(AtomicBitSet* const bitset, const uint64_t index, const memory_order order)
+{
+    atomic_fetch_and_explicit(bitset->data + index / 64u, ~((uint64_t)1u << index % 64u), order);
+}
+
+/**
+ * Flips the bit at the specified index
+ * @memberof AtomicBitSet
+ * @param bitset Pointer to bitset to modify
+ * @param index The index of the bit to flip (bit index)
+ * @param order Memory order of the read-modify-write
+ */
+BITSET_API void bitset_atomic_flip(AtomicBitSet* const bitset, const uint64_t index, const memory_order order)
+{
+    atomic_fetch_xor_explicit(bitset->data + index / 64u, (uint64_t)1u << index % 64u, order);
+}
+
+/**
+ * Sets the bit at the specified index and returns its previous value, e.g. to claim a vertex in a parallel traversal
+ * @memberof AtomicBitSet
+ * @param bitset Pointer to bitset to modify
+ * @param index The index of the bit to set (bit index)
+ * @param order Memory order of the read-modify-write
+ * @return True if the bit was already set (another thread claimed it), false if this call set it
+ */
+BITSET_API bool bitset_atomic_test_and_set(AtomicBitSet* const bitset, const uint64_t index, const memory_order order)
+{
+    const uint64_t mask = (uint64_t)1u << index % 64u;
+    return (atomic_fetch_or_explicit(bitset->data + index / 64u, mask, order) & mask) != 0;
+}
+
+/**
+ * Clears the bit at the specified index and returns its previous value
+ * @memberof AtomicBitSet
+ * @param bitset Pointer to bitset to modify
+ * @param index The index of the bit to clear (bit index)
+ * @param order Memory order of the read-modify-write
+ * @return The previous value of the bit
+ */
+BITSET_API bool bitset_atomic_test_and_clear(AtomicBitSet* const bitset, const uint64_t index, const memory_order order)
+{
+    const uint64_t mask = (uint64_t)1u << index % 64u;
+    return (atomic_fetch_and_explicit(bitset->data + index / 64u, ~mask, order) & mask) != 0;
+}
+
+/**
+ * Flips the bit at the specified index and returns its previous value
+ * @memberof AtomicBitSet
+ * @param bitset Pointer to bitset to modify
+ * @param index The index of the bit to flip (bit index)
+ * @param order Memory order of the read-modify-write
+ * @return The previous value of the bit
+ */
+BITSET_API bool bitset_atomic_test_and_flip(AtomicBitSet* const bitset, const uint64_t index, const memory_order order)
+{
+    const uint64_t mask = (uint64_t)1u << index % 64u;
+    return (atomic_fetch_xor_explicit(bitset->data + index / 64u, mask, order) & mask) != 0;
+}
+
+/**
+ * Retrieves the block at the specified index
+ * @memberof AtomicBitSet
+ * @param bitset Pointer to bitset to read from
+ * @param index Index of the block to read (block index)
+ * @param order Memory order of the load
+ * @return The block at the specified index
+ */
+BITSET_API uint64_t bitset_atomic_load_block(const AtomicBitSet* const bitset, const uint64_t index, const memory_order order)
+{
+    return atomic_load_explicit(bitset->data + index, order);
+}
+
+/**
+ * Sets the block at the specified index to the specified value
+ * @memberof AtomicBitSet
+ * @param bitset Pointer to bitset to modify
+ * @param block The block to set (block value)
+ * @param index Index of the block to set (block index)
+ * @param order Memory order of the store (memory_order_relaxed, memory_order_release, ...)
+ */
+BITSET_API void bitset_atomic_store_block(AtomicBitSet* const bitset, const uint64_t block, const uint64_t index, const memory_order order)
+{
+    atomic_store_explicit(bitset->data + index, block, order);
+}
+
+/**
+ * Sets all the bits of mask in the block at the specified index (block |= mask)
+ * @memberof AtomicBitSet
+ * @param bitset Pointer to bitset to modify
+ * @param mask Bits to set (block value)
+ * @param index Index of the block to modify (block index)
+ * @param order Memory order of the read-modify-write
+ * @return The previous value of the block (previous & mask are the bits set by other threads before)
+ */
+BITSET_API uint64_t bitset_atomic_fetch_or_block(AtomicBitSet* const bitset, const uint64_t mask, const uint64_t index, const memory_order order)
+{
+    return atomic_fetch_or_explicit(bitset->data + index, mask, order);
+}
+
+/**
+ * Keeps only the bits of mask in the block at the specified index (block &= mask)
+ * @memberof AtomicBitSet
+ * @param bitset Pointer to bitset to modify
+ * @param mask Bits to keep (block value)
+ * @param index Index of the block to modify (block index)
+ * @param order Memory order of the read-modify-write
+ * @return The previous value of the block
+ */
+BITSET_API uint64_t bitset_atomic_fetch_and_block(AtomicBitSet* const bitset, const uint64_t mask, const uint64_t index, const memory_order order)
+{
+    return atomic_fetch_and_explicit(bitset->data + index, mask, order);
+}
+
+/**
+ * Flips the bits of mask in the block at the specified index (block ^= mask)
+ * @memberof AtomicBitSet
+ * @param bitset Pointer to bitset to modify
+ * @param mask Bits to flip (block value)
+ * @param index Index of the block to modify (block index)
+ * @param order Memory order of the read-modify-write
+ * @return The previous value of the block
+ */
+BITSET_API uint64_t bitset_atomic_fetch_xor_block(AtomicBitSet* const bitset, const uint64_t mask, const uint64_t index, const memory_order order)
+{
+    return atomic_fetch_xor_explicit(bitset->data + index, mask, order);
+}
+
+/**
+ * Sets the bits at the specified indices to 1 (true)
+ * Consecutive indices landing in the same block are merged into a single fetch_or, so sorted batches need one read-modify-write per block
+ * @memberof AtomicBitSet
+ * @param bitset Pointer to bitset to modify
+ * @param indices The indices of the bits to set (bit index)
+ * @param count Number of indices
+ * @param order Memory order of every read-modify-write
+ */
+BITSET_API void bitset_atomic_set_many(AtomicBitSet* const bitset, const uint64_t* const indices, const uint64_t count, const memory_order order)
+{
+    for (uint64_t i = 0; i < count;)
+    {
+        const uint64_t block = *(indices + i) / 64u;
+        uint64_t mask = 0;
+        for (; i < count && *(indices + i) / 64u == block; ++i)
+            mask |= (uint64_t)1u << *(indices + i) % 64u;
+        if (i + BITSET_PREFETCH_DISTANCE < count)
+            BITSET_PREFETCH(bitset->data + *(indices + i + BITSET_PREFETCH_DISTANCE) / 64u, 1);
+        atomic_fetch_or_explicit(bitset->data + block, mask, order);
+    }
+}
+
+/**
+ * Sets the bits at the specified indices to 0 (false), merging consecutive indices of a block into a single fetch_and
+ * @memberof AtomicBitSet
+ * @param bitset Pointer to bitset to modify
+ * @param indices The indices of the bits to clear (bit index)
+ * @param count Number of indices
+ * @param order Memory order of every read-modify-write
+ */
+BITSET_API void bitset_atomic_clear_many(AtomicBitSet* const bitset, const uint64_t* const indices, const uint64_t count, const memory_order order)
+{
+    for (uint64_t i = 0; i < count;)
+    {
+        const uint64_t block = *(indices + i) / 64u;
+        uint64_t mask = 0;
+        for (; i < count && *(indices + i) / 64u == block; ++i)
+            mask |= (uint64_t)1u << *(indices + i) % 64u;
+        if (i + BITSET_PREFETCH_DISTANCE < count)
+            BITSET_PREFETCH(bitset->data + *(indices + i + BITSET_PREFETCH_DISTANCE) / 64u, 1);
+        atomic_fetch_and_explicit(bitset->data + block, ~mask, order);
+    }
+}
+
+/**
+ * Flips the bits at the specified indices, merging consecutive indices of a block into a single fetch_xor
+ * An index present twice is flipped twice
+ * @memberof AtomicBitSet
+ * @param bitset Pointer to bitset to modify
+ * @param indices The indices of the bits to flip (bit index)
+ * @param count Number of indices
+ * @param order Memory order of every read-modify-write
+ */
+BITSET_API void bitset_atomic_flip_many(AtomicBitSet* const bitset, const uint64_t* const indices, const uint64_t count, const memory_order order)
+{
+    for (uint64_t i = 0; i < count;)
+    {
+        const uint64_t block = *(indices + i) / 64u;
+        uint64_t mask = 0;
+        for (; i < count && *(indices + i) / 64u == block; ++i)
+            mask ^= (uint64_t)1u << *(indices + i) % 64u;
+        if (i + BITSET_PREFETCH_DISTANCE < count)
+            BITSET_PREFETCH(bitset->data + *(indices + i + BITSET_PREFETCH_DISTANCE) / 64u, 1);
+        if (mask)
+            atomic_fetch_xor_explicit(bitset->data + block, mask, order);
+    }
+}
+
+/**
+ * Retrieves the values of the bits at the specified indices, prefetching ahead
+ * @memberof AtomicBitSet
+ * @param bitset Pointer to bitset to read from
+ * @param indices The indices of the bits to read (bit index)
+ * @param count Number of indices
+ * @param values Array receiving the value of every bit (count values)
+ * @param order Memory order of every load
+ */
+BITSET_API void bitset_atomic_get_many(const AtomicBitSet* const bitset, const uint64_t* const indices, const uint64_t count, bool* const values, const memory_order order)
+{
+    for (uint64_t i = 0; i < count; ++i)
+    {
+        if (i + BITSET_PREFETCH_DISTANCE < count)
+            BITSET_PREFETCH(bitset->data + *(indices + i + BITSET_PREFETCH_DISTANCE) / 64u, 0);
+        *(values + i) = (atomic_load_explicit(bitset->data + *(indices + i) / 64u, order) >> *(indices + i) % 64u) & 1u;
+    }
+}
+
+/**
+ * Fills all the bits with the specified value (relaxed stores, publish with a release fence or a synchronizing operation)
+ * @memberof AtomicBitSet
+ * @param bitset Pointer to bitset to modify
+ * @param value Value to fill the bits with (bit value)
+ */
+BITSET_API void bitset_atomic_fill_all(AtomicBitSet* const bitset, const bool value)
+{
+    for (uint64_t i = 0; i < bitset->storage_size; ++i)
+        atomic_store_explicit(bitset->data + i, value ? UINT64_MAX : 0u, memory_order_relaxed);
+}
+
+/**
+ * Counts the set bits with the non-atomic popcount kernels
+ * Only call it while no thread is modifying the bitset (e.g. after joining the writers), the result is undefined otherwise
+ * @memberof AtomicBitSet
+ * @param bitset Pointer to bitset to check
+ * @return the number of bits set in the bitset
+ */
+BITSET_API uint64_t bitset_atomic_count(const AtomicBitSet* const bitset)
+{
+    const uint64_t full_words = bitset->size / 64u;
+    uint64_t count = bitset_popcount_bytes((const uint8_t*)bitset->data, full_words * sizeof(uint64_t));
+    // bits past the end of the bitset are not counted
+    if (bitset->size % 64u)
+        count += bitset_popcount64(atomic_load_explicit(bitset->data + full_words, memory_order_relaxed) & (UINT64_MAX >> (64u - bitset->size % 64u)));
+    return count;
+}
+
+/**
+ * Finds the first bit with the specified value at or after the specified index
+ * The words are read with relaxed loads (plain loads on x86 and ARM), so concurrent writers are allowed, but the result is not a snapshot
+ * @memberof AtomicBitSet
+ * @param bitset Pointer to bitset to search
+ * @param value The value of the bit to find
+ * @param begin Index to start the search from (bit index)
+ * @return Index of the found bit, BITSET_NPOS if there is none
+ */
+BITSET_API uint64_t bitset_atomic_find_next_value(const AtomicBitSet* const bitset, const bool value, const uint64_t begin)
+{
+    if (begin >= bitset->size)
+        return BITSET_NPOS;
+
+    const uint64_t invert = value ? 0u : UINT64_MAX;
+    uint64_t index = begin / 64u;
+    uint64_t word = (atomic_load_explicit(bitset->data + index, memory_order_relaxed) ^ invert) & (UINT64_MAX << begin % 64u);
+    while (!word)
+    {
+        if (++index >= bitset->storage_size)
+            return BITSET_NPOS;
+        word = atomic_load_explicit(bitset->data + index, memory_order_relaxed) ^ invert;
+    }
+    // matches past the size are bits of the last word that are not part of the bitset
+    index = index * 64u + bitset_ctz64(word);
+    return index < bitset->size ? index : BITSET_NPOS;
+}
+#endif
+
+/**
+ * Calculates the size of a single value, word or run of a container
+ * @param type The representation of the container
+ * @return Size of a single element in bytes
+ */
+BITSET_API uint64_t bitset_container_element_size(const bitset_container_type type)
+{
+    return type == BITSET_CONTAINER_BITMAP ? sizeof(uint64_t) : type == BITSET_CONTAINER_RUN ? 2u * sizeof(uint16_t) : sizeof(uint16_t);
+}
+
+/**
+ * Initializes an empty (array) container
+ * @memberof bitset_container
+ * @param container Pointer to container to initialize
+ * @param key Index of the container (bit index / BITSET_CONTAINER_BITS)
+ */
+BITSET_API void bitset_container_init(bitset_container* const container, const uint32_t key)
+{
+    container->data = NULL;
+    container->key = key;
+    container->cardinality = 0;
+    container->length = 0;
+    container->capacity = 0;
+    container->type = BITSET_CONTAINER_ARRAY;
+}
+
+/**
+ * Destroys the container (frees the memory)
+ * @memberof bitset_container
+ * @param container Pointer to container to destroy
+ */
+BITSET_API void bitset_container_destroy(bitset_container* const container)
+{
+    free(container->data);
+}
+
+/**
+ * Initializes the container with a copy of another one
+ * @memberof bitset_container
+ * @param destination Pointer to container to initialize
+ * @param source Pointer to container to copy
+ */
+BITSET_API void bitset_container_copy(bitset_container* const destination, const bitset_container* const source)
+{
+    *destination = *source;
+    destination->capacity = source->length;
+    destination->data = source->length ? malloc(source->length * bitset_container_element_size(source->type)) : NULL;
+    if (destination->data)
+        memcpy(destination->data, source->data, source->length * bitset_container_element_size(source->type));
+}
+
+/**
+ * Ensures the array or run container can hold at least the specified number of values or runs (grows geometrically)
+ * @memberof bitset_container
+ * @param container Pointer to container to modify
+ * @param capacity The number of values or runs to reserve
+ */
+BITSET_API void bitset_container_reserve(bitset_container* const container, const uint32_t capacity)
+{
+    if (capacity <= container->capacity)
+        return;
+
+    uint32_t new_capacity = container->capacity ? container->capacity * 2u : 4u;
+    if (container->type == BITSET_CONTAINER_ARRAY && new_capacity > BITSET_ARRAY_CONTAINER_MAX)
+        new_capacity = BITSET_ARRAY_CONTAINER_MAX;
+    if (new_capacity < capacity)
+        new_capacity = capacity;
+    void* const new_data = realloc(container->data, new_capacity * bitset_container_element_size(container->type));
+    if (!new_data)
+        return; // the old buffer is kept, throw exception in safe version
+    container->data = new_data;
+    container->capacity = new_capacity;
+}
+
+/**
+ * Replaces the contents of the container (frees the old data, takes ownership of the new one)
+ * @memberof bitset_container
+ * @param container Pointer to container to modify
+ * @param type The new representation
+ * @param data The new values, words or runs (allocated with malloc, may be NULL if length is 0)
+ * @param length Number of values, words or runs
+ * @param capacity Number of allocated values, words or runs
+ * @param cardinality Number of set bits
+ */
+BITSET_API void bitset_container_replace(bitset_container* const container, const bitset_container_type type, void* const data, const uint32_t length, const uint32_t capacity, const uint32_t cardinality)
+{
+    free(container->data);
+    container->data = data;
+    container->type = type;
+    container->length = length;
+    container->capacity = capacity;
+    container->cardinality = cardinality;
+}
+
+/**
+ * Searches the sorted values for the first one not less than value
+ * @param values The sorted values
+ * @param length Number of values
+ * @param value The value to search for
+ * @return Position of the found value, length if all of the values are less
+ */
+BITSET_API uint32_t bitset_container_lower_bound(const uint16_t* const values, const uint32_t length, const uint16_t value)
+{
+    uint32_t low = 0, high = length;
+    while (low < high)
+    {
+        const uint32_t middle = low + (high - low) / 2u;
+        if (*(values + middle) < value)
+            low = middle + 1u;
+        else
+            high = middle;
+    }
+    return low;
+}
+
+/**
+ * Searches the sorted runs for the last one starting at or before value
+ * @param runs The sorted runs (pairs of start and length - 1)
+ * @param length Number of runs
+ * @param value The value to search for
+ * @return Position of the found run, length if all of the runs start after value
+ */
+BITSET_API uint32_t bitset_container_find_run(const uint16_t* const runs, const uint32_t length, const uint16_t value)
+{
+    uint32_t low = 0, high = length;
+    while (low < high)
+    {
+        const uint32_t middle = low + (high - low) / 2u;
+        if (*(runs + 2u * middle) <= value)
+            low = middle + 1u;
+        else
+            high = middle;
+    }
+    return low ? low - 1u : length;
+}
+
+/**
+ * Applies the operation to a word (word op mask)
+ * @param word The word to modify
+ * @param mask The second operand
+ * @param operation The operation to apply
+ * @return The result of the operation
+ */
+BITSET_API uint64_t bitset_container_apply_word(const uint64_t word, const uint64_t mask, const bitset_operation operation)
+{
+    switch (operation)
+    {
+    case BITSET_OPERATION_AND:
+        return word & mask;
+    case BITSET_OPERATION_OR:
+        return word | mask;
+    case BITSET_OPERATION_XOR:
+        return word ^ mask;
+    default:
+        return word & ~mask;
+    }
+}
+
+/**
+ * Sets (OR), clears (ANDNOT) or flips (XOR) the bits [begin, end) of the bitmap words
+ * @param words The words to modify (BITSET_CONTAINER_WORDS of them)
+ * @param begin Index of the first bit to modify (bit index within container)
+ * @param end Index past the last bit to modify, at most BITSET_CONTAINER_BITS (bit index within container)
+ * @param operation BITSET_OPERATION_OR, BITSET_OPERATION_ANDNOT or BITSET_OPERATION_XOR
+ */
+BITSET_API void bitset_container_words_apply(uint64_t* const words, const uint32_t begin, const uint32_t end, const bitset_operation operation)
+{
+    if (begin >= end)
+        return;
+
+    const uint32_t first = begin / 64u, last = (end - 1u) / 64u;
+    if (first == last)
+    {
+        *(words + first) = bitset_container_apply_word(*(words + first), (UINT64_MAX << begin % 64u) & (UINT64_MAX >> (63u - (end - 1u) % 64u)), operation);
+        return;
+    }
+    *(words + first) = bitset_container_apply_word(*(words + first), UINT64_MAX << begin % 64u, operation);
+    for (uint32_t i = first + 1u; i < last; ++i)
+        *(words + i) = bitset_container_apply_word(*(words + i), UINT64_MAX, operation);
+    *(words + last) = bitset_container_apply_word(*(words + last), UINT64_MAX >> (63u - (end - 1u) % 64u), operation);
+}
+
+/**
+ * Counts the set bits [begin, end) of the bitmap words
+ * @param words The words to count the bits of (BITSET_CONTAINER_WORDS of them)
+ * @param begin Index of the first bit to count (bit index within container)
+ * @param end Index past the last bit to count, at most BITSET_CONTAINER_BITS (bit index within container)
+ * @return The number of set bits
+ */
+BITSET_API uint32_t bitset_container_words_count(const uint64_t* const words, const uint32_t begin, const uint32_t end)
+{
+    if (begin >= end)
+        return 0;
+
+    const uint32_t first = begin / 64u, last = (end - 1u) / 64u;
+    const uint64_t last_mask = UINT64_MAX >> (63u - (end - 1u) % 64u);
+    if (first == last)
+        return (uint32_t)bitset_popcount64(*(words + first) & (UINT64_MAX << begin % 64u) & last_mask);
+    uint64_t count = bitset_popcount64(*(words + first) & (UINT64_MAX << begin % 64u));
+    for (uint32_t i = first + 1u; i < last; ++i)
+        count += bitset_popcount64(*(words + i));
+    return (uint32_t)(count + bitset_popcount64(*(words + last) & last_mask));
+}
+
+/**
+ * Counts the runs of set bits of the bitmap words
+ * @param words The words to count the runs of (BITSET_CONTAINER_WORDS of them)
+ * @return The number of runs
+ */
+BITSET_API uint32_t bitset_container_words_count_runs(const uint64_t* const words)
+{
+    // a run starts at every set bit whose lower neighbour is cleared
+    uint64_t runs = 0, carry = 0;
+    for (uint32_t i = 0; i < BITSET_CONTAINER_WORDS; ++i)
+    {
+        const uint64_t word = *(words + i);
+        runs += bitset_popcount64(word & ~(word << 1 | carry));
+        carry = word >> 63;
+    }
+    return (uint32_t)runs;
+}
+
+/**
+ * Expands the container to bitmap words
+ * @memberof bitset_container
+ * @param container Pointer to container to read from
+ * @param words The words to store the bits to (BITSET_CONTAINER_WORDS of them)
+ */
+BITSET_API void bitset_container_to_words(const bitset_container* const container, uint64_t* const words)
+{
+    if (container->type == BITSET_CONTAINER_BITMAP)
+    {
+        memcpy(words, container->data, BITSET_CONTAINER_WORDS * sizeof(uint64_t));
+        return;
+    }
+
+    memset(words, 0, BITSET_CONTAINER_WORDS * sizeof(uint64_t));
+    const uint16_t* const values = (const uint16_t*)container->data;
+    if (container->type == BITSET_CONTAINER_ARRAY)
+    {
+        for (uint32_t i = 0; i < container->length; ++i)
+            *(words + *(values + i) / 64u) |= (uint64_t)1u << *(values + i) % 64u;
+    }
+    else
+    {
+        for (uint32_t i = 0; i < container->length; ++i)
+            bitset_container_words_apply(words, *(values + 2u * i), (uint32_t)*(values + 2u * i) + *(values + 2u * i + 1u) + 1u, BITSET_OPERATION_OR);
+    }
+}
+
+/**
+ * Replaces the contents of the container with bitmap words, stored as an array if there are few enough set bits
+ * @memberof bitset_container
+ * @param container Pointer to container to modify
+ * @param words The words to store (BITSET_CONTAINER_WORDS of them, may be the data of the container)
+ * @param cardinality Number of set bits of the words
+ */
+BITSET_API void bitset_container_set_words(bitset_container* const container, const uint64_t* const words, const uint32_t cardinality)
+{
+    if (cardinality <= BITSET_ARRAY_CONTAINER_MAX)
+    {
+        uint16_t* const values = cardinality ? (uint16_t*)malloc(cardinality * sizeof(uint16_t)) : NULL;
+        if (cardinality && !values)
+            return; // throw exception in safe version
+        uint32_t length = 0;
+        for (uint32_t i = 0; i < BITSET_CONTAINER_WORDS && length < cardinality; ++i)
+            for (uint64_t word = *(words + i); word; word &= word - 1u)
+                *(values + length++) = (uint16_t)(i * 64u + bitset_ctz64(word));
+        bitset_container_replace(container, BITSET_CONTAINER_ARRAY, values, cardinality, cardinality, cardinality);
+    }
+    else if (container->type != BITSET_CONTAINER_BITMAP || container->data != (const void*)words)
+    {
+        uint64_t* const bitmap = (uint64_t*)malloc(BITSET_CONTAINER_WORDS * sizeof(uint64_t));
+        if (!bitmap)
+            return; // throw exception in safe version
+        memcpy(bitmap, words, BITSET_CONTAINER_WORDS * sizeof(uint64_t));
+        bitset_container_replace(container, BITSET_CONTAINER_BITMAP, bitmap, BITSET_CONTAINER_WORDS, BITSET_CONTAINER_WORDS, cardinality);
+    }
+    else
+        container->cardinality = cardinality;
+}
+
+/**
+ * Replaces the contents of the container with the runs of bitmap words
+ * @memberof bitset_container
+ * @param container Pointer to container to modify
+ * @param words The words to store (BITSET_CONTAINER_WORDS of them, may be the data of the container)
+ * @param runs Number of runs of the words (see bitset_container_words_count_runs)
+ */
+BITSET_API void bitset_container_set_runs(bitset_container* const container, const uint64_t* const words, const uint32_t runs)
+{
+    uint16_t* const pairs = runs ? (uint16_t*)malloc(runs * 2u * sizeof(uint16_t)) : NULL;
+    if (runs && !pairs)
+        return; // throw exception in safe version
+
+    uint32_t length = 0, i = 0;
+    uint64_t word = *words;
+    while (true)
+    {
+        while (!word && i + 1u < BITSET_CONTAINER_WORDS)
+            word = *(words + ++i);
+        if (!word)
+            break;
+        const uint32_t start = i * 64u + (uint32_t)bitset_ctz64(word);
+        // set the bits below the start, the run ends at the first cleared bit above it
+        word |= word - 1u;
+        while (word == UINT64_MAX && i + 1u < BITSET_CONTAINER_WORDS)
+            word = *(words + ++i);
+        const uint32_t end = word == UINT64_MAX ? BITSET_CONTAINER_BITS : i * 64u + (uint32_t)bitset_ctz64(~word);
+        *(pairs + 2u * length) = (uint16_t)start;
+        *(pairs + 2u * length++ + 1u) = (uint16_t)(end - start - 1u);
+        if (end == BITSET_CONTAINER_BITS)
+            break;
+        // clear the run (the trailing set bits)
+        word &= word + 1u;
+    }
+    bitset_container_replace(container, BITSET_CONTAINER_RUN, pairs, length, length, container->cardinality);
+}
+
+/**
+ * Converts the container to a bitmap container
+ * @memberof bitset_container
+ * @param container Pointer to container to convert
+ */
+BITSET_API void bitset_container_to_bitmap(bitset_container* const container)
+{
+    if (container->type == BITSET_CONTAINER_BITMAP)
+        return;
+    uint64_t* const words = (uint64_t*)malloc(BITSET_CONTAINER_WORDS * sizeof(uint64_t));
+    if (!words)
+        return; // throw exception in safe version
+    bitset_container_to_words(container, words);
+    bitset_container_replace(container, BITSET_CONTAINER_BITMAP, words, BITSET_CONTAINER_WORDS, BITSET_CONTAINER_WORDS, container->cardinality);
+}
+
+/**
+ * Converts the container to its smallest representation (array, bitmap or run) and releases unused capacity
+ * @memberof bitset_container
+ * @param container Pointer to container to optimize
+ */
+BITSET_API void bitset_container_optimize(bitset_container* const container)
+{
+    const uint16_t* const values = (const uint16_t*)container->data;
+    uint32_t runs = container->length;
+    if (container->type == BITSET_CONTAINER_ARRAY)
+    {
+        runs = container->length ? 1u : 0u;
+        for (uint32_t i = 1; i < container->length; ++i)
+            runs += *(values + i) != *(values + i - 1u) + 1u;
+    }
+    else if (container->type == BITSET_CONTAINER_BITMAP)
+        runs = bitset_container_words_count_runs((const uint64_t*)container->data);
+
+    const uint64_t array_bytes = container->cardinality <= BITSET_ARRAY_CONTAINER_MAX ? container->cardinality * sizeof(uint16_t) : UINT64_MAX;
+    const uint64_t bitmap_bytes = BITSET_CONTAINER_WORDS * sizeof(uint64_t);
+    const uint64_t run_bytes = runs * 2u * sizeof(uint16_t);
+
+    if (run_bytes < array_bytes && run_bytes < bitmap_bytes)
+    {
+        if (container->type == BITSET_CONTAINER_BITMAP)
+            bitset_container_set_runs(container, (const uint64_t*)container->data, runs);
+        else if (container->type == BITSET_CONTAINER_ARRAY)
+        {
+            uint16_t* const pairs = (uint16_t*)malloc(runs * 2u * sizeof(uint16_t));
+            if (!pairs)
+                return; // throw exception in safe version
+            uint32_t length = 0;
+            for (uint32_t i = 0; i < container->length; ++i)
+            {
+                if (i && *(values + i) == *(values + i - 1u) + 1u)
+                    ++*(pairs + 2u * length - 1u);
+                else
+                {
+                    *(pairs + 2u * length) = *(values + i);
+                    *(pairs + 2u * length++ + 1u) = 0;
+                }
+            }
+            bitset_container_replace(container, BITSET_CONTAINER_RUN, pairs, length, length, container->cardinality);
+        }
+    }
+    else if (container->type == BITSET_CONTAINER_RUN || (container->type == BITSET_CONTAINER_ARRAY) != (container->cardinality <= BITSET_ARRAY_CONTAINER_MAX))
+    {
+        uint64_t words[BITSET_CONTAINER_WORDS];
+        bitset_container_to_words(container, words);
+        bitset_container_set_words(container, words, container->cardinality);
+    }
+
+    if (container->type != BITSET_CONTAINER_BITMAP && container->capacity > container->length && container->length)
+    {
+        void* const new_data = realloc(container->data, container->length * bitset_container_element_size(container->type));
+        if (new_data)
+        {
+            container->data = new_data;
+            container->capacity = container->length;
+        }
+    }
+}
+
+/**
+ * Retrieves the value of a bit of the container
+ * @memberof bitset_container
+ * @param container Pointer to container to read from
+ * @param value The index of the bit to read (bit index within container)
+ * @return The value of the bit
+ */
+BITSET_API bool bitset_container_get(const bitset_container* const container, const uint16_t value)
+{
+    const uint16_t* const values = (const uint16_t*)container->data;
+    switch (container->type)
+    {
+    case BITSET_CONTAINER_ARRAY:
+    {
+        const uint32_t position = bitset_container_lower_bound(values, container->length, value);
+        return position < container->length && *(values + position) == value;
+    }
+    case BITSET_CONTAINER_BITMAP:
+        return (*((const uint64_t*)container->data + value / 64u) >> value % 64u) & 1u;
+    default:
+    {
+        const uint32_t run = bitset_container_find_run(values, container->length, value);
+        return run < container->length && value - *(values + 2u * run) <= *(values + 2u * run + 1u);
+    }
+    }
+}
+
+/**
+ * Sets a bit of the container (a full array container becomes a bitmap container)
+ * @memberof bitset_container
+ * @param container Pointer to container to modify
+ * @param value The index of the bit to set (bit index within container)
+ */
+BITSET_API void bitset_container_set(bitset_container* const container, const uint16_t value)
+{
+    switch (container->type)
+    {
+    case BITSET_CONTAINER_ARRAY:
+    {
+        const uint32_t position = bitset_container_lower_bound((const uint16_t*)container->data, container->length, value);
+        if (position < container->length && *((const uint16_t*)container->data + position) == value)
+            return;
+        if (container->length == BITSET_ARRAY_CONTAINER_MAX)
+        {
+            bitset_container_to_bitmap(container);
+            bitset_container_set(container, value);
+            return;
+        }
+        bitset_container_reserve(container, container->length + 1u);
+        uint16_t* const values = (uint16_t*)container->data;
+        memmove(values + position + 1u, values + position, (container->length - position) * sizeof(uint16_t));
+        *(values + position) = value;
+        ++container->length;
+        ++container->cardinality;
+        return;
+    }
+    case BITSET_CONTAINER_BITMAP:
+    {
+        uint64_t* const word = (uint64_t*)container->data + value / 64u;
+        container->cardinality += !((*word >> value % 64u) & 1u);
+        *word |= (uint64_t)1u << value % 64u;
+        return;
+    }
+    default:
+    {
+        uint16_t* runs = (uint16_t*)container->data;
+        const uint32_t run = bitset_container_find_run(runs, container->length, value);
+        if (run < container->length && value - *(runs + 2u * run) <= *(runs + 2u * run + 1u))
+            return;
+
+        const uint32_t next = run < container->length ? run + 1u : 0u;
+        const bool extends_previous = run < container->length && (uint32_t)*(runs + 2u * run) + *(runs + 2u * run + 1u) + 1u == value;
+        const bool extends_next = next < container->length && *(runs + 2u * next) == value + 1u;
+        if (extends_previous && extends_next)
+        {
+            // the bit joins both runs
+            *(runs + 2u * run + 1u) = (uint16_t)(*(runs + 2u * next) + *(runs + 2u * next + 1u) - *(runs + 2u * run));
+            memmove(runs + 2u * next, runs + 2u * (next + 1u), (container->length - next - 1u) * 2u * sizeof(uint16_t));
+            --container->length;
+        }
+        else if (extends_previous)
+            ++*(runs + 2u * run + 1u);
+        else if (extends_next)
+        {
+            --*(runs + 2u * next);
+            ++*(runs + 2u * next + 1u);
+        }
+        else
+        {
+            bitset_container_reserve(container, container->length + 1u);
+            runs = (uint16_t*)container->data;
+            memmove(runs + 2u * (next + 1u), runs + 2u * next, (container->length - next) * 2u * sizeof(uint16_t));
+            *(runs + 2u * next) = value;
+            *(runs + 2u * next + 1u) = 0;
+            ++container->length;
+        }
+        ++container->cardinality;
+        return;
+    }
+    }
+}
+
+/**
+ * Clears a bit of the container (a bitmap container becomes an array container once it is sparse enough)
+ * @memberof bitset_container
+ * @param container Pointer to container to modify
+ * @param value The index of the bit to clear (bit index within container)
+ */
+BITSET_API void bitset_container_clear(bitset_container* const container, const uint16_t value)
+{
+    switch (container->type)
+    {
+    case BITSET_CONTAINER_ARRAY:
+    {
+        uint16_t* const values = (uint16_t*)container->data;
+        const uint32_t position = bitset_container_lower_bound(values, container->length, value);
+        if (position == container->length || *(values + position) != value)
+            return;
+        memmove(values + position, values + position + 1u, (container->length - position - 1u) * sizeof(uint16_t));
+        --container->length;
+        --container->cardinality;
+        return;
+    }
+    case BITSET_CONTAINER_BITMAP:
+    {
+        uint64_t* const word = (uint64_t*)container->data + value / 64u;
+        if (!((*word >> value % 64u) & 1u))
+            return;
+        *word &= ~((uint64_t)1u << value % 64u);
+        if (--container->cardinality <= BITSET_ARRAY_CONTAINER_MAX)
+            bitset_container_set_words(container, (const uint64_t*)container->data, container->cardinality);
+        return;
+    }
+    default:
+    {
+        uint16_t* runs = (uint16_t*)container->data;
+        const uint32_t run = bitset_container_find_run(runs, container->length, value);
+        if (run == container->length || value - *(runs + 2u * run) > *(runs + 2u * run + 1u))
+            return;
+
+        const uint32_t start = *(runs + 2u * run), end = start + *(runs + 2u * run + 1u);
+        if (start == end)
+        {
+            memmove(runs + 2u * run, runs + 2u * (run + 1u), (container->length - run - 1u) * 2u * sizeof(uint16_t));
+            --container->length;
+        }
+        else if (value == start)
+        {
+            ++*(runs + 2u * run);
+            --*(runs + 2u * run + 1u);
+        }
+        else if (value == end)
+            --*(runs + 2u * run + 1u);
+        else
+        {
+            // split the run around the bit
+            bitset_container_reserve(container, container->length + 1u);
+            runs = (uint16_t*)container->data;
+            memmove(runs + 2u * (run + 2u), runs + 2u * (run + 1u), (container->length - run - 1u) * 2u * sizeof(uint16_t));
+            *(runs + 2u * run + 1u) = (uint16_t)(value - start - 1u);
+            *(runs + 2u * (run + 1u)) = (uint16_t)(value + 1u);
+            *(runs + 2u * (run + 1u) + 1u) = (uint16_t)(end - value - 1u);
+            ++container->length;
+        }
+        --container->cardinality;
+        return;
+    }
+    }
+}
+
+/**
+ * Sets (OR), clears (ANDNOT) or flips (XOR) the bits [begin, end) of the container, then optimizes it
+ * @memberof bitset_container
+ * @param container Pointer to container to modify
+ * @param begin Index of the first bit to modify (bit index within container)
+ * @param end Index past the last bit to modify, at most BITSET_CONTAINER_BITS (bit index within container)
+ * @param operation BITSET_OPERATION_OR, BITSET_OPERATION_ANDNOT or BITSET_OPERATION_XOR
+ */
+BITSET_API void bitset_container_update_range(bitset_container* const container, const uint32_t begin, const uint32_t end, const bitset_operation operation)
+{
+    if (begin >= end)
+        return;
+
+    if (end - begin == BITSET_CONTAINER_BITS && operation != BITSET_OPERATION_XOR)
+    {
+        if (operation == BITSET_OPERATION_ANDNOT)
+        {
+            bitset_container_replace(container, BITSET_CONTAINER_ARRAY, NULL, 0, 0, 0);
+            return;
+        }
+        uint16_t* const full = (uint16_t*)malloc(2u * sizeof(uint16_t));
+        if (!full)
+            return; // throw exception in safe version
+        *full = 0;
+        *(full + 1) = (uint16_t)(BITSET_CONTAINER_BITS - 1u);
+        bitset_container_replace(container, BITSET_CONTAINER_RUN, full, 1, 1, BITSET_CONTAINER_BITS);
+        return;
+    }
+
+    bitset_container_to_bitmap(container);
+    uint64_t* const words = (uint64_t*)container->data;
+    const uint32_t before = bitset_container_words_count(words, begin, end);
+    bitset_container_words_apply(words, begin, end, operation);
+    container->cardinality -= before;
+    if (operation == BITSET_OPERATION_OR)
+        container->cardinality += end - begin;
+    else if (operation == BITSET_OPERATION_XOR)
+        container->cardinality += end - begin - before;
+    bitset_container_optimize(container);
+}
+
+/**
+ * Computes result = left op right of two containers with the same key
+ * Intersections and differences with an array container probe the other container directly, nothing is expanded
+ * @memberof bitset_container
+ * @param result Pointer to empty container to store the result to (initialized with the key)
+ * @param left Pointer to the left operand
+ * @param right Pointer to the right operand
+ * @param operation The operation to apply
+ */
+BITSET_API void bitset_container_binary_operation(bitset_container* const result, const bitset_container* const left, const bitset_container* const right, const bitset_operation operation)
+{
+    const uint16_t* const left_values = (const uint16_t*)left->data;
+    const uint16_t* const right_values = (const uint16_t*)right->data;
+
+    if (left->type == BITSET_CONTAINER_ARRAY && right->type == BITSET_CONTAINER_ARRAY)
+    {
+        // merge of the sorted values (a union may overflow the array limit, handled below)
+        const uint32_t capacity = operation == BITSET_OPERATION_AND ? (left->length < right->length ? left->length : right->length) : operation == BITSET_OPERATION_ANDNOT ? left->length : left->length + right->length;
+        uint16_t* const values = capacity ? (uint16_t*)malloc(capacity * sizeof(uint16_t)) : NULL;
+        if (capacity && !values)
+            return; // throw exception in safe version
+        uint32_t i = 0, j = 0, length = 0;
+        while (i < left->length && j < right->length)
+        {
+            const uint16_t a = *(left_values + i), b = *(right_values + j);
+            if (a < b)
+            {
+                if (operation != BITSET_OPERATION_AND)
+                    *(values + length++) = a;
+                ++i;
+            }
+            else if (b < a)
+            {
+                if (operation == BITSET_OPERATION_OR || operation == BITSET_OPERATION_XOR)
+                    *(values + length++) = b;
+                ++j;
+            }
+            else
+            {
+                if (operation == BITSET_OPERATION_AND || operation == BITSET_OPERATION_OR)
+                    *(values + length++) = a;
+                ++i;
+                ++j;
+            }
+        }
+        if (operation != BITSET_OPERATION_AND)
+            for (; i < left->length; ++i)
+                *(values + length++) = *(left_values + i);
+        if (operation == BITSET_OPERATION_OR || operation == BITSET_OPERATION_XOR)
+            for (; j < right->length; ++j)
+                *(values + length++) = *(right_values + j);
+
+        bitset_container_replace(result, BITSET_CONTAINER_ARRAY, values, length, capacity, length);
+        if (length > BITSET_ARRAY_CONTAINER_MAX)
+        {
+            uint64_t words[BITSET_CONTAINER_WORDS];
+            bitset_container_to_words(result, words);
+            bitset_container_set_words(result, words, length);
+        }
+        if (!length)
+            bitset_container_replace(result, BITSET_CONTAINER_ARRAY, NULL, 0, 0, 0);
+        return;
+    }
+
+    if ((operation == BITSET_OPERATION_AND && (left->type == BITSET_CONTAINER_ARRAY || right->type == BITSET_CONTAINER_ARRAY)) || (operation == BITSET_OPERATION_ANDNOT && left->type == BITSET_CONTAINER_ARRAY))
+    {
+        // filter the values of the array operand by the other container
+        const bitset_container* const array = left->type == BITSET_CONTAINER_ARRAY ? left : right;
+        const bitset_container* const other = array == left ? right : left;
+        const bool keep = operation == BITSET_OPERATION_AND;
+        uint16_t* const values = array->length ? (uint16_t*)malloc(array->length * sizeof(uint16_t)) : NULL;
+        if (array->length && !values)
+            return; // throw exception in safe version
+        uint32_t length = 0;
+        for (uint32_t i = 0; i < array->length; ++i)
+            if (bitset_container_get(other, *((const uint16_t*)array->data + i)) == keep)
+                *(values + length++) = *((const uint16_t*)array->data + i);
+        if (length)
+            bitset_container_replace(result, BITSET_CONTAINER_ARRAY, values, length, array->length, length);
+        else
+            free(values);
+        return;
+    }
+
+    if (operation == BITSET_OPERATION_AND && left->type == BITSET_CONTAINER_RUN && right->type == BITSET_CONTAINER_RUN)
+    {
+        // overlaps of the sorted runs
+        const uint32_t capacity = left->length + right->length;
+        uint16_t* const runs = capacity ? (uint16_t*)malloc(capacity * 2u * sizeof(uint16_t)) : NULL;
+        if (capacity && !runs)
+            return; // throw exception in safe version
+        uint32_t i = 0, j = 0, length = 0, cardinality = 0;
+        while (i < left->length && j < right->length)
+        {
+            const uint32_t left_start = *(left_values + 2u * i), left_end = left_start + *(left_values + 2u * i + 1u);
+            const uint32_t right_start = *(right_values + 2u * j), right_end = right_start + *(right_values + 2u * j + 1u);
+            const uint32_t start = left_start > right_start ? left_start : right_start;
+            const uint32_t end = left_end < right_end ? left_end : right_end;
+            if (start <= end)
+            {
+                *(runs + 2u * length) = (uint16_t)start;
+                *(runs + 2u * length++ + 1u) = (uint16_t)(end - start);
+                cardinality += end - start + 1u;
+            }
+            if (left_end < right_end)
+                ++i;
+            else
+                ++j;
+        }
+        if (!length)
+        {
+            free(runs);
+            return;
+        }
+        bitset_container_replace(result, BITSET_CONTAINER_RUN, runs, length, capacity, cardinality);
+        bitset_container_optimize(result);
+        return;
+    }
+
+    // word-at-a-time on a bitmap copy of left
+    uint64_t* const words = (uint64_t*)malloc(BITSET_CONTAINER_WORDS * sizeof(uint64_t));
+    if (!words)
+        return; // throw exception in safe version
+    bitset_container_to_words(left, words);
+    if (right->type == BITSET_CONTAINER_BITMAP)
+    {
+        const uint64_t* const right_words = (const uint64_t*)right->data;
+        for (uint32_t i = 0; i < BITSET_CONTAINER_WORDS; ++i)
+            *(words + i) = bitset_container_apply_word(*(words + i), *(right_words + i), operation);
+    }
+    else if (right->type == BITSET_CONTAINER_ARRAY)
+    {
+        // AND with an array is handled by the filter above
+        for (uint32_t i = 0; i < right->length; ++i)
+            *(words + *(right_values + i) / 64u) = bitset_container_apply_word(*(words + *(right_values + i) / 64u), (uint64_t)1u << *(right_values + i) % 64u, operation);
+    }
+    else if (operation == BITSET_OPERATION_AND)
+    {
+        // clear the gaps between the runs
+        uint32_t previous_end = 0;
+        for (uint32_t i = 0; i < right->length; ++i)
+        {
+            bitset_container_words_apply(words, previous_end, *(right_values + 2u * i), BITSET_OPERATION_ANDNOT);
+            previous_end = (uint32_t)*(right_values + 2u * i) + *(right_values + 2u * i + 1u) + 1u;
+        }
+        bitset_container_words_apply(words, previous_end, BITSET_CONTAINER_BITS, BITSET_OPERATION_ANDNOT);
+    }
+    else
+    {
+        for (uint32_t i = 0; i < right->length; ++i)
+            bitset_container_words_apply(words, *(right_values + 2u * i), (uint32_t)*(right_values + 2u * i) + *(right_values + 2u * i + 1u) + 1u, operation);
+    }
+
+    const uint32_t cardinality = bitset_container_words_count(words, 0, BITSET_CONTAINER_BITS);
+    bitset_container_replace(result, BITSET_CONTAINER_BITMAP, words, BITSET_CONTAINER_WORDS, BITSET_CONTAINER_WORDS, cardinality);
+    if (cardinality)
+        bitset_container_optimize(result);
+    else
+        bitset_container_replace(result, BITSET_CONTAINER_ARRAY, NULL, 0, 0, 0);
+}
+
+/**
+ * Counts the set bits of left & right of two containers with the same key, without storing the result
+ * @memberof bitset_container
+ * @param left Pointer to the left operand
+ * @param right Pointer to the right operand
+ * @return The number of set bits of the intersection
+ */
+BITSET_API uint32_t bitset_container_and_count(const bitset_container* const left, const bitset_container* const right)
+{
+    const uint16_t* const left_values = (const uint16_t*)left->data;
+    const uint16_t* const right_values = (const uint16_t*)right->data;
+    uint32_t count = 0;
+
+    if (left->type == BITSET_CONTAINER_ARRAY && right->type == BITSET_CONTAINER_ARRAY)
+    {
+        uint32_t i = 0, j = 0;
+        while (i < left->length && j < right->length)
+        {
+            if (*(left_values + i) < *(right_values + j))
+                ++i;
+            else if (*(right_values + j) < *(left_values + i))
+                ++j;
+            else
+            {
+                ++count;
+                ++i;
+                ++j;
+            }
+        }
+    }
+    else if (left->type == BITSET_CONTAINER_ARRAY || right->type == BITSET_CONTAINER_ARRAY)
+    {
+        const bitset_container* const array = left->type == BITSET_CONTAINER_ARRAY ? left : right;
+        const bitset_container* const other = array == left ? right : left;
+        for (uint32_t i = 0; i < array->length; ++i)
+            count += bitset_container_get(other, *((const uint16_t*)array->data + i));
+    }
+    else if (left->type == BITSET_CONTAINER_BITMAP && right->type == BITSET_CONTAINER_BITMAP)
+    {
+        const uint64_t* const left_words = (const uint64_t*)left->data;
+        const uint64_t* const right_words = (const uint64_t*)right->data;
+        for (uint32_t i = 0; i < BITSET_CONTAINER_WORDS; ++i)
+            count += (uint32_t)bitset_popcount64(*(left_words + i) & *(right_words + i));
+    }
+    else if (left->type == BITSET_CONTAINER_RUN && right->type == BITSET_CONTAINER_RUN)
+    {
+        uint32_t i = 0, j = 0;
+        while (i < left->length && j < right->length)
+        {
+            const uint32_t left_start = *(left_values + 2u * i), left_end = left_start + *(left_values + 2u * i + 1u);
+            const uint32_t right_start = *(right_values + 2u * j), right_end = right_start + *(right_values + 2u * j + 1u);
+            const uint32_t start = left_start > right_start ? left_start : right_start;
+            const uint32_t end = left_end < right_end ? left_end : right_end;
+            if (start <= end)
+                count += end - start + 1u;
+            if (left_end < right_end)
+                ++i;
+            else
+                ++j;
+        }
+    }
+    else
+    {
+        // runs over a bitmap
+        const bitset_container* const run = left->type == BITSET_CONTAINER_RUN ? left : right;
+        const uint64_t* const words = (const uint64_t*)(run == left ? right : left)->data;
+        const uint16_t* const runs = (const uint16_t*)run->data;
+        for (uint32_t i = 0; i < run->length; ++i)
+            count += bitset_container_words_count(words, *(runs + 2u * i), (uint32_t)*(runs + 2u * i) + *(runs + 2u * i + 1u) + 1u);
+    }
+    return count;
+}
+
+/**
+ * Size initialization, all of the bits are cleared (no memory is allocated)
+ * @memberof CompressedBitSet
+ * @param bitset Pointer to bitset to initialize
+ * @param size The size of the bitset to be initialized (bit size, at most 2^48)
+ */
+BITSET_API void bitset_compressed_init(CompressedBitSet* const bitset, const uint64_t size)
+{
+    bitset_compressed_init_allocator(bitset, size, NULL);
+}
+
+/**
+ * Size and allocator initialization, all of the bits are cleared (no memory is allocated)
+ * @memberof CompressedBitSet
+ * @param bitset Pointer to bitset to initialize
+ * @param size The size of the bitset to be initialized (bit size, at most 2^48)
+ * @param allocator The allocator of the container array (NULL for the default allocator), has to outlive the bitset
+ */
+BITSET_API void bitset_compressed_init_allocator(CompressedBitSet* const bitset, const uint64_t size, const bitset_allocator* const allocator)
+{
+    bitset->containers = NULL;
+    bitset->container_count = 0;
+    bitset->container_capacity = 0;
+    bitset->size = size;
+    bitset->allocator = allocator;
+}
+
+/**
+ * Initializes the bitset with the bits of a plain bitset (BitSet or DynamicBitSet)
+ * @memberof CompressedBitSet
+ * @param bitset Pointer to bitset to initialize
+ * @param source Pointer to bitset to compress
+ */
+BITSET_API void bitset_compressed_init_bitset(CompressedBitSet* const bitset, const BitSet* const source)
+{
+    bitset_compressed_init(bitset, source->size);
+    const uint64_t word_count = (source->size + 63u) / 64u;
+    uint64_t words[BITSET_CONTAINER_WORDS];
+    for (uint64_t first = 0; first < word_count; first += BITSET_CONTAINER_WORDS)
+    {
+        uint32_t cardinality = 0;
+        for (uint64_t i = 0; i < BITSET_CONTAINER_WORDS; ++i)
+        {
+            uint64_t word = first + i < word_count ? bitset_get_word(source, first + i) : 0;
+            if (first + i == word_count - 1u && source->size % 64u)
+                word &= UINT64_MAX >> (64u - source->size % 64u);
+            *(words + i) = word;
+            cardinality += (uint32_t)bitset_popcount64(word);
+        }
+        if (!cardinality)
+            continue;
+
+        bitset_compressed_reserve(bitset, bitset->container_count + 1u);
+        if (bitset->container_count >= bitset->container_capacity)
+            return; // the chunks compressed so far are kept, throw exception in safe version
+        bitset_container* const container = bitset->containers + bitset->container_count++;
+        bitset_container_init(container, (uint32_t)(first / BITSET_CONTAINER_WORDS));
+        bitset_container_set_words(container, words, cardinality);
+        bitset_container_optimize(container);
+    }
+}
+
+/**
+ * Destroys the bitset (frees the memory)
+ * @memberof CompressedBitSet
+ * @param bitset Pointer to bitset to destroy
+ */
+BITSET_API void bitset_compressed_destroy(CompressedBitSet* const bitset)
+{
+    for (uint64_t i = 0; i < bitset->container_count; ++i)
+        bitset_container_destroy(bitset->containers + i);
+    bitset_deallocate(bitset->allocator, bitset->containers, bitset->container_capacity * sizeof(bitset_container));
+}
+
+/**
+ * Replaces the contents of the bitset with a copy of another one (destination keeps its allocator)
+ * @memberof CompressedBitSet
+ * @param destination Pointer to bitset to copy to
+ * @param source Pointer to bitset to copy from
+ */
+BITSET_API void bitset_compressed_copy(CompressedBitSet* const destination, const CompressedBitSet* const source)
+{
+    if (destination == source)
+        return;
+    bitset_compressed_destroy(destination);
+    bitset_compressed_init_allocator(destination, source->size, destination->allocator);
+    bitset_compressed_reserve(destination, source->container_count);
+    if (destination->container_capacity < source->container_count)
+        return; // destination is left empty, throw exception in safe version
+    for (uint64_t i = 0; i < source->container_count; ++i)
+        bitset_container_copy(destination->containers + i, source->containers + i);
+    destination->container_count = source->container_count;
+}
+
+/**
+ * Ensures the bitset can hold at least the specified number of containers without reallocating (grows geometrically)
+ * @memberof CompressedBitSet
+ * @param bitset Pointer to bitset to modify
+ * @param capacity The number of containers to reserve
+ */
+BITSET_API void bitset_compressed_reserve(CompressedBitSet* const bitset, const uint64_t capacity)
+{
+    if (capacity <= bitset->container_capacity)
+        return;
+
+    uint64_t new_capacity = bitset->container_capacity ? bitset->container_capacity * 2u : 4u;
+    if (new_capacity < capacity)
+        new_capacity = capacity;
+    bitset_container* const new_containers = (bitset_container*)bitset_reallocate(bitset->allocator, bitset->containers, bitset->container_capacity * sizeof(bitset_container), new_capacity * sizeof(bitset_container));
+    if (!new_containers)
+        return; // the old buffer is kept, throw exception in safe version
+    bitset->containers = new_containers;
+    bitset->container_capacity = new_capacity;
+}
+
+/**
+ * Searches the containers for the first one with a key not less than the specified one
+ * @memberof CompressedBitSet
+ * @param bitset Pointer to bitset to search
+ * @param key The key to search for (bit index / BITSET_CONTAINER_BITS)
+ * @return Position of the found container, container_count if all of the keys are less
+ */
+BITSET_API uint64_t bitset_compressed_lower_bound(const CompressedBitSet* const bitset, const uint32_t key)
+{
+    uint64_t low = 0, high = bitset->container_count;
+    while (low < high)
+    {
+        const uint64_t middle = low + (high - low) / 2u;
+        if ((bitset->containers + middle)->key < key)
+            low = middle + 1u;
+        else
+            high = middle;
+    }
+    return low;
+}
+
+/**
+ * Searches the container with the specified key
+ * @memberof CompressedBitSet
+ * @param bitset Pointer to bitset to search
+ * @param key The key to search for (bit index / BITSET_CONTAINER_BITS)
+ * @return Pointer to the container, NULL if all of its bits are cleared
+ */
+BITSET_API bitset_container* bitset_compressed_find_container(const CompressedBitSet* const bitset, const uint32_t key)
+{
+    const uint64_t position = bitset_compressed_lower_bound(bitset, key);
+    return position < bitset->container_count && (bitset->containers + position)->key == key ? bitset->containers + position : NULL;
+}
+
+/**
+ * Retrieves the container with the specified key, inserting an empty one if there is none
+ * @memberof CompressedBitSet
+ * @param bitset Pointer to bitset to modify
+ * @param key The key of the container (bit index / BITSET_CONTAINER_BITS)
+ * @return Pointer to the container (valid until the next insertion or removal), NULL if the container array could not grow
+ */
+BITSET_API bitset_container* bitset_compressed_insert_container(CompressedBitSet* const bitset, const uint32_t key)
+{
+    const uint64_t position = bitset_compressed_lower_bound(bitset, key);
+    if (position < bitset->container_count && (bitset->containers + position)->key == key)
+        return bitset->containers + position;
+
+    bitset_compressed_reserve(bitset, bitset->container_count + 1u);
+    if (bitset->container_count >= bitset->container_capacity)
+        return NULL; // throw exception in safe version
+    memmove(bitset->containers + position + 1u, bitset->containers + position, (bitset->container_count - position) * sizeof(bitset_container));
+    ++bitset->container_count;
+    bitset_container_init(bitset->containers + position, key);
+    return bitset->containers + position;
+}
+
+/**
+ * Removes the container at the specified position
+ * @memberof CompressedBitSet
+ * @param bitset Pointer to bitset to modify
+ * @param position Position of the container to remove
+ */
+BITSET_API void bitset_compressed_remove_container(CompressedBitSet* const bitset, const uint64_t position)
+{
+    bitset_container_destroy(bitset->containers + position);
+    memmove(bitset->containers + position, bitset->containers + position + 1u, (bitset->container_count - position - 1u) * sizeof(bitset_container));
+    --bitset->container_count;
+}
+
+/**
+ * Retrieves the value of a bit at a specified index
+ * @memberof CompressedBitSet
+ * @param bitset Pointer to bitset to read from
+ * @param index The index of the bit to read (bit index)
+ * @return The value of the bit at the specified index
+ */
+BITSET_API bool bitset_compressed_get(const CompressedBitSet* const bitset, const uint64_t index)
+{
+    const bitset_container* const container = bitset_compressed_find_container(bitset, (uint32_t)(index / BITSET_CONTAINER_BITS));
+    return container && bitset_container_get(container, (uint16_t)(index % BITSET_CONTAINER_BITS));
+}
+
+/**
+ * Sets the bit at a specified index
+ * @memberof CompressedBitSet
+ * @param bitset Pointer to bitset to modify
+ * @param index The index of the bit to set (bit index)
+ */
+BITSET_API void bitset_compressed_set(CompressedBitSet* const bitset, const uint64_t index)
+{
+    bitset_container* const container = bitset_compressed_insert_container(bitset, (uint32_t)(index / BITSET_CONTAINER_BITS));
+    if (container)
+        bitset_container_set(container, (uint16_t)(index % BITSET_CONTAINER_BITS));
+    // else throw exception in safe version
+}
+
+/**
+ * Clears the bit at a specified index (the container is released once all of its bits are cleared)
+ * @memberof CompressedBitSet
+ * @param bitset Pointer to bitset to modify
+ * @param index The index of the bit to clear (bit index)
+ */
+BITSET_API void bitset_compressed_clear(CompressedBitSet* const bitset, const uint64_t index)
+{
+    const uint64_t position = bitset_compressed_lower_bound(bitset, (uint32_t)(index / BITSET_CONTAINER_BITS));
+    if (position == bitset->container_count || (bitset->containers + position)->key != (uint32_t)(index / BITSET_CONTAINER_BITS))
+        return;
+    bitset_container_clear(bitset->containers + position, (uint16_t)(index % BITSET_CONTAINER_BITS));
+    if (!(bitset->containers + position)->cardinality)
+        bitset_compressed_remove_container(bitset, position);
+}
+
+/**
+ * Sets the value of a bit at a specified index
+ * @memberof CompressedBitSet
+ * @param bitset Pointer to bitset to modify
+ * @param value The value to set the bit to
+ * @param index The index of the bit to modify (bit index)
+ */
+BITSET_API void bitset_compressed_set_value(CompressedBitSet* const bitset, const bool value, const uint64_t index)
+{
+    if (value)
+        bitset_compressed_set(bitset, index);
+    else
+        bitset_compressed_clear(bitset, index);
+}
+
+/**
+ * Flips the bit at a specified index
+ * @memberof CompressedBitSet
+ * @param bitset Pointer to bitset to modify
+ * @param index The index of the bit to flip (bit index)
+ */
+BITSET_API void bitset_compressed_flip_bit(CompressedBitSet* const bitset, const uint64_t index)
+{
+    bitset_compressed_set_value(bitset, !bitset_compressed_get(bitset, index), index);
+}
+
+/**
+ * Sets (OR), clears (ANDNOT) or flips (XOR) the bits [begin, end), whole containers are set as a single run
+ * @memberof CompressedBitSet
+ * @param bitset Pointer to bitset to modify
+ * @param begin Index of the first bit to modify (bit index)
+ * @param end Index past the last bit to modify (bit index)
+ * @param operation BITSET_OPERATION_OR, BITSET_OPERATION_ANDNOT or BITSET_OPERATION_XOR
+ */
+BITSET_API void bitset_compressed_update_range(CompressedBitSet* const bitset, const uint64_t begin, const uint64_t end, const bitset_operation operation)
+{
+    if (begin >= end)
+        return;
+
+    const uint32_t first_key = (uint32_t)(begin / BITSET_CONTAINER_BITS), last_key = (uint32_t)((end - 1u) / BITSET_CONTAINER_BITS);
+    const uint64_t position = bitset_compressed_lower_bound(bitset, first_key);
+    uint64_t tail = position;
+    while (tail < bitset->container_count && (bitset->containers + tail)->key <= last_key)
+        ++tail;
+
+    if (operation != BITSET_OPERATION_ANDNOT)
+    {
+        // insert all of the missing containers of the range in a single pass, from the back
+        const uint64_t missing = (uint64_t)(last_key - first_key) + 1u - (tail - position);
+        if (missing)
+        {
+            bitset_compressed_reserve(bitset, bitset->container_count + missing);
+            if (bitset->container_capacity < bitset->container_count + missing)
+                return; // the bitset is left unchanged, throw exception in safe version
+            memmove(bitset->containers + tail + missing, bitset->containers + tail, (bitset->container_count - tail) * sizeof(bitset_container));
+            uint64_t source = tail;
+            for (uint64_t destination = tail + missing; destination-- > position;)
+            {
+                const uint32_t key = (uint32_t)(first_key + (destination - position));
+                if (source > position && (bitset->containers + source - 1u)->key == key)
+                    *(bitset->containers + destination) = *(bitset->containers + --source);
+                else
+                    bitset_container_init(bitset->containers + destination, key);
+            }
+            bitset->container_count += missing;
+            tail += missing;
+        }
+    }
+
+    // update the containers of the range and compact the emptied ones away
+    uint64_t write = position;
+    for (uint64_t read = position; read < tail; ++read)
+    {
+        bitset_container* const container = bitset->containers + read;
+        const uint32_t local_begin = container->key == first_key ? (uint32_t)(begin % BITSET_CONTAINER_BITS) : 0u;
+        const uint32_t local_end = container->key == last_key ? (uint32_t)((end - 1u) % BITSET_CONTAINER_BITS) + 1u : BITSET_CONTAINER_BITS;
+        bitset_container_update_range(container, local_begin, local_end, operation);
+        if (container->cardinality)
+            *(bitset->containers + write++) = *container;
+        else
+            bitset_container_destroy(container);
+    }
+    if (write != tail)
+    {
+        memmove(bitset->containers + write, bitset->containers + tail, (bitset->container_count - tail) * sizeof(bitset_container));
+        bitset->container_count -= tail - write;
+    }
+}
+
+/**
+ * Fills the bits in the range [begin, end) with the specified value
+ * @memberof CompressedBitSet
+ * @param bitset Pointer to bitset to modify
+ * @param value The value to fill the bits with
+ * @param begin Index of the first bit to fill (bit index)
+ * @param end Index past the last bit to fill (bit index)
+ */
+BITSET_API void bitset_compressed_fill_in_range_begin_end(CompressedBitSet* const bitset, const bool value, const uint64_t begin, const uint64_t end)
+{
+    bitset_compressed_update_range(bitset, begin, end, value ? BITSET_OPERATION_OR : BITSET_OPERATION_ANDNOT);
+}
+
+/**
+ * Flips the bits in the range [begin, end)
+ * @memberof CompressedBitSet
+ * @param bitset Pointer to bitset to modify
+ * @param begin Index of the first bit to flip (bit index)
+ * @param end Index past the last bit to flip (bit index)
+ */
+BITSET_API void bitset_compressed_flip_in_range_begin_end(CompressedBitSet* const bitset, const uint64_t begin, const uint64_t end)
+{
+    bitset_compressed_update_range(bitset, begin, end, BITSET_OPERATION_XOR);
+}
+
+/**
+ * Counts the set bits (sum of the cardinalities of the containers)
+ * @memberof CompressedBitSet
+ * @param bitset Pointer to bitset to count the bits of
+ * @return The number of set bits
+ */
+BITSET_API uint64_t bitset_compressed_count(const CompressedBitSet* const bitset)
+{
+    uint64_t count = 0;
+    for (uint64_t i = 0; i < bitset->container_count; ++i)
+        count += (bitset->containers + i)->cardinality;
+    return count;
+}
+
+/**
+ * Checks if any of the bits are set
+ * @memberof CompressedBitSet
+ * @param bitset Pointer to bitset to check
+ * @return Whether any bit is set
+ */
+BITSET_API bool bitset_compressed_any(const CompressedBitSet* const bitset)
+{
+    return bitset->container_count != 0;
+}
+
+/**
+ * Checks if none of the bits are set
+ * @memberof CompressedBitSet
+ * @param bitset Pointer to bitset to check
+ * @return Whether all of the bits are cleared
+ */
+BITSET_API bool bitset_compressed_none(const CompressedBitSet* const bitset)
+{
+    return !bitset->container_count;
+}
+
+/**
+ * Computes destination = left op right container by container, without expanding the operands
+ * destination may be the same bitset as left or right, its size becomes the larger of both sizes and it keeps its allocator
+ * @memberof CompressedBitSet
+ * @param destination Pointer to bitset to store the result to
+ * @param left Pointer to the left operand
+ * @param right Pointer to the right operand
+ * @param operation The operation to apply
+ */
+BITSET_API void bitset_compressed_binary_operation(CompressedBitSet* const destination, const CompressedBitSet* const left, const CompressedBitSet* const right, const bitset_operation operation)
+{
+    const uint64_t capacity = left->container_count + right->container_count;
+    bitset_container* const containers = capacity ? (bitset_container*)bitset_allocate(destination->allocator, capacity * sizeof(bitset_container)) : NULL;
+    if (capacity && !containers)
+        return; // throw exception in safe version
+
+    uint64_t count = 0, i = 0, j = 0;
+    while (i < left->container_count || j < right->container_count)
+    {
+        const bitset_container* const a = i < left->container_count ? left->containers + i : NULL;
+        const bitset_container* const b = j < right->container_count ? right->containers + j : NULL;
+        if (a && (!b || a->key < b->key))
+        {
+            if (operation != BITSET_OPERATION_AND)
+                bitset_container_copy(containers + count++, a);
+            ++i;
+        }
+        else if (!a || b->key < a->key)
+        {
+            if (operation == BITSET_OPERATION_OR || operation == BITSET_OPERATION_XOR)
+                bitset_container_copy(containers + count++, b);
+            ++j;
+        }
+        else
+        {
+            bitset_container_init(containers + count, a->key);
+            bitset_container_binary_operation(containers + count, a, b, operation);
+            if ((containers + count)->cardinality)
+                ++count;
+            else
+                bitset_container_destroy(containers + count);
+            ++i;
+            ++j;
+        }
+    }
+
+    const uint64_t size = left->size > right->size ? left->size : right->size;
+    bitset_compressed_destroy(destination);
+    destination->containers = containers;
+    destination->container_count = count;
+    destination->container_capacity = capacity;
+    destination->size = size;
+}
+
+/**
+ * Counts the set bits of left op right, without storing the result (only the intersections of the containers are counted)
+ * @memberof CompressedBitSet
+ * @param left Pointer to the left operand
+ * @param right Pointer to the right operand
+ * @param operation The operation to apply
+ * @return The number of set bits of the result
+ */
+BITSET_API uint64_t bitset_compressed_binary_count(const CompressedBitSet* const left, const CompressedBitSet* const right, const bitset_operation operation)
+{
+    uint64_t intersection = 0, i = 0, j = 0;
+    while (i < left->container_count && j < right->container_count)
+    {
+        if ((left->containers + i)->key < (right->containers + j)->key)
+            ++i;
+        else if ((right->containers + j)->key < (left->containers + i)->key)
+            ++j;
+        else
+            intersection += bitset_container_and_count(left->containers + i++, right->containers + j++);
+    }
+
+    switch (operation)
+    {
+    case BITSET_OPERATION_AND:
+        return intersection;
+    case BITSET_OPERATION_OR:
+        return bitset_compressed_count(left) + bitset_compressed_count(right) - intersection;
+    case BITSET_OPERATION_XOR:
+        return bitset_compressed_count(left) + bitset_compressed_count(right) - 2u * intersection;
+    default:
+        return bitset_compressed_count(left) - intersection;
+    }
+}
+
+/**
+ * Converts every container to its smallest representation (runs for clustered bits)
+ * @memberof CompressedBitSet
+ * @param bitset Pointer to bitset to optimize
+ */
+BITSET_API void bitset_compressed_optimize(CompressedBitSet* const bitset)
+{
+    for (uint64_t i = 0; i < bitset->container_count; ++i)
+        bitset_container_optimize(bitset->containers + i);
+}
+
+/**
+ * Calculates the memory used by the bitset
+ * @memberof CompressedBitSet
+ * @param bitset Pointer to bitset to measure
+ * @return The number of allocated bytes (including the structure itself)
+ */
+BITSET_API uint64_t bitset_compressed_memory_usage(const CompressedBitSet* const bitset)
+{
+    uint64_t bytes = sizeof(CompressedBitSet) + bitset->container_capacity * sizeof(bitset_container);
+    for (uint64_t i = 0; i < bitset->container_count; ++i)
+        bytes += (bitset->containers + i)->capacity * bitset_container_element_size((bitset->containers + i)->type);
+    return bytes;
+}
+
+/**
+ * Calls the callback for every set bit, in ascending order
+ * @memberof CompressedBitSet
+ * @param bitset Pointer to bitset to iterate
+ * @param callback The function to call with the index of every set bit
+ * @param context Pointer passed to the callback
+ */
+BITSET_API void bitset_compressed_for_each_set_bit(const CompressedBitSet* const bitset, const bitset_index_callback callback, void* const context)
+{
+    for (uint64_t i = 0; i < bitset->container_count; ++i)
+    {
+        const bitset_container* const container = bitset->containers + i;
+        const uint64_t base = (uint64_t)container->key * BITSET_CONTAINER_BITS;
+        const uint16_t* const values = (const uint16_t*)container->data;
+        if (container->type == BITSET_CONTAINER_ARRAY)
+        {
+            for (uint32_t j = 0; j < container->length; ++j)
+                callback(base + *(values + j), context);
+        }
+        else if (container->type == BITSET_CONTAINER_BITMAP)
+        {
+            for (uint32_t j = 0; j < BITSET_CONTAINER_WORDS; ++j)
+                for (uint64_t word = *((const uint64_t*)container->data + j); word; word &= word - 1u)
+                    callback(base + j * 64u + bitset_ctz64(word), context);
+        }
+        else
+        {
+            for (uint32_t j = 0; j < container->length; ++j)
+                for (uint64_t index = base + *(values + 2u * j); index <= base + *(values + 2u * j) + *(values + 2u * j + 1u); ++index)
+                    callback(index, context);
+        }
+    }
+}
+
+/**
+ * Decompresses the bitset into a plain bitset (BitSet or DynamicBitSet), bits past destination->size are dropped
+ * @memberof CompressedBitSet
+ * @param bitset Pointer to bitset to decompress
+ * @param destination Pointer to bitset to store the bits to (all of its other bits are cleared)
+ */
+BITSET_API void bitset_compressed_to_bitset(const CompressedBitSet* const bitset, BitSet* const destination)
+{
+    bitset_clear_all(destination);
+    for (uint64_t i = 0; i < bitset->container_count; ++i)
+    {
+        const bitset_container* const container = bitset->containers + i;
+        const uint64_t base = (uint64_t)container->key * BITSET_CONTAINER_BITS;
+        const uint16_t* const values = (const uint16_t*)container->data;
+        if (container->type == BITSET_CONTAINER_ARRAY)
+        {
+            for (uint32_t j = 0; j < container->length && base + *(values + j) < destination->size; ++j)
+                bitset_set(destination, base + *(values + j));
+        }
+        else if (container->type == BITSET_CONTAINER_BITMAP)
+        {
+            for (uint32_t j = 0; j < BITSET_CONTAINER_WORDS; ++j)
+                for (uint64_t word = *((const uint64_t*)container->data + j); word; word &= word - 1u)
+                    if (base + j * 64u + bitset_ctz64(word) < destination->size)
+                        bitset_set(destination, base + j * 64u + bitset_ctz64(word));
+        }
+        else
+        {
+            for (uint32_t j = 0; j < container->length; ++j)
+            {
+                const uint64_t begin = base + *(values + 2u * j);
+                uint64_t end = begin + *(values + 2u * j + 1u) + 1u;
+                if (end > destination->size)
+                    end = destination->size;
+                if (begin < end)
+                    bitset_fill_in_range_begin_end(destination, true, begin, end);
+            }
+        }
+    }
+}
+
+/**
+ * Calculates the checksum of a byte array (64-bit multiply-rotate hash, processes a word at a time)
+ * @param data The array to hash
+ * @param size Size of the array in bytes
+ * @return The checksum
+ */
+BITSET_API uint64_t bitset_checksum_bytes(const uint8_t* const data, const uint64_t size)
+{
+    uint64_t hash = 0x9E3779B97F4A7C15ull ^ size;
+    uint64_t i = 0;
+    for (; i + 8u <= size; i += 8u)
+    {
+        uint64_t word;
+        memcpy(&word, data + i, sizeof(word));
+        hash ^= word * 0x87C37B91114253D5ull;
+        hash = (hash << 31 | hash >> 33) * 0x4CF5AD432745937Full;
+    }
+    uint64_t tail = 0;
+    for (uint64_t shift = 0; i < size; ++i, shift += 8u)
+        tail |= (uint64_t)*(data + i) << shift;
+    hash ^= tail * 0x87C37B91114253D5ull;
+
+    // final avalanche
+    hash ^= hash >> 33;
+    hash *= 0xFF51AFD7ED558CCDull;
+    hash ^= hash >> 33;
+    hash *= 0xC4CEB9FE1A85EC53ull;
+    return hash ^ hash >> 33;
+}
+
+/**
+ * Initializes the file header describing the bitset
+ * @param header Pointer to header to initialize
+ * @param bitset Pointer to bitset to describe (BitSet or DynamicBitSet)
+ */
+BITSET_API void bitset_file_header_init(bitset_file_header* const header, const BitSet* const bitset)
+{
+    memset(header, 0, sizeof(bitset_file_header));
+    header->magic = BITSET_FILE_MAGIC;
+    header->version = BITSET_FILE_VERSION;
+    header->byte_order = BITSET_FILE_BYTE_ORDER;
+    header->block_bits = BITSET_BLOCK_BITS;
+    header->header_size = sizeof(bitset_file_header);
+    header->size = bitset->size;
+    header->storage_size = bitset->storage_size;
+    header->checksum = bitset_checksum_bytes((const uint8_t*)bitset->data, bitset->storage_size * sizeof(bitset_block_t));
+}
+
+/**
+ * Checks that the file header can be used in place by this build (same version, byte order and block type)
+ * @param header Pointer to header to check
+ * @param file_size Size of the whole file in bytes
+ * @return Whether the blocks following the header can be used as they are
+ */
+BITSET_API bool bitset_file_header_check(const bitset_file_header* const header, const uint64_t file_size)
+{
+    return file_size >= sizeof(bitset_file_header)
+        && header->magic == BITSET_FILE_MAGIC
+        && header->version == BITSET_FILE_VERSION
+        && header->byte_order == BITSET_FILE_BYTE_ORDER
+        && header->block_bits == BITSET_BLOCK_BITS
+        && header->header_size == sizeof(bitset_file_header)
+        && header->storage_size == bitset_calculate_storage_size(header->size)
+        && header->storage_size <= (file_size - sizeof(bitset_file_header)) / sizeof(bitset_block_t)
+        && file_size - sizeof(bitset_file_header) == header->storage_size * sizeof(bitset_block_t);
+}
+
+/**
+ * Saves the bitset to a file (header followed by the blocks, see bitset_file_header)
+ * @memberof BitSet
+ * @param bitset Pointer to bitset to save (BitSet or DynamicBitSet)
+ * @param path Path of the file to create or overwrite
+ * @return Whether the file was written completely
+ */
+BITSET_API bool bitset_save_file(const BitSet* const bitset, const char* const path)
+{
+    FILE* const file = fopen(path, "wb");
+    if (!file)
+        return false;
+
+    bitset_file_header header;
+    bitset_file_header_init(&header, bitset);
+    bool written = fwrite(&header, sizeof(header), 1, file) == 1;
+    if (written && bitset->storage_size)
+        written = fwrite(bitset->data, sizeof(bitset_block_t), (size_t)bitset->storage_size, file) == bitset->storage_size;
+    return fclose(file) == 0 && written;
+}
+
+/**
+ * Size initialization from a file written by bitset_save_file, the blocks are read into memory (portable, verifies the checksum)
+ * @memberof DynamicBitSet
+ * @param bitset Pointer to bitset to initialize (left unchanged on failure)
+ * @param path Path of the file to read
+ * @return Whether the file was valid and read completely
+ */
+BITSET_API bool bitset_dynamic_load_file(DynamicBitSet* const bitset, const char* const path)
+{
+    FILE* const file = fopen(path, "rb");
+    if (!file)
+        return false;
+
+    bitset_file_header header;
+    bool valid = fread(&header, sizeof(header), 1, file) == 1 && fseek(file, 0, SEEK_END) == 0;
+    const long file_size = valid ? ftell(file) : -1;
+    valid = valid && file_size >= 0 && bitset_file_header_check(&header, (uint64_t)file_size) && fseek(file, (long)sizeof(header), SEEK_SET) == 0;
+
+    DynamicBitSet loaded;
+    if (valid)
+    {
+        bitset_dynamic_init_allocator(&loaded, header.size, NULL);
+        valid = (loaded.data || !loaded.storage_size)
+            && fread(loaded.data, sizeof(bitset_block_t), (size_t)loaded.storage_size, file) == loaded.storage_size
+            && bitset_checksum_bytes((const uint8_t*)loaded.data, loaded.storage_size * sizeof(bitset_block_t)) == header.checksum;
+        if (valid)
+            bitset_dynamic_move(bitset, &loaded);
+        else
+            bitset_dynamic_destroy(&loaded);
+    }
+    fclose(file);
+    return valid;
+}
+
+#ifdef BITSET_MAPPED_FILES
+/**
+ * Mapped bitsets never allocate new blocks
+ * @return NULL
+ */
+BITSET_API void* bitset_mapped_allocate(const uint64_t size, void* const context)
+{
+    (void)size;
+    (void)context;
+    return NULL;
+}
+
+/**
+ * Mapped blocks cannot be resized, so a mapped bitset keeps its capacity (see bitset_dynamic_map_file)
+ * @return NULL (the old mapping stays valid)
+ */
+BITSET_API void* bitset_mapped_reallocate(void* const pointer, const uint64_t old_size, const uint64_t new_size, void* const context)
+{
+    (void)pointer;
+    (void)old_size;
+    (void)new_size;
+    (void)context;
+    return NULL;
+}
+
+/**
+ * Unmaps the file of a mapped bitset
+ * @param pointer The blocks of the mapped bitset (the header precedes them)
+ * @param size Size of the blocks in bytes
+ * @param context Unused
+ */
+BITSET_API void bitset_mapped_deallocate(void* const pointer, const uint64_t size, void* const context)
+{
+    (void)context;
+    if (pointer)
+        munmap((uint8_t*)pointer - sizeof(bitset_file_header), (size_t)(sizeof(bitset_file_header) + size));
+}
+
+/**
+ * @return The allocator of the bitsets created by bitset_dynamic_map_file (bitset_dynamic_destroy unmaps the file)
+ */
+BITSET_API const bitset_allocator* bitset_mapped_allocator(void)
+{
+    static const bitset_allocator allocator = { bitset_mapped_allocate, bitset_mapped_reallocate, bitset_mapped_deallocate, NULL };
+    return &allocator;
+}
+
+/**
+ * Maps a file written by bitset_save_file straight into a bitset view, without reading or parsing the blocks
+ * The pages are loaded lazily on first access, so even huge files are ready instantly
+ * The view cannot grow past the mapped blocks (no push_back or resize beyond them, load the file to get a growable copy), bitset_dynamic_destroy unmaps the file
+ * @memberof DynamicBitSet
+ * @param bitset Pointer to bitset to initialize (left unchanged on failure)
+ * @param path Path of the file to map
+ * @param flags BITSET_MAP_READ_ONLY or BITSET_MAP_COPY_ON_WRITE, optionally combined with BITSET_MAP_VERIFY
+ * @return Whether the file was valid and mapped
+ */
+BITSET_API bool bitset_dynamic_map_file(DynamicBitSet* const bitset, const char* const path, const uint32_t flags)
+{
+    const int descriptor = open(path, O_RDONLY);
+    if (descriptor < 0)
+        return false;
+
+    struct stat status;
+    if (fstat(descriptor, &status) != 0 || (uint64_t)status.st_size < sizeof(bitset_file_header))
+    {
+        close(descriptor);
+        return false;
+    }
+
+    const bool copy_on_write = flags & BITSET_MAP_COPY_ON_WRITE;
+    void* const mapping = mmap(NULL, (size_t)status.st_size, copy_on_write ? PROT_READ | PROT_WRITE : PROT_READ, copy_on_write ? MAP_PRIVATE : MAP_SHARED, descriptor, 0);
+    close(descriptor); // the mapping keeps the file open
+    if (mapping == MAP_FAILED)
+        return false;
+
+    const bitset_file_header* const header = (const bitset_file_header*)mapping;
+    bitset_block_t* const data = (bitset_block_t*)((uint8_t*)mapping + sizeof(bitset_file_header));
+    if (!bitset_file_header_check(header, (uint64_t)status.st_size)
+        || ((flags & BITSET_MAP_VERIFY) && bitset_checksum_bytes((const uint8_t*)data, header->storage_size * sizeof(bitset_block_t)) != header->checksum))
+    {
+        munmap(mapping, (size_t)status.st_size);
+        return false;
+    }
+
+    bitset->data = data;
+    bitset->size = header->size;
+    bitset->storage_size = bitset->capacity = header->storage_size;
+    bitset->allocator = bitset_mapped_allocator();
+    return true;
+}
+#endif
+
+#ifdef BITSET_SHARED_MEMORY
+/**
+ * Calculates the size of a shared memory segment holding a bitset (header followed by the blocks, see bitset_file_header)
+ * The blocks are padded to whole 64-bit words, so an AtomicBitSet can attach to the segment
+ * @param storage_size Size of the bitset in blocks
+ * @return The size of the segment in bytes
+ */
+BITSET_API uint64_t bitset_shared_segment_size(const uint64_t storage_size)
+{
+    return sizeof(bitset_file_header) + (storage_size * sizeof(bitset_block_t) + 7u) / 8u * 8u;
+}
+
+/**
+ * Unmaps the shared memory segment of a bitset, including the padding of the blocks (see bitset_shared_segment_size)
+ * @param pointer The blocks of the mapped bitset (the header precedes them)
+ * @param size Size of the blocks in bytes
+ * @param context Unused
+ */
+BITSET_API void bitset_shared_deallocate(void* const pointer, const uint64_t size, void* const context)
+{
+    (void)context;
+    if (pointer)
+        munmap((uint8_t*)pointer - sizeof(bitset_file_header), (size_t)bitset_shared_segment_size(size / sizeof(bitset_block_t)));
+}
+
+/**
+ * @return The allocator of the bitsets created by bitset_dynamic_create_shared and bitset_dynamic_attach_shared (bitset_dynamic_destroy unmaps the segment)
+ */
+BITSET_API const bitset_allocator* bitset_shared_allocator(void)
+{
+    static const bitset_allocator allocator = { bitset_mapped_allocate, bitset_mapped_reallocate, bitset_shared_deallocate, NULL };
+    return &allocator;
+}
+
+/**
+ * Maps a shared memory segment created by bitset_dynamic_create_shared and checks its header
+ * @param name Name of the segment (e.g. "/filters")
+ * @param flags BITSET_MAP_READ_ONLY, BITSET_MAP_COPY_ON_WRITE or BITSET_MAP_SHARED_WRITE, optionally combined with BITSET_MAP_VERIFY
+ * @return The header of the mapped segment (the blocks follow it), NULL if the segment is missing, incomplete or not compatible
+ */
+BITSET_API bitset_file_header* bitset_shared_map(const char* const name, const uint32_t flags)
+{
+    const bool shared_write = flags & BITSET_MAP_SHARED_WRITE;
+    const int descriptor = shm_open(name, shared_write ? O_RDWR : O_RDONLY, 0);
+    if (descriptor < 0)
+        return NULL;
+
+    struct stat status;
+    if (fstat(descriptor, &status) != 0 || (uint64_t)status.st_size < sizeof(bitset_file_header))
+    {
+        close(descriptor);
+        return NULL;
+    }
+
+    const bool copy_on_write = !shared_write && (flags & BITSET_MAP_COPY_ON_WRITE);
+    void* const mapping = mmap(NULL, (size_t)status.st_size, shared_write || copy_on_write ? PROT_READ | PROT_WRITE : PROT_READ, copy_on_write ? MAP_PRIVATE : MAP_SHARED, descriptor, 0);
+    close(descriptor); // the mapping keeps the segment open
+    if (mapping == MAP_FAILED)
+        return NULL;
+
+    // the magic is published last by the creator, a segment still being filled is rejected
+    bitset_file_header* const header = (bitset_file_header*)mapping;
+    const uint64_t segment_size = (uint64_t)status.st_size;
+    if (__atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) != BITSET_FILE_MAGIC
+        || header->storage_size > (segment_size - sizeof(bitset_file_header)) / sizeof(bitset_block_t)
+        || !bitset_file_header_check(header, sizeof(bitset_file_header) + header->storage_size * sizeof(bitset_block_t))
+        || segment_size != bitset_shared_segment_size(header->storage_size)
+        || ((flags & BITSET_MAP_VERIFY) && bitset_checksum_bytes((const uint8_t*)(header + 1), header->storage_size * sizeof(bitset_block_t)) != header->checksum))
+    {
+        munmap(mapping, (size_t)status.st_size);
+        return NULL;
+    }
+    return header;
+}
+
+/**
+ * Creates a named POSIX shared memory segment holding a copy of the bitset, other processes attach to it without copying (see bitset_dynamic_attach_shared)
+ * The segment is self-describing (bitset_file_header followed by the blocks), it persists until bitset_unlink_shared even if no process has it mapped
+ * Programs linked against glibc older than 2.34 need -lrt
+ * @memberof DynamicBitSet
+ * @param bitset Pointer to bitset to initialize as a writable view of the segment (left unchanged on failure), bitset_dynamic_destroy unmaps it
+ * @param name Name of the segment (e.g. "/filters"), an existing segment is never replaced
+ * @param source Pointer to bitset (BitSet or DynamicBitSet) to copy into the segment, the checksum of the header covers these blocks
+ * @return Whether the segment was created
+ */
+BITSET_API bool bitset_dynamic_create_shared(DynamicBitSet* const bitset, const char* const name, const BitSet* const source)
+{
+    const int descriptor = shm_open(name, O_RDWR | O_CREAT | O_EXCL, BITSET_SHARED_MODE);
+    if (descriptor < 0)
+        return false;
+
+    const uint64_t segment_size = bitset_shared_segment_size(source->storage_size);
+    void* mapping = MAP_FAILED;
+    if (ftruncate(descriptor, (off_t)segment_size) == 0)
+        mapping = mmap(NULL, (size_t)segment_size, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+    close(descriptor);
+    if (mapping == MAP_FAILED)
+    {
+        shm_unlink(name);
+        return false;
+    }
+
+    // the segment starts zeroed, so attachers reject it until the magic is published
+    bitset_file_header header;
+    bitset_file_header_init(&header, source);
+    header.magic = 0;
+    memcpy(mapping, &header, sizeof(bitset_file_header));
+    bitset_block_t* const data = (bitset_block_t*)((uint8_t*)mapping + sizeof(bitset_file_header));
+    if (source->storage_size)
+        memcpy(data, source->data, source->storage_size * sizeof(bitset_block_t));
+    __atomic_store_n(&((bitset_file_header*)mapping)->magic, BITSET_FILE_MAGIC, __ATOMIC_RELEASE);
+
+    bitset->data = data;
+    bitset->size = source->size;
+    bitset->storage_size = bitset->capacity = source->storage_size;
+    bitset->allocator = bitset_shared_allocator();
+    return true;
+}
+
+/**
+ * Attaches to a shared memory segment created by bitset_dynamic_create_shared, the blocks are mapped and never copied
+ * The view cannot grow past the mapped blocks (like bitset_dynamic_map_file), bitset_dynamic_destroy unmaps the segment
+ * Concurrent plain writes from several processes race, use BITSET_MAP_SHARED_WRITE with a single writer or AtomicBitSet (bitset_atomic_attach_shared)
+ * @memberof DynamicBitSet
+ * @param bitset Pointer to bitset to initialize (left unchanged on failure)
+ * @param name Name of the segment
+ * @param flags BITSET_MAP_READ_ONLY, BITSET_MAP_COPY_ON_WRITE or BITSET_MAP_SHARED_WRITE, optionally combined with BITSET_MAP_VERIFY (fails once the blocks were modified)
+ * @return Whether the segment was valid and mapped
+ */
+BITSET_API bool bitset_dynamic_attach_shared(DynamicBitSet* const bitset, const char* const name, const uint32_t flags)
+{
+    bitset_file_header* const header = bitset_shared_map(name, flags);
+    if (!header)
+        return false;
+
+    bitset->data = (bitset_block_t*)((uint8_t*)header + sizeof(bitset_file_header));
+    bitset->size = header->size;
+    bitset->storage_size = bitset->capacity = header->storage_size;
+    bitset->allocator = bitset_shared_allocator();
+    return true;
+}
+
+/**
+ * Removes the name of a shared memory segment, the memory is released once every process unmapped it
+ * @param name Name of the segment
+ * @return Whether the name was removed
+ */
+BITSET_API bool bitset_unlink_shared(const char* const name)
+{
+    return shm_unlink(name) == 0;
+}
+
+#ifdef BITSET_ATOMICS
+/**
+ * Attaches an atomic bitset to a shared memory segment created by bitset_dynamic_create_shared, for lock-free updates from several processes
+ * The blocks are read as 64-bit atomic words (the same bits on little-endian machines, big-endian ones need 64-bit blocks)
+ * The atomic operations have to be lock-free (address-free), which holds for 64-bit words on the common 64-bit targets
+ * @memberof AtomicBitSet
+ * @param bitset Pointer to bitset to initialize (left unchanged on failure), detach it with bitset_atomic_detach_shared instead of bitset_atomic_destroy
+ * @param name Name of the segment
+ * @return Whether the segment was valid and mapped
+ */
+BITSET_API bool bitset_atomic_attach_shared(AtomicBitSet* const bitset, const char* const name)
+{
+    bitset_file_header* const header = bitset_shared_map(name, BITSET_MAP_SHARED_WRITE);
+    if (!header)
+        return false;
+#ifndef BITSET_LITTLE_ENDIAN
+    if (BITSET_BLOCK_BITS != 64u)
+    {
+        munmap(header, (size_t)bitset_shared_segment_size(header->storage_size));
+        return false;
+    }
+#endif
+
+    bitset->data = (_Atomic uint64_t*)((uint8_t*)header + sizeof(bitset_file_header));
+    bitset->size = header->size;
+    bitset->storage_size = bitset_calculate_word_count(header->size);
+    return true;
+}
+
+/**
+ * Unmaps a shared memory segment attached with bitset_atomic_attach_shared (the segment itself stays, see bitset_unlink_shared)
+ * @memberof AtomicBitSet
+ * @param bitset Pointer to bitset to detach
+ */
+BITSET_API void bitset_atomic_detach_shared(AtomicBitSet* const bitset)
+{
+    if (bitset->data)
+        munmap((uint8_t*)bitset->data - sizeof(bitset_file_header), (size_t)bitset_shared_segment_size(bitset_calculate_storage_size(bitset->size)));
+    bitset->data = NULL;
+    bitset->size = 0;
+    bitset->storage_size = 0;
+}
+#endif
+#endif
+
+/**
+ * Stores a 64-bit value as 8 little-endian bytes
+ * @param bytes Where to store the value
+ * @param value The value to store
+ */
+BITSET_API void bitset_store_le64(uint8_t* const bytes, const uint64_t value)
+{
+    for (uint64_t i = 0; i < 8u; ++i)
+        *(bytes + i) = (uint8_t)(value >> i * 8u);
+}
+
+/**
+ * Loads a 64-bit value from 8 little-endian bytes
+ * @param bytes The bytes to load
+ * @return The loaded value
+ */
+BITSET_API uint64_t bitset_load_le64(const uint8_t* const bytes)
+{
+    uint64_t value = 0;
+    for (uint64_t i = 0; i < 8u; ++i)
+        value |= (uint64_t)*(bytes + i) << i * 8u;
+    return value;
+}
+
+/**
+ * Passes the buffered bytes to the sink
+ * @param writer Pointer to writer to flush
+ */
+BITSET_API void bitset_stream_flush(bitset_stream_writer* const writer)
+{
+    if (writer->used && writer->valid)
+        writer->valid = writer->sink(writer->buffer, writer->used, writer->context);
+    writer->used = 0;
+}
+
+/**
+ * Appends bytes to the stream, full chunks are passed to the sink
+ * @param writer Pointer to writer to append to
+ * @param data The bytes to append
+ * @param size Number of bytes
+ */
+BITSET_API void bitset_stream_put(bitset_stream_writer* const writer, const uint8_t* const data, const uint64_t size)
+{
+    for (uint64_t offset = 0; offset < size && writer->valid;)
+    {
+        uint64_t bytes = BITSET_STREAM_CHUNK_SIZE - writer->used;
+        if (bytes > size - offset)
+            bytes = size - offset;
+        memcpy(writer->buffer + writer->used, data + offset, bytes);
+        writer->used += bytes;
+        offset += bytes;
+        if (writer->used == BITSET_STREAM_CHUNK_SIZE)
+            bitset_stream_flush(writer);
+    }
+}
+
+/**
+ * Appends a little-endian 64-bit word to the stream
+ * @param writer Pointer to writer to append to
+ * @param word The word to append
+ */
+BITSET_API void bitset_stream_put_word(bitset_stream_writer* const writer, const uint64_t word)
+{
+    uint8_t bytes[8];
+    bitset_store_le64(bytes, word);
+    bitset_stream_put(writer, bytes, sizeof(bytes));
+}
+
+/**
+ * Retrieves the 64-bit word at the specified index with the bits past the size cleared
+ * @param bitset Pointer to bitset to read from
+ * @param index Index of the word to read (word index)
+ * @return The word at the specified index
+ */
+BITSET_API uint64_t bitset_stream_word(const BitSet* const bitset, const uint64_t index)
+{
+    const uint64_t word = bitset_get_word(bitset, index);
+    return index == bitset->size / 64u && bitset->size % 64u ? word & (UINT64_MAX >> (64u - bitset->size % 64u)) : word;
+}
+
+/**
+ * Writes the bitset to a stream (header followed by the encoded 64-bit words), in chunks of BITSET_STREAM_CHUNK_SIZE bytes
+ * The stream is independent of the block type and byte order, so it can be read by any build
+ * @memberof BitSet
+ * @param bitset Pointer to bitset to write (BitSet or DynamicBitSet)
+ * @param sink The callback receiving the chunks
+ * @param context Pointer passed to the sink
+ * @param encoding BITSET_STREAM_RAW, or BITSET_STREAM_WAH for mostly empty or mostly full bitsets
+ * @return Whether the sink accepted the whole stream
+ */
+BITSET_API bool bitset_write(const BitSet* const bitset, const bitset_stream_sink sink, void* const context, const bitset_stream_encoding encoding)
+{
+    bitset_stream_writer writer;
+    writer.sink = sink;
+    writer.context = context;
+    writer.used = 0;
+    writer.valid = true;
+
+    uint8_t header[BITSET_STREAM_HEADER_SIZE];
+    bitset_store_le64(header, BITSET_STREAM_MAGIC);
+    bitset_store_le64(header + 8, (uint64_t)encoding << 32 | BITSET_STREAM_VERSION);
+    bitset_store_le64(header + 16, bitset->size);
+    bitset_stream_put(&writer, header, sizeof(header));
+
+    const uint64_t words = (bitset->size + 63u) / 64u;
+    if (encoding == BITSET_STREAM_RAW)
+    {
+#ifdef BITSET_LITTLE_ENDIAN
+        // the blocks already are little-endian words, all but the (masked) last one go to the sink without copying
+        bitset_stream_flush(&writer);
+        const uint8_t* const bytes = (const uint8_t*)bitset->data;
+        for (uint64_t offset = 0; words && offset < (words - 1u) * 8u && writer.valid; offset += BITSET_STREAM_CHUNK_SIZE)
+        {
+            const uint64_t size = (words - 1u) * 8u - offset < BITSET_STREAM_CHUNK_SIZE ? (words - 1u) * 8u - offset : BITSET_STREAM_CHUNK_SIZE;
+            writer.valid = sink(bytes + offset, size, context);
+        }
+        if (words)
+            bitset_stream_put_word(&writer, bitset_stream_word(bitset, words - 1u));
+#else
+        for (uint64_t i = 0; i < words && writer.valid; ++i)
+            bitset_stream_put_word(&writer, bitset_stream_word(bitset, i));
+#endif
+    }
+    else
+    {
+        for (uint64_t i = 0; i < words && writer.valid;)
+        {
+            // run of empty or full words
+            const uint64_t first = bitset_stream_word(bitset, i);
+            uint64_t run = 0;
+            if (first == 0 || first == UINT64_MAX)
+                while (i + run < words && run < UINT32_MAX && bitset_stream_word(bitset, i + run) == first)
+                    ++run;
+
+            // followed by the literal words up to the next run
+            uint64_t literals = 0;
+            while (i + run + literals < words && literals < (UINT32_MAX >> 1))
+            {
+                const uint64_t word = bitset_stream_word(bitset, i + run + literals);
+                if (word == 0 || word == UINT64_MAX)
+                    break;
+                ++literals;
+            }
+
+            bitset_stream_put_word(&writer, literals << 33 | (uint64_t)(run && first) << 32 | run);
+            for (uint64_t j = 0; j < literals; ++j)
+                bitset_stream_put_word(&writer, bitset_stream_word(bitset, i + run + j));
+            i += run + literals;
+        }
+    }
+    bitset_stream_flush(&writer);
+    return writer.valid;
+}
+
+/**
+ * Reads little-endian words from a stream into the bitset, straight into its blocks on little-endian machines
+ * @param bitset Pointer to bitset to store the words to
+ * @param first Index of the first word to store (word index)
+ * @param count Number of words to read
+ * @param source The callback providing the bytes
+ * @param context Pointer passed to the source
+ * @return Whether all of the words were read
+ */
+BITSET_API bool bitset_stream_read_words(BitSet* const bitset, const uint64_t first, const uint64_t count, const bitset_stream_source source, void* const context)
+{
+#ifdef BITSET_LITTLE_ENDIAN
+    // the stream bytes past the storage belong to the zero padding of the last word
+    const uint64_t storage_bytes = bitset->storage_size * sizeof(bitset_block_t);
+    const uint64_t end = (first + count) * 8u;
+    const uint64_t direct_end = end < storage_bytes ? end : storage_bytes;
+    uint64_t offset = first * 8u;
+    while (offset < direct_end)
+    {
+        const uint64_t size = direct_end - offset < BITSET_STREAM_CHUNK_SIZE ? direct_end - offset : BITSET_STREAM_CHUNK_SIZE;
+        if (!source((uint8_t*)bitset->data + offset, size, context))
+            return false;
+        offset += size;
+    }
+    if (offset < end)
+    {
+        uint8_t padding[8];
+        return source(padding, end - offset, context);
+    }
+    return true;
+#else
+    uint8_t buffer[BITSET_STREAM_CHUNK_SIZE];
+    for (uint64_t done = 0; done < count;)
+    {
+        const uint64_t words = count - done < BITSET_STREAM_CHUNK_SIZE / 8u ? count - done : BITSET_STREAM_CHUNK_SIZE / 8u;
+        if (!source(buffer, words * 8u, context))
+            return false;
+        for (uint64_t i = 0; i < words; ++i)
+            bitset_update_word(bitset, first + done + i, UINT64_MAX, bitset_load_le64(buffer + i * 8u));
+        done += words;
+    }
+    return true;
+#endif
+}
+
+/**
+ * Reads and checks the header of a stream
+ * @param size Where to store the size of the streamed bitset (bit size)
+ * @param encoding Where to store the encoding of the words
+ * @param source The callback providing the bytes
+ * @param context Pointer passed to the source
+ * @return Whether the header is a valid header of a supported version
  */
-typedef struct
+BITSET_API bool bitset_stream_read_header(uint64_t* const size, bitset_stream_encoding* const encoding, const bitset_stream_source source, void* const context)
 {
-    /**
-     * Underlying array of bytes containing the bits
-     */
-    uint8_t data[BITSET_SIZE];
-    /**
-     * Size of bitset in bits
-     */
-    uint64_t size;
-    /**
-     * Size of bitset in bytes
-    */
-    uint64_t storage_size;
-} BitSet;
+    uint8_t header[BITSET_STREAM_HEADER_SIZE];
+    if (!source(header, sizeof(header), context) || bitset_load_le64(header) != BITSET_STREAM_MAGIC)
+        return false;
+    const uint64_t version = bitset_load_le64(header + 8);
+    if ((version & UINT32_MAX) != BITSET_STREAM_VERSION || (version >> 32 != BITSET_STREAM_RAW && version >> 32 != BITSET_STREAM_WAH))
+        return false;
+    *encoding = (bitset_stream_encoding)(version >> 32);
+    *size = bitset_load_le64(header + 16);
+    return true;
+}
 
 /**
- * Casts the bitset to the universal bitset type (used with dynamic bitset)
- * @param bitset The bitset to cast
+ * Reads the encoded words of a stream into a bitset of the streamed size
+ * @param bitset Pointer to bitset to store the bits to
+ * @param encoding The encoding of the words (from bitset_stream_read_header)
+ * @param source The callback providing the bytes
+ * @param context Pointer passed to the source
+ * @return Whether the words were valid and read completely
  */
-#define UNIVERSAL_BITSET(bitset) (BitSet*)(bitset)
+BITSET_API bool bitset_stream_read_payload(BitSet* const bitset, const bitset_stream_encoding encoding, const bitset_stream_source source, void* const context)
+{
+    const uint64_t words = (bitset->size + 63u) / 64u;
+    if (encoding == BITSET_STREAM_RAW)
+        return bitset_stream_read_words(bitset, 0, words, source, context);
 
-inline void bitset_dynamic_init(DynamicBitSet* const bitset, const uint64_t size);
-inline void bitset_init(BitSet* const bitset);
-inline void bitset_dynamic_init_block(DynamicBitSet* const bitset, const uint64_t size, const uint8_t block);
-inline void bitset_init_block(BitSet* const bitset, const uint8_t block);
-inline void bitset_dynamic_destroy(const DynamicBitSet* const bitset);
-inline void bitset_copy_from(BitSet* const destination, const BitSet* const source);
-inline void bitset_dynamic_move_from(DynamicBitSet* const destination, DynamicBitSet* const source);
-inline bool bitset_get(const BitSet* const bitset, const uint64_t index);
-inline void bitset_set_value(BitSet* const bitset, const uint64_t value, const uint64_t index);
-inline void bitset_set(BitSet* const bitset, const uint64_t index); 
-inline void bitset_clear(BitSet* const bitset, const uint64_t index);
-inline void bitset_fill_all(BitSet* const bitset, const bool value);
-inline void bitset_clear_all(BitSet* const bitset);
-inline void bitset_set_all(BitSet* const bitset);
-inline void bitset_fill_in_range_end(BitSet* const bitset, const bool value, const uint64_t end);
-inline void bitset_clear_in_range_end(BitSet* const bitset, const uint64_t end);
-inline void bitset_set_in_range_end(BitSet* const bitset, const uint64_t end);
-inline void bitset_fill_in_range_begin_end(BitSet* const bitset, const bool value, const uint64_t begin, const uint64_t end);
-inline void bitset_clear_in_range_begin_end(BitSet* const bitset, const uint64_t begin, const uint64_t end);
-inline void bitset_set_in_range_begin_end(BitSet* const bitset, const uint64_t begin, const uint64_t end);
-inline void bitset_fill_in_range_begin_end_step(BitSet* const bitset, const bool value, const uint64_t begin, const uint64_t end, const uint64_t step);
-inline void bitset_clear_in_range_begin_end_step(BitSet* const bitset, const uint64_t begin, const uint64_t end, const uint64_t step);
-inline void bitset_set_in_range_begin_end_step(BitSet* const bitset, const uint64_t begin, const uint64_t end, const uint64_t step);
-inline void bitset_set_block(BitSet* const bitset, const uint8_t block, const uint64_t index);
-inline void bitset_fill_block(BitSet* const bitset, const uint8_t value);
-inline void bitset_fill_block_in_range_end(BitSet* const bitset, const uint8_t block, const uint64_t end);
-inline void bitset_fill_block_in_range_begin_end(BitSet* const bitset, const uint8_t block, const uint64_t begin, const uint64_t end);
-inline void bitset_fill_block_in_range_begin_end_step(BitSet* const bitset, const uint8_t block, const uint64_t begin, const uint64_t end, const uint64_t step);
-inline void bitset_flip(BitSet* const bitset, const uint64_t index);
-inline void bitset_flip_all(BitSet* const bitset);
-inline void bitset_flip_in_range_end(BitSet* const bitset, const uint64_t end);
-inline void bitset_flip_in_range_begin_end(BitSet* const bitset, const uint64_t begin, const uint64_t end);
-inline void bitset_flip_in_range_begin_end_step(BitSet* const bitset, const uint64_t begin, const uint64_t end, const uint64_t step);
-inline void bitset_flip_block(BitSet* const bitset, const uint64_t index);
-inline void bitset_flip_all_blocks(BitSet* const bitset);
-inline void bitset_flip_block_in_range_end(BitSet* const bitset, const uint64_t end);
-inline void bitset_flip_block_in_range_begin_end(BitSet* const bitset, const uint64_t begin, const uint64_t end);
-inline void bitset_flip_block_in_range_begin_end_step(BitSet* const bitset, const uint64_t begin, const uint64_t end, const uint64_t step);
-inline uint8_t bitset_get_block(const BitSet* const bitset, const uint64_t index);
-inline bool bitset_all(const BitSet* const bitset);
-inline bool bitset_any(const BitSet* const bitset);
-inline bool bitset_none(const BitSet* const bitset);
-inline bool bitset_all_cleared(const BitSet* const bitset);
-inline uint64_t bitset_count(const BitSet* const bitset);
-inline bool bitset_empty(const BitSet* const bitset);
-inline void bitset_dynamic_push_back(DynamicBitSet* const bitset, const bool value);
-inline void bitset_dynamic_pop_back(DynamicBitSet* const bitset);
-inline void bitset_dynamic_push_back_block(DynamicBitSet* const bitset, const uint8_t block);
-inline void bitset_dynamic_pop_back_block(DynamicBitSet* const bitset);
-inline void bitset_dynamic_resize(DynamicBitSet* const bitset, const uint64_t new_size);
-inline const uint64_t bitset_calculate_storage_size(const uint64_t size);
-inline const uint8_t bitset_create_filled_block(const bool value);
+    for (uint64_t i = 0; i < words;)
+    {
+        uint8_t bytes[8];
+        if (!source(bytes, sizeof(bytes), context))
+            return false;
+        const uint64_t marker = bitset_load_le64(bytes);
+        const uint64_t run = marker & UINT32_MAX, literals = marker >> 33;
+        if (!(run + literals) || run + literals > words - i)
+            return false;
+        if (run)
+            bitset_fill_in_range_begin_end(bitset, (marker >> 32) & 1u, i * 64u, (i + run) * 64u < bitset->size ? (i + run) * 64u : bitset->size);
+        if (!bitset_stream_read_words(bitset, i + run, literals, source, context))
+            return false;
+        i += run + literals;
+    }
+    return true;
+}
 
 /**
- * Size initialization
- * @param bitset Pointer to bitset to initialize
- * @param size The size of the bitset to be initialized
- * @memberof DynamicBitSet
+ * Reads a stream written by bitset_write into a bitset of the streamed size, in chunks of BITSET_STREAM_CHUNK_SIZE bytes
+ * The words are read straight into the blocks (no intermediate buffer on little-endian machines)
+ * @memberof BitSet
+ * @param bitset Pointer to bitset to read into (BitSet or DynamicBitSet), its size has to match the streamed one
+ * @param source The callback providing the bytes
+ * @param context Pointer passed to the source
+ * @return Whether the stream was valid, of the same size and read completely
  */
-inline void bitset_dynamic_init(DynamicBitSet* const bitset, const uint64_t size) 
+BITSET_API bool bitset_read(BitSet* const bitset, const bitset_stream_source source, void* const context)
 {
-    bitset->size = size;
-    bitset->storage_size = size / 8u + (size % 8u ? 1 : 0);
-    bitset->data = (uint8_t*)calloc(bitset->storage_size * sizeof(uint8_t), sizeof(uint8_t));
+    uint64_t size;
+    bitset_stream_encoding encoding;
+    return bitset_stream_read_header(&size, &encoding, source, context) && size == bitset->size && bitset_stream_read_payload(bitset, encoding, source, context);
 }
 
 /**
- * Size initialization
- * @param bitset Pointer to bitset to initialize
- * @param size The size of the bitset to be initialized
- * @memberof BitSet
+ * Reads a stream written by bitset_write, resizing the bitset to the streamed size (no reallocation if its capacity suffices)
+ * @memberof DynamicBitSet
+ * @param bitset Pointer to bitset to read into
+ * @param source The callback providing the bytes
+ * @param context Pointer passed to the source
+ * @return Whether the stream was valid and read completely
  */
-inline void bitset_init(BitSet* const bitset)
+BITSET_API bool bitset_dynamic_read(DynamicBitSet* const bitset, const bitset_stream_source source, void* const context)
 {
-    bitset->size = BITSET_SIZE;
-    bitset->storage_size = BITSET_SIZE / 8u + (BITSET_SIZE % 8u ? 1 : 0);
-    memset(bitset->data, 0, BITSET_SIZE * sizeof(uint8_t));
+    uint64_t size;
+    bitset_stream_encoding encoding;
+    if (!bitset_stream_read_header(&size, &encoding, source, context))
+        return false;
+    bitset_dynamic_resize(bitset, size);
+    if (bitset->size != size)
+        return false; // the resize failed
+    return bitset_stream_read_payload(UNIVERSAL_BITSET(bitset), encoding, source, context);
 }
 
 /**
- * Size and value initialization
- * @param bitset Pointer to bitset to initialize
- * @param size The size of the bitset to be initialized
- * @param block The block to fill the bitset with (block value)
- * @memberof DynamicBitSet
+ * Stream sink writing to a FILE* (pass the FILE* as the context)
  */
-inline void bitset_dynamic_init_block(DynamicBitSet* const bitset, const uint64_t size, const uint8_t block) 
+BITSET_API bool bitset_stream_file_sink(const void* const data, const uint64_t size, void* const context)
 {
-    bitset->size = size;
-    bitset->storage_size = size / 8u + (size % 8u ? 1 : 0);
-    bitset->data = (uint8_t*)malloc(bitset->storage_size * sizeof(uint8_t));
-    memset(bitset->data, block, bitset->storage_size * sizeof(uint8_t));
+    return fwrite(data, 1, (size_t)size, (FILE*)context) == size;
 }
 
 /**
- * Size and value initialization
- * @param bitset Pointer to bitset to initialize
- * @param size The size of the bitset to be initialized
- * @param block The block to fill the bitset with (block value)
- * @memberof BitSet
+ * Stream source reading from a FILE* (pass the FILE* as the context)
  */
-inline void bitset_init_block(BitSet* const bitset, const uint8_t block)
+BITSET_API bool bitset_stream_file_source(void* const data, const uint64_t size, void* const context)
 {
-    bitset->size = BITSET_SIZE;
-    bitset->storage_size = BITSET_SIZE / 8u + (BITSET_SIZE % 8u ? 1 : 0);
-    memset(bitset->data, block, BITSET_SIZE * sizeof(uint8_t));
+    return fread(data, 1, (size_t)size, (FILE*)context) == size;
 }
 
 /**
- * Destroys the bitset (frees the memory)
- * @param bitset Pointer to bitset to destroy
- * @memberof BitSet
+ * Finds the set bit with the specified rank in a word
+ * @param word The word to search
+ * @param rank Number of set bits below the bit to find, has to be below the popcount of word
+ * @return Index of the bit within the word
  */
-inline void bitset_dynamic_destroy(DynamicBitSet* bitset) 
+BITSET_API uint64_t bitset_select_word(uint64_t word, uint64_t rank)
 {
-    free(bitset->data);
+#if defined(__BMI2__) && (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+    return bitset_ctz64(_pdep_u64((uint64_t)1u << rank, word));
+#else
+    // halve the word 6 times, keeping the half that holds the bit
+    uint64_t position = 0;
+    for (uint64_t width = 32u; width; width >>= 1)
+    {
+        const uint64_t low = bitset_popcount64(word & (((uint64_t)1u << width) - 1u));
+        if (rank >= low)
+        {
+            rank -= low;
+            word >>= width;
+            position += width;
+        }
+    }
+    return position;
+#endif
 }
 
 /**
- * Copies the data from one bitset to another
- * @param destination Pointer to bitset to copy to
- * @param source Pointer to bitset to copy from
- * @memberof BitSet
+ * Builds the rank/select index of a bitset (one pass over its words)
+ * @memberof BitSetRankIndex
+ * @param index Pointer to index to initialize
+ * @param bitset Pointer to bitset to index, has to outlive the index and must not be modified while indexed
+ * @return Whether the memory of the index could be allocated (the index is empty otherwise)
  */
-inline void bitset_copy(BitSet* const destination, const BitSet* const source) 
+BITSET_API bool bitset_rank_index_init(BitSetRankIndex* const index, const BitSet* const bitset)
 {
-    for (uint64_t i = 0; i < destination->size; ++i)
-        *(destination->data + i) = *(source->data + i);
+    const uint64_t words = bitset_calculate_word_count(bitset->size);
+    const uint64_t words_per_block = BITSET_RANK_BLOCK_BITS / 64u, words_per_subblock = BITSET_RANK_SUBBLOCK_BITS / 64u;
+
+    index->bitset = bitset;
+    index->block_count = words / words_per_block + (words % words_per_block ? 1 : 0);
+    index->region_count = index->block_count ? (index->block_count - 1u) / BITSET_RANK_REGION_BLOCKS + 1u : 1u;
+    index->count = bitset_count(bitset);
+    index->sample_count = index->count / BITSET_SELECT_SAMPLE + (index->count % BITSET_SELECT_SAMPLE ? 1 : 0);
+    index->regions = (uint64_t*)bitset_allocate(NULL, index->region_count * sizeof(uint64_t));
+    index->blocks = (uint64_t*)bitset_allocate(NULL, (index->block_count ? index->block_count : 1u) * sizeof(uint64_t));
+    index->samples = (uint64_t*)bitset_allocate(NULL, (index->sample_count ? index->sample_count : 1u) * sizeof(uint64_t));
+    // throw exception in safe version
+    if (!index->regions || !index->blocks || !index->samples)
+    {
+        bitset_rank_index_destroy(index);
+        return false;
+    }
+
+    uint64_t total = 0, sample = 0;
+    *index->regions = 0;
+    for (uint64_t block = 0; block < index->block_count; ++block)
+    {
+        if (!(block % BITSET_RANK_REGION_BLOCKS))
+            *(index->regions + block / BITSET_RANK_REGION_BLOCKS) = total;
+
+        uint64_t entry = total - *(index->regions + block / BITSET_RANK_REGION_BLOCKS), block_total = 0;
+        for (uint64_t sub = 0; sub < BITSET_RANK_BLOCK_BITS / BITSET_RANK_SUBBLOCK_BITS; ++sub)
+        {
+            uint64_t sub_total = 0;
+            const uint64_t first = block * words_per_block + sub * words_per_subblock;
+            for (uint64_t word = first; word < first + words_per_subblock && word < words; ++word)
+                sub_total += bitset_popcount64(bitset_get_word_below(bitset, word, bitset->size));
+            // the last sub-block count is implied by the next entry
+            if (sub < 3u)
+                entry |= sub_total << (32u + sub * 10u);
+            block_total += sub_total;
+        }
+        *(index->blocks + block) = entry;
+
+        // samples of the set bits numbered total .. total + block_total - 1
+        for (; sample < index->sample_count && sample * BITSET_SELECT_SAMPLE < total + block_total; ++sample)
+            *(index->samples + sample) = block;
+        total += block_total;
+    }
+    return true;
 }
 
 /**
- * Moves the data from one bitset to another
- * @param destination Pointer to bitset to move to
- * @param source Pointer to bitset to move from
- * @memberof BitSet
+ * Frees the memory of the index (the bitset is left untouched)
+ * @memberof BitSetRankIndex
+ * @param index Pointer to index to destroy
  */
-inline void bitset_dynamic_move(DynamicBitSet* const destination, DynamicBitSet* const source) 
+BITSET_API void bitset_rank_index_destroy(BitSetRankIndex* const index)
 {
-    destination->size = source->size;
-    destination->data = source->data;
-    source->size = 0;
-    source->data = NULL;
+    bitset_deallocate(NULL, index->regions, index->region_count * sizeof(uint64_t));
+    bitset_deallocate(NULL, index->blocks, (index->block_count ? index->block_count : 1u) * sizeof(uint64_t));
+    bitset_deallocate(NULL, index->samples, (index->sample_count ? index->sample_count : 1u) * sizeof(uint64_t));
+    index->regions = index->blocks = index->samples = NULL;
+    index->block_count = index->region_count = index->sample_count = index->count = 0;
 }
 
 /**
- * Sets the value of a bit at a specified index
- * @param bitset Pointer to bitset to modify
- * @param value The value to set the bit to
- * @param index The index of the bit to modify (bit index)
- * @memberof BitSet
+ * @memberof BitSetRankIndex
+ * @param index Pointer to index to read
+ * @param block Index of the block, in range [0, block_count] (block_count gives the total count)
+ * @return Number of set bits before the block
  */
-inline void bitset_set_value(BitSet* const bitset, const uint64_t value, const uint64_t index) 
+BITSET_API uint64_t bitset_rank_index_block_rank(const BitSetRankIndex* const index, const uint64_t block)
 {
-    if (value)
-        *(bitset->data + index / 8) |= (uint8_t)1u << index % sizeof(uint8_t);
-    else
-        *(bitset->data + index / 8) &= ~((uint8_t)1u << index % sizeof(uint8_t));
+    if (block >= index->block_count)
+        return index->count;
+    return *(index->regions + block / BITSET_RANK_REGION_BLOCKS) + (*(index->blocks + block) & UINT32_MAX);
 }
 
 /**
- * Retrieves the value of a bit at a specified index
- * @param bitset Pointer to bitset to read from
- * @param index The index of the bit to read (bit index)
- * @return The value of the bit at the specified index
- * @memberof BitSet
+ * Counts the set bits before the specified position in O(1) (two lookups and at most 7 popcounts)
+ * @memberof BitSetRankIndex
+ * @param index Pointer to index of the bitset
+ * @param position End of the counted range, exclusive (bit index, positions past the size count the whole bitset)
+ * @return Number of set bits in [0, position)
  */
-inline bool bitset_get(const BitSet* const bitset, const uint64_t index) {
-    return (*(bitset->data + index / 8u) & (uint8_t)1u << index % 8u);
+BITSET_API uint64_t bitset_rank(const BitSetRankIndex* const index, const uint64_t position)
+{
+    if (position >= index->bitset->size)
+        return index->count;
+
+    const uint64_t block = position / BITSET_RANK_BLOCK_BITS, sub = position % BITSET_RANK_BLOCK_BITS / BITSET_RANK_SUBBLOCK_BITS;
+    const uint64_t entry = *(index->blocks + block);
+    uint64_t rank = bitset_rank_index_block_rank(index, block);
+    for (uint64_t i = 0; i < sub; ++i)
+        rank += entry >> (32u + i * 10u) & 1023u;
+
+    // every word before the one holding position lies entirely inside the bitset
+    const uint64_t last = position / 64u;
+    for (uint64_t word = position / BITSET_RANK_SUBBLOCK_BITS * (BITSET_RANK_SUBBLOCK_BITS / 64u); word < last; ++word)
+        rank += bitset_popcount64(bitset_get_word(index->bitset, word));
+    if (position % 64u)
+        rank += bitset_popcount64(bitset_get_word(index->bitset, last) & (UINT64_MAX >> (64u - position % 64u)));
+    return rank;
 }
 
 /**
- * Sets the value of a bit at a specified index to 1 (true)
- * @param bitset Pointer to bitset to modify
- * @param index The index of the bit to set (bit index)
- * @memberof BitSet
+ * Finds the set bit with the specified rank, searching only the blocks between two select samples
+ * @memberof BitSetRankIndex
+ * @param index Pointer to index of the bitset
+ * @param rank Number of set bits before the bit to find (0 finds the first set bit)
+ * @return Index of the bit, BITSET_NPOS if the bitset has at most rank set bits
  */
-inline void bitset_set(BitSet* const bitset, const uint64_t index) {
-    *(bitset->data + index / 8) |= (uint8_t)(uint8_t)1u << index % 8;
+BITSET_API uint64_t bitset_select(const BitSetRankIndex* const index, const uint64_t rank)
+{
+    if (rank >= index->count)
+        return BITSET_NPOS;
+
+    // the last block whose rank is at most rank, between the neighbouring samples
+    const uint64_t sample = rank / BITSET_SELECT_SAMPLE;
+    uint64_t low = *(index->samples + sample);
+    uint64_t high = sample + 1u < index->sample_count ? *(index->samples + sample + 1u) + 1u : index->block_count;
+    while (high - low > 1u)
+    {
+        const uint64_t middle = low + (high - low) / 2u;
+        if (bitset_rank_index_block_rank(index, middle) <= rank)
+            low = middle;
+        else
+            high = middle;
+    }
+
+    uint64_t remaining = rank - bitset_rank_index_block_rank(index, low);
+    const uint64_t entry = *(index->blocks + low);
+    uint64_t sub = 0;
+    for (; sub < 3u && remaining >= (entry >> (32u + sub * 10u) & 1023u); ++sub)
+        remaining -= entry >> (32u + sub * 10u) & 1023u;
+
+    const uint64_t words = bitset_calculate_word_count(index->bitset->size);
+    for (uint64_t word = low * (BITSET_RANK_BLOCK_BITS / 64u) + sub * (BITSET_RANK_SUBBLOCK_BITS / 64u); word < words; ++word)
+    {
+        const uint64_t value = bitset_get_word_below(index->bitset, word, index->bitset->size);
+        const uint64_t count = bitset_popcount64(value);
+        if (remaining < count)
+            return word * 64u + bitset_select_word(value, remaining);
+        remaining -= count;
+    }
+    return BITSET_NPOS;
 }
 
 /**
- * Sets the value of a bit at a specified index to 0 (false)
- * @param bitset Pointer to bitset to modify
- * @param index The index of the bit to clear (bit index)
- * @memberof BitSet
+ * @memberof BitSetRankIndex
+ * @param index Pointer to index to measure
+ * @return Number of bytes allocated by the index
  */
-inline void bitset_clear(BitSet* const bitset, const uint64_t index) {
-    *(bitset->data + index / 8) &= ~((uint8_t)1u << index % 8);
+BITSET_API uint64_t bitset_rank_index_memory_usage(const BitSetRankIndex* const index)
+{
+    return (index->region_count + index->block_count + index->sample_count) * sizeof(uint64_t);
 }
 
 /**
- * Fills the bitset with a specified value
- * @param bitset Pointer to bitset to modify
- * @param value The value to fill the bitset with
- * @memberof BitSet
+ * Base 2 logarithm without libm (about 1e-12 relative error), used to size the Bloom filters
+ * @param value The argument, has to be positive and finite
+ * @return log2(value)
  */
-inline void bitset_fill_all(BitSet* const bitset, const bool value) {
-    memset(bitset->data, value ? 255u : 0u, bitset->size);
+BITSET_API double bitset_log2_double(const double value)
+{
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(double));
+    const int64_t exponent = (int64_t)(bits >> 52 & 0x7ffu) - 1023;
+    bits = (bits & 0x000fffffffffffffull) | 0x3ff0000000000000ull;
+    double mantissa;
+    memcpy(&mantissa, &bits, sizeof(double));
+
+    // ln(m) = 2 * atanh((m - 1) / (m + 1)), the series converges fast for m in [1, 2)
+    const double t = (mantissa - 1.0) / (mantissa + 1.0), t2 = t * t;
+    double term = t, sum = 0.0;
+    for (uint32_t k = 1; k < 30u; k += 2u)
+    {
+        sum += term / k;
+        term *= t2;
+    }
+    return (double)exponent + 2.0 * sum * 1.4426950408889634;
 }
 
 /**
- * Clears all the bits (sets all bits to 0)
- * @param bitset Pointer to bitset to modify
- * @memberof BitSet
+ * Base 2 exponential without libm (about 1e-12 relative error), used to size the Bloom filters
+ * @param value The exponent
+ * @return 2^value, 0 below and 1e308 above the normal range
  */
-inline void bitset_clear_all(BitSet* const bitset) {
-    memset(bitset->data, 0, bitset->storage_size);
+BITSET_API double bitset_exp2_double(const double value)
+{
+    if (value < -1022.0)
+        return 0.0;
+    if (value > 1023.0)
+        return 1e308;
+
+    const int64_t integer = (int64_t)(value + 1023.0) - 1023;
+    // 2^f = e^(f ln 2) for f in [0, 1)
+    const double x = (value - (double)integer) * 0.6931471805599453;
+    double term = 1.0, sum = 1.0;
+    for (uint32_t k = 1; k < 20u; ++k)
+    {
+        term *= x / k;
+        sum += term;
+    }
+    const uint64_t bits = (uint64_t)(integer + 1023) << 52;
+    double scale;
+    memcpy(&scale, &bits, sizeof(double));
+    return sum * scale;
 }
 
 /**
- * Sets all the bits (sets all bits to 1)
- * @param bitset Pointer to bitset to modify
- * @memberof BitSet
+ * Mixes a key of a Bloom filter (murmur3 finalizer), so that every bit of the key affects every bit of the hash
+ * @param key The key to mix
+ * @return The hash of the key
  */
-inline void bitset_set_all(BitSet* const bitset) {
-    memset(bitset->data, 255, bitset->storage_size);
+BITSET_API uint64_t bitset_bloom_hash(const uint64_t key)
+{
+    uint64_t hash = key;
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdull;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ull;
+    hash ^= hash >> 33;
+    return hash;
 }
 
 /**
- * Fills all the bits in the specified range with 1 (true)
- * @param bitset Pointer to bitset to modify
- * @param value The value to fill the bits with (bit value)
- * @param end End of the range to fill (bit index)
- * @memberof BitSet
+ * Maps a hash to a block of a Bloom filter (multiply-shift instead of a division)
+ * @param hash The hash of the key
+ * @param block_count Number of blocks of the filter
+ * @return Index of the block in range [0, block_count)
  */
-inline void bitset_fill_in_range_end(BitSet* const bitset, const bool value, const uint64_t end) {
-    for (uint64_t i = 0; i < end; ++i)
-        *(bitset->data + i) = value ? 255u : 0u;
+BITSET_API uint64_t bitset_bloom_block_index(const uint64_t hash, const uint64_t block_count)
+{
+    if (block_count <= UINT32_MAX)
+        return (hash >> 32) * block_count >> 32;
+    return hash % block_count;
 }
 
 /**
- * Fills all the bits in the specified range with 0 (false)
- * @param bitset Pointer to bitset to modify
- * @param end End of the range to fill (bit index)
- * @memberof BitSet
+ * Builds the bits a key sets inside its block of a Bloom filter
+ * Every position takes 9 fresh bits of a rehash of the key (7 per 64-bit rehash), arithmetic progressions correlate too much in 512 bits
+ * @param hash The hash of the key
+ * @param hash_count Number of bits to set (at most BITSET_BLOOM_MAX_HASHES)
+ * @param mask Array receiving the mask, BITSET_BLOOM_BLOCK_BITS / 64 words
  */
-inline void bitset_clear_in_range_end(BitSet* const bitset, const uint64_t end)
+BITSET_API void bitset_bloom_block_mask(const uint64_t hash, const uint64_t hash_count, uint64_t* const mask)
 {
-    memset(bitset->data, 0, end / 8u);
-    if (end % 8u)
+    uint64_t positions = 0;
+    memset(mask, 0, BITSET_BLOOM_BLOCK_BITS / 8u);
+    for (uint64_t i = 0; i < hash_count; ++i)
     {
-        for (uint16_t i = 0; i < end % 8u; ++i)
-            *(bitset->data + end / 8u) &= ~((uint8_t)1u << i);
+        // the block index uses the high half of hash, the positions further mixes of it
+        if (!(i % 7u))
+            positions = bitset_bloom_hash(hash + (i / 7u + 1u) * 0x9e3779b97f4a7c15ull);
+        const uint64_t position = positions % BITSET_BLOOM_BLOCK_BITS;
+        positions >>= 9;
+        *(mask + position / 64u) |= (uint64_t)1u << position % 64u;
     }
 }
 
 /**
- * Fills all the bits in the specified range with 1 (true)
- * @param bitset Pointer to bitset to modify
- * @param end End of the range to fill (bit index)
- * @memberof BitSet
+ * Estimates the false positive rate of a blocked Bloom filter
+ * Sums the rate of a single block over the Poisson distributed number of keys per block, so it accounts for overfull blocks
+ * @param block_count Number of blocks of the filter
+ * @param hash_count Number of bits set per key
+ * @param items Number of inserted keys
+ * @return The expected probability that a query of a key never inserted returns true
  */
-inline void bitset_set_in_range_end(BitSet* const bitset, const uint64_t end)
+BITSET_API double bitset_bloom_false_positive_rate(const uint64_t block_count, const uint64_t hash_count, const uint64_t items)
 {
-    memset(bitset->data, 255u, end / 8u);
-    if (end % 8u)
+    if (!items)
+        return 0.0;
+    if (!block_count)
+        return 1.0;
+
+    const double load = (double)items / (double)block_count;
+    const double log2_load = bitset_log2_double(load);
+    // log2 of the probability that a bit of a block stays clear per key
+    const double log2_clear = (double)hash_count * bitset_log2_double(1.0 - 1.0 / BITSET_BLOOM_BLOCK_BITS);
+    const double last = load + 12.0 * bitset_exp2_double(0.5 * log2_load) + 32.0;
+
+    double rate = 0.0, log2_factorial = 0.0;
+    for (uint64_t keys = 0; (double)keys <= last; ++keys)
     {
-        for (uint16_t i = 0; i < end % 8u; ++i)
-            *(bitset->data + end / 8u) |= (uint8_t)1u << i;
+        if (keys)
+            log2_factorial += bitset_log2_double((double)keys);
+        const double log2_probability = (double)keys * log2_load - load * 1.4426950408889634 - log2_factorial;
+        const double set = 1.0 - bitset_exp2_double((double)keys * log2_clear);
+        // set ^ hash_count
+        double block_rate = 1.0;
+        for (uint64_t k = 0; k < hash_count; ++k)
+            block_rate *= set;
+        rate += bitset_exp2_double(log2_probability) * block_rate;
     }
+    return rate < 1.0 ? rate : 1.0;
 }
 
 /**
- * Fills all the bits in the specified range with the specified value
- * @param bitset Pointer to bitset to modify
- * @param value Value to fill the bits with (bit value)
- * @param begin Begin of the range to fill (bit index)
- * @param end End of the range to fill (bit index)
- * @memberof BitSet
+ * Geometry initialization, all of the bits are cleared
+ * @memberof BloomFilter
+ * @param filter Pointer to filter to initialize
+ * @param block_count Number of blocks (at least 1)
+ * @param hash_count Number of bits set per key (clamped to 1 - BITSET_BLOOM_MAX_HASHES)
  */
-inline void bitset_fill_in_range_begin_end(BitSet* const bitset, const bool value, const uint64_t begin, const uint64_t end)
+BITSET_API void bitset_bloom_init_blocks(BloomFilter* const filter, const uint64_t block_count, const uint64_t hash_count)
 {
-    uint8_t to_add = 1, to_sub = 1;
-    // create begin_block and fill the first byte with it
-    if (begin % 8)
-    {
-        const uint16_t end_bit = (begin / 8 == end / 8) ? end % 8 : 8;
-        if (value)
-        {
-            for (uint16_t i = begin % 8; i < end_bit; ++i)
-                *(bitset->data + begin / 8) |= 1 << i;
-        }
-        else
-        {
-            for (uint16_t i = begin % 8; i < end_bit; ++i)
-                *(bitset->data + begin / 8) &= ~(1 << i);
-        }
-    }
-    else
-        to_add = 0;
-    if (end % 8 && begin / 8 != end / 8)
-    {
-        if (value)
-        {
-            for (uint16_t i = 0; i < end % 8; ++i)
-                *(bitset->data + end / 8) |= (uint8_t)1u << i;
-        }
-        else
-        {
-            for (uint16_t i = 0; i < end % 8; ++i)
-                *(bitset->data + end / 8) &= ~((uint8_t)1u << i);
-        }
-    }
-    else
-        to_sub = 0;
+    filter->block_count = block_count ? block_count : 1u;
+    filter->hash_count = hash_count < 1u ? 1u : hash_count > BITSET_BLOOM_MAX_HASHES ? BITSET_BLOOM_MAX_HASHES : hash_count;
+    bitset_dynamic_init(&filter->bits, filter->block_count * BITSET_BLOOM_BLOCK_BITS);
+}
 
-    memset(bitset->data + begin / 8 + to_add, value ? 255u : 0u, (end - begin) / 8u - to_sub);
+/**
+ * Picks the geometry of a Bloom filter keeping the false positive rate at the target after expected_items inserts
+ * @param expected_items Number of keys the filter is sized for
+ * @param false_positive_rate Target false positive rate (clamped to [1e-9, 0.5])
+ * @param block_count Pointer receiving the number of blocks
+ * @param hash_count Pointer receiving the number of bits set per key
+ */
+BITSET_API void bitset_bloom_geometry(const uint64_t expected_items, const double false_positive_rate, uint64_t* const block_count, uint64_t* const hash_count)
+{
+    const double rate = false_positive_rate < 1e-9 ? 1e-9 : false_positive_rate > 0.5 ? 0.5 : false_positive_rate;
+    // the classic optimum (k = log2(1 / p) and k / ln 2 bits per key), then enlarged until the blocked layout meets the rate
+    const double hashes = -bitset_log2_double(rate);
+    *hash_count = hashes + 0.5 > BITSET_BLOOM_MAX_HASHES ? BITSET_BLOOM_MAX_HASHES : (uint64_t)(hashes + 0.5) ? (uint64_t)(hashes + 0.5) : 1u;
+    *block_count = (uint64_t)((double)expected_items * hashes * 1.4426950408889634 / BITSET_BLOOM_BLOCK_BITS) + 1u;
+    while (bitset_bloom_false_positive_rate(*block_count, *hash_count, expected_items) > rate)
+        *block_count += *block_count / 32u + 1u;
 }
 
 /**
- * Fills all the bits in the specified range with 0 (false)
- * @param bitset Pointer to bitset to modify
- * @param begin Begin of the range to fill (bit index)
- * @param end End of the range to fill (bit index)
- * @memberof BitSet
+ * Sizing initialization, picks the geometry with bitset_bloom_geometry, all of the bits are cleared
+ * @memberof BloomFilter
+ * @param filter Pointer to filter to initialize
+ * @param expected_items Number of keys the filter is sized for
+ * @param false_positive_rate Target false positive rate (clamped to [1e-9, 0.5])
  */
-inline void bitset_clear_in_range_begin_end(BitSet* const bitset, const uint64_t begin, const uint64_t end)
+BITSET_API void bitset_bloom_init(BloomFilter* const filter, const uint64_t expected_items, const double false_positive_rate)
 {
-    uint8_t to_add = 1, to_sub = 1;
-    // create begin_block and fill the first byte with it
-    if (begin % 8u)
-    {
-        const uint16_t end_bit = begin / 8u == end / 8u ? end % 8u : 8u;
-        for (uint16_t i = begin % 8u; i < end_bit; ++i)
-            *(bitset->data + begin / 8u) &= ~((uint8_t)1u << i);
-    }
-    else
-        to_add = 0;
+    uint64_t block_count, hash_count;
+    bitset_bloom_geometry(expected_items, false_positive_rate, &block_count, &hash_count);
+    bitset_bloom_init_blocks(filter, block_count, hash_count);
+}
 
-    // set the end block if the end is not aligned with the block size
-    if (end % 8 && begin / 8 != end / 8)
-    {
-        for (uint16_t i = 0; i < end % 8; ++i)
-            *(bitset->data + end / 8) &= ~((uint8_t)1u << i);
-    }
-    else
-        to_sub = 0;
+/**
+ * Destroys the filter (frees the memory)
+ * @memberof BloomFilter
+ * @param filter Pointer to filter to destroy
+ */
+BITSET_API void bitset_bloom_destroy(BloomFilter* const filter)
+{
+    bitset_dynamic_destroy(&filter->bits);
+}
 
-    memset(bitset->data + begin / 8u + to_add, 0u, (end - begin) / 8u - to_sub);
+/**
+ * Removes all the keys
+ * @memberof BloomFilter
+ * @param filter Pointer to filter to clear
+ */
+BITSET_API void bitset_bloom_clear(BloomFilter* const filter)
+{
+    bitset_clear_all(UNIVERSAL_BITSET(&filter->bits));
 }
 
 /**
- * Fills all the bits in the specified range with 1 (true)
- * @param bitset Pointer to bitset to modify
- * @param begin Begin of the range to fill (bit index)
- * @param end End of the range to fill (bit index)
- * @memberof BitSet
+ * Inserts a key, the mask is OR-ed into its block at once
+ * @memberof BloomFilter
+ * @param filter Pointer to filter to modify
+ * @param key The key to insert
  */
-inline void bitset_set_in_range_begin_end(BitSet* const bitset, const uint64_t begin, const uint64_t end)
+BITSET_API void bitset_bloom_insert(BloomFilter* const filter, const uint64_t key)
 {
-    uint8_t to_add = 1, to_sub = 1;
-    // create begin_block and fill the first byte with it
-    if (begin % 8u)
+    const uint64_t hash = bitset_bloom_hash(key);
+    uint8_t* const block = (uint8_t*)filter->bits.data + bitset_bloom_block_index(hash, filter->block_count) * (BITSET_BLOOM_BLOCK_BITS / 8u);
+    uint64_t mask[BITSET_BLOOM_BLOCK_BITS / 64u], words[BITSET_BLOOM_BLOCK_BITS / 64u];
+    bitset_bloom_block_mask(hash, filter->hash_count, mask);
+    // fixed-size copies and a fixed loop, compiled to a vector load, OR and store
+    memcpy(words, block, sizeof(words));
+    for (uint32_t i = 0; i < BITSET_BLOOM_BLOCK_BITS / 64u; ++i)
+        words[i] |= mask[i];
+    memcpy(block, words, sizeof(words));
+}
+
+/**
+ * Checks if a key may have been inserted
+ * @memberof BloomFilter
+ * @param filter Pointer to filter to check
+ * @param key The key to look up
+ * @return False if the key was never inserted, true if it was or on a false positive
+ */
+BITSET_API bool bitset_bloom_contains(const BloomFilter* const filter, const uint64_t key)
+{
+    const uint64_t hash = bitset_bloom_hash(key);
+    const uint8_t* const block = (const uint8_t*)filter->bits.data + bitset_bloom_block_index(hash, filter->block_count) * (BITSET_BLOOM_BLOCK_BITS / 8u);
+    uint64_t mask[BITSET_BLOOM_BLOCK_BITS / 64u], words[BITSET_BLOOM_BLOCK_BITS / 64u], missing = 0;
+    bitset_bloom_block_mask(hash, filter->hash_count, mask);
+    memcpy(words, block, sizeof(words));
+    for (uint32_t i = 0; i < BITSET_BLOOM_BLOCK_BITS / 64u; ++i)
+        missing |= mask[i] & ~words[i];
+    return !missing;
+}
+
+/**
+ * Inserts the keys, prefetching the blocks BITSET_PREFETCH_DISTANCE keys ahead
+ * @memberof BloomFilter
+ * @param filter Pointer to filter to modify
+ * @param keys The keys to insert
+ * @param count Number of keys
+ */
+BITSET_API void bitset_bloom_insert_many(BloomFilter* const filter, const uint64_t* const keys, const uint64_t count)
+{
+    for (uint64_t i = 0; i < count; ++i)
     {
-        const uint16_t end_bit = begin / 8u == end / 8u ? end % 8u : 8u;
-        for (uint16_t i = begin % 8u; i < end_bit; ++i)
-            *(bitset->data + begin / 8u) |= (uint8_t)1u << i;
+        if (i + BITSET_PREFETCH_DISTANCE < count)
+            BITSET_PREFETCH((const uint8_t*)filter->bits.data + bitset_bloom_block_index(bitset_bloom_hash(*(keys + i + BITSET_PREFETCH_DISTANCE)), filter->block_count) * (BITSET_BLOOM_BLOCK_BITS / 8u), 1);
+        bitset_bloom_insert(filter, *(keys + i));
     }
-    else
-        to_add = 0;
+}
 
-    // set the end block if the end is not aligned with the block size
-    if (end % 8 && begin / 8 != end / 8)
+/**
+ * Looks up the keys, prefetching the blocks BITSET_PREFETCH_DISTANCE keys ahead
+ * @memberof BloomFilter
+ * @param filter Pointer to filter to check
+ * @param keys The keys to look up
+ * @param count Number of keys
+ * @param results Array receiving the result of bitset_bloom_contains for every key (count values)
+ */
+BITSET_API void bitset_bloom_contains_many(const BloomFilter* const filter, const uint64_t* const keys, const uint64_t count, bool* const results)
+{
+    for (uint64_t i = 0; i < count; ++i)
     {
-        for (uint16_t i = 0; i < end % 8; ++i)
-            *(bitset->data + end / 8) |= (uint8_t)1u << i;
+        if (i + BITSET_PREFETCH_DISTANCE < count)
+            BITSET_PREFETCH((const uint8_t*)filter->bits.data + bitset_bloom_block_index(bitset_bloom_hash(*(keys + i + BITSET_PREFETCH_DISTANCE)), filter->block_count) * (BITSET_BLOOM_BLOCK_BITS / 8u), 0);
+        *(results + i) = bitset_bloom_contains(filter, *(keys + i));
     }
-    else
-        to_sub = 0;
+}
 
-    memset(bitset->data + begin / 8u + to_add, 255u, (end - begin) / 8u - to_sub);
+/**
+ * Merges the keys of source into destination (bitwise OR with the bulk kernels)
+ * @memberof BloomFilter
+ * @param destination Pointer to filter to modify
+ * @param source Pointer to filter to merge
+ * @return True on success, false if the filters differ in block_count or hash_count (destination is left unchanged)
+ */
+BITSET_API bool bitset_bloom_union(BloomFilter* const destination, const BloomFilter* const source)
+{
+    if (destination->block_count != source->block_count || destination->hash_count != source->hash_count)
+        return false;
+    bitset_or(UNIVERSAL_BITSET(&destination->bits), UNIVERSAL_BITSET(&source->bits));
+    return true;
 }
 
 /**
- * Fills all the bits in the specified range with the specified value
- * @param bitset Pointer to bitset to modify
- * @param value Value to fill the bits with (bit value)
- * @param begin Begin of the range to fill (bit index)
- * @param end End of the range to fill (bit index)
- * @param step Step size between the bits to fill (bit step)
- * @memberof BitSet
+ * Intersects the filters (bitwise AND with the bulk kernels), the result answers true for every key inserted into both
+ * @memberof BloomFilter
+ * @param destination Pointer to filter to modify
+ * @param source Pointer to filter to intersect with
+ * @return True on success, false if the filters differ in block_count or hash_count (destination is left unchanged)
  */
-inline void bitset_fill_in_range_begin_end_step(BitSet* const bitset, const bool value, const uint64_t begin, const uint64_t end, const uint64_t step)
+BITSET_API bool bitset_bloom_intersection(BloomFilter* const destination, const BloomFilter* const source)
 {
-    for (uint64_t i = begin; i < end; i += step)
-    {
-        if (value)
-            *(bitset->data + i / 8) |= (uint8_t)1u << i % 8;
-        else
-            *(bitset->data + i / 8) &= ~((uint8_t)1u << i % 8);
-    }
+    if (destination->block_count != source->block_count || destination->hash_count != source->hash_count)
+        return false;
+    bitset_and(UNIVERSAL_BITSET(&destination->bits), UNIVERSAL_BITSET(&source->bits));
+    return true;
 }
 
 /**
- * Fills all the bits in the specified range with 0 (false
- * @param bitset Pointer to bitset to modify
- * @param begin Begin of the range to fill (bit index)
- * @param end End of the range to fill (bit index)
- * @param step Step size between the bits to fill (bit step)
- * @memberof BitSet
+ * Gets the blocks of a page
+ * @memberof CowBitSet
+ * @param page Pointer to page
+ * @return Pointer to the BITSET_COW_PAGE_SIZE bytes of blocks of the page
  */
-inline void bitset_clear_in_range_begin_end_step(BitSet* const bitset, const uint64_t begin, const uint64_t end, const uint64_t step)
+BITSET_API bitset_block_t* bitset_cow_page_blocks(const bitset_cow_page* const page)
 {
-    for (uint64_t i = begin; i < end; i += step)
-        *(bitset->data + i / 8) &= ~((uint8_t)1u << i % 8);
+    return (bitset_block_t*)((uint8_t*)page + BITSET_ALIGNMENT);
 }
 
 /**
- * Fills all the bits in the specified range with 1 (true)
- * @param bitset Pointer to bitset to modify
- * @param value Value to fill the bits with (bit value)
- * @param begin Begin of the range to fill (bit index)
- * @param end End of the range to fill (bit index)
- * @param step Step size between the bits to fill (bit step)
- * @memberof BitSet
+ * Describes a page as a bitset, so the bitset_* functions can work on it (the view owns nothing, do not destroy it)
+ * The view of the last page is only as large as the bits of the bitset it holds
+ * @memberof CowBitSet
+ * @param bitset Pointer to bitset
+ * @param page Index of a page that is not NULL (page index)
+ * @param view Pointer to the storage of the view
+ * @return The view, use it instead of view (its members are written through BitSet, the type the bitset_* functions read them as)
+ */
+BITSET_API BitSet* bitset_cow_page_bitset(const CowBitSet* const bitset, const uint64_t page, DynamicBitSet* const view)
+{
+    BitSet* const universal = UNIVERSAL_BITSET(view);
+    const uint64_t rest = bitset->size - page * BITSET_COW_PAGE_BITS;
+    universal->data = bitset_cow_page_blocks(*(bitset->pages + page));
+    universal->size = rest < BITSET_COW_PAGE_BITS ? rest : BITSET_COW_PAGE_BITS;
+    universal->storage_size = bitset_calculate_storage_size(universal->size);
+    return universal;
+}
+
+/**
+ * Drops a reference to a page, the last one frees it
+ * @memberof CowBitSet
+ * @param allocator The allocator of the page (NULL for the default allocator)
+ * @param page Pointer to page (may be NULL)
  */
-inline void bitset_set_in_range_begin_end_step(BitSet* const bitset, const uint64_t begin, const uint64_t end, const uint64_t step)
+BITSET_API void bitset_cow_release_page(const bitset_allocator* const allocator, bitset_cow_page* const page)
 {
-    for (uint64_t i = begin; i < end; i += step)
-        *(bitset->data + i / 8) |= (uint8_t)1u << i % 8;
+    if (page && !BITSET_REFERENCE_DECREMENT(&page->references))
+        bitset_deallocate(allocator, page, BITSET_ALIGNMENT + BITSET_COW_PAGE_SIZE);
 }
 
 /**
- * Sets the block at the specified index to the specified value
+ * Gets a page the bitset can modify, a missing page is allocated and a shared page is copied first
+ * A page only referenced by this bitset stays exclusive: new references only come from snapshots of its holders
+ * @memberof CowBitSet
  * @param bitset Pointer to bitset to modify
- * @param block The block to set (block value)
- * @param index The index of the block to set (block index)
- * @memberof BitSet
+ * @param page Index of the page (page index)
+ * @param preserve Whether the bits of a new page have to match the old ones (false when the caller overwrites the whole page)
+ * @return Pointer to the page, NULL if it could not be allocated (the bitset is left unchanged)
  */
-inline void bitset_set_block(BitSet* const bitset, const uint8_t block, const uint64_t index)
+BITSET_API bitset_cow_page* bitset_cow_writable_page(CowBitSet* const bitset, const uint64_t page, const bool preserve)
 {
-    *(bitset->data + index) = block;
+    bitset_cow_page* const old_page = *(bitset->pages + page);
+    if (old_page && BITSET_REFERENCE_LOAD(&old_page->references) == 1u)
+        return old_page;
+
+    bitset_cow_page* const new_page = (bitset_cow_page*)bitset_allocate(bitset->allocator, BITSET_ALIGNMENT + BITSET_COW_PAGE_SIZE);
+    // throw exception in safe version
+    if (!new_page)
+        return NULL;
+    new_page->references = 1u;
+    if (preserve && old_page)
+        memcpy(bitset_cow_page_blocks(new_page), bitset_cow_page_blocks(old_page), BITSET_COW_PAGE_SIZE);
+    else if (preserve)
+        memset(bitset_cow_page_blocks(new_page), 0, BITSET_COW_PAGE_SIZE);
+    bitset_cow_release_page(bitset->allocator, old_page);
+    *(bitset->pages + page) = new_page;
+    return new_page;
 }
 
 /**
- * Fills all the blocks in the specified range with the specified value
- * @param bitset Pointer to bitset to modify
- * @param value The value to fill the bits with (block value)
- * @memberof BitSet
+ * Size initialization, all of the bits are cleared (no page is allocated)
+ * @memberof CowBitSet
+ * @param bitset Pointer to bitset to initialize
+ * @param size The size of the bitset to be initialized
+ * @return Whether the page table could be allocated (the bitset is empty otherwise)
  */
-inline void bitset_fill_all_blocks(BitSet* const bitset, const uint8_t value)
+BITSET_API bool bitset_cow_init(CowBitSet* const bitset, const uint64_t size)
 {
-    for (uint64_t i = 0; i < bitset->storage_size; ++i)
-        *(bitset->data + i) = value;
+    return bitset_cow_init_allocator(bitset, size, NULL);
 }
 
 /**
- * Fills all the bits in the specified range with the specified block
- * @param bitset Pointer to bitset to modify
- * @param block Chunk to fill the bits with (block value)
- * @param end End of the range to fill (block index)
- * @memberof BitSet
+ * Size and allocator initialization, all of the bits are cleared (no page is allocated)
+ * @memberof CowBitSet
+ * @param bitset Pointer to bitset to initialize
+ * @param size The size of the bitset to be initialized
+ * @param allocator The allocator of the pages (NULL for the default allocator), has to outlive the bitset and its snapshots
+ * @return Whether the page table could be allocated (the bitset is empty otherwise)
  */
-inline void bitset_fill_block_in_range_end(BitSet* const bitset, const uint8_t block, const uint64_t end)
+BITSET_API bool bitset_cow_init_allocator(CowBitSet* const bitset, const uint64_t size, const bitset_allocator* const allocator)
 {
-    for (uint64_t i = 0; i < end; ++i)
-        *(bitset->data + i) = block;
+    bitset->size = size;
+    bitset->page_count = size / BITSET_COW_PAGE_BITS + (size % BITSET_COW_PAGE_BITS ? 1 : 0);
+    bitset->allocator = allocator;
+    bitset->pages = (bitset_cow_page**)bitset_allocate(allocator, (bitset->page_count ? bitset->page_count : 1u) * sizeof(bitset_cow_page*));
+    // throw exception in safe version
+    if (!bitset->pages)
+    {
+        bitset->size = bitset->page_count = 0;
+        return false;
+    }
+    memset(bitset->pages, 0, bitset->page_count * sizeof(bitset_cow_page*));
+    return true;
 }
 
 /**
- * Fills all the bits in the specified range with the specified block
- * @param bitset Pointer to bitset to modify
- * @param block Chunk to fill the bits with
- * @param begin begin of the range to fill (block index)
- * @param end End of the range to fill (block index)
- * @memberof BitSet
+ * Copy initialization from a plain bitset (BitSet or DynamicBitSet), pages with all of the bits cleared are not allocated
+ * @memberof CowBitSet
+ * @param bitset Pointer to bitset to initialize
+ * @param source Pointer to bitset to copy the bits from
+ * @return Whether the memory could be allocated (the bitset is empty otherwise)
  */
-inline void bitset_fill_block_in_range_begin_end(BitSet* const bitset, const uint8_t block, const uint64_t begin, const uint64_t end)
+BITSET_API bool bitset_cow_init_bitset(CowBitSet* const bitset, const BitSet* const source)
 {
-    for (uint64_t i = begin; i < end; ++i)
-        *(bitset->data + i) = block;
+    if (!bitset_cow_init(bitset, source->size))
+        return false;
+    const uint64_t blocks_per_page = BITSET_COW_PAGE_SIZE / sizeof(bitset_block_t);
+    for (uint64_t page = 0; page < bitset->page_count; ++page)
+    {
+        const uint64_t first = page * blocks_per_page;
+        const uint64_t blocks = source->storage_size - first < blocks_per_page ? source->storage_size - first : blocks_per_page;
+        const uint8_t* const bytes = (const uint8_t*)(source->data + first);
+        if (bitset_find_byte_not(bytes, blocks * sizeof(bitset_block_t), 0u) == BITSET_NPOS)
+            continue;
+
+        bitset_cow_page* const new_page = bitset_cow_writable_page(bitset, page, false);
+        if (!new_page)
+        {
+            bitset_cow_destroy(bitset);
+            return false;
+        }
+        memcpy(bitset_cow_page_blocks(new_page), bytes, blocks * sizeof(bitset_block_t));
+        memset(bitset_cow_page_blocks(new_page) + blocks, 0, (blocks_per_page - blocks) * sizeof(bitset_block_t));
+    }
+    return true;
 }
 
 /**
- * Fills all the bits in the specified range with the specified block
- * @param bitset Pointer to bitset to modify
- * @param block Chunk to fill the bits with (block value)
- * @param begin begin of the range to fill (block index)
- * @param end End of the range to fill (block index)
- * @param step Step size between the bits to fill (block step)
- * @memberof BitSet
+ * Destroys the bitset, the pages still shared with snapshots stay alive until those are destroyed
+ * @memberof CowBitSet
+ * @param bitset Pointer to bitset to destroy
  */
-inline void bitset_fill_block_in_range_begin_end_step(BitSet* const bitset, const uint8_t block, const uint64_t begin, const uint64_t end, const uint64_t step)
+BITSET_API void bitset_cow_destroy(CowBitSet* const bitset)
 {
-    for (uint64_t i = begin; i < end; i += step)
-        *(bitset->data + i) = block;
+    for (uint64_t page = 0; page < bitset->page_count; ++page)
+        bitset_cow_release_page(bitset->allocator, *(bitset->pages + page));
+    bitset_deallocate(bitset->allocator, bitset->pages, (bitset->page_count ? bitset->page_count : 1u) * sizeof(bitset_cow_page*));
+    bitset->pages = NULL;
+    bitset->size = bitset->page_count = 0;
 }
 
 /**
- * Flips the bit at the specified index
- * @param bitset Pointer to bitset to modify
- * @param index Index of the bit to flip (bit index)
- * @memberof BitSet
+ * Takes a snapshot of the bitset, sharing all of its pages (O(pages), no bits are copied)
+ * Later writes to either bitset copy the pages they touch, so the other one keeps its bits, destroy the snapshot with bitset_cow_destroy
+ * @memberof CowBitSet
+ * @param snapshot Pointer to bitset to initialize as the snapshot
+ * @param source Pointer to bitset to take the snapshot of (must not be modified concurrently)
+ * @return Whether the page table could be allocated (the snapshot is empty otherwise)
  */
-inline void bitset_flip_bit(BitSet* const bitset, const uint64_t index)
+BITSET_API bool bitset_cow_snapshot(CowBitSet* const snapshot, const CowBitSet* const source)
 {
-    *(bitset->data + index / sizeof(uint8_t)) ^= (uint8_t)1u << index % sizeof(uint8_t);
+    if (!bitset_cow_init_allocator(snapshot, source->size, source->allocator))
+        return false;
+    for (uint64_t page = 0; page < source->page_count; ++page)
+    {
+        bitset_cow_page* const shared_page = *(source->pages + page);
+        if (shared_page)
+            BITSET_REFERENCE_INCREMENT(&shared_page->references);
+        *(snapshot->pages + page) = shared_page;
+    }
+    return true;
 }
 
 /**
- * Flips all the bits
- * @param bitset Pointer to bitset to modify
- * @memberof BitSet
+ * Gets the value of a bit at a specified index
+ * @memberof CowBitSet
+ * @param bitset Pointer to bitset to read from
+ * @param index The index of the bit to read (bit index)
+ * @return The value of the bit at the specified index
  */
-inline void bitset_flip_all(BitSet* const bitset)
+BITSET_API bool bitset_cow_get(const CowBitSet* const bitset, const uint64_t index)
 {
-    for (uint64_t i = 0; i < bitset->storage_size; ++i)
-        *(bitset->data + i) = ~*(bitset->data + i);
+    const bitset_cow_page* const page = *(bitset->pages + index / BITSET_COW_PAGE_BITS);
+    const uint64_t bit = index % BITSET_COW_PAGE_BITS;
+    return page && (*(bitset_cow_page_blocks(page) + bit / BITSET_BLOCK_BITS) >> bit % BITSET_BLOCK_BITS & 1u);
 }
 
 /**
- * Flips all the bits in the specified range
+ * Sets the value of a bit at a specified index to 1 (true), copies its page if it is shared
+ * @memberof CowBitSet
  * @param bitset Pointer to bitset to modify
- * @param end End of the range to flip (bit index)
- * @memberof BitSet
+ * @param index The index of the bit to set (bit index)
  */
-inline void bitset_flip_in_range_end(BitSet* const bitset, const uint64_t end)
+BITSET_API void bitset_cow_set(CowBitSet* const bitset, const uint64_t index)
 {
-    for (uint64_t i = 0; i < end; ++i)
-        *(bitset->data + i) = ~*(bitset->data + i);
+    bitset_cow_page* const page = bitset_cow_writable_page(bitset, index / BITSET_COW_PAGE_BITS, true);
+    const uint64_t bit = index % BITSET_COW_PAGE_BITS;
+    if (page)
+        *(bitset_cow_page_blocks(page) + bit / BITSET_BLOCK_BITS) |= (bitset_block_t)1u << bit % BITSET_BLOCK_BITS;
 }
 
 /**
- * Flips all the bits in the specified range
+ * Sets the value of a bit at a specified index to 0 (false), copies its page if it is shared (a missing page stays missing)
+ * @memberof CowBitSet
  * @param bitset Pointer to bitset to modify
- * @param begin Begin of the range to flip (bit index)
- * @param end End of the range to flip (bit index)
- * @memberof BitSet
+ * @param index The index of the bit to clear (bit index)
  */
-inline void bitset_flip_in_range_begin_end(BitSet* const bitset, const uint64_t begin, const uint64_t end)
+BITSET_API void bitset_cow_clear(CowBitSet* const bitset, const uint64_t index)
 {
-    for (uint64_t i = begin; i < end; ++i)
-        *(bitset->data + i) = ~*(bitset->data + i);
+    if (!*(bitset->pages + index / BITSET_COW_PAGE_BITS))
+        return;
+    bitset_cow_page* const page = bitset_cow_writable_page(bitset, index / BITSET_COW_PAGE_BITS, true);
+    const uint64_t bit = index % BITSET_COW_PAGE_BITS;
+    if (page)
+        *(bitset_cow_page_blocks(page) + bit / BITSET_BLOCK_BITS) &= ~((bitset_block_t)1u << bit % BITSET_BLOCK_BITS);
 }
 
 /**
- * Flips all the bits in the specified range
+ * Sets the value of a bit at a specified index
+ * @memberof CowBitSet
  * @param bitset Pointer to bitset to modify
- * @param begin Begin of the range to flip (bit index)
- * @param end End of the range to flip (bit index)
- * @param step Step size between the bits to flip (bit step)
- * @memberof BitSet
+ * @param value The value to set the bit to
+ * @param index The index of the bit to set (bit index)
  */
-inline void bitset_flip_in_range_begin_end_step(BitSet* const bitset, const uint64_t begin, const uint64_t end, const uint64_t step)
+BITSET_API void bitset_cow_set_value(CowBitSet* const bitset, const bool value, const uint64_t index)
 {
-    for (uint64_t i = begin; i < end; i += step)
-        *(bitset->data + i / sizeof(uint8_t)) ^= (uint8_t)1u << i % sizeof(uint8_t);
+    if (value)
+        bitset_cow_set(bitset, index);
+    else
+        bitset_cow_clear(bitset, index);
 }
 
 /**
- * Flips the block at the specified index
+ * Flips the value of a bit at a specified index, copies its page if it is shared
+ * @memberof CowBitSet
  * @param bitset Pointer to bitset to modify
- * @param index Index of the block to flip (block index)
- * @memberof BitSet
+ * @param index The index of the bit to flip (bit index)
  */
-inline void bitset_flip_block(BitSet* const bitset, const uint64_t index)
+BITSET_API void bitset_cow_flip_bit(CowBitSet* const bitset, const uint64_t index)
 {
-    *(bitset->data + index) = ~*(bitset->data + index);
+    bitset_cow_page* const page = bitset_cow_writable_page(bitset, index / BITSET_COW_PAGE_BITS, true);
+    const uint64_t bit = index % BITSET_COW_PAGE_BITS;
+    if (page)
+        *(bitset_cow_page_blocks(page) + bit / BITSET_BLOCK_BITS) ^= (bitset_block_t)1u << bit % BITSET_BLOCK_BITS;
 }
 
 /**
- * Flips all the blocks (exactly the same as bitset_flip_all, just alias)
+ * Fills bits [begin, end) with a specified value page by page
+ * Pages cleared entirely are released and pages filled entirely are replaced without copying their old bits
+ * @memberof CowBitSet
  * @param bitset Pointer to bitset to modify
- * @memberof BitSet
+ * @param value The value to fill the bits with
+ * @param begin The index of the first bit to fill (bit index)
+ * @param end The index past the last bit to fill (bit index), begin <= end <= size
  */
-inline void bitset_flip_block_all(BitSet* const bitset)
+BITSET_API void bitset_cow_fill_in_range_begin_end(CowBitSet* const bitset, const bool value, const uint64_t begin, const uint64_t end)
 {
-    bitset_flip_all(bitset);
+    for (uint64_t page = begin / BITSET_COW_PAGE_BITS; begin < end && page <= (end - 1u) / BITSET_COW_PAGE_BITS; ++page)
+    {
+        const uint64_t base = page * BITSET_COW_PAGE_BITS;
+        const uint64_t first = begin > base ? begin - base : 0;
+        const uint64_t last = end - base < BITSET_COW_PAGE_BITS ? end - base : BITSET_COW_PAGE_BITS;
+        const bool whole = !first && (last == BITSET_COW_PAGE_BITS || base + last == bitset->size);
+        if (!value && (whole || !*(bitset->pages + page)))
+        {
+            bitset_cow_release_page(bitset->allocator, *(bitset->pages + page));
+            *(bitset->pages + page) = NULL;
+            continue;
+        }
+
+        if (!bitset_cow_writable_page(bitset, page, !whole))
+            continue;
+        DynamicBitSet storage;
+        BitSet* const view = bitset_cow_page_bitset(bitset, page, &storage);
+        // the bits of the last block past the size are not filled, keep them cleared
+        if (whole)
+            *(view->data + view->storage_size - 1u) = 0;
+        bitset_fill_in_range_begin_end(view, value, first, last);
+    }
 }
 
 /**
- * Flips all the blocks in the specified range
+ * Flips bits [begin, end) page by page
+ * @memberof CowBitSet
  * @param bitset Pointer to bitset to modify
- * @param end End of the range to flip (block index)
- * @memberof BitSet
+ * @param begin The index of the first bit to flip (bit index)
+ * @param end The index past the last bit to flip (bit index), begin <= end <= size
  */
-inline void bitset_flip_block_in_range_end(BitSet* const bitset, const uint64_t end)
+BITSET_API void bitset_cow_flip_in_range_begin_end(CowBitSet* const bitset, const uint64_t begin, const uint64_t end)
 {
-    for (uint64_t i = 0; i < end; ++i)
-        *(bitset->data + i) = ~*(bitset->data + i);
+    for (uint64_t page = begin / BITSET_COW_PAGE_BITS; begin < end && page <= (end - 1u) / BITSET_COW_PAGE_BITS; ++page)
+    {
+        const uint64_t base = page * BITSET_COW_PAGE_BITS;
+        if (!bitset_cow_writable_page(bitset, page, true))
+            continue;
+        DynamicBitSet storage;
+        bitset_flip_in_range_begin_end(bitset_cow_page_bitset(bitset, page, &storage), begin > base ? begin - base : 0, end - base < BITSET_COW_PAGE_BITS ? end - base : BITSET_COW_PAGE_BITS);
+    }
 }
 
 /**
- * Flips all the blocks in the specified range
+ * Fills the bitset with a specified value, clearing releases all of the pages
+ * @memberof CowBitSet
  * @param bitset Pointer to bitset to modify
- * @param begin Begin of the range to flip (block index)
- * @param end End of the range to flip (block index)
- * @memberof BitSet
+ * @param value The value to fill the bitset with
  */
-inline void bitset_flip_block_in_range_begin_end(BitSet* const bitset, const uint64_t begin, const uint64_t end)
+BITSET_API void bitset_cow_fill_all(CowBitSet* const bitset, const bool value)
 {
-    for (uint64_t i = begin; i < end; ++i)
-        *(bitset->data + i) = ~*(bitset->data + i);
+    bitset_cow_fill_in_range_begin_end(bitset, value, 0, bitset->size);
 }
 
 /**
- * Flips all the blocks in the specified range
- * @param bitset Pointer to bitset to modify
- * @param begin Begin of the range to flip (block index)
- * @param end End of the range to flip (block index)
- * @param step Step size between the blocks to flip (block step)
- * @memberof BitSet
+ * Counts the set bits, missing pages are skipped
+ * @memberof CowBitSet
+ * @param bitset Pointer to bitset to count the bits of
+ * @return The number of set bits
  */
-inline void bitset_flip_block_in_range_begin_end_step(BitSet* const bitset, const uint64_t begin, const uint64_t end, const uint64_t step)
+BITSET_API uint64_t bitset_cow_count(const CowBitSet* const bitset)
 {
-    for (uint64_t i = begin; i < end; i += step)
-        *(bitset->data + i) = ~*(bitset->data + i);
+    uint64_t count = 0;
+    for (uint64_t page = 0; page < bitset->page_count; ++page)
+    {
+        if (!*(bitset->pages + page))
+            continue;
+        DynamicBitSet storage;
+        count += bitset_count(bitset_cow_page_bitset(bitset, page, &storage));
+    }
+    return count;
 }
 
 /**
- * Retrieves the block at the specified index
- * @memberof BitSet
- * @param bitset Pointer to bitset to read from
- * @param index Index of the block to read (block index)
- * @return The block at the specified index
+ * Counts the pages shared with other bitsets, the pages a write could still copy
+ * @memberof CowBitSet
+ * @param bitset Pointer to bitset to inspect
+ * @return The number of shared pages (a snapshot may be released concurrently, the result is a momentary value)
  */
-inline uint8_t bitset_get_block(const BitSet* const bitset, const uint64_t index)
+BITSET_API uint64_t bitset_cow_shared_pages(const CowBitSet* const bitset)
 {
-    return *(bitset->data + index);
+    uint64_t count = 0;
+    for (uint64_t page = 0; page < bitset->page_count; ++page)
+        count += *(bitset->pages + page) && BITSET_REFERENCE_LOAD(&(*(bitset->pages + page))->references) > 1u;
+    return count;
 }
 
 /**
- * Checks if all the bits are set
- * @memberof BitSet
- * @param bitset Pointer to bitset to check
- * @return True if all the bits are set, false otherwise
+ * Copies the bits into a plain bitset (BitSet or DynamicBitSet), as many blocks as both bitsets hold
+ * @memberof CowBitSet
+ * @param bitset Pointer to bitset to copy from
+ * @param destination Pointer to bitset to copy to
  */
-inline bool bitset_all(const BitSet* const bitset)
+BITSET_API void bitset_cow_to_bitset(const CowBitSet* const bitset, BitSet* const destination)
 {
-    for (uint64_t i = 0; i < bitset->storage_size - (bitset->size % 8 ? 1 : 0); ++i)
-    {
-        if (*(bitset->data + i) != 255u)
-            return false;
-    }
-    if (bitset->size % 8)
+    const uint64_t blocks_per_page = BITSET_COW_PAGE_SIZE / sizeof(bitset_block_t);
+    const uint64_t storage_size = bitset_calculate_storage_size(bitset->size);
+    const uint64_t blocks = destination->storage_size < storage_size ? destination->storage_size : storage_size;
+    for (uint64_t first = 0; first < blocks; first += blocks_per_page)
     {
-        for (uint16_t i = 0; i < bitset->size % 8; ++i)
-        {
-            if (*(bitset->data + bitset->storage_size - 1) & (uint8_t)1u << i)
-                return false;
-        }
+        const bitset_cow_page* const page = *(bitset->pages + first / blocks_per_page);
+        const uint64_t length = blocks - first < blocks_per_page ? blocks - first : blocks_per_page;
+        if (page)
+            memcpy(destination->data + first, bitset_cow_page_blocks(page), length * sizeof(bitset_block_t));
+        else
+            memset(destination->data + first, 0, length * sizeof(bitset_block_t));
     }
-    return true;
 }
 
 /**
- * Checks if any of the bits are set
- * @memberof BitSet
- * @param bitset Pointer to bitset to check
- * @return True if any of the bits are set, false otherwise
+ * Calculates the distance between the starts of two rows of a BitMatrix
+ * @memberof BitMatrix
+ * @param columns Number of columns (bits per row)
+ * @return The row stride (block size), the row rounded up to BITSET_MATRIX_ROW_ALIGNMENT bytes
  */
-inline bool bitset_any(const BitSet* const bitset)
+BITSET_API uint64_t bitset_matrix_row_stride(const uint64_t columns)
 {
-    for (uint64_t i = 0; i < bitset->storage_size - (bitset->size % 8 ? 1 : 0); ++i)
-    {
-        if (*(bitset->data + i))
-            return true;
-    }
-    if (bitset->size % 8)
-    {
-        for (uint16_t i = 0; i < bitset->size % 8; ++i)
-        {
-            if (*(bitset->data + bitset->storage_size - 1) & (uint8_t)1u << i)
-                return true;
-        }
-    }
-    return false;
+    const uint64_t bytes = (columns + 7u) / 8u;
+    return (bytes + BITSET_MATRIX_ROW_ALIGNMENT - 1u) / BITSET_MATRIX_ROW_ALIGNMENT * BITSET_MATRIX_ROW_ALIGNMENT / sizeof(bitset_block_t);
 }
 
 /**
- * Checks if none of the bits are set
- * @memberof BitSet
- * @param bitset Pointer to bitset to check
- * @return True if none of the bits are set, false otherwise
+ * Size initialization, all of the bits are cleared
+ * @memberof BitMatrix
+ * @param matrix Pointer to matrix to initialize
+ * @param rows Number of rows
+ * @param columns Number of columns (bits per row)
  */
-inline bool bitset_none(const BitSet* const bitset)
+BITSET_API void bitset_matrix_init(BitMatrix* const matrix, const uint64_t rows, const uint64_t columns)
 {
-    return bitset_all_cleared(bitset);
+    matrix->rows = rows;
+    matrix->columns = columns;
+    matrix->row_stride = bitset_matrix_row_stride(columns);
+    bitset_dynamic_init(&matrix->bits, rows * matrix->row_stride * BITSET_BLOCK_BITS);
 }
 
 /**
- * Checks if all the bits are clear
- * @memberof BitSet
- * @param bitset Pointer to bitset to check
- * @return True if all the bits are clear, false otherwise
+ * Rows initialization, copies the bitsets into the rows of the matrix
+ * @memberof BitMatrix
+ * @param matrix Pointer to matrix to initialize
+ * @param rows Pointers to the bitsets (BitSet or DynamicBitSet) to copy, the first one sets the number of columns and the others have to hold at least as many bits
+ * @param count Number of bitsets (rows)
  */
-inline bool bitset_all_cleared(const BitSet* const bitset)
+BITSET_API void bitset_matrix_init_rows(BitMatrix* const matrix, const BitSet* const* const rows, const uint64_t count)
 {
-    for (uint64_t i = 0; i < bitset->storage_size - (bitset->size % 8u ? 1 : 0); ++i)
-    {
-        if (*(bitset->data + i))
-            return false;
-    }
-    if (bitset->size % 8)
+    bitset_matrix_init(matrix, count, count ? (*rows)->size : 0u);
+    if (!matrix->bits.data)
+        return; // throw exception in safe version
+    for (uint64_t i = 0; i < count; ++i)
     {
-        for (uint16_t i = 0; i < bitset->size % 8; ++i)
-        {
-            if (*(bitset->data + bitset->storage_size - 1) & (uint8_t)1u << i)
-                return false;
-        }
+        DynamicBitSet view;
+        bitset_copy(bitset_matrix_row(matrix, i, &view), *(rows + i));
     }
-    return true;
+    BITSET_STATS_RECORD(BITSET_STATS_FILL, count * matrix->columns, count * matrix->row_stride * sizeof(bitset_block_t));
 }
 
 /**
- * @memberof BitSet
- * @return the number of bits set in the bitset
+ * Destroys the matrix (frees the memory)
+ * @memberof BitMatrix
+ * @param matrix Pointer to matrix to destroy
  */
-inline uint64_t bitset_count(const BitSet* const bitset)
+BITSET_API void bitset_matrix_destroy(BitMatrix* const matrix)
 {
-    uint64_t count = 0;
-    for (uint64_t i = 0; i < bitset->storage_size; ++i)
-    {
-        uint8_t block = *(bitset->data + i);
-        while (block)
-        {
-            count += block & (uint8_t)1u;
-            block >>= 1;
-        }
-    }
-    return count;
+    bitset_dynamic_destroy(&matrix->bits);
 }
 
 /**
- * Check if bitset is empty
- * @param bitset Pointer to bitset to check
- * @return True if the bitset is empty, false otherwise
- * @memberof BitSet
-*/
-inline bool bitset_empty(const BitSet* const bitset)
+ * Makes a view of a row, the view can be passed to every BitSet function that neither resizes nor frees it
+ * @memberof BitMatrix
+ * @param matrix Pointer to matrix to view
+ * @param row Index of the row
+ * @param view Pointer to the DynamicBitSet receiving the view (data, size and storage_size are set)
+ * @return The view cast to BitSet
+ */
+BITSET_API BitSet* bitset_matrix_row(const BitMatrix* const matrix, const uint64_t row, DynamicBitSet* const view)
 {
-    return !bitset->size;
+    BitSet* const universal = UNIVERSAL_BITSET(view);
+    universal->data = matrix->bits.data + row * matrix->row_stride;
+    universal->size = matrix->columns;
+    universal->storage_size = bitset_calculate_storage_size(matrix->columns);
+    return universal;
 }
 
 /**
- * Pushes back a bit to the bitset
- * @param bitset Pointer to bitset to modify
- * @param value Value of the bit to append (bit value)
- * @memberof BitSet
+ * Retrieves the value of a bit of the matrix
+ * @memberof BitMatrix
+ * @param matrix Pointer to matrix to read from
+ * @param row Index of the row
+ * @param column Index of the column
+ * @return The value of the bit
  */
-void bitset_dynamic_push_back(DynamicBitSet* const bitset, const bool value)
+BITSET_API bool bitset_matrix_get(const BitMatrix* const matrix, const uint64_t row, const uint64_t column)
 {
-	if (bitset->size % 8)
-	{
-		if (value)
-			*(bitset->data + bitset->size / 8) |= (uint8_t)1u << bitset->size % 8;
-		else
-			*(bitset->data + bitset->size / 8) &= ~((uint8_t)1u << bitset->size % 8);
-	}
-	else
-	{
-		uint8_t* new_data = (uint8_t*)malloc((bitset->storage_size + 1) * sizeof(uint8_t));
-		if (bitset->data)
-		{
-			memcpy(new_data, bitset->data, bitset->storage_size);
-			free(bitset->data);
-		}
-		bitset->data = new_data;
-		*(bitset->data + bitset->storage_size++) = value ? 1u : 0u;
-	}
-	++bitset->size;
+    return *(matrix->bits.data + row * matrix->row_stride + column / BITSET_BLOCK_BITS) >> column % BITSET_BLOCK_BITS & 1u;
 }
 
 /**
- * Removes the last bit from the bitset
- * @param bitset Pointer to bitset to modify
- * @memberof BitSet
+ * Sets the value of a bit of the matrix
+ * @memberof BitMatrix
+ * @param matrix Pointer to matrix to modify
+ * @param value The value to set the bit to
+ * @param row Index of the row
+ * @param column Index of the column
  */
-void bitset_dynamic_pop_back(DynamicBitSet* const bitset)
+BITSET_API void bitset_matrix_set_value(BitMatrix* const matrix, const bool value, const uint64_t row, const uint64_t column)
 {
-    if (bitset->data)
+    bitset_block_t* const block = matrix->bits.data + row * matrix->row_stride + column / BITSET_BLOCK_BITS;
+    if (value)
+        *block |= (bitset_block_t)1u << column % BITSET_BLOCK_BITS;
+    else
+        *block &= ~((bitset_block_t)1u << column % BITSET_BLOCK_BITS);
+}
+
+/**
+ * Stores the transpose of a matrix, tile by tile (64 rows x 64 columns, see bitset_transpose64)
+ * Afterwards row c of destination holds column c of source
+ * @memberof BitMatrix
+ * @param destination Pointer to matrix to store the result to (initialized with source->columns rows and source->rows columns, must not be source)
+ * @param source Pointer to matrix to transpose
+ * @return True on success, false if the shape of destination does not match
+ */
+BITSET_API bool bitset_matrix_transpose(BitMatrix* const destination, const BitMatrix* const source)
+{
+    if (destination->rows != source->columns || destination->columns != source->rows)
+        return false; // throw exception in safe version
+    BITSET_STATS_RECORD(BITSET_STATS_ACCESS, source->rows * source->columns, 2u * source->bits.storage_size * sizeof(bitset_block_t));
+    BITSET_TRACE_BEGIN("matrix_transpose", source->bits.storage_size * sizeof(bitset_block_t));
+
+    const uint64_t source_words = source->row_stride * sizeof(bitset_block_t) / sizeof(uint64_t);
+    const uint64_t destination_words = destination->row_stride * sizeof(bitset_block_t) / sizeof(uint64_t);
+    const BitSet* const source_bits = UNIVERSAL_BITSET(&source->bits);
+    BitSet* const destination_bits = UNIVERSAL_BITSET(&destination->bits);
+    uint64_t tile[64];
+    for (uint64_t row = 0; row < source->rows; row += 64u)
     {
-        if (!(bitset->size % 8))
+        const uint64_t rows = source->rows - row < 64u ? source->rows - row : 64u;
+        for (uint64_t column = 0; column < source->columns; column += 64u)
         {
-            uint8_t* new_data = (uint8_t*)malloc((bitset->storage_size - 1) * sizeof(uint8_t));
-            memcpy(new_data, bitset->data, bitset->storage_size - 1);
-            free(bitset->data);
-            bitset->data = new_data;
+            const uint64_t columns = source->columns - column < 64u ? source->columns - column : 64u;
+            for (uint64_t i = 0; i < rows; ++i)
+                tile[i] = bitset_get_word(source_bits, (row + i) * source_words + column / 64u);
+            for (uint64_t i = rows; i < 64u; ++i)
+                tile[i] = 0;
+            bitset_transpose64(tile);
+            for (uint64_t i = 0; i < columns; ++i)
+                bitset_update_word(destination_bits, (column + i) * destination_words + row / 64u, UINT64_MAX, tile[i]);
         }
-        --bitset->size;
     }
-    // else throw exception in safe version
+
+    BITSET_TRACE_END("matrix_transpose", source->bits.storage_size * sizeof(bitset_block_t));
+    return true;
 }
 
 /**
- * Pushes back a block to the bitset, adjusting the size to the nearest multiple of sizeof(T) upwards. [e.g. 65 bits -> (+8 {block} +7 {expanded area} = +15) -> 80 bits]
- * The bits in the expanded area may be initialized by previous calls, but their values are not explicitly defined by this function.
- * @memberof BitSet
- * @param bitset Pointer to bitset to modify
- * @param block The block to push back (block value)
+ * Copies a column of the matrix (gathers one bit per row, transpose the matrix to read many columns)
+ * @memberof BitMatrix
+ * @param matrix Pointer to matrix to read from
+ * @param column Index of the column
+ * @param destination Pointer to bitset to store the column to (at least matrix->rows bits), its first matrix->rows bits are overwritten
  */
-void bitset_dynamic_push_back_block(DynamicBitSet* const bitset, const uint8_t block)
+BITSET_API void bitset_matrix_extract_column(const BitMatrix* const matrix, const uint64_t column, BitSet* const destination)
 {
-    uint8_t* new_data = (uint8_t*)malloc(bitset->storage_size + (bitset->size % 8 ? 2 : 1));
-    if (bitset->data)
+    BITSET_STATS_RECORD(BITSET_STATS_ACCESS, matrix->rows, matrix->rows * sizeof(bitset_block_t));
+    const bitset_block_t* block = matrix->bits.data + column / BITSET_BLOCK_BITS;
+    for (uint64_t row = 0; row < matrix->rows; row += 64u)
     {
-        memcpy(new_data, bitset->data, bitset->storage_size);
-        free(bitset->data);
+        const uint64_t rows = matrix->rows - row < 64u ? matrix->rows - row : 64u;
+        uint64_t word = 0;
+        for (uint64_t i = 0; i < rows; ++i, block += matrix->row_stride)
+            word |= (uint64_t)(*block >> column % BITSET_BLOCK_BITS & 1u) << i;
+        bitset_update_word(destination, row / 64u, rows < 64u ? UINT64_MAX >> (64u - rows) : UINT64_MAX, word);
     }
-    bitset->data = new_data;
-    *(bitset->data + bitset->storage_size++) = block;
-    bitset->size += 8 + (bitset->size % 8 ? 8 - bitset->size % 8 : 0);
 }
 
 /**
- * Removes the last block from the bitset, adjusting the size to the nearest lower multiple of sizeof(T). [e.g. 65 bits -> 64 bits -> 56 bits]
- * @memberof BitSet
- * @param bitset Pointer to bitset to modify
+ * Computes row = row op other for every row of the matrix
+ * @memberof BitMatrix
+ * @param matrix Pointer to matrix to modify
+ * @param other Pointer to the right operand (at least matrix->columns bits)
+ * @param operation The operation to apply
  */
-void bitset_dynamic_pop_back_block(DynamicBitSet* const bitset)
+BITSET_API void bitset_matrix_rows_operation(BitMatrix* const matrix, const BitSet* const other, const bitset_operation operation)
 {
-	if (bitset->data)
-	{
-		if (bitset->size % 8)
-		{
-			uint8_t* new_data = (uint8_t*)malloc((bitset->storage_size - 1) * sizeof(uint8_t));
-			memcpy(new_data, bitset->data, bitset->storage_size - 1);
-			free(bitset->data);
-			bitset->data = new_data;
-		}
-		bitset->size -= 8;
-	}
-	// else throw exception in safe version
+    for (uint64_t i = 0; i < matrix->rows; ++i)
+    {
+        DynamicBitSet view;
+        BitSet* const row = bitset_matrix_row(matrix, i, &view);
+        bitset_binary_operation(row, row, other, operation);
+    }
 }
 
 /**
- * Resizes the bitset to the specified size
- * @memberof BitSet
- * @param bitset Pointer to bitset to resize
- * @param new_size The new size of the bitset (bit size)
+ * Folds the specified rows with the operation, destination = rows[0] op rows[1] op ... op rows[count - 1]
+ * @memberof BitMatrix
+ * @param matrix Pointer to matrix to read from
+ * @param rows Indices of the rows to fold
+ * @param count Number of rows (destination is left unchanged for 0)
+ * @param operation The operation to apply
+ * @param destination Pointer to bitset to store the result to (at least matrix->columns bits), its first matrix->columns bits are overwritten
  */
-void bitset_dynamic_resize(DynamicBitSet* const bitset, const uint64_t new_size)
+BITSET_API void bitset_matrix_reduce_rows(const BitMatrix* const matrix, const uint64_t* const rows, const uint64_t count, const bitset_operation operation, BitSet* const destination)
 {
-	if (new_size == bitset->size)
-		return;
-
-	const uint64_t new_storage_size = bitset_calculate_storage_size(new_size);
-	uint8_t* new_data = (uint8_t*)malloc(new_storage_size * sizeof(uint8_t));
-	if (bitset->data)
-	{
-		memcpy(new_data, bitset->data, new_storage_size);
-		free(bitset->data);
-	}
-	bitset->data = new_data;
-	bitset->storage_size = new_storage_size;
-	bitset->size = new_size;
+    if (!count)
+        return;
+    // the result covers the columns only, the bits of destination past them are kept
+    const uint64_t size = destination->size;
+    destination->size = matrix->columns;
+    DynamicBitSet view;
+    const BitSet* const first = bitset_matrix_row(matrix, *rows, &view);
+    bitset_binary_operation(destination, first, first, BITSET_OPERATION_OR);
+    for (uint64_t i = 1; i < count; ++i)
+        bitset_binary_operation(destination, destination, bitset_matrix_row(matrix, *(rows + i), &view), operation);
+    destination->size = size;
 }
 
 /**
- * Calculates the number of bytes required to store the bitset
- * @memberof BitSet
- * @param size The size of the bitset
- * @return The number of bytes required to store the bitset
+ * Counts the set bits of every row
+ * @memberof BitMatrix
+ * @param matrix Pointer to matrix to count
+ * @param counts Array receiving the number of set bits of every row (matrix->rows values)
  */
-inline const uint64_t bitset_calculate_storage_size(const uint64_t size)
+BITSET_API void bitset_matrix_count_rows(const BitMatrix* const matrix, uint64_t* const counts)
 {
-    return size / 8u + (size % 8u ? 1 : 0);
+    for (uint64_t i = 0; i < matrix->rows; ++i)
+    {
+        DynamicBitSet view;
+        *(counts + i) = bitset_count(bitset_matrix_row(matrix, i, &view));
+    }
 }
 
 /**
- * Creates a block of type uint8_t based on the given boolean value.
- *
- * @param value A boolean value indicating whether to create the block with the maximum value or zero.
- * @return The created block of type uint8_t. If value is true, returns the maximum value representable by type uint8_t, which is 255,
- *         otherwise returns zero.
+ * Counts the set bits of row op other for every row, without storing the results (e.g. the overlap of every row with a query)
+ * @memberof BitMatrix
+ * @param matrix Pointer to matrix to read from
+ * @param other Pointer to the right operand (at least matrix->columns bits)
+ * @param operation The operation to apply
+ * @param counts Array receiving the count of every row (matrix->rows values)
  */
-inline const uint8_t bitset_create_filled_block(const bool value)
+BITSET_API void bitset_matrix_binary_count_rows(const BitMatrix* const matrix, const BitSet* const other, const bitset_operation operation, uint64_t* const counts)
 {
-    return value ? 255u : 0u;
-}
\ No newline at end of file
+    for (uint64_t i = 0; i < matrix->rows; ++i)
+    {
+        DynamicBitSet view;
+        *(counts + i) = bitset_binary_count(bitset_matrix_row(matrix, i, &view), other, operation);
+    }
+}
@@ -0,0 +1,4529 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// shared word and SIMD kernels (adjust as needed)
+#include "../C/BitSet.h"
+
+/**
+ * Allocator aligning the chunks to BITSET_ALIGNMENT (64 bytes by default), the default allocator of CDynamicBitSet
+ * @tparam T Type of the allocated elements
+ */
+template <typename T>
+struct CAlignedAllocator
+{
+    using value_type = T;
+
+    /**
+     * Alignment of the allocations in bytes
+     */
+    static constexpr std::size_t alignment = BITSET_ALIGNMENT > alignof(T) ? BITSET_ALIGNMENT : alignof(T);
+
+    CAlignedAllocator() noexcept = default;
+
+    template <typename U>
+    CAlignedAllocator(const CAlignedAllocator<U>&) noexcept {}
+
+    /**
+     * @param count Number of elements to allocate
+     * @return The allocated memory (uninitialized)
+     */
+    [[nodiscard]] T* allocate(const std::size_t count)
+    {
+        return static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t(alignment)));
+    }
+
+    /**
+     * @param pointer The memory to release
+     * @param count Number of elements the memory was allocated with
+     */
+    void deallocate(T* const pointer, const std::size_t count) noexcept
+    {
+        ::operator delete(pointer, count * sizeof(T), std::align_val_t(alignment));
+    }
+
+    template <typename U>
+    bool operator==(const CAlignedAllocator<U>&) const noexcept { return true; }
+
+    template <typename U>
+    bool operator!=(const CAlignedAllocator<U>&) const noexcept { return false; }
+};
+
+/**
+ * Adapter of a C bitset_allocator (e.g. a bitset_pool or BITSET_HUGE_PAGE_ALLOCATOR) for CDynamicBitSet
+ * @tparam T Type of the allocated elements
+ */
+template <typename T>
+struct CBitSetAllocator
+{
+    using value_type = T;
+
+    /**
+     * The C allocator (NULL for the default allocator), has to outlive every bitset using it
+     */
+    const bitset_allocator* allocator;
+
+    CBitSetAllocator(const bitset_allocator* const allocator = nullptr) noexcept : allocator(allocator) {}
+
+    template <typename U>
+    CBitSetAllocator(const CBitSetAllocator<U>& other) noexcept : allocator(other.allocator) {}
+
+    /**
+     * @param count Number of elements to allocate
+     * @return The allocated memory (uninitialized)
+     */
+    [[nodiscard]] T* allocate(const std::size_t count)
+    {
+        T* const pointer = static_cast<T*>(bitset_allocate(allocator, count * sizeof(T)));
+        if (!pointer && count)
+            throw std::bad_alloc();
+        return pointer;
+    }
+
+    /**
+     * @param pointer The memory to release
+     * @param count Number of elements the memory was allocated with
+     */
+    void deallocate(T* const pointer, const std::size_t count) noexcept
+    {
+        bitset_deallocate(allocator, pointer, count * sizeof(T));
+    }
+
+    template <typename U>
+    bool operator==(const CBitSetAllocator<U>& other) const noexcept { return allocator == other.allocator; }
+
+    template <typename U>
+    bool operator!=(const CBitSetAllocator<U>& other) const noexcept { return allocator != other.allocator; }
+};
+
+#ifdef BITSET_ENABLE_STATS
+/**
+ * Emits the trace markers of a bulk operation for the lifetime of the scope (see bitset_trace_begin)
+ */
+class CBitSetTraceScope
+{
+public:
+    CBitSetTraceScope(const char* const name, const uint64_t bytes) noexcept : name(name), bytes(bytes)
+    {
+        BITSET_TRACE_BEGIN(name, bytes);
+    }
+
+    ~CBitSetTraceScope()
+    {
+        BITSET_TRACE_END(name, bytes);
+    }
+
+    CBitSetTraceScope(const CBitSetTraceScope&) = delete;
+    CBitSetTraceScope& operator=(const CBitSetTraceScope&) = delete;
+
+private:
+    const char* name;
+    uint64_t bytes;
+};
+
+#define BITSET_TRACE_SCOPE(name, bytes) const CBitSetTraceScope bitset_trace_scope(name, bytes)
+#else
+#define BITSET_TRACE_SCOPE(name, bytes) ((void)0)
+#endif
+
+template <typename T, typename Allocator>
+class CBitSetView;
+
+template <typename Derived>
+class CBitSetExpression;
+
+template <typename T, typename Allocator>
+class CBitSetTerminal;
+
+/**
+ * A dynamic bitset class (for C++ API bitset)
+ * @tparam T Type of a single storage block (chunk), any unsigned integral type, e.g. uint8_t or uint64_t
+ * @tparam Allocator Allocator of the chunks, e.g. CBitSetAllocator<T> for the C pool and huge page allocators or std::pmr::polymorphic_allocator<T>
+ */
+template <typename T = uint8_t, typename Allocator = CAlignedAllocator<T>>
+class CDynamicBitSet
+{
+    static_assert(std::is_integral_v<T> && std::is_unsigned_v<T> && !std::is_same_v<T, bool>, "CDynamicBitSet: T has to be an unsigned integral type");
+    static_assert(std::is_same_v<typename std::allocator_traits<Allocator>::value_type, T>, "CDynamicBitSet: Allocator has to allocate T");
+
+    using allocator_traits = std::allocator_traits<Allocator>;
+
+public:
+    /**
+     * Number of bits in a single chunk
+     */
+    static constexpr uint64_t chunk_bits = sizeof(T) * 8u;
+
+    /**
+     * Chunk with all of the bits set
+     */
+    static constexpr T chunk_max = static_cast<T>(~static_cast<T>(0u));
+
+    /**
+     * Number of chunks in a 64-bit word (word-at-a-time scans assemble words from chunks)
+     */
+    static constexpr uint64_t chunks_per_word = 64u / chunk_bits;
+
+    /**
+     * Index returned by the find functions when no matching bit exists
+     */
+    static constexpr uint64_t npos = BITSET_NPOS;
+
+    /**
+     * Underlying array of chunks containing the bits
+     */
+    T* data;
+    /**
+     * Size of bitset in bits
+     */
+    uint64_t size;
+    /**
+     * Size of bitset in chunks
+     */
+    uint64_t storage_size;
+    /**
+     * Number of allocated chunks (at least storage_size)
+     */
+    uint64_t capacity;
+    /**
+     * Allocator of the chunks
+     */
+    Allocator allocator;
+
+    /**
+     * Default constructor, creates an empty bitset
+     */
+    CDynamicBitSet() noexcept(std::is_nothrow_default_constructible_v<Allocator>) : data(nullptr), size(0), storage_size(0), capacity(0), allocator() {}
+
+    /**
+     * Allocator constructor, creates an empty bitset
+     * @param allocator The allocator of the chunks
+     */
+    explicit CDynamicBitSet(const Allocator& allocator) noexcept : data(nullptr), size(0), storage_size(0), capacity(0), allocator(allocator) {}
+
+    /**
+     * Size constructor, all of the bits are cleared
+     * @param size The size of the bitset (bit size)
+     * @param allocator The allocator of the chunks
+     */
+    explicit CDynamicBitSet(const uint64_t size, const Allocator& allocator = Allocator()) : size(size), storage_size(calculate_storage_size(size)), capacity(storage_size), allocator(allocator)
+    {
+        T* const chunks = allocate(capacity);
+        data = chunks;
+        if (chunks)
+            std::memset(chunks, 0, storage_size * sizeof(T));
+    }
+
+    /**
+     * Size and value constructor
+     * @param size The size of the bitset (bit size)
+     * @param chunk The chunk to fill the bitset with (chunk value)
+     * @param allocator The allocator of the chunks
+     */
+    CDynamicBitSet(const uint64_t size, const T chunk, const Allocator& allocator = Allocator()) : size(size), storage_size(calculate_storage_size(size)), capacity(storage_size), allocator(allocator)
+    {
+        data = allocate(capacity);
+        if (data)
+            fill_chunk(chunk);
+    }
+
+    /**
+     * Copy constructor
+     * @param other The bitset to copy
+     */
+    CDynamicBitSet(const CDynamicBitSet& other) : size(other.size), storage_size(other.storage_size), capacity(other.storage_size), allocator(allocator_traits::select_on_container_copy_construction(other.allocator))
+    {
+        data = allocate(capacity);
+        if (storage_size)
+            std::memcpy(data, other.data, storage_size * sizeof(T));
+    }
+
+    /**
+     * Evaluates a lazy expression in a single pass, see CBitSetExpression
+     * @param expression The expression to evaluate, the bitset is sized like it
+     * @param allocator The allocator of the chunks
+     */
+    template <typename Expression>
+    CDynamicBitSet(const CBitSetExpression<Expression>& expression, const Allocator& allocator = Allocator()) : CDynamicBitSet(expression.derived().size(), allocator)
+    {
+        assign(expression);
+    }
+
+    /**
+     * Move constructor
+     * @param other The bitset to move from (left empty)
+     */
+    CDynamicBitSet(CDynamicBitSet&& other) noexcept : data(other.data), size(other.size), storage_size(other.storage_size), capacity(other.capacity), allocator(std::move(other.allocator))
+    {
+        other.data = nullptr;
+        other.size = other.storage_size = other.capacity = 0;
+    }
+
+    /**
+     * Destructor (frees the memory)
+     */
+    ~CDynamicBitSet()
+    {
+        deallocate(data, capacity);
+    }
+
+    /**
+     * Copy assignment
+     * @param other The bitset to copy
+     * @return Reference to this bitset
+     */
+    CDynamicBitSet& operator=(const CDynamicBitSet& other)
+    {
+        if (this != &other)
+        {
+            if constexpr (allocator_traits::propagate_on_container_copy_assignment::value)
+            {
+                if (allocator != other.allocator)
+                {
+                    deallocate(data, capacity);
+                    data = nullptr;
+                    capacity = 0;
+                }
+                allocator = other.allocator;
+            }
+            if (capacity < other.storage_size)
+            {
+                deallocate(data, capacity);
+                data = nullptr;
+                capacity = 0;
+                data = allocate(other.storage_size); // left empty if this throws
+                capacity = other.storage_size;
+            }
+            size = other.size;
+            storage_size = other.storage_size;
+            if (storage_size)
+                std::memcpy(data, other.data, storage_size * sizeof(T));
+        }
+        return *this;
+    }
+
+    /**
+     * Evaluates a lazy expression in a single pass, see CBitSetExpression
+     * @param expression The expression to evaluate, the bitset is resized like it
+     * @return Reference to this bitset
+     */
+    template <typename Expression>
+    CDynamicBitSet& operator=(const CBitSetExpression<Expression>& expression)
+    {
+        if (size != expression.derived().size())
+            resize(expression.derived().size());
+        assign(expression);
+        return *this;
+    }
+
+    /**
+     * Move assignment (copies the chunks if the allocators differ and do not propagate)
+     * @param other The bitset to move from (left empty)
+     * @return Reference to this bitset
+     */
+    CDynamicBitSet& operator=(CDynamicBitSet&& other) noexcept(allocator_traits::propagate_on_container_move_assignment::value || allocator_traits::is_always_equal::value)
+    {
+        if (this != &other)
+        {
+            if constexpr (!allocator_traits::propagate_on_container_move_assignment::value && !allocator_traits::is_always_equal::value)
+            {
+                if (allocator != other.allocator)
+                {
+                    *this = static_cast<const CDynamicBitSet&>(other);
+                    return *this;
+                }
+            }
+            deallocate(data, capacity);
+            if constexpr (allocator_traits::propagate_on_container_move_assignment::value)
+                allocator = std::move(other.allocator);
+            data = std::exchange(other.data, nullptr);
+            size = std::exchange(other.size, 0);
+            storage_size = std::exchange(other.storage_size, 0);
+            capacity = std::exchange(other.capacity, 0);
+        }
+        return *this;
+    }
+
+    /**
+     * Retrieves the value of a bit at a specified index
+     * @param index The index of the bit to read (bit index)
+     * @return The value of the bit at the specified index
+     */
+    bool get(const uint64_t index) const noexcept
+    {
+        BITSET_STATS_RECORD(BITSET_STATS_ACCESS, 1u, sizeof(T));
+        return (data[index / chunk_bits] >> index % chunk_bits) & 1u;
+    }
+
+    /**
+     * Retrieves the value of a bit at a specified index
+     * @param index The index of the bit to read (bit index)
+     * @return The value of the bit at the specified index
+     */
+    bool operator[](const uint64_t index) const noexcept
+    {
+        return get(index);
+    }
+
+    /**
+     * Sets the value of a bit at a specified index
+     * @param value The value to set the bit to
+     * @param index The index of the bit to modify (bit index)
+     */
+    void set(const bool value, const uint64_t index) noexcept
+    {
+        BITSET_STATS_RECORD(BITSET_STATS_ACCESS, 1u, sizeof(T));
+        if (value)
+            data[index / chunk_bits] |= static_cast<T>(T(1u) << index % chunk_bits);
+        else
+            data[index / chunk_bits] &= static_cast<T>(~(T(1u) << index % chunk_bits));
+    }
+
+    /**
+     * Sets the value of a bit at a specified index to 1 (true)
+     * @param index The index of the bit to set (bit index)
+     */
+    void set(const uint64_t index) noexcept
+    {
+        BITSET_STATS_RECORD(BITSET_STATS_ACCESS, 1u, sizeof(T));
+        data[index / chunk_bits] |= static_cast<T>(T(1u) << index % chunk_bits);
+    }
+
+    /**
+     * Sets the value of a bit at a specified index to 0 (false)
+     * @param index The index of the bit to clear (bit index)
+     */
+    void clear(const uint64_t index) noexcept
+    {
+        BITSET_STATS_RECORD(BITSET_STATS_ACCESS, 1u, sizeof(T));
+        data[index / chunk_bits] &= static_cast<T>(~(T(1u) << index % chunk_bits));
+    }
+
+    /**
+     * Flips the bit at the specified index
+     * @param index Index of the bit to flip (bit index)
+     */
+    void flip(const uint64_t index) noexcept
+    {
+        BITSET_STATS_RECORD(BITSET_STATS_ACCESS, 1u, sizeof(T));
+        data[index / chunk_bits] ^= static_cast<T>(T(1u) << index % chunk_bits);
+    }
+
+    /**
+     * Sets the bits at the specified indices to 1 (true), faster than separate set calls on random indices
+     * @param indices The indices of the bits to set (bit index)
+     * @param count Number of indices
+     */
+    void set_many(const uint64_t* const indices, const uint64_t count) noexcept
+    {
+        update_many(indices, count, true, true);
+    }
+
+    /**
+     * Sets the bits at the specified indices to 0 (false)
+     * @param indices The indices of the bits to clear (bit index)
+     * @param count Number of indices
+     */
+    void clear_many(const uint64_t* const indices, const uint64_t count) noexcept
+    {
+        update_many(indices, count, true, false);
+    }
+
+    /**
+     * Flips the bits at the specified indices (an index present twice is flipped twice)
+     * @param indices The indices of the bits to flip (bit index)
+     * @param count Number of indices
+     */
+    void flip_many(const uint64_t* const indices, const uint64_t count) noexcept
+    {
+        update_many(indices, count, false, true);
+    }
+
+    /**
+     * Retrieves the values of the bits at the specified indices, prefetching ahead (and with AVX2 gathers on little-endian x86)
+     * @param indices The indices of the bits to read (bit index)
+     * @param count Number of indices
+     * @param values Array receiving the value of every bit (count values)
+     */
+    void get_many(const uint64_t* const indices, const uint64_t count, bool* const values) const noexcept
+    {
+        BITSET_STATS_RECORD(BITSET_STATS_ACCESS, count, count * sizeof(T));
+#ifdef BITSET_LITTLE_ENDIAN
+        bitset_get_many_bytes(reinterpret_cast<const uint8_t*>(data), storage_size * sizeof(T), indices, count, values);
+#else
+        for (uint64_t i = 0; i < count; ++i)
+        {
+            if (i + BITSET_PREFETCH_DISTANCE < count)
+                BITSET_PREFETCH(data + indices[i + BITSET_PREFETCH_DISTANCE] / chunk_bits, 0);
+            values[i] = (data[indices[i] / chunk_bits] >> indices[i] % chunk_bits) & 1u;
+        }
+#endif
+    }
+
+    /**
+     * Fills the bitset with a specified value
+     * @param value The value to fill the bitset with
+     */
+    void fill(const bool value) noexcept
+    {
+        BITSET_STATS_RECORD(BITSET_STATS_FILL, size, storage_size * sizeof(T));
+        BITSET_TRACE_SCOPE("fill", storage_size * sizeof(T));
+        if (storage_size)
+            std::memset(data, value ? 255u : 0u, storage_size * sizeof(T));
+    }
+
+    /**
+     * Sets all the bits (sets all bits to 1)
+     */
+    void set() noexcept
+    {
+        fill(true);
+    }
+
+    /**
+     * Clears all the bits (sets all bits to 0)
+     */
+    void clear() noexcept
+    {
+        fill(false);
+    }
+
+    /**
+     * Flips all the bits
+     */
+    void flip() noexcept
+    {
+        BITSET_STATS_RECORD(BITSET_STATS_FILL, size, storage_size * sizeof(T));
+        BITSET_TRACE_SCOPE("flip", storage_size * sizeof(T));
+        for (uint64_t i = 0; i < storage_size; ++i)
+            data[i] = static_cast<T>(~data[i]);
+    }
+
+    /**
+     * Fills all the bits in the specified range with the specified value
+     * @param value Value to fill the bits with (bit value)
+     * @param begin Begin of the range to fill (bit index)
+     * @param end End of the range to fill (bit index)
+     */
+    void fill_in_range(const bool value, const uint64_t begin, const uint64_t end) noexcept
+    {
+        if (begin >= end)
+            return;
+
+        const uint64_t first = begin / chunk_bits, last = (end - 1) / chunk_bits;
+        T first_mask = create_mask_from(begin % chunk_bits);
+        const T last_mask = create_mask_to((end - 1) % chunk_bits + 1);
+        BITSET_STATS_RECORD(BITSET_STATS_FILL, end - begin, (last - first + 1u) * sizeof(T));
+
+        // both ends in the same chunk, only the bits in between are touched
+        if (first == last)
+            first_mask &= last_mask;
+
+        if (value)
+            data[first] |= first_mask;
+        else
+            data[first] &= static_cast<T>(~first_mask);
+
+        if (first != last)
+        {
+            // whole chunks in between
+            BITSET_TRACE_SCOPE("fill", (last - first - 1) * sizeof(T));
+            std::memset(data + first + 1, value ? 255u : 0u, (last - first - 1) * sizeof(T));
+
+            if (value)
+                data[last] |= last_mask;
+            else
+                data[last] &= static_cast<T>(~last_mask);
+        }
+    }
+
+    /**
+     * Fills all the bits in the specified range with the specified value
+     * @param value Value to fill the bits with (bit value)
+     * @param end End of the range to fill (bit index)
+     */
+    void fill_in_range(const bool value, const uint64_t end) noexcept
+    {
+        fill_in_range(value, 0, end);
+    }
+
+    /**
+     * Fills every step-th bit in the specified range with the specified value
+     * @param value Value to fill the bits with (bit value)
+     * @param begin Begin of the range to fill (bit index)
+     * @param end End of the range to fill (bit index)
+     * @param step Step size between the bits to fill (bit step)
+     */
+    void fill_in_range(const bool value, const uint64_t begin, const uint64_t end, const uint64_t step) noexcept
+    {
+        if (step == 1)
+            fill_in_range(value, begin, end);
+        else
+            update_in_range(begin, end, step, 1, UINT64_MAX, value ? UINT64_MAX : 0u);
+    }
+
+    /**
+     * Sets all the bits in the specified range to 1 (true)
+     * @param end End of the range to set (bit index)
+     */
+    void set_in_range(const uint64_t end) noexcept
+    {
+        fill_in_range(true, 0, end);
+    }
+
+    /**
+     * Sets all the bits in the specified range to 1 (true)
+     * @param begin Begin of the range to set (bit index)
+     * @param end End of the range to set (bit index)
+     */
+    void set_in_range(const uint64_t begin, const uint64_t end) noexcept
+    {
+        fill_in_range(true, begin, end);
+    }
+
+    /**
+     * Sets every step-th bit in the specified range to 1 (true)
+     * @param begin Begin of the range to set (bit index)
+     * @param end End of the range to set (bit index)
+     * @param step Step size between the bits to set (bit step)
+     */
+    void set_in_range(const uint64_t begin, const uint64_t end, const uint64_t step) noexcept
+    {
+        fill_in_range(true, begin, end, step);
+    }
+
+    /**
+     * Clears all the bits in the specified range (sets them to 0)
+     * @param end End of the range to clear (bit index)
+     */
+    void clear_in_range(const uint64_t end) noexcept
+    {
+        fill_in_range(false, 0, end);
+    }
+
+    /**
+     * Clears all the bits in the specified range (sets them to 0)
+     * @param begin Begin of the range to clear (bit index)
+     * @param end End of the range to clear (bit index)
+     */
+    void clear_in_range(const uint64_t begin, const uint64_t end) noexcept
+    {
+        fill_in_range(false, begin, end);
+    }
+
+    /**
+     * Clears every step-th bit in the specified range (sets them to 0)
+     * @param begin Begin of the range to clear (bit index)
+     * @param end End of the range to clear (bit index)
+     * @param step Step size between the bits to clear (bit step)
+     */
+    void clear_in_range(const uint64_t begin, const uint64_t end, const uint64_t step) noexcept
+    {
+        fill_in_range(false, begin, end, step);
+    }
+
+    /**
+     * Flips all the bits in the specified range
+     * @param end End of the range to flip (bit index)
+     */
+    void flip_in_range(const uint64_t end) noexcept
+    {
+        flip_in_range(0, end);
+    }
+
+    /**
+     * Flips all the bits in the specified range
+     * @param begin Begin of the range to flip (bit index)
+     * @param end End of the range to flip (bit index)
+     */
+    void flip_in_range(const uint64_t begin, const uint64_t end) noexcept
+    {
+        if (begin >= end)
+            return;
+
+        const uint64_t first = begin / chunk_bits, last = (end - 1) / chunk_bits;
+        const T first_mask = create_mask_from(begin % chunk_bits);
+        const T last_mask = create_mask_to((end - 1) % chunk_bits + 1);
+        BITSET_STATS_RECORD(BITSET_STATS_FILL, end - begin, (last - first + 1u) * sizeof(T));
+
+        if (first == last)
+        {
+            data[first] ^= static_cast<T>(first_mask & last_mask);
+            return;
+        }
+
+        BITSET_TRACE_SCOPE("flip", (last - first - 1) * sizeof(T));
+        data[first] ^= first_mask;
+        for (uint64_t i = first + 1; i < last; ++i)
+            data[i] = static_cast<T>(~data[i]);
+        data[last] ^= last_mask;
+    }
+
+    /**
+     * Flips every step-th bit in the specified range
+     * @param begin Begin of the range to flip (bit index)
+     * @param end End of the range to flip (bit index)
+     * @param step Step size between the bits to flip (bit step)
+     */
+    void flip_in_range(const uint64_t begin, const uint64_t end, const uint64_t step) noexcept
+    {
+        if (step == 1)
+            flip_in_range(begin, end);
+        else
+            update_in_range(begin, end, step, 1, 0u, UINT64_MAX);
+    }
+
+    /**
+     * Retrieves the chunk at the specified index
+     * @param index Index of the chunk to read (chunk index)
+     * @return The chunk at the specified index
+     */
+    T get_chunk(const uint64_t index) const noexcept
+    {
+        return data[index];
+    }
+
+    /**
+     * Sets the chunk at the specified index to the specified value
+     * @param chunk The chunk to set (chunk value)
+     * @param index The index of the chunk to set (chunk index)
+     */
+    void set_chunk(const T chunk, const uint64_t index) noexcept
+    {
+        data[index] = chunk;
+    }
+
+    /**
+     * Fills all the chunks with the specified value
+     * @param chunk The value to fill the chunks with (chunk value)
+     */
+    void fill_chunk(const T chunk) noexcept
+    {
+        fill_chunk_in_range(chunk, 0, storage_size);
+    }
+
+    /**
+     * Fills all the chunks in the specified range with the specified chunk
+     * @param chunk Chunk to fill the bits with (chunk value)
+     * @param end End of the range to fill (chunk index)
+     */
+    void fill_chunk_in_range(const T chunk, const uint64_t end) noexcept
+    {
+        fill_chunk_in_range(chunk, 0, end);
+    }
+
+    /**
+     * Fills all the chunks in the specified range with the specified chunk
+     * @param chunk Chunk to fill the bits with (chunk value)
+     * @param begin Begin of the range to fill (chunk index)
+     * @param end End of the range to fill (chunk index)
+     */
+    void fill_chunk_in_range(const T chunk, const uint64_t begin, const uint64_t end) noexcept
+    {
+        if (begin >= end)
+            return;
+        // the chunk repeated over a native word has the period of a chunk, so any chunk-aligned start keeps the phase
+        bitset_fill_pattern_bytes(reinterpret_cast<uint8_t*>(data + begin), UINT64_MAX / chunk_max * chunk, (end - begin) * sizeof(T));
+    }
+
+    /**
+     * Fills every step-th chunk in the specified range with the specified chunk
+     * @param chunk Chunk to fill the bits with (chunk value)
+     * @param begin Begin of the range to fill (chunk index)
+     * @param end End of the range to fill (chunk index)
+     * @param step Step size between the chunks to fill (chunk step)
+     */
+    void fill_chunk_in_range(const T chunk, const uint64_t begin, const uint64_t end, const uint64_t step) noexcept
+    {
+        if (step == 1)
+            fill_chunk_in_range(chunk, begin, end);
+        else
+            update_in_range(begin * chunk_bits, end * chunk_bits, step * chunk_bits, chunk_bits, UINT64_MAX, UINT64_MAX / chunk_max * chunk);
+    }
+
+    /**
+     * Fills all the bits in the specified range with a repeating pattern, bit i receives bit i % pattern_bits of the pattern
+     * The pattern is anchored at bit 0 of the bitset, so consecutive calls over adjacent ranges continue it seamlessly
+     * @param pattern The pattern to fill the bits with (its lowest pattern_bits bits are used)
+     * @param pattern_bits Length of the pattern (8, 16, 32 or 64), other lengths leave the bitset unchanged
+     * @param begin Begin of the range to fill (bit index)
+     * @param end End of the range to fill (bit index)
+     */
+    void fill_pattern_in_range(const uint64_t pattern, const uint64_t pattern_bits, const uint64_t begin, const uint64_t end) noexcept
+    {
+        if (begin >= end || (pattern_bits != 8u && pattern_bits != 16u && pattern_bits != 32u && pattern_bits != 64u))
+            return;
+        BITSET_STATS_RECORD(BITSET_STATS_FILL, end - begin, ((end - 1) / chunk_bits - begin / chunk_bits + 1u) * sizeof(T));
+
+        uint64_t word = pattern;
+        for (uint64_t bits = pattern_bits; bits < 64u; bits *= 2u)
+            word = (word & (UINT64_MAX >> (64u - bits))) * ((1ull << bits) + 1u);
+
+        // the memory image of a word of bits, chunk by chunk in native order
+        T chunks[chunks_per_word];
+        uint64_t image;
+        for (uint64_t k = 0; k < chunks_per_word; ++k)
+            chunks[k] = static_cast<T>(word >> k * chunk_bits);
+        std::memcpy(&image, chunks, sizeof(uint64_t));
+
+        const uint64_t first = begin / chunk_bits, last = (end - 1) / chunk_bits;
+        T first_mask = create_mask_from(begin % chunk_bits);
+        const T last_mask = create_mask_to((end - 1) % chunk_bits + 1);
+
+        // both ends in the same chunk, only the bits in between are touched
+        if (first == last)
+            first_mask &= last_mask;
+
+        data[first] = static_cast<T>((data[first] & ~first_mask) | (chunks[first % chunks_per_word] & first_mask));
+
+        if (first != last)
+        {
+            // whole chunks in between, starting at the matching byte of the image
+            BITSET_TRACE_SCOPE("fill_pattern", (last - first - 1) * sizeof(T));
+            bitset_fill_pattern_bytes(reinterpret_cast<uint8_t*>(data + first + 1), bitset_rotate_pattern_bytes(image, (first + 1) % chunks_per_word * sizeof(T)), (last - first - 1) * sizeof(T));
+            data[last] = static_cast<T>((data[last] & ~last_mask) | (chunks[last % chunks_per_word] & last_mask));
+        }
+    }
+
+    /**
+     * Flips the chunk at the specified index
+     * @param index Index of the chunk to flip (chunk index)
+     */
+    void flip_chunk(const uint64_t index) noexcept
+    {
+        data[index] = static_cast<T>(~data[index]);
+    }
+
+    /**
+     * Flips all the chunks in the specified range
+     * @param begin Begin of the range to flip (chunk index)
+     * @param end End of the range to flip (chunk index)
+     * @param step Step size between the chunks to flip (chunk step)
+     */
+    void flip_chunk_in_range(const uint64_t begin, const uint64_t end, const uint64_t step = 1) noexcept
+    {
+        if (step == 1)
+        {
+            for (uint64_t i = begin; i < end; ++i)
+                data[i] = static_cast<T>(~data[i]);
+        }
+        else
+            update_in_range(begin * chunk_bits, end * chunk_bits, step * chunk_bits, chunk_bits, 0u, UINT64_MAX);
+    }
+
+    /**
+     * Checks if all the bits are set
+     * @return True if all the bits are set, false otherwise
+     */
+    bool all() const noexcept
+    {
+        const uint64_t full_chunks = size / chunk_bits;
+        if (bitset_find_byte_not(reinterpret_cast<const uint8_t*>(data), full_chunks * sizeof(T), UINT8_MAX) != full_chunks * sizeof(T))
+            return false;
+        if (size % chunk_bits)
+        {
+            const T tail_mask = create_mask_to(size % chunk_bits);
+            return (data[full_chunks] & tail_mask) == tail_mask;
+        }
+        return true;
+    }
+
+    /**
+     * Checks if any of the bits are set
+     * @return True if any of the bits are set, false otherwise
+     */
+    bool any() const noexcept
+    {
+        const uint64_t full_chunks = size / chunk_bits;
+        if (bitset_find_byte_not(reinterpret_cast<const uint8_t*>(data), full_chunks * sizeof(T), 0u) != full_chunks * sizeof(T))
+            return true;
+        if (size % chunk_bits)
+            return data[full_chunks] & create_mask_to(size % chunk_bits);
+        return false;
+    }
+
+    /**
+     * Checks if none of the bits are set
+     * @return True if none of the bits are set, false otherwise
+     */
+    bool none() const noexcept
+    {
+        return !any();
+    }
+
+    /**
+     * Checks if all the bits in the specified range are set
+     * @param begin Begin of the range to check (bit index)
+     * @param end End of the range to check (bit index)
+     * @return True if all the bits in the range are set (also for an empty range), false otherwise
+     */
+    bool all_in_range(const uint64_t begin, const uint64_t end) const noexcept
+    {
+        if (begin >= end)
+            return true;
+
+        const uint64_t first = begin / chunk_bits, last = (end - 1) / chunk_bits;
+        const T first_mask = create_mask_from(begin % chunk_bits);
+        const T last_mask = create_mask_to((end - 1) % chunk_bits + 1);
+
+        if (first == last)
+            return (data[first] & first_mask & last_mask) == static_cast<T>(first_mask & last_mask);
+
+        return (data[first] & first_mask) == first_mask && (data[last] & last_mask) == last_mask
+            && bitset_find_byte_not(reinterpret_cast<const uint8_t*>(data + first + 1), (last - first - 1) * sizeof(T), UINT8_MAX) == (last - first - 1) * sizeof(T);
+    }
+
+    /**
+     * Checks if any of the bits in the specified range are set
+     * @param begin Begin of the range to check (bit index)
+     * @param end End of the range to check (bit index)
+     * @return True if any of the bits in the range are set, false otherwise (also for an empty range)
+     */
+    bool any_in_range(const uint64_t begin, const uint64_t end) const noexcept
+    {
+        if (begin >= end)
+            return false;
+
+        const uint64_t first = begin / chunk_bits, last = (end - 1) / chunk_bits;
+        const T first_mask = create_mask_from(begin % chunk_bits);
+        const T last_mask = create_mask_to((end - 1) % chunk_bits + 1);
+
+        if (first == last)
+            return data[first] & first_mask & last_mask;
+
+        return (data[first] & first_mask) || (data[last] & last_mask)
+            || bitset_find_byte_not(reinterpret_cast<const uint8_t*>(data + first + 1), (last - first - 1) * sizeof(T), 0u) != (last - first - 1) * sizeof(T);
+    }
+
+    /**
+     * @return The number of bits set in the bitset
+     */
+    uint64_t count() const noexcept
+    {
+        const uint64_t full_chunks = size / chunk_bits;
+        BITSET_STATS_RECORD(BITSET_STATS_COUNT, size, storage_size * sizeof(T));
+        BITSET_TRACE_SCOPE("count", full_chunks * sizeof(T));
+        uint64_t count = bitset_popcount_bytes(reinterpret_cast<const uint8_t*>(data), full_chunks * sizeof(T));
+        // bits past the end of the bitset are not counted
+        if (size % chunk_bits)
+            count += bitset_popcount64(data[full_chunks] & create_mask_to(size % chunk_bits));
+        return count;
+    }
+
+    /**
+     * Counts the set bits in the specified range
+     * @param begin Begin of the range to count (bit index)
+     * @param end End of the range to count (bit index)
+     * @return The number of bits set in the range
+     */
+    uint64_t count_in_range(const uint64_t begin, const uint64_t end) const noexcept
+    {
+        if (begin >= end)
+            return 0;
+
+        const uint64_t first = begin / chunk_bits, last = (end - 1) / chunk_bits;
+        const T first_mask = create_mask_from(begin % chunk_bits);
+        const T last_mask = create_mask_to((end - 1) % chunk_bits + 1);
+        BITSET_STATS_RECORD(BITSET_STATS_COUNT, end - begin, (last - first + 1u) * sizeof(T));
+
+        if (first == last)
+            return bitset_popcount64(data[first] & first_mask & last_mask);
+
+        BITSET_TRACE_SCOPE("count", (last - first - 1) * sizeof(T));
+        return bitset_popcount64(data[first] & first_mask)
+             + bitset_popcount_bytes(reinterpret_cast<const uint8_t*>(data + first + 1), (last - first - 1) * sizeof(T))
+             + bitset_popcount64(data[last] & last_mask);
+    }
+
+    /**
+     * Intersects the bitset with another one (other has to hold at least size bits)
+     * @param other The bitset to intersect with
+     * @return Reference to this bitset
+     */
+    CDynamicBitSet& operator&=(const CDynamicBitSet& other) noexcept
+    {
+        binary_operation(*this, other, BITSET_OPERATION_AND);
+        return *this;
+    }
+
+    /**
+     * Unites the bitset with another one (other has to hold at least size bits)
+     * @param other The bitset to unite with
+     * @return Reference to this bitset
+     */
+    CDynamicBitSet& operator|=(const CDynamicBitSet& other) noexcept
+    {
+        binary_operation(*this, other, BITSET_OPERATION_OR);
+        return *this;
+    }
+
+    /**
+     * Computes the symmetric difference with another bitset (other has to hold at least size bits)
+     * @param other The other bitset
+     * @return Reference to this bitset
+     */
+    CDynamicBitSet& operator^=(const CDynamicBitSet& other) noexcept
+    {
+        binary_operation(*this, other, BITSET_OPERATION_XOR);
+        return *this;
+    }
+
+    /**
+     * Removes the bits of another bitset (this &= ~other, other has to hold at least size bits)
+     * @param other The bitset with the bits to remove
+     * @return Reference to this bitset
+     */
+    CDynamicBitSet& and_not(const CDynamicBitSet& other) noexcept
+    {
+        binary_operation(*this, other, BITSET_OPERATION_ANDNOT);
+        return *this;
+    }
+
+    /**
+     * Shifts the bitset towards the higher indices and ORs new bits into the freed low bits (this = (this << shift) | bits)
+     * Whole words are moved and a single pass funnels the carry between neighbouring words, chunk aligned shifts are a memmove
+     * The bits past size are left unchanged
+     * @param shift Number of bits to shift by (bit count, any value)
+     * @param bits Bits ORed into the lowest word after the shift, e.g. the newest slots of a sliding window
+     * @return Reference to this bitset
+     */
+    CDynamicBitSet& shift_left_or(const uint64_t shift, const uint64_t bits) noexcept
+    {
+        const uint64_t words = bitset_calculate_word_count(size);
+        if (!words)
+            return *this;
+        BITSET_STATS_RECORD(BITSET_STATS_SHIFT, size, 2u * words * sizeof(uint64_t));
+        const uint64_t last_mask = size % 64u ? UINT64_MAX >> (64u - size % 64u) : UINT64_MAX;
+
+        if (shift >= size)
+            fill_in_range(false, 0, size);
+        else if (!(shift % chunk_bits))
+        {
+            const uint64_t chunk_shift = shift / chunk_bits;
+            // the bits past the size of the last chunk are restored after the move
+            const T kept = data[storage_size - 1u];
+            std::memmove(data + chunk_shift, data, (storage_size - chunk_shift) * sizeof(T));
+            std::memset(data, 0, chunk_shift * sizeof(T));
+            if (size % chunk_bits)
+            {
+                const T tail_mask = create_mask_to(size % chunk_bits);
+                data[storage_size - 1u] = static_cast<T>((data[storage_size - 1u] & tail_mask) | (kept & ~tail_mask));
+            }
+        }
+        else
+        {
+            // not chunk aligned, so bit_shift is never 0
+            const uint64_t word_shift = shift / 64u, bit_shift = shift % 64u;
+            // descending, so every word is read before it is written
+            uint64_t upper = get_word(words - 1u - word_shift);
+            for (uint64_t i = words; i-- > word_shift;)
+            {
+                const uint64_t lower = i > word_shift ? get_word(i - word_shift - 1u) : 0;
+                const uint64_t mask = i == words - 1u ? last_mask : UINT64_MAX;
+                update_word(i, mask, (upper << bit_shift | lower >> (64u - bit_shift)) & mask);
+                upper = lower;
+            }
+            for (uint64_t i = 0; i < word_shift; ++i)
+                update_word(i, UINT64_MAX, 0);
+        }
+
+        if (bits)
+        {
+            const uint64_t mask = bits & (words == 1u ? last_mask : UINT64_MAX);
+            update_word(0, mask, mask);
+        }
+        return *this;
+    }
+
+    /**
+     * Shifts the bitset towards the higher indices (bit i moves to i + shift, the low bits are cleared)
+     * @param shift Number of bits to shift by (bit count, any value)
+     * @return Reference to this bitset
+     */
+    CDynamicBitSet& shift_left(const uint64_t shift) noexcept
+    {
+        return shift_left_or(shift, 0);
+    }
+
+    /**
+     * Shifts the bitset towards the lower indices (bit i moves to i - shift, the high bits are cleared)
+     * Whole words are moved and a single pass funnels the carry between neighbouring words, chunk aligned shifts are a memmove
+     * The bits past size are left unchanged
+     * @param shift Number of bits to shift by (bit count, any value)
+     * @return Reference to this bitset
+     */
+    CDynamicBitSet& shift_right(const uint64_t shift) noexcept
+    {
+        const uint64_t words = bitset_calculate_word_count(size);
+        if (!words || !shift)
+            return *this;
+        BITSET_STATS_RECORD(BITSET_STATS_SHIFT, size, 2u * words * sizeof(uint64_t));
+
+        if (shift >= size)
+            fill_in_range(false, 0, size);
+        else if (!(shift % chunk_bits))
+        {
+            // the chunks moved in stop below the last chunk, the bits past the size they carry are cleared with the vacated range
+            const uint64_t chunk_shift = shift / chunk_bits;
+            std::memmove(data, data + chunk_shift, (storage_size - chunk_shift) * sizeof(T));
+            fill_in_range(false, size - shift, size);
+        }
+        else
+        {
+            // not chunk aligned, so bit_shift is never 0
+            const uint64_t word_shift = shift / 64u, bit_shift = shift % 64u;
+            const uint64_t last_mask = size % 64u ? UINT64_MAX >> (64u - size % 64u) : UINT64_MAX;
+            // ascending, so every word is read before it is written
+            uint64_t lower = get_word_below(word_shift);
+            for (uint64_t i = 0; i < words; ++i)
+            {
+                const uint64_t upper = get_word_below(i + word_shift + 1u);
+                const uint64_t mask = i == words - 1u ? last_mask : UINT64_MAX;
+                update_word(i, mask, (lower >> bit_shift | upper << (64u - bit_shift)) & mask);
+                lower = upper;
+            }
+        }
+        return *this;
+    }
+
+    /**
+     * Rotates the bitset towards the higher indices (bit i moves to (i + shift) % size)
+     * @param shift Number of bits to rotate by (bit count, any value)
+     * @return Reference to this bitset
+     */
+    CDynamicBitSet& rotate_left(const uint64_t shift)
+    {
+        if (!size || !(shift % size))
+            return *this;
+        const uint64_t offset = shift % size;
+        // the top offset bits wrap around into the low bits cleared by the shift
+        const CDynamicBitSet wrapped(*this);
+        shift_left(offset);
+        const uint64_t begin = size - offset;
+        for (uint64_t i = 0; i * 64u < offset; ++i)
+        {
+            const uint64_t bit = begin + i * 64u;
+            uint64_t word = wrapped.get_word_below(bit / 64u) >> bit % 64u;
+            if (bit % 64u)
+                word |= wrapped.get_word_below(bit / 64u + 1u) << (64u - bit % 64u);
+            update_word(i, word, word);
+        }
+        return *this;
+    }
+
+    /**
+     * Rotates the bitset towards the lower indices (bit i moves to (i - shift) % size)
+     * @param shift Number of bits to rotate by (bit count, any value)
+     * @return Reference to this bitset
+     */
+    CDynamicBitSet& rotate_right(const uint64_t shift)
+    {
+        return size ? rotate_left(size - shift % size) : *this;
+    }
+
+    /**
+     * Shifts the bitset towards the higher indices, see shift_left
+     * @param shift Number of bits to shift by (bit count)
+     * @return Reference to this bitset
+     */
+    CDynamicBitSet& operator<<=(const uint64_t shift) noexcept
+    {
+        return shift_left(shift);
+    }
+
+    /**
+     * Shifts the bitset towards the lower indices, see shift_right
+     * @param shift Number of bits to shift by (bit count)
+     * @return Reference to this bitset
+     */
+    CDynamicBitSet& operator>>=(const uint64_t shift) noexcept
+    {
+        return shift_right(shift);
+    }
+
+    /**
+     * Creates a non-owning view of bits [begin, begin + size), see CBitSetView
+     * @param begin Index of the first bit of the view (bit index)
+     * @param size Size of the view, begin + size has to be at most the size of the bitset (bit size)
+     * @return The view
+     */
+    CBitSetView<T, Allocator> view(const uint64_t begin, const uint64_t size) noexcept
+    {
+        return CBitSetView<T, Allocator>(*this, begin, size);
+    }
+
+    /**
+     * Wraps the bitset as an operand of a lazy expression, e.g. CDynamicBitSet<> r = (a.lazy() & b) | (c.lazy() & ~d.lazy()), see CBitSetExpression
+     * @return The expression terminal referencing this bitset (the bitset has to outlive it)
+     */
+    CBitSetTerminal<T, Allocator> lazy() const noexcept
+    {
+        return CBitSetTerminal<T, Allocator>(*this);
+    }
+
+    /**
+     * Stores a lazy expression over the first size bits in a single pass, the bits past size are left unchanged
+     * Every word of the result depends only on the same word of the operands, so the bitset may be an operand itself
+     * @param expression The expression to evaluate (at least size bits)
+     */
+    template <typename Expression>
+    void assign(const CBitSetExpression<Expression>& expression) noexcept
+    {
+        const Expression& source = expression.derived();
+        const uint64_t full_words = size / 64u;
+        uint8_t* const bytes = reinterpret_cast<uint8_t*>(data);
+        for (uint64_t i = 0; i < full_words; ++i)
+        {
+            const uint64_t word = source.word(i);
+            std::memcpy(bytes + i * sizeof(uint64_t), &word, sizeof(uint64_t));
+        }
+        if (size % 64u)
+        {
+            const uint64_t tail_mask = UINT64_MAX >> (64u - size % 64u);
+            update_word(full_words, tail_mask, source.tail_word(full_words) & tail_mask);
+        }
+    }
+
+    /**
+     * Computes this = left op right over the first size bits, the bits past size are left unchanged
+     * @param left The left operand (at least size bits)
+     * @param right The right operand (at least size bits)
+     * @param operation The operation to apply
+     */
+    void binary_operation(const CDynamicBitSet& left, const CDynamicBitSet& right, const bitset_operation operation) noexcept
+    {
+        const uint64_t full_chunks = size / chunk_bits;
+        BITSET_STATS_RECORD(BITSET_STATS_ALGEBRA, size, 3u * storage_size * sizeof(T));
+        BITSET_TRACE_SCOPE("binary_operation", full_chunks * sizeof(T));
+        bitset_binary_bytes(reinterpret_cast<uint8_t*>(data), reinterpret_cast<const uint8_t*>(left.data), reinterpret_cast<const uint8_t*>(right.data), full_chunks * sizeof(T), operation);
+        if (size % chunk_bits)
+        {
+            const T tail_mask = create_mask_to(size % chunk_bits);
+            const T result = apply_operation(left.data[full_chunks], right.data[full_chunks], operation);
+            data[full_chunks] = static_cast<T>((data[full_chunks] & ~tail_mask) | (result & tail_mask));
+        }
+    }
+
+    /**
+     * Counts the set bits of this op other without storing the result (other has to hold at least size bits)
+     * @param other The right operand
+     * @param operation The operation to apply
+     * @return The number of set bits of the result
+     */
+    uint64_t binary_count(const CDynamicBitSet& other, const bitset_operation operation) const noexcept
+    {
+        const uint64_t full_chunks = size / chunk_bits;
+        BITSET_STATS_RECORD(BITSET_STATS_ALGEBRA, size, 2u * storage_size * sizeof(T));
+        BITSET_TRACE_SCOPE("binary_count", full_chunks * sizeof(T));
+        uint64_t count = bitset_binary_count_bytes(reinterpret_cast<const uint8_t*>(data), reinterpret_cast<const uint8_t*>(other.data), full_chunks * sizeof(T), operation);
+        if (size % chunk_bits)
+            count += bitset_popcount64(apply_operation(data[full_chunks], other.data[full_chunks], operation) & create_mask_to(size % chunk_bits));
+        return count;
+    }
+
+    /**
+     * @param other The other bitset (at least size bits)
+     * @return The number of bits set in both bitsets
+     */
+    uint64_t and_count(const CDynamicBitSet& other) const noexcept
+    {
+        return binary_count(other, BITSET_OPERATION_AND);
+    }
+
+    /**
+     * @param other The other bitset (at least size bits)
+     * @return The number of bits set in any of the bitsets
+     */
+    uint64_t or_count(const CDynamicBitSet& other) const noexcept
+    {
+        return binary_count(other, BITSET_OPERATION_OR);
+    }
+
+    /**
+     * @param other The other bitset (at least size bits)
+     * @return The number of bits set in exactly one of the bitsets (hamming distance)
+     */
+    uint64_t xor_count(const CDynamicBitSet& other) const noexcept
+    {
+        return binary_count(other, BITSET_OPERATION_XOR);
+    }
+
+    /**
+     * @param other The other bitset (at least size bits)
+     * @return The number of bits set in this bitset but not in the other one
+     */
+    uint64_t and_not_count(const CDynamicBitSet& other) const noexcept
+    {
+        return binary_count(other, BITSET_OPERATION_ANDNOT);
+    }
+
+    /**
+     * Checks if this op other has any set bit, stopping at the first one (other has to hold at least size bits)
+     * @param other The right operand
+     * @param operation The operation to apply
+     * @return True if any bit of the result is set, false otherwise
+     */
+    bool binary_any(const CDynamicBitSet& other, const bitset_operation operation) const noexcept
+    {
+        const uint64_t full_chunks = size / chunk_bits;
+        BITSET_STATS_RECORD(BITSET_STATS_ALGEBRA, size, 2u * storage_size * sizeof(T));
+        if (bitset_binary_any_bytes(reinterpret_cast<const uint8_t*>(data), reinterpret_cast<const uint8_t*>(other.data), full_chunks * sizeof(T), operation))
+            return true;
+        if (size % chunk_bits)
+            return apply_operation(data[full_chunks], other.data[full_chunks], operation) & create_mask_to(size % chunk_bits);
+        return false;
+    }
+
+    /**
+     * @param other The other bitset (at least size bits)
+     * @return True if the bitsets share any set bit, false otherwise
+     */
+    bool intersects(const CDynamicBitSet& other) const noexcept
+    {
+        return binary_any(other, BITSET_OPERATION_AND);
+    }
+
+    /**
+     * @param other The other bitset (at least size bits)
+     * @return True if every set bit of this bitset is also set in the other one, false otherwise
+     */
+    bool is_subset_of(const CDynamicBitSet& other) const noexcept
+    {
+        return !binary_any(other, BITSET_OPERATION_ANDNOT);
+    }
+
+    /**
+     * Computes the Jaccard index |this & other| / |this | other| in a single pass
+     * @param other The other bitset (at least size bits)
+     * @return The Jaccard index in range [0, 1], 1 if both bitsets are empty
+     */
+    double jaccard(const CDynamicBitSet& other) const noexcept
+    {
+        const uint64_t full_chunks = size / chunk_bits;
+        uint64_t and_count = 0, or_count = 0;
+        BITSET_STATS_RECORD(BITSET_STATS_ALGEBRA, size, 2u * storage_size * sizeof(T));
+        BITSET_TRACE_SCOPE("jaccard", full_chunks * sizeof(T));
+        bitset_and_or_count_bytes(reinterpret_cast<const uint8_t*>(data), reinterpret_cast<const uint8_t*>(other.data), full_chunks * sizeof(T), &and_count, &or_count);
+        if (size % chunk_bits)
+        {
+            const T tail_mask = create_mask_to(size % chunk_bits);
+            and_count += bitset_popcount64(data[full_chunks] & other.data[full_chunks] & tail_mask);
+            or_count += bitset_popcount64((data[full_chunks] | other.data[full_chunks]) & tail_mask);
+        }
+        return or_count ? static_cast<double>(and_count) / static_cast<double>(or_count) : 1.0;
+    }
+
+    /**
+     * Retrieves the 64-bit word at the specified index, assembled from the chunks (bits past the storage read as 0)
+     * @param index Index of the word to read (word index, bits [index * 64, index * 64 + 64))
+     * @return The word at the specified index
+     */
+    uint64_t get_word(const uint64_t index) const noexcept
+    {
+        const uint64_t first_chunk = index * chunks_per_word;
+        if (first_chunk >= storage_size)
+            return 0;
+        if constexpr (chunks_per_word == 1)
+            return data[first_chunk];
+        else
+        {
+            const uint64_t chunks = storage_size - first_chunk < chunks_per_word ? storage_size - first_chunk : chunks_per_word;
+            uint64_t word = 0;
+#ifdef BITSET_LITTLE_ENDIAN
+            std::memcpy(&word, data + first_chunk, chunks * sizeof(T));
+#else
+            for (uint64_t i = 0; i < chunks; ++i)
+                word |= static_cast<uint64_t>(data[first_chunk + i]) << (i * chunk_bits);
+#endif
+            return word;
+        }
+    }
+
+    /**
+     * Finds the first bit with the specified value at or after the specified index
+     * @param value The value of the bit to find
+     * @param begin Index to start the search from (bit index)
+     * @return Index of the found bit, npos if there is none
+     */
+    uint64_t find_next_value(const bool value, const uint64_t begin) const noexcept
+    {
+        if (begin >= size)
+            return npos;
+
+        const uint64_t words = bitset_calculate_word_count(size);
+        const uint64_t invert = value ? 0u : UINT64_MAX;
+        uint64_t index = begin / 64u;
+        uint64_t word = (get_word(index) ^ invert) & (UINT64_MAX << begin % 64u);
+        while (!word)
+        {
+            if (++index >= words)
+            {
+                BITSET_STATS_RECORD(BITSET_STATS_FIND, size - begin, (index - begin / 64u) * sizeof(uint64_t));
+                return npos;
+            }
+            word = get_word(index) ^ invert;
+        }
+        BITSET_STATS_RECORD(BITSET_STATS_FIND, index * 64u + bitset_ctz64(word) + 1u - begin, (index - begin / 64u + 1u) * sizeof(uint64_t));
+        // matches past the size are bits of the last chunk that are not part of the bitset
+        index = index * 64u + bitset_ctz64(word);
+        return index < size ? index : npos;
+    }
+
+    /**
+     * Finds the last bit with the specified value before the specified index
+     * @param value The value of the bit to find
+     * @param end Index to search backwards from, exclusive (bit index)
+     * @return Index of the found bit, npos if there is none
+     */
+    uint64_t find_prev_value(const bool value, const uint64_t end) const noexcept
+    {
+        const uint64_t last = end < size ? end : size;
+        if (!last)
+            return npos;
+
+        const uint64_t invert = value ? 0u : UINT64_MAX;
+        uint64_t index = (last - 1u) / 64u;
+        uint64_t word = (get_word(index) ^ invert) & (UINT64_MAX >> (63u - (last - 1u) % 64u));
+        while (!word)
+        {
+            if (!index--)
+            {
+                BITSET_STATS_RECORD(BITSET_STATS_FIND, last, ((last - 1u) / 64u + 1u) * sizeof(uint64_t));
+                return npos;
+            }
+            word = get_word(index) ^ invert;
+        }
+        index = index * 64u + 63u - bitset_clz64(word);
+        BITSET_STATS_RECORD(BITSET_STATS_FIND, last - index, ((last - 1u) / 64u - index / 64u + 1u) * sizeof(uint64_t));
+        return index;
+    }
+
+    /**
+     * @return Index of the first set bit, npos if there is none
+     */
+    uint64_t find_first() const noexcept
+    {
+        return find_next_value(true, 0);
+    }
+
+    /**
+     * @param index Index to search after, exclusive (bit index)
+     * @return Index of the first set bit after index, npos if there is none
+     */
+    uint64_t find_next(const uint64_t index) const noexcept
+    {
+        return index == npos ? npos : find_next_value(true, index + 1u);
+    }
+
+    /**
+     * @return Index of the last set bit, npos if there is none
+     */
+    uint64_t find_last() const noexcept
+    {
+        return find_prev_value(true, size);
+    }
+
+    /**
+     * @param index Index to search before, exclusive (bit index)
+     * @return Index of the last set bit before index, npos if there is none
+     */
+    uint64_t find_prev(const uint64_t index) const noexcept
+    {
+        return find_prev_value(true, index);
+    }
+
+    /**
+     * @return Index of the first cleared bit, npos if there is none
+     */
+    uint64_t find_first_unset() const noexcept
+    {
+        return find_next_value(false, 0);
+    }
+
+    /**
+     * @param index Index to search after, exclusive (bit index)
+     * @return Index of the first cleared bit after index, npos if there is none
+     */
+    uint64_t find_next_unset(const uint64_t index) const noexcept
+    {
+        return index == npos ? npos : find_next_value(false, index + 1u);
+    }
+
+    /**
+     * @return Index of the last cleared bit, npos if there is none
+     */
+    uint64_t find_last_unset() const noexcept
+    {
+        return find_prev_value(false, size);
+    }
+
+    /**
+     * @param index Index to search before, exclusive (bit index)
+     * @return Index of the last cleared bit before index, npos if there is none
+     */
+    uint64_t find_prev_unset(const uint64_t index) const noexcept
+    {
+        return find_prev_value(false, index);
+    }
+
+    /**
+     * Writes the indices of the set bits, starting at the specified index, to a buffer
+     * To continue extracting after a full buffer, call again with begin set to the last written index + 1
+     * @param begin Index to start extracting from (bit index)
+     * @param indices Pointer to the buffer to write the indices to
+     * @param capacity Maximal number of indices to write
+     * @return Number of indices written
+     */
+    uint64_t extract_indices(const uint64_t begin, uint64_t* const indices, const uint64_t capacity) const noexcept
+    {
+        if (begin >= size || !capacity)
+            return 0;
+
+        const uint64_t words = bitset_calculate_word_count(size);
+        BITSET_STATS_RECORD(BITSET_STATS_FIND, size - begin, (words - begin / 64u) * sizeof(uint64_t));
+        [[maybe_unused]] const bool compress = bitset_extract_word_compress_supported();
+        uint64_t count = 0, index = begin / 64u;
+        uint64_t word = get_word(index) & (UINT64_MAX << begin % 64u);
+        for (;;)
+        {
+            if (index == words - 1u && size % 64u)
+                word &= UINT64_MAX >> (64u - size % 64u);
+
+            const uint64_t word_count = bitset_popcount64(word);
+            if (count + word_count > capacity)
+            {
+                // the buffer fills up inside this word
+                while (count < capacity)
+                {
+                    indices[count++] = index * 64u + bitset_ctz64(word);
+                    word &= word - 1u;
+                }
+                return count;
+            }
+#ifdef BITSET_X86_DISPATCH
+            // dense words are cheaper to compress than to walk bit by bit
+            if (compress && word_count >= 8u)
+                count += bitset_extract_word_compress(word, index * 64u, indices + count);
+            else
+#endif
+                count += bitset_extract_word(word, index * 64u, indices + count);
+
+            if (++index >= words)
+                return count;
+            word = get_word(index);
+        }
+    }
+
+    /**
+     * Calls the function with the index of every set bit, in increasing order
+     * @param function The function to call, takes the bit index (uint64_t)
+     */
+    template <typename F>
+    void for_each_set_bit(F&& function) const
+    {
+        const uint64_t words = bitset_calculate_word_count(size);
+        BITSET_STATS_RECORD(BITSET_STATS_FIND, size, words * sizeof(uint64_t));
+        for (uint64_t index = 0; index < words; ++index)
+        {
+            uint64_t word = get_word(index);
+            if (index == words - 1u && size % 64u)
+                word &= UINT64_MAX >> (64u - size % 64u);
+            while (word)
+            {
+                function(index * 64u + bitset_ctz64(word));
+                word &= word - 1u;
+            }
+        }
+    }
+
+    /**
+     * Finds the first run of at least min_length bits with the specified value at or after the specified index
+     * @param begin Index to start the search from, bits before it are not part of any run (bit index)
+     * @param min_length Minimal length of the run (bit count, 0 is treated as 1)
+     * @param value The value of the bits of the run
+     * @return Index of the first bit of the found run, npos if there is none
+     */
+    uint64_t find_next_run(const uint64_t begin, const uint64_t min_length, const bool value = true) const noexcept
+    {
+        uint64_t run_begin = find_next_value(value, begin);
+        while (run_begin != npos)
+        {
+            if (size - run_begin < min_length)
+                return npos;
+            // the run is long enough if no opposite bit lies within its first min_length bits
+            const uint64_t run_end = find_next_value(!value, run_begin);
+            if (run_end == npos || run_end - run_begin >= min_length)
+                return run_begin;
+            run_begin = find_next_value(value, run_end);
+        }
+        return npos;
+    }
+
+    /**
+     * Calls the function with the [begin, end) interval of every maximal run of bits with the specified value, in increasing order
+     * @param value The value of the bits of the runs
+     * @param function The function to call, takes the begin and end of the run (uint64_t, uint64_t)
+     */
+    template <typename F>
+    void for_each_run(const bool value, F&& function) const
+    {
+        uint64_t run_begin = find_next_value(value, 0);
+        while (run_begin != npos)
+        {
+            uint64_t run_end = find_next_value(!value, run_begin);
+            if (run_end == npos)
+                run_end = size;
+            function(run_begin, run_end);
+            run_begin = find_next_value(value, run_end);
+        }
+    }
+
+    /**
+     * Counts the maximal runs of bits with the specified value (edge detection, see bitset_count_run_starts_bytes)
+     * @param value The value of the bits of the runs
+     * @return The number of runs
+     */
+    uint64_t count_runs(const bool value = true) const noexcept
+    {
+        const uint64_t words = bitset_calculate_word_count(size);
+        const uint64_t invert = value ? 0u : UINT64_MAX;
+        uint64_t count = 0, index = 0, carry = 0;
+        BITSET_STATS_RECORD(BITSET_STATS_COUNT, size, words * sizeof(uint64_t));
+#ifdef BITSET_LITTLE_ENDIAN
+        // the full words are laid out as little-endian 64-bit words in memory whatever the chunk type
+        index = size / 64u;
+        if (index)
+        {
+            BITSET_TRACE_SCOPE("count_runs", index * 8u);
+            count = bitset_count_run_starts_bytes(reinterpret_cast<const uint8_t*>(data), index * 8u, invert);
+            carry = (get_word(index - 1u) ^ invert) >> 63;
+        }
+#endif
+        for (; index < words; ++index)
+        {
+            uint64_t word = get_word(index) ^ invert;
+            if (index == words - 1u && size % 64u)
+                word &= UINT64_MAX >> (64u - size % 64u);
+            count += bitset_popcount64(word & ~(word << 1 | carry));
+            carry = word >> 63;
+        }
+        return count;
+    }
+
+    /**
+     * Counts the set bits using all the threads (see bitset_parallel_popcount_bytes)
+     * @return The number of bits set in the bitset
+     */
+    uint64_t parallel_count() const noexcept
+    {
+        const uint64_t full_chunks = size / chunk_bits;
+        uint64_t count = bitset_parallel_popcount_bytes(reinterpret_cast<const uint8_t*>(data), full_chunks * sizeof(T));
+        // bits past the end of the bitset are not counted
+        if (size % chunk_bits)
+            count += bitset_popcount64(data[full_chunks] & create_mask_to(size % chunk_bits));
+        return count;
+    }
+
+    /**
+     * Fills the bitset with a specified value using all the threads
+     * @param value The value to fill the bitset with
+     */
+    void parallel_fill(const bool value) noexcept
+    {
+        bitset_parallel_fill_bytes(reinterpret_cast<uint8_t*>(data), value ? 255u : 0u, storage_size * sizeof(T));
+    }
+
+    /**
+     * Fills all the bits in the specified range with the specified value using all the threads
+     * @param value Value to fill the bits with (bit value)
+     * @param begin Begin of the range to fill (bit index)
+     * @param end End of the range to fill (bit index)
+     */
+    void parallel_fill_in_range(const bool value, const uint64_t begin, const uint64_t end) noexcept
+    {
+        if (begin >= end)
+            return;
+
+        // only the whole chunks are filled in parallel, the partial ones at the edges are masked on this thread
+        const uint64_t first = (begin + chunk_bits - 1u) / chunk_bits, last = end / chunk_bits;
+        if (first >= last)
+        {
+            fill_in_range(value, begin, end);
+            return;
+        }
+        fill_in_range(value, begin, first * chunk_bits);
+        bitset_parallel_fill_bytes(reinterpret_cast<uint8_t*>(data + first), value ? 255u : 0u, (last - first) * sizeof(T));
+        fill_in_range(value, last * chunk_bits, end);
+    }
+
+    /**
+     * Flips all the bits using all the threads
+     */
+    void parallel_flip() noexcept
+    {
+        bitset_parallel_flip_bytes(reinterpret_cast<uint8_t*>(data), storage_size * sizeof(T));
+    }
+
+    /**
+     * Computes this = left op right using all the threads (see binary_operation)
+     * @param left The left operand (at least size bits)
+     * @param right The right operand (at least size bits)
+     * @param operation The operation to apply
+     */
+    void parallel_binary_operation(const CDynamicBitSet& left, const CDynamicBitSet& right, const bitset_operation operation) noexcept
+    {
+        const uint64_t full_chunks = size / chunk_bits;
+        bitset_parallel_binary_bytes(reinterpret_cast<uint8_t*>(data), reinterpret_cast<const uint8_t*>(left.data), reinterpret_cast<const uint8_t*>(right.data), full_chunks * sizeof(T), operation);
+        if (size % chunk_bits)
+        {
+            const T tail_mask = create_mask_to(size % chunk_bits);
+            const T result = apply_operation(left.data[full_chunks], right.data[full_chunks], operation);
+            data[full_chunks] = static_cast<T>((data[full_chunks] & ~tail_mask) | (result & tail_mask));
+        }
+    }
+
+    /**
+     * Counts the set bits of this op other using all the threads, without storing the result (see binary_count)
+     * @param other The right operand (at least size bits)
+     * @param operation The operation to apply
+     * @return The number of set bits of the result
+     */
+    uint64_t parallel_binary_count(const CDynamicBitSet& other, const bitset_operation operation) const noexcept
+    {
+        const uint64_t full_chunks = size / chunk_bits;
+        uint64_t count = bitset_parallel_binary_count_bytes(reinterpret_cast<const uint8_t*>(data), reinterpret_cast<const uint8_t*>(other.data), full_chunks * sizeof(T), operation);
+        if (size % chunk_bits)
+            count += bitset_popcount64(apply_operation(data[full_chunks], other.data[full_chunks], operation) & create_mask_to(size % chunk_bits));
+        return count;
+    }
+
+    /**
+     * Finds the first bit with the specified value at or after the specified index using all the threads
+     * @param value The value of the bit to find
+     * @param begin Index to start the search from (bit index)
+     * @return Index of the found bit, npos if there is none
+     */
+    uint64_t parallel_find_next_value(const bool value, const uint64_t begin) const noexcept
+    {
+        if (begin >= size)
+            return npos;
+
+        // the chunk holding begin is checked on this thread
+        const uint64_t first = begin / chunk_bits;
+        const T chunk = static_cast<T>((value ? data[first] : static_cast<T>(~data[first])) & create_mask_from(begin % chunk_bits));
+        if (chunk)
+        {
+            const uint64_t index = first * chunk_bits + bitset_ctz64(chunk);
+            return index < size ? index : npos;
+        }
+        if (first + 1u >= storage_size)
+            return npos;
+
+        // any chunk with a byte other than the skipped one holds a match
+        const uint64_t bytes = (storage_size - first - 1u) * sizeof(T);
+        const uint64_t offset = bitset_parallel_find_byte_not(reinterpret_cast<const uint8_t*>(data + first + 1u), bytes, value ? 0u : 255u);
+        if (offset == bytes)
+            return npos;
+        return find_next_value(value, (first + 1u + offset / sizeof(T)) * chunk_bits);
+    }
+
+    /**
+     * Check if bitset is empty
+     * @return True if the bitset is empty, false otherwise
+     */
+    bool empty() const noexcept
+    {
+        return !size;
+    }
+
+    /**
+     * Pushes back a bit to the bitset
+     * @param value Value of the bit to append (bit value)
+     */
+    void push_back(const bool value)
+    {
+        BITSET_STATS_RECORD(BITSET_STATS_RESIZE, 1u, sizeof(T));
+        if (size % chunk_bits)
+        {
+            const T mask = static_cast<T>(T(1u) << size % chunk_bits);
+            data[size / chunk_bits] = static_cast<T>(value ? data[size / chunk_bits] | mask : data[size / chunk_bits] & ~mask);
+        }
+        else
+        {
+            grow();
+            data[storage_size++] = value ? 1u : 0u;
+        }
+        ++size;
+    }
+
+    /**
+     * Removes the last bit from the bitset (the memory is kept, see shrink_to_fit)
+     */
+    void pop_back() noexcept
+    {
+        BITSET_STATS_RECORD(BITSET_STATS_RESIZE, 1u, 0u);
+        if (size)
+        {
+            --size;
+            if (!(size % chunk_bits))
+                --storage_size;
+        }
+    }
+
+    /**
+     * Pushes back a chunk to the bitset, adjusting the size to the nearest multiple of chunk_bits upwards
+     * The bits in the expanded area may be initialized by previous calls, but their values are not explicitly defined by this function.
+     * @param chunk The chunk to push back (chunk value)
+     */
+    void push_back_chunk(const T chunk)
+    {
+        BITSET_STATS_RECORD(BITSET_STATS_RESIZE, chunk_bits, sizeof(T));
+        grow();
+        data[storage_size++] = chunk;
+        size = storage_size * chunk_bits;
+    }
+
+    /**
+     * Removes the last chunk from the bitset, adjusting the size to the nearest lower multiple of chunk_bits
+     * The memory is kept, see shrink_to_fit
+     */
+    void pop_back_chunk() noexcept
+    {
+        BITSET_STATS_RECORD(BITSET_STATS_RESIZE, chunk_bits, 0u);
+        if (storage_size)
+        {
+            --storage_size;
+            size = storage_size * chunk_bits;
+        }
+    }
+
+    /**
+     * Resizes the bitset to the specified size, reallocating only if the capacity is exceeded
+     * Only the newly exposed bits are written and shrinking never copies
+     * @param new_size The new size of the bitset (bit size)
+     * @param value The value of the new bits (bit value)
+     */
+    void resize(const uint64_t new_size, const bool value = false)
+    {
+        if (new_size == size)
+            return;
+        BITSET_STATS_RECORD(BITSET_STATS_RESIZE, new_size > size ? new_size - size : size - new_size, 0u);
+        const uint64_t new_storage_size = calculate_storage_size(new_size);
+        if (new_size > size)
+        {
+            reserve(new_storage_size);
+            // the bits past the old size in its last chunk may hold stale values (e.g. after pop_back)
+            if (size % chunk_bits)
+            {
+                const T mask = create_mask_from(size % chunk_bits);
+                data[storage_size - 1u] = (data[storage_size - 1u] & ~mask) | (create_filled_chunk(value) & mask);
+            }
+            if (new_storage_size > storage_size)
+                std::memset(data + storage_size, value ? 255u : 0u, (new_storage_size - storage_size) * sizeof(T));
+        }
+        storage_size = new_storage_size;
+        size = new_size;
+    }
+
+    /**
+     * Ensures the bitset can hold at least the specified number of chunks without reallocating
+     * @param new_capacity The number of chunks to reserve (chunk size)
+     */
+    void reserve(const uint64_t new_capacity)
+    {
+        if (new_capacity <= capacity)
+            return;
+        data = reallocate(new_capacity);
+        BITSET_STATS_REALLOCATION(BITSET_STATS_RESIZE, capacity * sizeof(T), new_capacity * sizeof(T));
+        capacity = new_capacity;
+    }
+
+    /**
+     * Releases the reserved chunks past storage_size
+     */
+    void shrink_to_fit() noexcept
+    {
+        if (capacity == storage_size)
+            return;
+        BITSET_STATS_RECORD(BITSET_STATS_RESIZE, 0u, 0u);
+        if (!storage_size)
+        {
+            deallocate(data, capacity);
+            data = nullptr;
+            capacity = 0;
+            return;
+        }
+        try
+        {
+            data = reallocate(storage_size);
+        }
+        catch (...)
+        {
+            return; // the old (larger) buffer is still valid
+        }
+        BITSET_STATS_REALLOCATION(BITSET_STATS_RESIZE, capacity * sizeof(T), storage_size * sizeof(T));
+        capacity = storage_size;
+    }
+
+    /**
+     * Calculates the number of chunks required to store the bitset
+     * @param size The size of the bitset (bit size)
+     * @return The number of chunks required to store the bitset
+     */
+    static constexpr uint64_t calculate_storage_size(const uint64_t size) noexcept
+    {
+        return size / chunk_bits + (size % chunk_bits ? 1 : 0);
+    }
+
+    /**
+     * Creates a chunk based on the given boolean value
+     * @param value Whether to create the chunk with all of the bits set or cleared
+     * @return chunk_max if value is true, otherwise zero
+     */
+    static constexpr T create_filled_chunk(const bool value) noexcept
+    {
+        return value ? chunk_max : T(0u);
+    }
+
+    /**
+     * Creates a chunk with all of the bits from the given bit upwards set
+     * @param bit Index of the lowest set bit, in range [0, chunk_bits) (bit index within chunk)
+     * @return The created mask
+     */
+    static constexpr T create_mask_from(const uint64_t bit) noexcept
+    {
+        return static_cast<T>(chunk_max << bit);
+    }
+
+    /**
+     * Creates a chunk with all of the bits below the given bit set
+     * @param bit Number of low bits to set, in range [0, chunk_bits] (bit index within chunk)
+     * @return The created mask
+     */
+    static constexpr T create_mask_to(const uint64_t bit) noexcept
+    {
+        return bit ? static_cast<T>(chunk_max >> (chunk_bits - bit)) : T(0u);
+    }
+
+    /**
+     * Applies the operation to a single chunk
+     * @param left The left operand (chunk value)
+     * @param right The right operand (chunk value)
+     * @param operation The operation to apply
+     * @return left op right
+     */
+    static constexpr T apply_operation(const T left, const T right, const bitset_operation operation) noexcept
+    {
+        switch (operation)
+        {
+        case BITSET_OPERATION_AND:
+            return static_cast<T>(left & right);
+        case BITSET_OPERATION_OR:
+            return static_cast<T>(left | right);
+        case BITSET_OPERATION_XOR:
+            return static_cast<T>(left ^ right);
+        case BITSET_OPERATION_ANDNOT:
+            return static_cast<T>(left & ~right);
+        }
+        return T(0u);
+    }
+
+private:
+    template <typename, typename>
+    friend class CBitSetView;
+
+    /**
+     * Updates the 64-bit word at the specified index as word = (word & ~clear_mask) ^ toggle_mask
+     * Only the chunks covered by the masks have to exist (the last word may be partial)
+     * @param index Index of the word to update (word index, bits [index * 64, index * 64 + 64))
+     * @param clear_mask Bits to clear
+     * @param toggle_mask Bits to flip after clearing (clear + toggle = set)
+     */
+    void update_word(const uint64_t index, const uint64_t clear_mask, const uint64_t toggle_mask) noexcept
+    {
+        const uint64_t first_chunk = index * chunks_per_word;
+        if constexpr (chunks_per_word == 1)
+            data[first_chunk] = static_cast<T>((data[first_chunk] & ~clear_mask) ^ toggle_mask);
+        else
+        {
+            const uint64_t chunks = storage_size - first_chunk < chunks_per_word ? storage_size - first_chunk : chunks_per_word;
+#ifdef BITSET_LITTLE_ENDIAN
+            uint64_t word = 0;
+            if (chunks == chunks_per_word)
+            {
+                std::memcpy(&word, data + first_chunk, sizeof(uint64_t));
+                word = (word & ~clear_mask) ^ toggle_mask;
+                std::memcpy(data + first_chunk, &word, sizeof(uint64_t));
+                return;
+            }
+            std::memcpy(&word, data + first_chunk, chunks * sizeof(T));
+            word = (word & ~clear_mask) ^ toggle_mask;
+            std::memcpy(data + first_chunk, &word, chunks * sizeof(T));
+#else
+            for (uint64_t i = 0; i < chunks; ++i)
+                data[first_chunk + i] = static_cast<T>((data[first_chunk + i] & ~static_cast<T>(clear_mask >> (i * chunk_bits))) ^ static_cast<T>(toggle_mask >> (i * chunk_bits)));
+#endif
+        }
+    }
+
+    /**
+     * Retrieves the 64-bit word at the specified index with the bits past size read as 0
+     * @param index Index of the word to read (word index)
+     * @return The masked word at the specified index
+     */
+    uint64_t get_word_below(const uint64_t index) const noexcept
+    {
+        if (index >= bitset_calculate_word_count(size))
+            return 0;
+        const uint64_t word = get_word(index);
+        return index == size / 64u ? word & (UINT64_MAX >> (64u - size % 64u)) : word;
+    }
+
+    /**
+     * Updates the bits at the specified indices (chunk = (chunk & ~bit if clear) ^ bit if toggle), prefetching the chunks ahead
+     * @param indices The indices of the bits to update (bit index)
+     * @param count Number of indices
+     * @param clear Whether the bits are cleared first
+     * @param toggle Whether the bits are flipped afterwards
+     */
+    void update_many(const uint64_t* const indices, const uint64_t count, const bool clear, const bool toggle) noexcept
+    {
+        BITSET_STATS_RECORD(BITSET_STATS_ACCESS, count, count * sizeof(T));
+        for (uint64_t i = 0; i < count; ++i)
+        {
+            if (i + BITSET_PREFETCH_DISTANCE < count)
+                BITSET_PREFETCH(data + indices[i + BITSET_PREFETCH_DISTANCE] / chunk_bits, 1);
+            const T mask = static_cast<T>(T(1u) << indices[i] % chunk_bits);
+            T& chunk = data[indices[i] / chunk_bits];
+            chunk = static_cast<T>((chunk & ~(clear ? mask : T(0u))) ^ (toggle ? mask : T(0u)));
+        }
+    }
+
+    /**
+     * Strided update engine behind the step overloads, see bitset_update_in_range_begin_end_step
+     * Updates runs of width bits starting at begin, begin + step, ... (below end), every run as bits = (bits & ~clear_value) ^ toggle_value
+     * Steps below 64 bits are applied word-at-a-time with masks repeating every lcm(step, 64) bits, larger steps touch one chunk per run
+     * @param begin Begin of the range to update (bit index)
+     * @param end End of the range to update (bit index)
+     * @param step Distance between the starts of two runs (bit step)
+     * @param width Width of a single run, 1 or chunk_bits (bit size)
+     * @param clear_value Bits to clear inside the runs (replicated across the word)
+     * @param toggle_value Bits to flip inside the runs after clearing (replicated across the word)
+     */
+    void update_in_range(const uint64_t begin, const uint64_t end, const uint64_t step, const uint64_t width, const uint64_t clear_value, const uint64_t toggle_value) noexcept
+    {
+        if (begin >= end || !step)
+            return;
+        BITSET_STATS_RECORD(BITSET_STATS_FILL, end - begin, ((end - 1) / chunk_bits - begin / chunk_bits + 1u) * sizeof(T));
+
+        if (step >= 64u)
+        {
+            // chunk_bits is a power of two, so the chunk index and bit offset are a shift and a mask
+            const T run = static_cast<T>(chunk_max >> (chunk_bits - width));
+            for (uint64_t i = begin; i < end; i += step)
+            {
+                const T mask = static_cast<T>(run << i % chunk_bits);
+                T& chunk = data[i / chunk_bits];
+                chunk = static_cast<T>((chunk & ~(mask & static_cast<T>(clear_value))) ^ (mask & static_cast<T>(toggle_value)));
+            }
+            return;
+        }
+
+        const uint64_t first = begin / 64u, last = (end - 1) / 64u;
+        const uint64_t last_mask = UINT64_MAX >> (63u - (end - 1) % 64u);
+        const uint64_t run = width < 64u ? (uint64_t(1u) << width) - 1u : UINT64_MAX;
+        uint64_t base = 0;
+        for (uint64_t bit = 0; bit < 64u; bit += step)
+            base |= run << bit;
+
+        uint64_t mask = base << begin % 64u;
+        if (first == last)
+        {
+            mask &= last_mask;
+            update_word(first, mask & clear_value, mask & toggle_value);
+            return;
+        }
+        update_word(first, mask & clear_value, mask & toggle_value);
+
+        // masks of the following words, the pattern repeats every step / gcd(step, 64) words
+        uint64_t masks[64];
+        const uint64_t full_period = step >> bitset_ctz64(step);
+        const uint64_t period = full_period < last - first ? full_period : last - first;
+        const uint64_t advance = step - 64u % step;
+        uint64_t offset = begin % 64u % step;
+        for (uint64_t k = 0; k < period; ++k)
+        {
+            offset += advance;
+            if (offset >= step)
+                offset -= step;
+            masks[k] = base << offset;
+        }
+
+        uint64_t k = 0;
+        for (uint64_t i = first + 1; i < last; ++i)
+        {
+            update_word(i, masks[k] & clear_value, masks[k] & toggle_value);
+            if (++k == period)
+                k = 0;
+        }
+        mask = masks[k] & last_mask;
+        update_word(last, mask & clear_value, mask & toggle_value);
+    }
+
+    /**
+     * Grows the capacity geometrically so that one more chunk fits (amortized O(1) appends)
+     */
+    void grow()
+    {
+        if (storage_size < capacity)
+            return;
+        reserve(capacity ? capacity * 2u : chunks_per_word);
+    }
+
+    /**
+     * Moves the used chunks to an allocation of the specified number of chunks and releases the old one
+     * C allocators (CBitSetAllocator) go through bitset_reallocate, so the blocks can grow or shrink in place
+     * @param count Number of chunks to allocate, at least storage_size and not 0
+     * @return The new chunks, std::bad_alloc is thrown on failure (data stays valid)
+     */
+    T* reallocate(const uint64_t count)
+    {
+        if constexpr (std::is_same<Allocator, CBitSetAllocator<T>>::value)
+        {
+            T* const new_data = static_cast<T*>(bitset_reallocate(allocator.allocator, data, capacity * sizeof(T), count * sizeof(T)));
+            if (!new_data)
+                throw std::bad_alloc();
+            return new_data;
+        }
+        else
+        {
+            T* const new_data = allocate(count);
+            if (storage_size)
+                std::memcpy(new_data, data, storage_size * sizeof(T));
+            deallocate(data, capacity);
+            return new_data;
+        }
+    }
+
+    /**
+     * Allocates the specified number of chunks (uninitialized)
+     * @param count Number of chunks to allocate
+     * @return The allocated chunks, nullptr for count 0
+     */
+    T* allocate(const uint64_t count)
+    {
+        return count ? allocator_traits::allocate(allocator, static_cast<std::size_t>(count)) : nullptr;
+    }
+
+    /**
+     * Releases chunks from allocate
+     * @param chunks The chunks to release (may be nullptr)
+     * @param count Number of chunks they were allocated with
+     */
+    void deallocate(T* const chunks, const uint64_t count) noexcept
+    {
+        if (chunks)
+            allocator_traits::deallocate(allocator, chunks, static_cast<std::size_t>(count));
+    }
+};
+
+/**
+ * @return The intersection of two bitsets (sized like left, right has to hold at least left.size bits)
+ */
+template <typename T, typename Allocator>
+inline CDynamicBitSet<T, Allocator> operator&(const CDynamicBitSet<T, Allocator>& left, const CDynamicBitSet<T, Allocator>& right)
+{
+    CDynamicBitSet<T, Allocator> result(left.size, left.allocator);
+    result.binary_operation(left, right, BITSET_OPERATION_AND);
+    return result;
+}
+
+/**
+ * @return The union of two bitsets (sized like left, right has to hold at least left.size bits)
+ */
+template <typename T, typename Allocator>
+inline CDynamicBitSet<T, Allocator> operator|(const CDynamicBitSet<T, Allocator>& left, const CDynamicBitSet<T, Allocator>& right)
+{
+    CDynamicBitSet<T, Allocator> result(left.size, left.allocator);
+    result.binary_operation(left, right, BITSET_OPERATION_OR);
+    return result;
+}
+
+/**
+ * @return The symmetric difference of two bitsets (sized like left, right has to hold at least left.size bits)
+ */
+template <typename T, typename Allocator>
+inline CDynamicBitSet<T, Allocator> operator^(const CDynamicBitSet<T, Allocator>& left, const CDynamicBitSet<T, Allocator>& right)
+{
+    CDynamicBitSet<T, Allocator> result(left.size, left.allocator);
+    result.binary_operation(left, right, BITSET_OPERATION_XOR);
+    return result;
+}
+
+/**
+ * @return The bitset shifted towards the higher indices (sized like bitset)
+ */
+template <typename T, typename Allocator>
+inline CDynamicBitSet<T, Allocator> operator<<(CDynamicBitSet<T, Allocator> bitset, const uint64_t shift)
+{
+    bitset.shift_left(shift);
+    return bitset;
+}
+
+/**
+ * @return The bitset shifted towards the lower indices (sized like bitset)
+ */
+template <typename T, typename Allocator>
+inline CDynamicBitSet<T, Allocator> operator>>(CDynamicBitSet<T, Allocator> bitset, const uint64_t shift)
+{
+    bitset.shift_right(shift);
+    return bitset;
+}
+
+/**
+ * Base of the lazy bitset expressions, combining CDynamicBitSet operands with &, |, ^ and ~ builds a tree evaluated in one pass
+ * Start an expression with CDynamicBitSet::lazy(), (a.lazy() & b) | (c.lazy() & ~d.lazy()) reads every operand once and writes no temporaries
+ * An expression is sized like its leftmost operand, the other operands have to hold at least that many bits
+ * The operands are referenced, not copied, so they have to outlive the expression
+ * Whole words are combined as stored in memory (bitwise operations do not depend on the bit order), the last partial word in bit order
+ * @tparam Derived The expression type, providing size(), word(index) for the full words and tail_word(index) for the last one
+ */
+template <typename Derived>
+class CBitSetExpression
+{
+public:
+    /**
+     * @return The expression as its concrete type
+     */
+    const Derived& derived() const noexcept
+    {
+        return static_cast<const Derived&>(*this);
+    }
+
+    /**
+     * Counts the set bits of the expression without materializing it
+     * @return The number of set bits
+     */
+    uint64_t count() const noexcept
+    {
+        const Derived& expression = derived();
+        const uint64_t size = expression.size(), full_words = size / 64u;
+        uint64_t count = 0;
+        for (uint64_t i = 0; i < full_words; ++i)
+            count += bitset_popcount64(expression.word(i));
+        if (size % 64u)
+            count += bitset_popcount64(expression.tail_word(full_words) & (UINT64_MAX >> (64u - size % 64u)));
+        return count;
+    }
+
+    /**
+     * Checks if any bit of the expression is set without materializing it, stopping at the first set bit
+     * @return True if any of the bits are set, false otherwise
+     */
+    bool any() const noexcept
+    {
+        const Derived& expression = derived();
+        const uint64_t size = expression.size(), full_words = size / 64u;
+        for (uint64_t i = 0; i < full_words; ++i)
+        {
+            if (expression.word(i))
+                return true;
+        }
+        if (size % 64u)
+            return expression.tail_word(full_words) & (UINT64_MAX >> (64u - size % 64u));
+        return false;
+    }
+
+    /**
+     * Checks if none of the bits of the expression are set without materializing it
+     * @return True if none of the bits are set, false otherwise
+     */
+    bool none() const noexcept
+    {
+        return !any();
+    }
+
+protected:
+    CBitSetExpression() noexcept = default;
+};
+
+/**
+ * Leaf of a lazy expression referencing a CDynamicBitSet, created with CDynamicBitSet::lazy()
+ */
+template <typename T, typename Allocator>
+class CBitSetTerminal : public CBitSetExpression<CBitSetTerminal<T, Allocator>>
+{
+public:
+    using chunk_type = T;
+
+    /**
+     * @param bitset The referenced bitset, has to outlive the expression
+     */
+    explicit CBitSetTerminal(const CDynamicBitSet<T, Allocator>& bitset) noexcept : bitset(&bitset) {}
+
+    /**
+     * @return Size of the referenced bitset (bit size)
+     */
+    uint64_t size() const noexcept
+    {
+        return bitset->size;
+    }
+
+    /**
+     * @param index Index of a full word (word index, lower than size / 64)
+     * @return The word as stored in memory
+     */
+    uint64_t word(const uint64_t index) const noexcept
+    {
+        uint64_t word;
+        std::memcpy(&word, reinterpret_cast<const uint8_t*>(bitset->data) + index * sizeof(uint64_t), sizeof(uint64_t));
+        return word;
+    }
+
+    /**
+     * @param index Index of the last, partial word (word index)
+     * @return The word in bit order, see CDynamicBitSet::get_word
+     */
+    uint64_t tail_word(const uint64_t index) const noexcept
+    {
+        return bitset->get_word(index);
+    }
+
+private:
+    const CDynamicBitSet<T, Allocator>* bitset;
+};
+
+/**
+ * Node of a lazy expression combining two operands with a bulk operation
+ * @tparam Operation The operation applied to every word, see bitset_apply_operation64
+ */
+template <bitset_operation Operation, typename Left, typename Right>
+class CBitSetBinaryExpression : public CBitSetExpression<CBitSetBinaryExpression<Operation, Left, Right>>
+{
+    static_assert(std::is_same_v<typename Left::chunk_type, typename Right::chunk_type>, "CBitSetBinaryExpression: the operands have to use the same chunk type");
+
+public:
+    using chunk_type = typename Left::chunk_type;
+
+    CBitSetBinaryExpression(const Left& left, const Right& right) noexcept : left(left), right(right) {}
+
+    /**
+     * @return Size of the left operand (bit size)
+     */
+    uint64_t size() const noexcept
+    {
+        return left.size();
+    }
+
+    uint64_t word(const uint64_t index) const noexcept
+    {
+        return bitset_apply_operation64(left.word(index), right.word(index), Operation);
+    }
+
+    uint64_t tail_word(const uint64_t index) const noexcept
+    {
+        return bitset_apply_operation64(left.tail_word(index), right.tail_word(index), Operation);
+    }
+
+private:
+    // the nodes are small, storing them by value keeps an expression valid after its temporaries are gone
+    Left left;
+    Right right;
+};
+
+/**
+ * Node of a lazy expression inverting its operand (the bits past the size are inverted too, they are masked on evaluation)
+ */
+template <typename Operand>
+class CBitSetNotExpression : public CBitSetExpression<CBitSetNotExpression<Operand>>
+{
+public:
+    using chunk_type = typename Operand::chunk_type;
+
+    explicit CBitSetNotExpression(const Operand& operand) noexcept : operand(operand) {}
+
+    uint64_t size() const noexcept
+    {
+        return operand.size();
+    }
+
+    uint64_t word(const uint64_t index) const noexcept
+    {
+        return ~operand.word(index);
+    }
+
+    uint64_t tail_word(const uint64_t index) const noexcept
+    {
+        return ~operand.tail_word(index);
+    }
+
+private:
+    Operand operand;
+};
+
+/**
+ * Generates the lazy operator of a bulk operation for expression-expression, expression-bitset and bitset-expression operands
+ */
+#define BITSET_DEFINE_LAZY_OPERATOR(symbol, operation) \
+template <typename Left, typename Right> \
+inline CBitSetBinaryExpression<operation, Left, Right> operator symbol(const CBitSetExpression<Left>& left, const CBitSetExpression<Right>& right) noexcept \
+{ \
+    return CBitSetBinaryExpression<operation, Left, Right>(left.derived(), right.derived()); \
+} \
+template <typename Left, typename T, typename Allocator> \
+inline CBitSetBinaryExpression<operation, Left, CBitSetTerminal<T, Allocator>> operator symbol(const CBitSetExpression<Left>& left, const CDynamicBitSet<T, Allocator>& right) noexcept \
+{ \
+    return CBitSetBinaryExpression<operation, Left, CBitSetTerminal<T, Allocator>>(left.derived(), right.lazy()); \
+} \
+template <typename T, typename Allocator, typename Right> \
+inline CBitSetBinaryExpression<operation, CBitSetTerminal<T, Allocator>, Right> operator symbol(const CDynamicBitSet<T, Allocator>& left, const CBitSetExpression<Right>& right) noexcept \
+{ \
+    return CBitSetBinaryExpression<operation, CBitSetTerminal<T, Allocator>, Right>(left.lazy(), right.derived()); \
+}
+
+BITSET_DEFINE_LAZY_OPERATOR(&, BITSET_OPERATION_AND)
+BITSET_DEFINE_LAZY_OPERATOR(|, BITSET_OPERATION_OR)
+BITSET_DEFINE_LAZY_OPERATOR(^, BITSET_OPERATION_XOR)
+
+/**
+ * @return The lazy inversion of an expression
+ */
+template <typename Operand>
+inline CBitSetNotExpression<Operand> operator~(const CBitSetExpression<Operand>& operand) noexcept
+{
+    return CBitSetNotExpression<Operand>(operand.derived());
+}
+
+/**
+ * A non-owning view of bits [begin, begin + size) of a CDynamicBitSet, no bits are copied
+ * Views at chunk aligned begins run the bulk operations on the chunks directly (the same vectorized paths as whole bitsets),
+ * other views assemble 64-bit words funneled by begin % 64
+ * The bits outside of the view are never modified, the viewed bitset has to outlive the view and must not be resized while viewed
+ */
+template <typename T, typename Allocator>
+class CBitSetView
+{
+    using bitset_type = CDynamicBitSet<T, Allocator>;
+
+public:
+    /**
+     * Index returned by the find functions when no matching bit exists
+     */
+    static constexpr uint64_t npos = BITSET_NPOS;
+
+    /**
+     * The viewed bitset
+     */
+    bitset_type* bitset;
+    /**
+     * Index of the first bit of the view in the viewed bitset (bit index)
+     */
+    uint64_t begin;
+    /**
+     * Size of view in bits
+     */
+    uint64_t size;
+
+    /**
+     * Creates a view of bits [begin, begin + size) of the bitset
+     * @param bitset The bitset to view (begin + size has to be at most bitset.size)
+     * @param begin Index of the first bit of the view (bit index)
+     * @param size Size of the view (bit size)
+     */
+    CBitSetView(bitset_type& bitset, const uint64_t begin, const uint64_t size) noexcept : bitset(&bitset), begin(begin), size(size) {}
+
+    /**
+     * Retrieves the value of a bit of the view
+     * @param index The index of the bit to read (bit index within the view)
+     * @return The value of the bit at the specified index
+     */
+    bool get(const uint64_t index) const noexcept
+    {
+        return bitset->get(begin + index);
+    }
+
+    /**
+     * Retrieves the value of a bit of the view
+     * @param index The index of the bit to read (bit index within the view)
+     * @return The value of the bit at the specified index
+     */
+    bool operator[](const uint64_t index) const noexcept
+    {
+        return get(index);
+    }
+
+    /**
+     * Sets the value of a bit of the view
+     * @param value The value to set the bit to
+     * @param index The index of the bit to modify (bit index within the view)
+     */
+    void set(const bool value, const uint64_t index) noexcept
+    {
+        bitset->set(value, begin + index);
+    }
+
+    /**
+     * Fills all the bits of the view with the specified value
+     * @param value The value to fill the bits with
+     */
+    void fill(const bool value) noexcept
+    {
+        bitset->fill_in_range(value, begin, begin + size);
+    }
+
+    /**
+     * Sets all the bits of the view (sets all bits to 1)
+     */
+    void set() noexcept
+    {
+        fill(true);
+    }
+
+    /**
+     * Clears all the bits of the view (sets all bits to 0)
+     */
+    void clear() noexcept
+    {
+        fill(false);
+    }
+
+    /**
+     * Flips all the bits of the view
+     */
+    void flip() noexcept
+    {
+        bitset->flip_in_range(begin, begin + size);
+    }
+
+    /**
+     * @return The number of bits set in the view
+     */
+    uint64_t count() const noexcept
+    {
+        return bitset->count_in_range(begin, begin + size);
+    }
+
+    /**
+     * Checks if any of the bits of the view are set
+     * @return True if any of the bits are set, false otherwise
+     */
+    bool any() const noexcept
+    {
+        const uint64_t words = bitset_calculate_word_count(size);
+        for (uint64_t i = 0; i < words; ++i)
+        {
+            if (get_word(i))
+                return true;
+        }
+        return false;
+    }
+
+    /**
+     * Checks if all the bits of the view are set
+     * @return True if all the bits are set, false otherwise
+     */
+    bool all() const noexcept
+    {
+        const uint64_t words = bitset_calculate_word_count(size);
+        for (uint64_t i = 0; i < words; ++i)
+        {
+            if (get_word(i) != word_mask(i))
+                return false;
+        }
+        return true;
+    }
+
+    /**
+     * Checks if none of the bits of the view are set
+     * @return True if none of the bits are set, false otherwise
+     */
+    bool none() const noexcept
+    {
+        return !any();
+    }
+
+    /**
+     * Retrieves the 64-bit word at the specified index of the view (bits past the size read as 0)
+     * @param index Index of the word to read (word index, view bits [index * 64, index * 64 + 64))
+     * @return The word at the specified index
+     */
+    uint64_t get_word(const uint64_t index) const noexcept
+    {
+        const uint64_t first = begin / 64u + index, offset = begin % 64u;
+        uint64_t word = bitset->get_word(first);
+        if (offset)
+            word = word >> offset | bitset->get_word(first + 1u) << (64u - offset);
+        return word & word_mask(index);
+    }
+
+    /**
+     * Finds the first bit of the view with the specified value at or after the specified index
+     * @param value The value of the bit to find
+     * @param from Index to start the search from (bit index within the view)
+     * @return Index of the found bit (within the view), npos if there is none
+     */
+    uint64_t find_next_value(const bool value, const uint64_t from) const noexcept
+    {
+        if (from >= size)
+            return npos;
+
+        const uint64_t words = bitset_calculate_word_count(size);
+        const uint64_t invert = value ? 0u : UINT64_MAX;
+        uint64_t index = from / 64u;
+        uint64_t word = (get_word(index) ^ invert) & (UINT64_MAX << from % 64u);
+        while (!word)
+        {
+            if (++index >= words)
+                return npos;
+            word = get_word(index) ^ invert;
+        }
+        // unset matches past the size are the bits read as 0
+        index = index * 64u + bitset_ctz64(word);
+        return index < size ? index : npos;
+    }
+
+    /**
+     * @return Index of the first set bit of the view, npos if there is none
+     */
+    uint64_t find_first() const noexcept
+    {
+        return find_next_value(true, 0);
+    }
+
+    /**
+     * @param index Index to search after, exclusive (bit index within the view)
+     * @return Index of the first set bit of the view after index, npos if there is none
+     */
+    uint64_t find_next(const uint64_t index) const noexcept
+    {
+        return index == npos ? npos : find_next_value(true, index + 1u);
+    }
+
+    /**
+     * Calls the function with the index (within the view) of every set bit of the view, in increasing order
+     * @param function The function to call, takes the bit index (uint64_t)
+     */
+    template <typename F>
+    void for_each_set_bit(F&& function) const
+    {
+        const uint64_t words = bitset_calculate_word_count(size);
+        for (uint64_t index = 0; index < words; ++index)
+        {
+            for (uint64_t word = get_word(index); word; word &= word - 1u)
+                function(index * 64u + bitset_ctz64(word));
+        }
+    }
+
+    /**
+     * Computes this = left op right over the first size bits of the views
+     * Both operands have to hold at least size bits, this may be the same view as left or right, otherwise it must not overlap them
+     * @param left The left operand
+     * @param right The right operand
+     * @param operation The operation to apply
+     */
+    void binary_operation(const CBitSetView& left, const CBitSetView& right, const bitset_operation operation) noexcept
+    {
+        if (!(begin % bitset_type::chunk_bits) && !(left.begin % bitset_type::chunk_bits) && !(right.begin % bitset_type::chunk_bits))
+        {
+            const uint64_t full_chunks = size / bitset_type::chunk_bits;
+            T* const data = chunks();
+            bitset_binary_bytes(reinterpret_cast<uint8_t*>(data), reinterpret_cast<const uint8_t*>(left.chunks()), reinterpret_cast<const uint8_t*>(right.chunks()), full_chunks * sizeof(T), operation);
+            if (size % bitset_type::chunk_bits)
+            {
+                const T tail_mask = bitset_type::create_mask_to(size % bitset_type::chunk_bits);
+                const T result = bitset_type::apply_operation(left.chunks()[full_chunks], right.chunks()[full_chunks], operation);
+                data[full_chunks] = static_cast<T>((data[full_chunks] & ~tail_mask) | (result & tail_mask));
+            }
+            return;
+        }
+
+        const uint64_t words = bitset_calculate_word_count(size);
+        for (uint64_t i = 0; i < words; ++i)
+            update_word(i, word_mask(i), bitset_apply_operation64(left.get_word(i), right.get_word(i), operation) & word_mask(i));
+    }
+
+    /**
+     * Counts the set bits of this op other over the first size bits of the views, without storing the result
+     * @param other The right operand (at least size bits)
+     * @param operation The operation to apply
+     * @return The number of set bits of the result
+     */
+    uint64_t binary_count(const CBitSetView& other, const bitset_operation operation) const noexcept
+    {
+        if (!(begin % bitset_type::chunk_bits) && !(other.begin % bitset_type::chunk_bits))
+        {
+            const uint64_t full_chunks = size / bitset_type::chunk_bits;
+            uint64_t count = bitset_binary_count_bytes(reinterpret_cast<const uint8_t*>(chunks()), reinterpret_cast<const uint8_t*>(other.chunks()), full_chunks * sizeof(T), operation);
+            if (size % bitset_type::chunk_bits)
+                count += bitset_popcount64(bitset_type::apply_operation(chunks()[full_chunks], other.chunks()[full_chunks], operation) & bitset_type::create_mask_to(size % bitset_type::chunk_bits));
+            return count;
+        }
+
+        const uint64_t words = bitset_calculate_word_count(size);
+        uint64_t count = 0;
+        for (uint64_t i = 0; i < words; ++i)
+            count += bitset_popcount64(bitset_apply_operation64(get_word(i), other.get_word(i), operation) & word_mask(i));
+        return count;
+    }
+
+    /**
+     * Copies the first size bits of another view into this one (other must not overlap this view)
+     * @param other The view to copy from
+     * @return Reference to this view
+     */
+    CBitSetView& assign(const CBitSetView& other) noexcept
+    {
+        binary_operation(other, other, BITSET_OPERATION_OR);
+        return *this;
+    }
+
+    /**
+     * Intersects the view with another one (other has to hold at least size bits)
+     * @param other The view to intersect with
+     * @return Reference to this view
+     */
+    CBitSetView& operator&=(const CBitSetView& other) noexcept
+    {
+        binary_operation(*this, other, BITSET_OPERATION_AND);
+        return *this;
+    }
+
+    /**
+     * Unites the view with another one (other has to hold at least size bits)
+     * @param other The view to unite with
+     * @return Reference to this view
+     */
+    CBitSetView& operator|=(const CBitSetView& other) noexcept
+    {
+        binary_operation(*this, other, BITSET_OPERATION_OR);
+        return *this;
+    }
+
+    /**
+     * Computes the symmetric difference with another view (other has to hold at least size bits)
+     * @param other The other view
+     * @return Reference to this view
+     */
+    CBitSetView& operator^=(const CBitSetView& other) noexcept
+    {
+        binary_operation(*this, other, BITSET_OPERATION_XOR);
+        return *this;
+    }
+
+    /**
+     * Removes the bits of another view (this &= ~other, other has to hold at least size bits)
+     * @param other The view with the bits to remove
+     * @return Reference to this view
+     */
+    CBitSetView& and_not(const CBitSetView& other) noexcept
+    {
+        binary_operation(*this, other, BITSET_OPERATION_ANDNOT);
+        return *this;
+    }
+
+private:
+    /**
+     * @return Pointer to the chunk holding the first bit of the view
+     */
+    T* chunks() const noexcept
+    {
+        return bitset->data + begin / bitset_type::chunk_bits;
+    }
+
+    /**
+     * @param index Index of the word (word index)
+     * @return Mask of the bits of the word that are part of the view
+     */
+    uint64_t word_mask(const uint64_t index) const noexcept
+    {
+        if (index < size / 64u)
+            return UINT64_MAX;
+        return index == size / 64u && size % 64u ? UINT64_MAX >> (64u - size % 64u) : 0;
+    }
+
+    /**
+     * Updates the 64-bit word at the specified index of the view as word = (word & ~clear_mask) ^ toggle_mask
+     * The masks must not cover bits past the size of the view
+     * @param index Index of the word to update (word index, view bits [index * 64, index * 64 + 64))
+     * @param clear_mask Bits to clear
+     * @param toggle_mask Bits to flip after clearing (clear + toggle = set)
+     */
+    void update_word(const uint64_t index, const uint64_t clear_mask, const uint64_t toggle_mask) noexcept
+    {
+        const uint64_t first = begin / 64u + index, offset = begin % 64u;
+        if (!offset)
+        {
+            bitset->update_word(first, clear_mask, toggle_mask);
+            return;
+        }
+        bitset->update_word(first, clear_mask << offset, toggle_mask << offset);
+        // the high bits spill into the next word of the bitset, which only exists if the masks reach it
+        const uint64_t high_clear = clear_mask >> (64u - offset), high_toggle = toggle_mask >> (64u - offset);
+        if (high_clear | high_toggle)
+            bitset->update_word(first + 1u, high_clear, high_toggle);
+    }
+};
+
+/**
+ * A fixed-size bitset of N bits with exactly ceil(N / chunk_bits) chunks of inline storage
+ * Every operation is constexpr and the loops over the chunks are unrolled for small N, so 128 and 256-bit masks stay in registers
+ * The bits past N are always kept cleared
+ */
+template <uint64_t N, typename T = uint64_t>
+class CBitSet
+{
+    static_assert(std::is_integral_v<T> && std::is_unsigned_v<T> && !std::is_same_v<T, bool>, "CBitSet: T has to be an unsigned integral type");
+
+public:
+    /**
+     * Number of bits in a single chunk
+     */
+    static constexpr uint64_t chunk_bits = sizeof(T) * 8u;
+
+    /**
+     * Chunk with all of the bits set
+     */
+    static constexpr T chunk_max = static_cast<T>(~static_cast<T>(0u));
+
+    /**
+     * Size of bitset in bits
+     */
+    static constexpr uint64_t size = N;
+
+    /**
+     * Size of bitset in chunks
+     */
+    static constexpr uint64_t storage_size = N / chunk_bits + (N % chunk_bits ? 1 : 0);
+
+    /**
+     * Index returned by the find functions when no matching bit exists
+     */
+    static constexpr uint64_t npos = BITSET_NPOS;
+
+    /**
+     * Bitsets with at most this many chunks have their chunk loops unrolled
+     */
+    static constexpr uint64_t unroll_limit = 8u;
+
+    /**
+     * Underlying array of chunks containing the bits
+     */
+    std::array<T, storage_size> data;
+
+    /**
+     * Default constructor, all of the bits are cleared
+     */
+    constexpr CBitSet() noexcept : data() {}
+
+    /**
+     * Value constructor, the low bits are initialized from the value (like std::bitset)
+     * @param value The value of the first min(N, 64) bits
+     */
+    constexpr explicit CBitSet(const uint64_t value) noexcept : data()
+    {
+        for (uint64_t i = 0; i < storage_size && i * chunk_bits < 64u; ++i)
+            data[i] = static_cast<T>(value >> i * chunk_bits);
+        clear_tail();
+    }
+
+    /**
+     * Retrieves the value of a bit at a specified index
+     * @param index The index of the bit to read (bit index)
+     * @return The value of the bit at the specified index
+     */
+    constexpr bool get(const uint64_t index) const noexcept
+    {
+        return (data[index / chunk_bits] >> index % chunk_bits) & 1u;
+    }
+
+    /**
+     * Retrieves the value of a bit at a specified index
+     * @param index The index of the bit to read (bit index)
+     * @return The value of the bit at the specified index
+     */
+    constexpr bool operator[](const uint64_t index) const noexcept
+    {
+        return get(index);
+    }
+
+    /**
+     * Sets the value of a bit at a specified index
+     * @param value The value to set the bit to
+     * @param index The index of the bit to modify (bit index)
+     */
+    constexpr void set(const bool value, const uint64_t index) noexcept
+    {
+        const T mask = static_cast<T>(T(1u) << index % chunk_bits);
+        data[index / chunk_bits] = static_cast<T>(value ? data[index / chunk_bits] | mask : data[index / chunk_bits] & ~mask);
+    }
+
+    /**
+     * Sets the value of a bit at a specified index to 1 (true)
+     * @param index The index of the bit to set (bit index)
+     */
+    constexpr void set(const uint64_t index) noexcept
+    {
+        data[index / chunk_bits] |= static_cast<T>(T(1u) << index % chunk_bits);
+    }
+
+    /**
+     * Sets the value of a bit at a specified index to 0 (false)
+     * @param index The index of the bit to clear (bit index)
+     */
+    constexpr void clear(const uint64_t index) noexcept
+    {
+        data[index / chunk_bits] &= static_cast<T>(~(T(1u) << index % chunk_bits));
+    }
+
+    /**
+     * Flips the bit at the specified index
+     * @param index Index of the bit to flip (bit index)
+     */
+    constexpr void flip(const uint64_t index) noexcept
+    {
+        data[index / chunk_bits] ^= static_cast<T>(T(1u) << index % chunk_bits);
+    }
+
+    /**
+     * Fills the bitset with a specified value
+     * @param value The value to fill the bitset with
+     */
+    constexpr void fill(const bool value) noexcept
+    {
+        for_each_chunk([&](const uint64_t i) { data[i] = value ? chunk_max : T(0u); });
+        clear_tail();
+    }
+
+    /**
+     * Sets all the bits (sets all bits to 1)
+     */
+    constexpr void set() noexcept
+    {
+        fill(true);
+    }
+
+    /**
+     * Clears all the bits (sets all bits to 0)
+     */
+    constexpr void clear() noexcept
+    {
+        fill(false);
+    }
+
+    /**
+     * Flips all the bits
+     */
+    constexpr void flip() noexcept
+    {
+        for_each_chunk([&](const uint64_t i) { data[i] = static_cast<T>(~data[i]); });
+        clear_tail();
+    }
+
+    /**
+     * Fills all the bits in the specified range with the specified value
+     * @param value Value to fill the bits with (bit value)
+     * @param begin Begin of the range to fill (bit index)
+     * @param end End of the range to fill (bit index)
+     */
+    constexpr void fill_in_range(const bool value, const uint64_t begin, const uint64_t end) noexcept
+    {
+        for (uint64_t i = begin / chunk_bits; i * chunk_bits < end && begin < end; ++i)
+        {
+            const T mask = range_mask(i, begin, end);
+            data[i] = static_cast<T>(value ? data[i] | mask : data[i] & ~mask);
+        }
+    }
+
+    /**
+     * Sets all the bits in the specified range to 1 (true)
+     * @param begin Begin of the range to set (bit index)
+     * @param end End of the range to set (bit index)
+     */
+    constexpr void set_in_range(const uint64_t begin, const uint64_t end) noexcept
+    {
+        fill_in_range(true, begin, end);
+    }
+
+    /**
+     * Clears all the bits in the specified range (sets them to 0)
+     * @param begin Begin of the range to clear (bit index)
+     * @param end End of the range to clear (bit index)
+     */
+    constexpr void clear_in_range(const uint64_t begin, const uint64_t end) noexcept
+    {
+        fill_in_range(false, begin, end);
+    }
+
+    /**
+     * Flips all the bits in the specified range
+     * @param begin Begin of the range to flip (bit index)
+     * @param end End of the range to flip (bit index)
+     */
+    constexpr void flip_in_range(const uint64_t begin, const uint64_t end) noexcept
+    {
+        for (uint64_t i = begin / chunk_bits; i * chunk_bits < end && begin < end; ++i)
+            data[i] ^= range_mask(i, begin, end);
+    }
+
+    /**
+     * Checks if all the bits are set
+     * @return True if all the bits are set, false otherwise
+     */
+    constexpr bool all() const noexcept
+    {
+        bool result = true;
+        for_each_chunk([&](const uint64_t i) { result &= data[i] == (i == storage_size - 1u ? tail_mask : chunk_max); });
+        return result;
+    }
+
+    /**
+     * Checks if any of the bits are set
+     * @return True if any of the bits are set, false otherwise
+     */
+    constexpr bool any() const noexcept
+    {
+        T result = 0u;
+        for_each_chunk([&](const uint64_t i) { result |= data[i]; });
+        return result;
+    }
+
+    /**
+     * Checks if none of the bits are set
+     * @return True if none of the bits are set, false otherwise
+     */
+    constexpr bool none() const noexcept
+    {
+        return !any();
+    }
+
+    /**
+     * @return The number of bits set in the bitset
+     */
+    constexpr uint64_t count() const noexcept
+    {
+        uint64_t count = 0;
+        for_each_chunk([&](const uint64_t i) { count += popcount(data[i]); });
+        return count;
+    }
+
+    /**
+     * Finds the first bit with the specified value at or after the specified index
+     * @param value The value of the bit to find
+     * @param begin Index to start the search from (bit index)
+     * @return Index of the found bit, npos if there is none
+     */
+    constexpr uint64_t find_next_value(const bool value, const uint64_t begin) const noexcept
+    {
+        for (uint64_t i = begin / chunk_bits; i < storage_size; ++i)
+        {
+            T chunk = value ? data[i] : static_cast<T>(~data[i]);
+            if (i == begin / chunk_bits)
+                chunk &= static_cast<T>(chunk_max << begin % chunk_bits);
+            if (chunk)
+            {
+                // unset matches past the size are the cleared bits of the last chunk
+                const uint64_t index = i * chunk_bits + ctz(chunk);
+                return index < N ? index : npos;
+            }
+        }
+        return npos;
+    }
+
+    /**
+     * @return Index of the first set bit, npos if there is none
+     */
+    constexpr uint64_t find_first() const noexcept
+    {
+        return find_next_value(true, 0);
+    }
+
+    /**
+     * @param index Index to search after, exclusive (bit index)
+     * @return Index of the first set bit after index, npos if there is none
+     */
+    constexpr uint64_t find_next(const uint64_t index) const noexcept
+    {
+        return index == npos ? npos : find_next_value(true, index + 1u);
+    }
+
+    /**
+     * @return Index of the first unset bit, npos if there is none
+     */
+    constexpr uint64_t find_first_unset() const noexcept
+    {
+        return find_next_value(false, 0);
+    }
+
+    /**
+     * @param index Index to search after, exclusive (bit index)
+     * @return Index of the first unset bit after index, npos if there is none
+     */
+    constexpr uint64_t find_next_unset(const uint64_t index) const noexcept
+    {
+        return index == npos ? npos : find_next_value(false, index + 1u);
+    }
+
+    /**
+     * Calls the function with the index of every set bit, in increasing order
+     * @param function The function to call, takes the bit index (uint64_t)
+     */
+    template <typename F>
+    constexpr void for_each_set_bit(F&& function) const
+    {
+        for (uint64_t i = 0; i < storage_size; ++i)
+        {
+            for (T chunk = data[i]; chunk; chunk &= static_cast<T>(chunk - 1u))
+                function(i * chunk_bits + ctz(chunk));
+        }
+    }
+
+    /**
+     * Intersects the bitset with another one
+     * @param other The bitset to intersect with
+     * @return Reference to this bitset
+     */
+    constexpr CBitSet& operator&=(const CBitSet& other) noexcept
+    {
+        for_each_chunk([&](const uint64_t i) { data[i] &= other.data[i]; });
+        return *this;
+    }
+
+    /**
+     * Unites the bitset with another one
+     * @param other The bitset to unite with
+     * @return Reference to this bitset
+     */
+    constexpr CBitSet& operator|=(const CBitSet& other) noexcept
+    {
+        for_each_chunk([&](const uint64_t i) { data[i] |= other.data[i]; });
+        return *this;
+    }
+
+    /**
+     * Computes the symmetric difference with another bitset
+     * @param other The other bitset
+     * @return Reference to this bitset
+     */
+    constexpr CBitSet& operator^=(const CBitSet& other) noexcept
+    {
+        for_each_chunk([&](const uint64_t i) { data[i] ^= other.data[i]; });
+        return *this;
+    }
+
+    /**
+     * Removes the bits of another bitset (this &= ~other)
+     * @param other The bitset with the bits to remove
+     * @return Reference to this bitset
+     */
+    constexpr CBitSet& and_not(const CBitSet& other) noexcept
+    {
+        for_each_chunk([&](const uint64_t i) { data[i] &= static_cast<T>(~other.data[i]); });
+        return *this;
+    }
+
+    /**
+     * Shifts the bitset towards the higher indices (bit i moves to i + shift, the low bits are cleared)
+     * @param shift Number of bits to shift by (bit count, any value)
+     * @return Reference to this bitset
+     */
+    constexpr CBitSet& operator<<=(const uint64_t shift) noexcept
+    {
+        const uint64_t chunk_shift = shift / chunk_bits, bit_shift = shift % chunk_bits;
+        // descending, so every chunk is read before it is written
+        for (uint64_t i = storage_size; i-- > 0;)
+        {
+            T chunk = 0u;
+            if (i >= chunk_shift)
+            {
+                chunk = static_cast<T>(data[i - chunk_shift] << bit_shift);
+                if (bit_shift && i > chunk_shift)
+                    chunk |= static_cast<T>(data[i - chunk_shift - 1u] >> (chunk_bits - bit_shift));
+            }
+            data[i] = chunk;
+        }
+        clear_tail();
+        return *this;
+    }
+
+    /**
+     * Shifts the bitset towards the lower indices (bit i moves to i - shift, the high bits are cleared)
+     * @param shift Number of bits to shift by (bit count, any value)
+     * @return Reference to this bitset
+     */
+    constexpr CBitSet& operator>>=(const uint64_t shift) noexcept
+    {
+        const uint64_t chunk_shift = shift / chunk_bits, bit_shift = shift % chunk_bits;
+        // ascending, so every chunk is read before it is written
+        for (uint64_t i = 0; i < storage_size; ++i)
+        {
+            T chunk = 0u;
+            if (chunk_shift < storage_size - i)
+            {
+                chunk = static_cast<T>(data[i + chunk_shift] >> bit_shift);
+                if (bit_shift && chunk_shift + 1u < storage_size - i)
+                    chunk |= static_cast<T>(data[i + chunk_shift + 1u] << (chunk_bits - bit_shift));
+            }
+            data[i] = chunk;
+        }
+        return *this;
+    }
+
+    /**
+     * Shifts the bitset towards the higher indices and ORs new bits into the freed low bits (this = (this << shift) | bits)
+     * @param shift Number of bits to shift by (bit count, any value)
+     * @param bits Bits ORed into the first min(N, 64) bits after the shift
+     * @return Reference to this bitset
+     */
+    constexpr CBitSet& shift_left_or(const uint64_t shift, const uint64_t bits) noexcept
+    {
+        *this <<= shift;
+        for (uint64_t i = 0; i < storage_size && i * chunk_bits < 64u; ++i)
+            data[i] |= static_cast<T>(bits >> i * chunk_bits);
+        clear_tail();
+        return *this;
+    }
+
+    /**
+     * Rotates the bitset towards the higher indices (bit i moves to (i + shift) % N)
+     * @param shift Number of bits to rotate by (bit count, any value)
+     * @return Reference to this bitset
+     */
+    constexpr CBitSet& rotate_left(const uint64_t shift) noexcept
+    {
+        if constexpr (N != 0)
+        {
+            CBitSet wrapped(*this);
+            wrapped >>= N - shift % N;
+            *this <<= shift % N;
+            *this |= wrapped;
+        }
+        return *this;
+    }
+
+    /**
+     * Rotates the bitset towards the lower indices (bit i moves to (i - shift) % N)
+     * @param shift Number of bits to rotate by (bit count, any value)
+     * @return Reference to this bitset
+     */
+    constexpr CBitSet& rotate_right(const uint64_t shift) noexcept
+    {
+        if constexpr (N != 0)
+            rotate_left(N - shift % N);
+        return *this;
+    }
+
+    /**
+     * @return The complement of the bitset
+     */
+    constexpr CBitSet operator~() const noexcept
+    {
+        CBitSet result(*this);
+        result.flip();
+        return result;
+    }
+
+    /**
+     * @return True if both of the bitsets hold the same bits
+     */
+    constexpr bool operator==(const CBitSet& other) const noexcept
+    {
+        bool result = true;
+        for_each_chunk([&](const uint64_t i) { result &= data[i] == other.data[i]; });
+        return result;
+    }
+
+    /**
+     * @return True if the bitsets differ in any bit
+     */
+    constexpr bool operator!=(const CBitSet& other) const noexcept
+    {
+        return !(*this == other);
+    }
+
+    /**
+     * Counts the set bits of this & other without storing the result
+     * @param other The right operand
+     * @return The number of set bits of the intersection
+     */
+    constexpr uint64_t and_count(const CBitSet& other) const noexcept
+    {
+        uint64_t count = 0;
+        for_each_chunk([&](const uint64_t i) { count += popcount(static_cast<T>(data[i] & other.data[i])); });
+        return count;
+    }
+
+private:
+    /**
+     * Mask of the bits of the last chunk that are part of the bitset
+     */
+    static constexpr T tail_mask = N % chunk_bits ? static_cast<T>(chunk_max >> (chunk_bits - N % chunk_bits)) : chunk_max;
+
+    /**
+     * Calls the function with every chunk index, unrolled with a fold expression when there are at most unroll_limit chunks
+     * @param function The function to call, takes the chunk index (uint64_t)
+     */
+    template <typename F>
+    constexpr void for_each_chunk(F&& function) const
+    {
+        if constexpr (storage_size <= unroll_limit)
+            unrolled(function, std::make_index_sequence<storage_size>());
+        else
+        {
+            for (uint64_t i = 0; i < storage_size; ++i)
+                function(i);
+        }
+    }
+
+    template <typename F, std::size_t... I>
+    static constexpr void unrolled(F& function, std::index_sequence<I...>)
+    {
+        (function(uint64_t(I)), ...);
+    }
+
+    /**
+     * Clears the bits of the last chunk past N
+     */
+    constexpr void clear_tail() noexcept
+    {
+        if constexpr (storage_size != 0)
+            data[storage_size - 1u] &= tail_mask;
+    }
+
+    /**
+     * Creates the mask of the bits of chunk i in range [begin, end)
+     * @param i Index of the chunk (chunk index)
+     * @param begin Begin of the range (bit index)
+     * @param end End of the range (bit index)
+     * @return The created mask
+     */
+    static constexpr T range_mask(const uint64_t i, const uint64_t begin, const uint64_t end) noexcept
+    {
+        T mask = chunk_max;
+        if (begin > i * chunk_bits)
+            mask = static_cast<T>(mask << (begin - i * chunk_bits));
+        if (end < (i + 1u) * chunk_bits)
+            mask &= static_cast<T>(chunk_max >> ((i + 1u) * chunk_bits - end));
+        return mask;
+    }
+
+    /**
+     * Counts the set bits of a chunk (usable in constant expressions)
+     * @param chunk The chunk to count (chunk value)
+     * @return The number of set bits
+     */
+    static constexpr uint64_t popcount(const T chunk) noexcept
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return static_cast<uint64_t>(__builtin_popcountll(chunk));
+#else
+        uint64_t word = chunk;
+        word = word - ((word >> 1) & 0x5555555555555555ull);
+        word = (word & 0x3333333333333333ull) + ((word >> 2) & 0x3333333333333333ull);
+        word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+        return (word * 0x0101010101010101ull) >> 56;
+#endif
+    }
+
+    /**
+     * Counts the trailing zero bits of a chunk (usable in constant expressions)
+     * @param chunk The chunk to scan, non-zero (chunk value)
+     * @return Index of the lowest set bit
+     */
+    static constexpr uint64_t ctz(const T chunk) noexcept
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return static_cast<uint64_t>(__builtin_ctzll(chunk));
+#else
+        uint64_t index = 0;
+        for (T value = chunk; !(value & 1u); value = static_cast<T>(value >> 1))
+            ++index;
+        return index;
+#endif
+    }
+};
+
+/**
+ * @return The intersection of two bitsets
+ */
+template <uint64_t N, typename T>
+constexpr CBitSet<N, T> operator&(CBitSet<N, T> left, const CBitSet<N, T>& right) noexcept
+{
+    return left &= right;
+}
+
+/**
+ * @return The union of two bitsets
+ */
+template <uint64_t N, typename T>
+constexpr CBitSet<N, T> operator|(CBitSet<N, T> left, const CBitSet<N, T>& right) noexcept
+{
+    return left |= right;
+}
+
+/**
+ * @return The symmetric difference of two bitsets
+ */
+template <uint64_t N, typename T>
+constexpr CBitSet<N, T> operator^(CBitSet<N, T> left, const CBitSet<N, T>& right) noexcept
+{
+    return left ^= right;
+}
+
+/**
+ * @return The bitset shifted towards the higher indices
+ */
+template <uint64_t N, typename T>
+constexpr CBitSet<N, T> operator<<(CBitSet<N, T> bitset, const uint64_t shift) noexcept
+{
+    return bitset <<= shift;
+}
+
+/**
+ * @return The bitset shifted towards the lower indices
+ */
+template <uint64_t N, typename T>
+constexpr CBitSet<N, T> operator>>(CBitSet<N, T> bitset, const uint64_t shift) noexcept
+{
+    return bitset >>= shift;
+}
+
+/**
+ * A dynamic bitset with atomic 64-bit chunks, safe to modify from multiple threads without locking
+ * The read-modify-write operations default to std::memory_order_acq_rel, pass std::memory_order_relaxed where only atomicity is needed
+ */
+class CAtomicBitSet
+{
+    static_assert(sizeof(std::atomic<uint64_t>) == sizeof(uint64_t) && std::atomic<uint64_t>::is_always_lock_free, "CAtomicBitSet: std::atomic<uint64_t> has to be a lock-free plain word");
+
+public:
+    /**
+     * Index returned by the find functions when no matching bit exists
+     */
+    static constexpr uint64_t npos = BITSET_NPOS;
+
+    /**
+     * Underlying array of atomic words containing the bits
+     */
+    std::atomic<uint64_t>* data;
+    /**
+     * Size of bitset in bits
+     */
+    uint64_t size;
+    /**
+     * Size of bitset in 64-bit words
+     */
+    uint64_t storage_size;
+
+    /**
+     * Default constructor, creates an empty bitset
+     */
+    CAtomicBitSet() noexcept : data(nullptr), size(0), storage_size(0) {}
+
+    /**
+     * Size constructor, all of the bits are cleared
+     * @param size The size of the bitset (bit size)
+     */
+    explicit CAtomicBitSet(const uint64_t size) : data(new std::atomic<uint64_t>[bitset_calculate_word_count(size)]()), size(size), storage_size(bitset_calculate_word_count(size)) {}
+
+    CAtomicBitSet(const CAtomicBitSet&) = delete;
+    CAtomicBitSet& operator=(const CAtomicBitSet&) = delete;
+
+    /**
+     * Move constructor
+     * @param other The bitset to move from (left empty)
+     */
+    CAtomicBitSet(CAtomicBitSet&& other) noexcept : data(std::exchange(other.data, nullptr)), size(std::exchange(other.size, 0)), storage_size(std::exchange(other.storage_size, 0)) {}
+
+    /**
+     * Move assignment
+     * @param other The bitset to move from (left empty)
+     * @return Reference to this bitset
+     */
+    CAtomicBitSet& operator=(CAtomicBitSet&& other) noexcept
+    {
+        if (this != &other)
+        {
+            delete[] data;
+            data = std::exchange(other.data, nullptr);
+            size = std::exchange(other.size, 0);
+            storage_size = std::exchange(other.storage_size, 0);
+        }
+        return *this;
+    }
+
+    /**
+     * Destructor (frees the memory), no other thread may access the bitset anymore
+     */
+    ~CAtomicBitSet()
+    {
+        delete[] data;
+    }
+
+    /**
+     * Retrieves the value of a bit at a specified index
+     * @param index The index of the bit to read (bit index)
+     * @param order Memory order of the load
+     * @return The value of the bit at the specified index
+     */
+    bool get(const uint64_t index, const std::memory_order order = std::memory_order_acquire) const noexcept
+    {
+        return (data[index / 64u].load(order) >> index % 64u) & 1u;
+    }
+
+    /**
+     * Sets the bit at the specified index to 1 (true)
+     * @param index The index of the bit to set (bit index)
+     * @param order Memory order of the read-modify-write
+     */
+    void set(const uint64_t index, const std::memory_order order = std::memory_order_acq_rel) noexcept
+    {
+        data[index / 64u].fetch_or(uint64_t(1u) << index % 64u, order);
+    }
+
+    /**
+     * Sets the bit at the specified index to 0 (false)
+     * @param index The index of the bit to clear (bit index)
+     * @param order Memory order of the read-modify-write
+     */
+    void clear(const uint64_t index, const std::memory_order order = std::memory_order_acq_rel) noexcept
+    {
+        data[index / 64u].fetch_and(~(uint64_t(1u) << index % 64u), order);
+    }
+
+    /**
+     * Flips the bit at the specified index
+     * @param index The index of the bit to flip (bit index)
+     * @param order Memory order of the read-modify-write
+     */
+    void flip(const uint64_t index, const std::memory_order order = std::memory_order_acq_rel) noexcept
+    {
+        data[index / 64u].fetch_xor(uint64_t(1u) << index % 64u, order);
+    }
+
+    /**
+     * Sets the bit at the specified index and returns its previous value, e.g. to claim a vertex in a parallel traversal
+     * @param index The index of the bit to set (bit index)
+     * @param order Memory order of the read-modify-write
+     * @return True if the bit was already set (another thread claimed it), false if this call set it
+     */
+    bool test_and_set(const uint64_t index, const std::memory_order order = std::memory_order_acq_rel) noexcept
+    {
+        const uint64_t mask = uint64_t(1u) << index % 64u;
+        return data[index / 64u].fetch_or(mask, order) & mask;
+    }
+
+    /**
+     * Clears the bit at the specified index and returns its previous value
+     * @param index The index of the bit to clear (bit index)
+     * @param order Memory order of the read-modify-write
+     * @return The previous value of the bit
+     */
+    bool test_and_clear(const uint64_t index, const std::memory_order order = std::memory_order_acq_rel) noexcept
+    {
+        const uint64_t mask = uint64_t(1u) << index % 64u;
+        return data[index / 64u].fetch_and(~mask, order) & mask;
+    }
+
+    /**
+     * Flips the bit at the specified index and returns its previous value
+     * @param index The index of the bit to flip (bit index)
+     * @param order Memory order of the read-modify-write
+     * @return The previous value of the bit
+     */
+    bool test_and_flip(const uint64_t index, const std::memory_order order = std::memory_order_acq_rel) noexcept
+    {
+        const uint64_t mask = uint64_t(1u) << index % 64u;
+        return data[index / 64u].fetch_xor(mask, order) & mask;
+    }
+
+    /**
+     * Retrieves the chunk at the specified index
+     * @param index Index of the chunk to read (chunk index)
+     * @param order Memory order of the load
+     * @return The chunk at the specified index
+     */
+    uint64_t load_chunk(const uint64_t index, const std::memory_order order = std::memory_order_acquire) const noexcept
+    {
+        return data[index].load(order);
+    }
+
+    /**
+     * Sets the chunk at the specified index to the specified value
+     * @param chunk The chunk to set (chunk value)
+     * @param index Index of the chunk to set (chunk index)
+     * @param order Memory order of the store
+     */
+    void store_chunk(const uint64_t chunk, const uint64_t index, const std::memory_order order = std::memory_order_release) noexcept
+    {
+        data[index].store(chunk, order);
+    }
+
+    /**
+     * Sets all the bits of mask in the chunk at the specified index (chunk |= mask)
+     * @param mask Bits to set (chunk value)
+     * @param index Index of the chunk to modify (chunk index)
+     * @param order Memory order of the read-modify-write
+     * @return The previous value of the chunk (previous & mask are the bits set by other threads before)
+     */
+    uint64_t fetch_or_chunk(const uint64_t mask, const uint64_t index, const std::memory_order order = std::memory_order_acq_rel) noexcept
+    {
+        return data[index].fetch_or(mask, order);
+    }
+
+    /**
+     * Keeps only the bits of mask in the chunk at the specified index (chunk &= mask)
+     * @param mask Bits to keep (chunk value)
+     * @param index Index of the chunk to modify (chunk index)
+     * @param order Memory order of the read-modify-write
+     * @return The previous value of the chunk
+     */
+    uint64_t fetch_and_chunk(const uint64_t mask, const uint64_t index, const std::memory_order order = std::memory_order_acq_rel) noexcept
+    {
+        return data[index].fetch_and(mask, order);
+    }
+
+    /**
+     * Flips the bits of mask in the chunk at the specified index (chunk ^= mask)
+     * @param mask Bits to flip (chunk value)
+     * @param index Index of the chunk to modify (chunk index)
+     * @param order Memory order of the read-modify-write
+     * @return The previous value of the chunk
+     */
+    uint64_t fetch_xor_chunk(const uint64_t mask, const uint64_t index, const std::memory_order order = std::memory_order_acq_rel) noexcept
+    {
+        return data[index].fetch_xor(mask, order);
+    }
+
+    /**
+     * Sets the bits at the specified indices to 1 (true)
+     * Consecutive indices landing in the same chunk are merged into a single fetch_or, so sorted batches need one read-modify-write per chunk
+     * @param indices The indices of the bits to set (bit index)
+     * @param count Number of indices
+     * @param order Memory order of every read-modify-write
+     */
+    void set_many(const uint64_t* const indices, const uint64_t count, const std::memory_order order = std::memory_order_acq_rel) noexcept
+    {
+        for_each_chunk_mask(indices, count, false, [&](const uint64_t mask, const uint64_t index) { data[index].fetch_or(mask, order); });
+    }
+
+    /**
+     * Sets the bits at the specified indices to 0 (false), merging consecutive indices of a chunk into a single fetch_and
+     * @param indices The indices of the bits to clear (bit index)
+     * @param count Number of indices
+     * @param order Memory order of every read-modify-write
+     */
+    void clear_many(const uint64_t* const indices, const uint64_t count, const std::memory_order order = std::memory_order_acq_rel) noexcept
+    {
+        for_each_chunk_mask(indices, count, false, [&](const uint64_t mask, const uint64_t index) { data[index].fetch_and(~mask, order); });
+    }
+
+    /**
+     * Flips the bits at the specified indices, merging consecutive indices of a chunk into a single fetch_xor
+     * An index present twice is flipped twice
+     * @param indices The indices of the bits to flip (bit index)
+     * @param count Number of indices
+     * @param order Memory order of every read-modify-write
+     */
+    void flip_many(const uint64_t* const indices, const uint64_t count, const std::memory_order order = std::memory_order_acq_rel) noexcept
+    {
+        for_each_chunk_mask(indices, count, true, [&](const uint64_t mask, const uint64_t index) { if (mask) data[index].fetch_xor(mask, order); });
+    }
+
+    /**
+     * Retrieves the values of the bits at the specified indices, prefetching ahead
+     * @param indices The indices of the bits to read (bit index)
+     * @param count Number of indices
+     * @param values Array receiving the value of every bit (count values)
+     * @param order Memory order of every load
+     */
+    void get_many(const uint64_t* const indices, const uint64_t count, bool* const values, const std::memory_order order = std::memory_order_acquire) const noexcept
+    {
+        for (uint64_t i = 0; i < count; ++i)
+        {
+            if (i + BITSET_PREFETCH_DISTANCE < count)
+                BITSET_PREFETCH(data + indices[i + BITSET_PREFETCH_DISTANCE] / 64u, 0);
+            values[i] = (data[indices[i] / 64u].load(order) >> indices[i] % 64u) & 1u;
+        }
+    }
+
+    /**
+     * Fills all the bits with the specified value (relaxed stores, publish with a release fence or a synchronizing operation)
+     * @param value The value to fill the bitset with
+     */
+    void fill(const bool value) noexcept
+    {
+        for (uint64_t i = 0; i < storage_size; ++i)
+            data[i].store(value ? UINT64_MAX : 0u, std::memory_order_relaxed);
+    }
+
+    /**
+     * Counts the set bits with the non-atomic popcount kernels
+     * Only call it while no thread is modifying the bitset (e.g. after joining the writers), the result is undefined otherwise
+     * @return The number of bits set in the bitset
+     */
+    uint64_t count() const noexcept
+    {
+        const uint64_t full_words = size / 64u;
+        uint64_t count = bitset_popcount_bytes(reinterpret_cast<const uint8_t*>(data), full_words * sizeof(uint64_t));
+        // bits past the end of the bitset are not counted
+        if (size % 64u)
+            count += bitset_popcount64(data[full_words].load(std::memory_order_relaxed) & (UINT64_MAX >> (64u - size % 64u)));
+        return count;
+    }
+
+    /**
+     * Finds the first bit with the specified value at or after the specified index
+     * The words are read with relaxed loads (plain loads on x86 and ARM), so concurrent writers are allowed, but the result is not a snapshot
+     * @param value The value of the bit to find
+     * @param begin Index to start the search from (bit index)
+     * @return Index of the found bit, npos if there is none
+     */
+    uint64_t find_next_value(const bool value, const uint64_t begin) const noexcept
+    {
+        if (begin >= size)
+            return npos;
+
+        const uint64_t invert = value ? 0u : UINT64_MAX;
+        uint64_t index = begin / 64u;
+        uint64_t word = (data[index].load(std::memory_order_relaxed) ^ invert) & (UINT64_MAX << begin % 64u);
+        while (!word)
+        {
+            if (++index >= storage_size)
+                return npos;
+            word = data[index].load(std::memory_order_relaxed) ^ invert;
+        }
+        // matches past the size are bits of the last word that are not part of the bitset
+        index = index * 64u + bitset_ctz64(word);
+        return index < size ? index : npos;
+    }
+
+private:
+    /**
+     * Merges runs of consecutive indices landing in the same chunk into a single mask, prefetching the chunks ahead
+     * @param indices The indices of the bits (bit index)
+     * @param count Number of indices
+     * @param toggle Whether the bits of an index present twice cancel out (xor) instead of being merged (or)
+     * @param function Callable receiving (mask, chunk index) once per run
+     */
+    template <typename Function>
+    void for_each_chunk_mask(const uint64_t* const indices, const uint64_t count, const bool toggle, Function&& function) const noexcept
+    {
+        for (uint64_t i = 0; i < count;)
+        {
+            const uint64_t index = indices[i] / 64u;
+            uint64_t mask = 0;
+            for (; i < count && indices[i] / 64u == index; ++i)
+                mask = toggle ? mask ^ uint64_t(1u) << indices[i] % 64u : mask | uint64_t(1u) << indices[i] % 64u;
+            if (i + BITSET_PREFETCH_DISTANCE < count)
+                BITSET_PREFETCH(data + indices[i + BITSET_PREFETCH_DISTANCE] / 64u, 1);
+            function(mask, index);
+        }
+    }
+};
+
+/**
+ * Rank/select index over a bitset that is not modified anymore (poppy layout, see BitSetRankIndex), the bits are not copied
+ * Works with every bitset providing size and get_word, e.g. CDynamicBitSet or CBitSetView
+ * @tparam B Type of the indexed bitset
+ */
+template <typename B>
+class CBitSetRankIndex
+{
+public:
+    /**
+     * Index returned by select when no matching bit exists
+     */
+    static constexpr uint64_t npos = BITSET_NPOS;
+
+    /**
+     * Builds the index of a bitset (one pass over its words)
+     * @param bitset The bitset to index, has to outlive the index and must not be modified while indexed
+     */
+    explicit CBitSetRankIndex(const B& bitset) : bitset(&bitset), count(0)
+    {
+        const uint64_t words = bitset_calculate_word_count(bitset.size);
+        const uint64_t block_count = words / words_per_block + (words % words_per_block ? 1 : 0);
+        blocks.resize(block_count);
+        regions.resize(block_count ? (block_count - 1u) / BITSET_RANK_REGION_BLOCKS + 1u : 1u);
+
+        for (uint64_t block = 0; block < block_count; ++block)
+        {
+            if (!(block % BITSET_RANK_REGION_BLOCKS))
+                regions[block / BITSET_RANK_REGION_BLOCKS] = count;
+
+            uint64_t entry = count - regions[block / BITSET_RANK_REGION_BLOCKS], block_total = 0;
+            for (uint64_t sub = 0; sub < BITSET_RANK_BLOCK_BITS / BITSET_RANK_SUBBLOCK_BITS; ++sub)
+            {
+                uint64_t sub_total = 0;
+                const uint64_t first = block * words_per_block + sub * words_per_subblock;
+                for (uint64_t word = first; word < first + words_per_subblock && word < words; ++word)
+                    sub_total += bitset_popcount64(get_word(word));
+                // the last sub-block count is implied by the next entry
+                if (sub < 3u)
+                    entry |= sub_total << (32u + sub * 10u);
+                block_total += sub_total;
+            }
+            blocks[block] = entry;
+
+            // samples of the set bits numbered count .. count + block_total - 1
+            for (uint64_t sample = samples.size() * BITSET_SELECT_SAMPLE; sample < count + block_total; sample += BITSET_SELECT_SAMPLE)
+                samples.push_back(block);
+            count += block_total;
+        }
+    }
+
+    /**
+     * @return Number of set bits of the bitset
+     */
+    uint64_t size() const noexcept
+    {
+        return count;
+    }
+
+    /**
+     * Counts the set bits before the specified position in O(1) (two lookups and at most 7 popcounts)
+     * @param position End of the counted range, exclusive (bit index, positions past the size count the whole bitset)
+     * @return Number of set bits in [0, position)
+     */
+    uint64_t rank(const uint64_t position) const noexcept
+    {
+        if (position >= bitset->size)
+            return count;
+
+        const uint64_t block = position / BITSET_RANK_BLOCK_BITS, sub = position % BITSET_RANK_BLOCK_BITS / BITSET_RANK_SUBBLOCK_BITS;
+        uint64_t result = block_rank(block);
+        for (uint64_t i = 0; i < sub; ++i)
+            result += blocks[block] >> (32u + i * 10u) & 1023u;
+
+        const uint64_t last = position / 64u;
+        for (uint64_t word = position / BITSET_RANK_SUBBLOCK_BITS * words_per_subblock; word < last; ++word)
+            result += bitset_popcount64(bitset->get_word(word));
+        if (position % 64u)
+            result += bitset_popcount64(bitset->get_word(last) & (UINT64_MAX >> (64u - position % 64u)));
+        return result;
+    }
+
+    /**
+     * Finds the set bit with the specified rank, searching only the blocks between two select samples
+     * @param rank Number of set bits before the bit to find (0 finds the first set bit)
+     * @return Index of the bit, npos if the bitset has at most rank set bits
+     */
+    uint64_t select(const uint64_t rank) const noexcept
+    {
+        if (rank >= count)
+            return npos;
+
+        // the last block whose rank is at most rank, between the neighbouring samples
+        const uint64_t sample = rank / BITSET_SELECT_SAMPLE;
+        uint64_t low = samples[sample];
+        uint64_t high = sample + 1u < samples.size() ? samples[sample + 1u] + 1u : blocks.size();
+        while (high - low > 1u)
+        {
+            const uint64_t middle = low + (high - low) / 2u;
+            if (block_rank(middle) <= rank)
+                low = middle;
+            else
+                high = middle;
+        }
+
+        uint64_t remaining = rank - block_rank(low);
+        uint64_t sub = 0;
+        for (; sub < 3u && remaining >= (blocks[low] >> (32u + sub * 10u) & 1023u); ++sub)
+            remaining -= blocks[low] >> (32u + sub * 10u) & 1023u;
+
+        const uint64_t words = bitset_calculate_word_count(bitset->size);
+        for (uint64_t word = low * words_per_block + sub * words_per_subblock; word < words; ++word)
+        {
+            const uint64_t value = get_word(word);
+            const uint64_t value_count = bitset_popcount64(value);
+            if (remaining < value_count)
+                return word * 64u + bitset_select_word(value, remaining);
+            remaining -= value_count;
+        }
+        return npos;
+    }
+
+    /**
+     * @return Number of bytes allocated by the index
+     */
+    uint64_t memory_usage() const noexcept
+    {
+        return (regions.size() + blocks.size() + samples.size()) * sizeof(uint64_t);
+    }
+
+private:
+    static constexpr uint64_t words_per_block = BITSET_RANK_BLOCK_BITS / 64u;
+    static constexpr uint64_t words_per_subblock = BITSET_RANK_SUBBLOCK_BITS / 64u;
+
+    const B* bitset;
+    uint64_t count;
+    std::vector<uint64_t> regions;
+    std::vector<uint64_t> blocks;
+    std::vector<uint64_t> samples;
+
+    /**
+     * @param block Index of the block, in range [0, blocks.size()] (blocks.size() gives the total count)
+     * @return Number of set bits before the block
+     */
+    uint64_t block_rank(const uint64_t block) const noexcept
+    {
+        if (block >= blocks.size())
+            return count;
+        return regions[block / BITSET_RANK_REGION_BLOCKS] + (blocks[block] & UINT32_MAX);
+    }
+
+    /**
+     * @param index Index of the word (word index)
+     * @return The word of the bitset with the bits past its size read as 0
+     */
+    uint64_t get_word(const uint64_t index) const noexcept
+    {
+        if (index < bitset->size / 64u)
+            return bitset->get_word(index);
+        return bitset->size % 64u ? bitset->get_word(index) & (UINT64_MAX >> (64u - bitset->size % 64u)) : 0;
+    }
+};
+
+/**
+ * Blocked Bloom filter stored in a CDynamicBitSet, see BloomFilter (same layout and hashing as the C filter)
+ * Every key sets hash_count bits of a single BITSET_BLOOM_BLOCK_BITS-bit block, so an insert or a query costs one cache miss
+ */
+class CBloomFilter
+{
+public:
+    /**
+     * The bits of the filter (block_count * BITSET_BLOOM_BLOCK_BITS bits, cache line aligned)
+     */
+    CDynamicBitSet<uint64_t> bits;
+    /**
+     * Number of blocks
+     */
+    uint64_t block_count;
+    /**
+     * Number of bits set per key (1 - BITSET_BLOOM_MAX_HASHES)
+     */
+    uint64_t hash_count;
+
+    /**
+     * Sizing constructor, picks the geometry keeping the false positive rate at the target after expected_items inserts
+     * @param expected_items Number of keys the filter is sized for
+     * @param false_positive_rate Target false positive rate (clamped to [1e-9, 0.5])
+     */
+    CBloomFilter(const uint64_t expected_items, const double false_positive_rate) : block_count(0), hash_count(0)
+    {
+        bitset_bloom_geometry(expected_items, false_positive_rate, &block_count, &hash_count);
+        bits = CDynamicBitSet<uint64_t>(block_count * BITSET_BLOOM_BLOCK_BITS);
+    }
+
+    /**
+     * Removes all the keys
+     */
+    void clear() noexcept
+    {
+        bits.fill(false);
+    }
+
+    /**
+     * Inserts a key, the mask is OR-ed into its block at once
+     * @param key The key to insert
+     */
+    void insert(const uint64_t key) noexcept
+    {
+        const uint64_t hash = bitset_bloom_hash(key);
+        uint64_t* const block = bits.data + bitset_bloom_block_index(hash, block_count) * words_per_block;
+        uint64_t mask[words_per_block];
+        bitset_bloom_block_mask(hash, hash_count, mask);
+        for (uint64_t i = 0; i < words_per_block; ++i)
+            block[i] |= mask[i];
+    }
+
+    /**
+     * Checks if a key may have been inserted
+     * @param key The key to look up
+     * @return False if the key was never inserted, true if it was or on a false positive
+     */
+    bool contains(const uint64_t key) const noexcept
+    {
+        const uint64_t hash = bitset_bloom_hash(key);
+        const uint64_t* const block = bits.data + bitset_bloom_block_index(hash, block_count) * words_per_block;
+        uint64_t mask[words_per_block], missing = 0;
+        bitset_bloom_block_mask(hash, hash_count, mask);
+        for (uint64_t i = 0; i < words_per_block; ++i)
+            missing |= mask[i] & ~block[i];
+        return !missing;
+    }
+
+    /**
+     * Inserts the keys, prefetching the blocks BITSET_PREFETCH_DISTANCE keys ahead
+     * @param keys The keys to insert
+     * @param count Number of keys
+     */
+    void insert_many(const uint64_t* const keys, const uint64_t count) noexcept
+    {
+        for (uint64_t i = 0; i < count; ++i)
+        {
+            if (i + BITSET_PREFETCH_DISTANCE < count)
+                BITSET_PREFETCH(bits.data + bitset_bloom_block_index(bitset_bloom_hash(keys[i + BITSET_PREFETCH_DISTANCE]), block_count) * words_per_block, 1);
+            insert(keys[i]);
+        }
+    }
+
+    /**
+     * Looks up the keys, prefetching the blocks BITSET_PREFETCH_DISTANCE keys ahead
+     * @param keys The keys to look up
+     * @param count Number of keys
+     * @param results Array receiving the result of contains for every key (count values)
+     */
+    void contains_many(const uint64_t* const keys, const uint64_t count, bool* const results) const noexcept
+    {
+        for (uint64_t i = 0; i < count; ++i)
+        {
+            if (i + BITSET_PREFETCH_DISTANCE < count)
+                BITSET_PREFETCH(bits.data + bitset_bloom_block_index(bitset_bloom_hash(keys[i + BITSET_PREFETCH_DISTANCE]), block_count) * words_per_block, 0);
+            results[i] = contains(keys[i]);
+        }
+    }
+
+    /**
+     * Merges the keys of other into this filter (bitwise OR with the bulk kernels)
+     * @param other The filter to merge
+     * @return True on success, false if the filters differ in geometry (this filter is left unchanged)
+     */
+    bool merge(const CBloomFilter& other) noexcept
+    {
+        if (block_count != other.block_count || hash_count != other.hash_count)
+            return false;
+        bits |= other.bits;
+        return true;
+    }
+
+    /**
+     * Intersects the filters (bitwise AND with the bulk kernels), the result answers true for every key inserted into both
+     * @param other The filter to intersect with
+     * @return True on success, false if the filters differ in geometry (this filter is left unchanged)
+     */
+    bool intersect(const CBloomFilter& other) noexcept
+    {
+        if (block_count != other.block_count || hash_count != other.hash_count)
+            return false;
+        bits &= other.bits;
+        return true;
+    }
+
+    /**
+     * @param items Number of inserted keys
+     * @return The expected false positive rate after items inserts, see bitset_bloom_false_positive_rate
+     */
+    double false_positive_rate(const uint64_t items) const noexcept
+    {
+        return bitset_bloom_false_positive_rate(block_count, hash_count, items);
+    }
+
+private:
+    static constexpr uint64_t words_per_block = BITSET_BLOOM_BLOCK_BITS / 64u;
+};
+
+/**
+ * A copy-on-write bitset split into reference counted pages of BITSET_COW_PAGE_SIZE bytes, the C++ counterpart of CowBitSet
+ * Copying the bitset takes a snapshot: all of the pages are shared (O(pages), no bits are copied) and a shared page is copied
+ * on the first write to it, so a writer only pays for the pages it touches and every snapshot keeps a consistent view
+ * A bitset and its snapshots may be used by different threads (each one by a single thread at a time)
+ * Pages that were never written are null and read as cleared, bit i is bit i % 64 of word i / 64 (independent of BITSET_BLOCK_TYPE)
+ */
+class CCowBitSet
+{
+public:
+    /**
+     * Number of 64-bit words per page
+     */
+    static constexpr uint64_t page_words = BITSET_COW_PAGE_SIZE / sizeof(uint64_t);
+
+    /**
+     * A page of the bitset, shared by the snapshots holding it
+     */
+    struct alignas(BITSET_ALIGNMENT) page_type
+    {
+        uint64_t words[page_words];
+    };
+
+    /**
+     * Pointers to the pages (null for pages with all of the bits cleared), a page shared with another bitset must not be modified
+     */
+    std::vector<std::shared_ptr<page_type>> pages;
+    /**
+     * Size of bitset in bits
+     */
+    uint64_t size;
+
+    /**
+     * Default constructor, creates an empty bitset
+     */
+    CCowBitSet() noexcept : size(0) {}
+
+    /**
+     * Size constructor, all of the bits are cleared (no page is allocated)
+     * @param size The size of the bitset (bit size)
+     */
+    explicit CCowBitSet(const uint64_t size) : pages(size / BITSET_COW_PAGE_BITS + (size % BITSET_COW_PAGE_BITS ? 1 : 0)), size(size) {}
+
+    /**
+     * Copy constructor and assignment take a snapshot, copy-on-write keeps both bitsets independent
+     * The source must not be modified concurrently
+     */
+    CCowBitSet(const CCowBitSet&) = default;
+    CCowBitSet& operator=(const CCowBitSet&) = default;
+
+    /**
+     * Move constructor
+     * @param other The bitset to move from (left empty)
+     */
+    CCowBitSet(CCowBitSet&& other) noexcept : pages(std::move(other.pages)), size(std::exchange(other.size, 0))
+    {
+        other.pages.clear();
+    }
+
+    /**
+     * Move assignment
+     * @param other The bitset to move from (left empty)
+     * @return Reference to this bitset
+     */
+    CCowBitSet& operator=(CCowBitSet&& other) noexcept
+    {
+        if (this != &other)
+        {
+            pages = std::move(other.pages);
+            other.pages.clear();
+            size = std::exchange(other.size, 0);
+        }
+        return *this;
+    }
+
+    /**
+     * @return A snapshot of the bitset, same as copying it
+     */
+    CCowBitSet snapshot() const
+    {
+        return *this;
+    }
+
+    /**
+     * Retrieves the value of a bit at a specified index
+     * @param index The index of the bit to read (bit index)
+     * @return The value of the bit at the specified index
+     */
+    bool get(const uint64_t index) const noexcept
+    {
+        const page_type* const page = pages[index / BITSET_COW_PAGE_BITS].get();
+        const uint64_t bit = index % BITSET_COW_PAGE_BITS;
+        return page && (page->words[bit / 64u] >> bit % 64u & 1u);
+    }
+
+    /**
+     * Sets the value of a bit at a specified index to 1 (true), copies its page if it is shared
+     * @param index The index of the bit to set (bit index)
+     */
+    void set(const uint64_t index)
+    {
+        const uint64_t bit = index % BITSET_COW_PAGE_BITS;
+        writable_page(index / BITSET_COW_PAGE_BITS, true).words[bit / 64u] |= uint64_t(1u) << bit % 64u;
+    }
+
+    /**
+     * Sets the value of a bit at a specified index
+     * @param value The value to set the bit to
+     * @param index The index of the bit to set (bit index)
+     */
+    void set(const bool value, const uint64_t index)
+    {
+        if (value)
+            set(index);
+        else
+            clear(index);
+    }
+
+    /**
+     * Sets the value of a bit at a specified index to 0 (false), copies its page if it is shared (a missing page stays missing)
+     * @param index The index of the bit to clear (bit index)
+     */
+    void clear(const uint64_t index)
+    {
+        const uint64_t bit = index % BITSET_COW_PAGE_BITS;
+        if (pages[index / BITSET_COW_PAGE_BITS])
+            writable_page(index / BITSET_COW_PAGE_BITS, true).words[bit / 64u] &= ~(uint64_t(1u) << bit % 64u);
+    }
+
+    /**
+     * Flips the value of a bit at a specified index, copies its page if it is shared
+     * @param index The index of the bit to flip (bit index)
+     */
+    void flip(const uint64_t index)
+    {
+        const uint64_t bit = index % BITSET_COW_PAGE_BITS;
+        writable_page(index / BITSET_COW_PAGE_BITS, true).words[bit / 64u] ^= uint64_t(1u) << bit % 64u;
+    }
+
+    /**
+     * Fills bits [begin, end) with a specified value page by page
+     * Pages cleared entirely are released and pages filled entirely are replaced without copying their old bits
+     * @param value The value to fill the bits with
+     * @param begin The index of the first bit to fill (bit index)
+     * @param end The index past the last bit to fill (bit index), begin <= end <= size
+     */
+    void fill_in_range(const bool value, const uint64_t begin, const uint64_t end)
+    {
+        for (uint64_t page = begin / BITSET_COW_PAGE_BITS; begin < end && page <= (end - 1u) / BITSET_COW_PAGE_BITS; ++page)
+        {
+            const uint64_t base = page * BITSET_COW_PAGE_BITS;
+            const uint64_t first = begin > base ? begin - base : 0;
+            const uint64_t last = end - base < BITSET_COW_PAGE_BITS ? end - base : BITSET_COW_PAGE_BITS;
+            const bool whole = !first && (last == BITSET_COW_PAGE_BITS || base + last == size);
+            if (!value && (whole || !pages[page]))
+            {
+                pages[page].reset();
+                continue;
+            }
+            update_words(writable_page(page, !whole), first, last, value ? UINT64_MAX : 0, whole);
+        }
+    }
+
+    /**
+     * Fills the bitset with a specified value, clearing releases all of the pages
+     * @param value The value to fill the bitset with
+     */
+    void fill(const bool value)
+    {
+        fill_in_range(value, 0, size);
+    }
+
+    /**
+     * Flips bits [begin, end) page by page
+     * @param begin The index of the first bit to flip (bit index)
+     * @param end The index past the last bit to flip (bit index), begin <= end <= size
+     */
+    void flip_in_range(const uint64_t begin, const uint64_t end)
+    {
+        for (uint64_t page = begin / BITSET_COW_PAGE_BITS; begin < end && page <= (end - 1u) / BITSET_COW_PAGE_BITS; ++page)
+        {
+            const uint64_t base = page * BITSET_COW_PAGE_BITS;
+            const uint64_t first = begin > base ? begin - base : 0;
+            const uint64_t last = end - base < BITSET_COW_PAGE_BITS ? end - base : BITSET_COW_PAGE_BITS;
+            page_type& target = writable_page(page, true);
+            for (uint64_t word = first / 64u; word <= (last - 1u) / 64u; ++word)
+                target.words[word] ^= word_mask(word, first, last);
+        }
+    }
+
+    /**
+     * Counts the set bits, missing pages are skipped
+     * @return The number of set bits
+     */
+    uint64_t count() const noexcept
+    {
+        uint64_t count = 0;
+        for (uint64_t page = 0; page < pages.size(); ++page)
+        {
+            if (!pages[page])
+                continue;
+            const uint64_t bits = size - page * BITSET_COW_PAGE_BITS < BITSET_COW_PAGE_BITS ? size - page * BITSET_COW_PAGE_BITS : BITSET_COW_PAGE_BITS;
+            for (uint64_t word = 0; word < bits / 64u; ++word)
+                count += bitset_popcount64(pages[page]->words[word]);
+            if (bits % 64u)
+                count += bitset_popcount64(pages[page]->words[bits / 64u] & (UINT64_MAX >> (64u - bits % 64u)));
+        }
+        return count;
+    }
+
+    /**
+     * Counts the pages shared with other bitsets, the pages a write could still copy
+     * @return The number of shared pages (a snapshot may be released concurrently, the result is a momentary value)
+     */
+    uint64_t shared_pages() const noexcept
+    {
+        uint64_t count = 0;
+        for (const std::shared_ptr<page_type>& page : pages)
+            count += page && page.use_count() > 1;
+        return count;
+    }
+
+private:
+    /**
+     * @return Mask of the bits of the word in range [first, last) of its page
+     */
+    static uint64_t word_mask(const uint64_t word, const uint64_t first, const uint64_t last) noexcept
+    {
+        const uint64_t low = word * 64u < first ? first - word * 64u : 0;
+        const uint64_t high = last - word * 64u < 64u ? last - word * 64u : 64u;
+        return (UINT64_MAX >> (64u - (high - low))) << low;
+    }
+
+    /**
+     * Stores value into the bits [first, last) of a page, a freshly replaced page (whole) gets its other bits cleared
+     */
+    static void update_words(page_type& page, const uint64_t first, const uint64_t last, const uint64_t value, const bool whole) noexcept
+    {
+        for (uint64_t word = first / 64u; word <= (last - 1u) / 64u; ++word)
+        {
+            const uint64_t mask = word_mask(word, first, last);
+            page.words[word] = whole ? value & mask : (page.words[word] & ~mask) | (value & mask);
+        }
+        if (whole)
+            std::memset(page.words + (last - 1u) / 64u + 1u, 0, (page_words - (last - 1u) / 64u - 1u) * sizeof(uint64_t));
+    }
+
+    /**
+     * Gets a page the bitset can modify, a missing page is allocated and a shared page is copied first
+     * A page only referenced by this bitset stays exclusive: new references only come from snapshots of its holders
+     * @param page Index of the page (page index)
+     * @param preserve Whether the bits of a new page have to match the old ones (false when the caller overwrites the whole page)
+     * @return Reference to the page
+     */
+    page_type& writable_page(const uint64_t page, const bool preserve)
+    {
+        std::shared_ptr<page_type>& current = pages[page];
+        if (current && current.use_count() == 1)
+        {
+            // pairs with the release of the last other reference, its reads happen before the writes to the page
+            std::atomic_thread_fence(std::memory_order_acquire);
+            return *current;
+        }
+
+        std::shared_ptr<page_type> copy(new page_type);
+        if (preserve && current)
+            std::memcpy(copy->words, current->words, sizeof(copy->words));
+        else if (preserve)
+            std::memset(copy->words, 0, sizeof(copy->words));
+        current = std::move(copy);
+        return *current;
+    }
+};
+
+/**
+ * A rows x columns bit matrix stored in a CDynamicBitSet, see BitMatrix (same row layout as the C matrix)
+ * Every row starts on a BITSET_MATRIX_ROW_ALIGNMENT byte boundary and is a whole number of 64-bit words, the padding past the columns is kept cleared
+ * A column becomes a row of the transposed matrix (transpose), so a column query is one contiguous read
+ */
+class CBitMatrix
+{
+public:
+    using bitset_type = CDynamicBitSet<uint64_t>;
+
+    /**
+     * The rows (rows * row_stride words, cache line aligned)
+     */
+    bitset_type bits;
+    /**
+     * Number of rows
+     */
+    uint64_t rows;
+    /**
+     * Number of columns (bits per row)
+     */
+    uint64_t columns;
+    /**
+     * Distance between the starts of two rows (word size)
+     */
+    uint64_t row_stride;
+
+    /**
+     * Size constructor, all of the bits are cleared
+     * @param rows Number of rows
+     * @param columns Number of columns (bits per row)
+     */
+    CBitMatrix(const uint64_t rows, const uint64_t columns)
+        : bits(rows * row_words(columns) * 64u), rows(rows), columns(columns), row_stride(row_words(columns)) {}
+
+    /**
+     * Rows constructor, copies the bitsets into the rows of the matrix
+     * @param source The bitsets to copy, the first one sets the number of columns and the others have to hold at least as many bits
+     */
+    template <typename T, typename Allocator>
+    explicit CBitMatrix(const std::vector<CDynamicBitSet<T, Allocator>>& source) : CBitMatrix(source.size(), source.empty() ? 0u : source.front().size)
+    {
+        const uint64_t words = bitset_calculate_word_count(columns);
+        for (uint64_t i = 0; i < rows; ++i)
+        {
+            uint64_t* const row = row_data(i);
+            for (uint64_t j = 0; j < words; ++j)
+                row[j] = source[i].get_word(j);
+            if (columns % 64u)
+                row[words - 1u] &= UINT64_MAX >> (64u - columns % 64u);
+        }
+        BITSET_STATS_RECORD(BITSET_STATS_FILL, rows * columns, rows * row_stride * sizeof(uint64_t));
+    }
+
+    /**
+     * Retrieves the value of a bit of the matrix
+     * @param row Index of the row
+     * @param column Index of the column
+     * @return The value of the bit
+     */
+    bool get(const uint64_t row, const uint64_t column) const noexcept
+    {
+        return row_data(row)[column / 64u] >> column % 64u & 1u;
+    }
+
+    /**
+     * Sets the value of a bit of the matrix
+     * @param value The value to set the bit to
+     * @param row Index of the row
+     * @param column Index of the column
+     */
+    void set(const bool value, const uint64_t row, const uint64_t column) noexcept
+    {
+        if (value)
+            row_data(row)[column / 64u] |= 1ull << column % 64u;
+        else
+            row_data(row)[column / 64u] &= ~(1ull << column % 64u);
+    }
+
+    /**
+     * Creates a non-owning view of a row, the bits past the columns are never modified through it
+     * @param row Index of the row
+     * @return The view (chunk aligned, so its bulk operations run the vectorized kernels)
+     */
+    CBitSetView<uint64_t, CAlignedAllocator<uint64_t>> row(const uint64_t row) noexcept
+    {
+        return bits.view(row * row_stride * 64u, columns);
+    }
+
+    /**
+     * Computes the transpose tile by tile (64 rows x 64 columns, see bitset_transpose64)
+     * @return The transposed matrix, its row c holds column c of this matrix
+     */
+    CBitMatrix transpose() const
+    {
+        CBitMatrix result(columns, rows);
+        BITSET_STATS_RECORD(BITSET_STATS_ACCESS, rows * columns, 2u * bits.storage_size * sizeof(uint64_t));
+        BITSET_TRACE_SCOPE("matrix_transpose", bits.storage_size * sizeof(uint64_t));
+        uint64_t tile[64];
+        for (uint64_t row = 0; row < rows; row += 64u)
+        {
+            const uint64_t tile_rows = rows - row < 64u ? rows - row : 64u;
+            for (uint64_t column = 0; column < columns; column += 64u)
+            {
+                const uint64_t tile_columns = columns - column < 64u ? columns - column : 64u;
+                for (uint64_t i = 0; i < tile_rows; ++i)
+                    tile[i] = row_data(row + i)[column / 64u];
+                for (uint64_t i = tile_rows; i < 64u; ++i)
+                    tile[i] = 0;
+                bitset_transpose64(tile);
+                for (uint64_t i = 0; i < tile_columns; ++i)
+                    result.row_data(column + i)[row / 64u] = tile[i];
+            }
+        }
+        return result;
+    }
+
+    /**
+     * Copies a column of the matrix (gathers one bit per row, transpose the matrix to read many columns)
+     * @param column Index of the column
+     * @return The column (rows bits)
+     */
+    bitset_type column(const uint64_t column) const
+    {
+        bitset_type result(rows);
+        BITSET_STATS_RECORD(BITSET_STATS_ACCESS, rows, rows * sizeof(uint64_t));
+        const uint64_t* word = bits.data + column / 64u;
+        for (uint64_t row = 0; row < rows; ++row, word += row_stride)
+            result.data[row / 64u] |= (*word >> column % 64u & 1u) << row % 64u;
+        return result;
+    }
+
+    /**
+     * Computes row = row op other for every row of the matrix
+     * @param other The right operand (at least columns bits)
+     * @param operation The operation to apply
+     */
+    void rows_operation(const bitset_type& other, const bitset_operation operation) noexcept
+    {
+        const uint64_t full_words = columns / 64u;
+        for (uint64_t i = 0; i < rows; ++i)
+        {
+            uint64_t* const row = row_data(i);
+            bitset_binary_bytes(reinterpret_cast<uint8_t*>(row), reinterpret_cast<const uint8_t*>(row), reinterpret_cast<const uint8_t*>(other.data), full_words * sizeof(uint64_t), operation);
+            if (columns % 64u)
+                row[full_words] = bitset_apply_operation64(row[full_words], other.data[full_words], operation) & (UINT64_MAX >> (64u - columns % 64u));
+        }
+    }
+
+    /**
+     * Folds the specified rows with the operation, rows[0] op rows[1] op ... op rows[count - 1]
+     * @param indices Indices of the rows to fold
+     * @param count Number of rows (at least 1)
+     * @param operation The operation to apply
+     * @return The result (columns bits)
+     */
+    bitset_type reduce_rows(const uint64_t* const indices, const uint64_t count, const bitset_operation operation) const
+    {
+        bitset_type result(columns);
+        const uint64_t words = bitset_calculate_word_count(columns);
+        if (!count || !words)
+            return result;
+        // the padding of the rows is cleared, so whole words give the right result
+        std::memcpy(result.data, row_data(indices[0]), words * sizeof(uint64_t));
+        for (uint64_t i = 1; i < count; ++i)
+            bitset_binary_bytes(reinterpret_cast<uint8_t*>(result.data), reinterpret_cast<const uint8_t*>(result.data), reinterpret_cast<const uint8_t*>(row_data(indices[i])), words * sizeof(uint64_t), operation);
+        return result;
+    }
+
+    /**
+     * @return The number of set bits of every row (rows values)
+     */
+    std::vector<uint64_t> count_rows() const
+    {
+        std::vector<uint64_t> counts(rows);
+        const uint64_t words = bitset_calculate_word_count(columns);
+        for (uint64_t i = 0; i < rows; ++i)
+            counts[i] = bitset_popcount_bytes(reinterpret_cast<const uint8_t*>(row_data(i)), words * sizeof(uint64_t));
+        return counts;
+    }
+
+    /**
+     * Counts the set bits of row op other for every row, without storing the results (e.g. the overlap of every row with a query)
+     * @param other The right operand (at least columns bits)
+     * @param operation The operation to apply
+     * @return The count of every row (rows values)
+     */
+    std::vector<uint64_t> binary_count_rows(const bitset_type& other, const bitset_operation operation) const
+    {
+        std::vector<uint64_t> counts(rows);
+        const uint64_t full_words = columns / 64u;
+        for (uint64_t i = 0; i < rows; ++i)
+        {
+            const uint64_t* const row = row_data(i);
+            counts[i] = bitset_binary_count_bytes(reinterpret_cast<const uint8_t*>(row), reinterpret_cast<const uint8_t*>(other.data), full_words * sizeof(uint64_t), operation);
+            if (columns % 64u)
+                counts[i] += bitset_popcount64(bitset_apply_operation64(row[full_words], other.data[full_words], operation) & (UINT64_MAX >> (64u - columns % 64u)));
+        }
+        return counts;
+    }
+
+private:
+    /**
+     * @param columns Number of columns (bits per row)
+     * @return The row stride (word size), the row rounded up to BITSET_MATRIX_ROW_ALIGNMENT bytes
+     */
+    static constexpr uint64_t row_words(const uint64_t columns) noexcept
+    {
+        return ((columns + 7u) / 8u + BITSET_MATRIX_ROW_ALIGNMENT - 1u) / BITSET_MATRIX_ROW_ALIGNMENT * BITSET_MATRIX_ROW_ALIGNMENT / sizeof(uint64_t);
+    }
+
+    uint64_t* row_data(const uint64_t row) noexcept
+    {
+        return bits.data + row * row_stride;
+    }
+
+    const uint64_t* row_data(const uint64_t row) const noexcept
+    {
+        return bits.data + row * row_stride;
+    }
+};
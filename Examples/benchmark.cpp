@@ -0,0 +1,529 @@
+// Portable micro benchmark of the C and C++ APIs against std::bitset, std::vector<bool> and boost::dynamic_bitset
+// build: g++ -std=c++17 -O2 -march=native -I../C -I../Cpp benchmark.cpp -o benchmark (add -fopenmp for the parallel paths)
+// usage: benchmark [--json] [--filter=substring] [--min-time=seconds] [--repetitions=count] [--max-bits=bits]
+
+// for std::bitset
+#include <bitset>
+
+// for timing functions
+#include <chrono>
+
+// for shorter type names
+#include <cstdint>
+
+// for std::strncmp, std::strtod
+#include <cstring>
+#include <cstdlib>
+
+// for C++ I/O
+#include <iostream>
+
+// for std::unique_ptr
+#include <memory>
+
+// for std::string
+#include <string>
+
+// for std::index_sequence
+#include <utility>
+
+// for std::vector
+#include <vector>
+
+// for std::fill, std::count, std::find
+#include <algorithm>
+
+// boost is optional, the comparison is skipped when it is not installed
+#if defined(__has_include)
+#if __has_include(<boost/dynamic_bitset.hpp>)
+#include <boost/dynamic_bitset.hpp>
+#define BENCHMARK_BOOST
+#endif
+#endif
+
+// adjust as needed
+#include "BitSet.h"
+#include "BitSet.hpp"
+
+// Sizes in bits, chosen to fit in L1 (16 KiB), L2 (256 KiB), L3 (8 MiB) and to spill into DRAM (256 MiB)
+// std::bitset needs them at compile time, so they are a template parameter pack
+using benchmark_sizes = std::index_sequence<(1ull << 17), (1ull << 21), (1ull << 26), (1ull << 31)>;
+
+// Number of random indices used by the get/set benchmarks (per iteration)
+constexpr uint64_t random_accesses = 4096;
+
+// Density of the bitsets used by the iteration benchmark (1 in iterate_density bits is set)
+constexpr uint64_t iterate_density = 64;
+
+struct benchmark_options
+{
+    bool json = false;
+    std::string filter;
+    double min_time = 0.1;
+    uint64_t repetitions = 3;
+    uint64_t max_bits = UINT64_MAX;
+};
+
+static benchmark_options options;
+
+/**
+ * Keeps the compiler from removing a computation whose result is otherwise unused
+ * @param value The result to keep
+ */
+template <typename T>
+inline void do_not_optimize(const T& value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile T sink;
+    sink = value;
+#endif
+}
+
+/**
+ * xorshift64, deterministic so every implementation sees the same indices
+ */
+struct benchmark_random
+{
+    uint64_t state = 88172645463325252ull;
+
+    uint64_t operator()() noexcept
+    {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    }
+};
+
+/**
+ * Generates random bit indices in [0, size)
+ * @param size The size of the bitset (bit size)
+ * @return random_accesses indices
+ */
+static std::vector<uint64_t> random_indices(const uint64_t size)
+{
+    benchmark_random random;
+    std::vector<uint64_t> indices(random_accesses);
+    for (uint64_t& index : indices)
+        index = random() % size;
+    return indices;
+}
+
+/**
+ * Prints one result as a CSV row or a JSON line
+ * @param name Name of the benchmark
+ * @param implementation Name of the implementation
+ * @param block_bits Width of a block of the implementation (0 if unknown)
+ * @param size Size of the bitset (bit size)
+ * @param elements Number of elements (bits or accesses) processed per iteration
+ * @param iterations Number of timed iterations of the fastest repetition
+ * @param seconds Time per iteration of the fastest repetition
+ */
+static void report(const char* name, const char* implementation, const uint64_t block_bits, const uint64_t size, const uint64_t elements, const uint64_t iterations, const double seconds)
+{
+    const double ns_per_iteration = seconds * 1e9;
+    const double ns_per_element = ns_per_iteration / static_cast<double>(elements ? elements : 1);
+    if (options.json)
+        std::cout << "{\"benchmark\":\"" << name << "\",\"implementation\":\"" << implementation << "\",\"block_bits\":" << block_bits
+            << ",\"size_bits\":" << size << ",\"elements\":" << elements << ",\"iterations\":" << iterations
+            << ",\"ns_per_iteration\":" << ns_per_iteration << ",\"ns_per_element\":" << ns_per_element << "}\n";
+    else
+        std::cout << name << ',' << implementation << ',' << block_bits << ',' << size << ',' << elements << ','
+            << iterations << ',' << ns_per_iteration << ',' << ns_per_element << '\n';
+    std::cout.flush();
+}
+
+/**
+ * Times a function, it runs once untimed and then until it took min_time, the fastest of the repetitions is reported
+ * @param name Name of the benchmark
+ * @param implementation Name of the implementation
+ * @param block_bits Width of a block of the implementation (0 if unknown)
+ * @param size Size of the bitset (bit size)
+ * @param elements Number of elements (bits or accesses) processed per call
+ * @param function The function to time
+ */
+template <typename F>
+static void run(const char* name, const char* implementation, const uint64_t block_bits, const uint64_t size, const uint64_t elements, F&& function)
+{
+    if (!options.filter.empty() && (std::string(name) + '/' + implementation).find(options.filter) == std::string::npos)
+        return;
+
+    using clock = std::chrono::steady_clock;
+    function();
+
+    double best = 0;
+    uint64_t best_iterations = 0;
+    for (uint64_t repetition = 0; repetition < options.repetitions; ++repetition)
+    {
+        uint64_t iterations = 0;
+        const clock::time_point start = clock::now();
+        double elapsed;
+        do
+        {
+            function();
+            ++iterations;
+            elapsed = std::chrono::duration<double>(clock::now() - start).count();
+        } while (elapsed < options.min_time);
+
+        const double per_iteration = elapsed / static_cast<double>(iterations);
+        if (!repetition || per_iteration < best)
+        {
+            best = per_iteration;
+            best_iterations = iterations;
+        }
+    }
+    report(name, implementation, block_bits, size, elements, best_iterations, best);
+}
+
+/**
+ * Adapter of DynamicBitSet (C API), the block width is fixed per build by BITSET_BLOCK_TYPE
+ */
+struct c_adapter
+{
+    static constexpr const char* name = "c_dynamic_bitset";
+    static constexpr uint64_t block_bits = BITSET_BLOCK_BITS;
+    static constexpr bool growable = true;
+
+    DynamicBitSet bitset;
+
+    explicit c_adapter(const uint64_t size) { bitset_dynamic_init(&bitset, size); }
+    c_adapter(const c_adapter&) = delete;
+    c_adapter& operator=(const c_adapter&) = delete;
+    ~c_adapter() { bitset_dynamic_destroy(&bitset); }
+
+    bool get(const uint64_t index) const noexcept { return bitset_get(UNIVERSAL_BITSET(&bitset), index); }
+    void set(const bool value, const uint64_t index) noexcept { bitset_set_value(UNIVERSAL_BITSET(&bitset), value, index); }
+    void fill_in_range(const bool value, const uint64_t begin, const uint64_t end) noexcept { bitset_fill_in_range_begin_end(UNIVERSAL_BITSET(&bitset), value, begin, end); }
+    void clear_in_range(const uint64_t begin, const uint64_t end, const uint64_t step) noexcept { bitset_clear_in_range_begin_end_step(UNIVERSAL_BITSET(&bitset), begin, end, step); }
+    uint64_t count() const noexcept { return bitset_count(UNIVERSAL_BITSET(&bitset)); }
+    bool any() const noexcept { return bitset_any(UNIVERSAL_BITSET(&bitset)); }
+    bool all() const noexcept { return bitset_all(UNIVERSAL_BITSET(&bitset)); }
+    void and_with(const c_adapter& other) noexcept { bitset_and(UNIVERSAL_BITSET(&bitset), UNIVERSAL_BITSET(&other.bitset)); }
+    void or_with(const c_adapter& other) noexcept { bitset_or(UNIVERSAL_BITSET(&bitset), UNIVERSAL_BITSET(&other.bitset)); }
+    void xor_with(const c_adapter& other) noexcept { bitset_xor(UNIVERSAL_BITSET(&bitset), UNIVERSAL_BITSET(&other.bitset)); }
+    void push_back(const bool value) { bitset_dynamic_push_back(&bitset, value); }
+
+    template <typename F>
+    void for_each_set_bit(F& function) const
+    {
+        bitset_for_each_set_bit(UNIVERSAL_BITSET(&bitset), [](const uint64_t index, void* const context) { (*static_cast<F*>(context))(index); }, &function);
+    }
+};
+
+/**
+ * Adapter of CDynamicBitSet (C++ API) with the specified chunk type
+ */
+template <typename T>
+struct cpp_adapter
+{
+    static constexpr const char* name = sizeof(T) == 1 ? "cpp_dynamic_bitset_u8" : sizeof(T) == 8 ? "cpp_dynamic_bitset_u64" : "cpp_dynamic_bitset";
+    static constexpr uint64_t block_bits = sizeof(T) * 8;
+    static constexpr bool growable = true;
+
+    CDynamicBitSet<T> bitset;
+
+    explicit cpp_adapter(const uint64_t size) : bitset(size) {}
+
+    bool get(const uint64_t index) const noexcept { return bitset.get(index); }
+    void set(const bool value, const uint64_t index) noexcept { bitset.set(value, index); }
+    void fill_in_range(const bool value, const uint64_t begin, const uint64_t end) noexcept { bitset.fill_in_range(value, begin, end); }
+    void clear_in_range(const uint64_t begin, const uint64_t end, const uint64_t step) noexcept { bitset.clear_in_range(begin, end, step); }
+    uint64_t count() const noexcept { return bitset.count(); }
+    bool any() const noexcept { return bitset.any(); }
+    bool all() const noexcept { return bitset.all(); }
+    void and_with(const cpp_adapter& other) noexcept { bitset &= other.bitset; }
+    void or_with(const cpp_adapter& other) noexcept { bitset |= other.bitset; }
+    void xor_with(const cpp_adapter& other) noexcept { bitset ^= other.bitset; }
+    void push_back(const bool value) { bitset.push_back(value); }
+
+    template <typename F>
+    void for_each_set_bit(F& function) const { bitset.for_each_set_bit(function); }
+};
+
+/**
+ * Adapter of std::bitset, kept on the heap since the large sizes do not fit on the stack
+ * Operations returning a new std::bitset (operator~, operator<<, ...) are avoided for the same reason
+ */
+template <std::size_t N>
+struct std_bitset_adapter
+{
+    static constexpr const char* name = "std_bitset";
+    static constexpr uint64_t block_bits = 0;
+    static constexpr bool growable = false;
+
+    std::unique_ptr<std::bitset<N>> bitset;
+
+    explicit std_bitset_adapter(const uint64_t) : bitset(std::make_unique<std::bitset<N>>()) {}
+
+    bool get(const uint64_t index) const noexcept { return (*bitset)[index]; }
+    void set(const bool value, const uint64_t index) noexcept { (*bitset)[index] = value; }
+    void fill_in_range(const bool value, const uint64_t begin, const uint64_t end) noexcept
+    {
+        for (uint64_t i = begin; i < end; ++i)
+            (*bitset)[i] = value;
+    }
+    void clear_in_range(const uint64_t begin, const uint64_t end, const uint64_t step) noexcept
+    {
+        for (uint64_t i = begin; i < end; i += step)
+            (*bitset)[i] = false;
+    }
+    uint64_t count() const noexcept { return bitset->count(); }
+    bool any() const noexcept { return bitset->any(); }
+    bool all() const noexcept { return bitset->all(); }
+    void and_with(const std_bitset_adapter& other) noexcept { *bitset &= *other.bitset; }
+    void or_with(const std_bitset_adapter& other) noexcept { *bitset |= *other.bitset; }
+    void xor_with(const std_bitset_adapter& other) noexcept { *bitset ^= *other.bitset; }
+    void push_back(bool) {}
+
+    template <typename F>
+    void for_each_set_bit(F& function) const
+    {
+#if defined(__GLIBCXX__)
+        // libstdc++ extension, scans whole words
+        for (std::size_t i = bitset->_Find_first(); i < N; i = bitset->_Find_next(i))
+            function(i);
+#else
+        for (std::size_t i = 0; i < N; ++i)
+            if ((*bitset)[i])
+                function(i);
+#endif
+    }
+};
+
+/**
+ * Adapter of std::vector<bool>, the standard library may specialize the algorithms for its bit iterators
+ */
+struct vector_bool_adapter
+{
+    static constexpr const char* name = "std_vector_bool";
+    static constexpr uint64_t block_bits = 0;
+    static constexpr bool growable = true;
+
+    std::vector<bool> bitset;
+
+    explicit vector_bool_adapter(const uint64_t size) : bitset(size) {}
+
+    bool get(const uint64_t index) const noexcept { return bitset[index]; }
+    void set(const bool value, const uint64_t index) noexcept { bitset[index] = value; }
+    void fill_in_range(const bool value, const uint64_t begin, const uint64_t end) noexcept { std::fill(bitset.begin() + begin, bitset.begin() + end, value); }
+    void clear_in_range(const uint64_t begin, const uint64_t end, const uint64_t step) noexcept
+    {
+        for (uint64_t i = begin; i < end; i += step)
+            bitset[i] = false;
+    }
+    uint64_t count() const noexcept { return std::count(bitset.begin(), bitset.end(), true); }
+    bool any() const noexcept { return std::find(bitset.begin(), bitset.end(), true) != bitset.end(); }
+    bool all() const noexcept { return std::find(bitset.begin(), bitset.end(), false) == bitset.end(); }
+    void and_with(const vector_bool_adapter& other) noexcept
+    {
+        for (std::size_t i = 0; i < bitset.size(); ++i)
+            bitset[i] = bitset[i] && other.bitset[i];
+    }
+    void or_with(const vector_bool_adapter& other) noexcept
+    {
+        for (std::size_t i = 0; i < bitset.size(); ++i)
+            bitset[i] = bitset[i] || other.bitset[i];
+    }
+    void xor_with(const vector_bool_adapter& other) noexcept
+    {
+        for (std::size_t i = 0; i < bitset.size(); ++i)
+            bitset[i] = bitset[i] != other.bitset[i];
+    }
+    void push_back(const bool value) { bitset.push_back(value); }
+
+    template <typename F>
+    void for_each_set_bit(F& function) const
+    {
+        for (std::size_t i = 0; i < bitset.size(); ++i)
+            if (bitset[i])
+                function(i);
+    }
+};
+
+#ifdef BENCHMARK_BOOST
+/**
+ * Adapter of boost::dynamic_bitset with 64-bit blocks
+ */
+struct boost_adapter
+{
+    static constexpr const char* name = "boost_dynamic_bitset";
+    static constexpr uint64_t block_bits = 64;
+    static constexpr bool growable = true;
+
+    boost::dynamic_bitset<uint64_t> bitset;
+
+    explicit boost_adapter(const uint64_t size) : bitset(size) {}
+
+    bool get(const uint64_t index) const noexcept { return bitset.test(index); }
+    void set(const bool value, const uint64_t index) noexcept { bitset.set(index, value); }
+    void fill_in_range(const bool value, const uint64_t begin, const uint64_t end) noexcept { bitset.set(begin, end - begin, value); }
+    void clear_in_range(const uint64_t begin, const uint64_t end, const uint64_t step) noexcept
+    {
+        for (uint64_t i = begin; i < end; i += step)
+            bitset.reset(i);
+    }
+    uint64_t count() const noexcept { return bitset.count(); }
+    bool any() const noexcept { return bitset.any(); }
+    bool all() const noexcept { return bitset.all(); }
+    void and_with(const boost_adapter& other) noexcept { bitset &= other.bitset; }
+    void or_with(const boost_adapter& other) noexcept { bitset |= other.bitset; }
+    void xor_with(const boost_adapter& other) noexcept { bitset ^= other.bitset; }
+    void push_back(const bool value) { bitset.push_back(value); }
+
+    template <typename F>
+    void for_each_set_bit(F& function) const
+    {
+        for (std::size_t i = bitset.find_first(); i != bitset.npos; i = bitset.find_next(i))
+            function(i);
+    }
+};
+#endif
+
+/**
+ * Runs every benchmark on one implementation and size
+ * @param size The size of the bitsets (bit size)
+ */
+template <typename A>
+static void run_suite(const uint64_t size)
+{
+    if (size > options.max_bits)
+        return;
+
+    const char* name = A::name;
+    const uint64_t block_bits = A::block_bits;
+    const std::vector<uint64_t> indices = random_indices(size);
+
+    {
+        A bitset(size);
+        for (uint64_t i = 0; i < size; i += 3)
+            bitset.set(true, i);
+
+        run("get_random", name, block_bits, size, random_accesses, [&]
+        {
+            uint64_t sum = 0;
+            for (const uint64_t index : indices)
+                sum += bitset.get(index);
+            do_not_optimize(sum);
+        });
+
+        bool value = false;
+        run("set_random", name, block_bits, size, random_accesses, [&]
+        {
+            value = !value;
+            for (const uint64_t index : indices)
+                bitset.set(value, index);
+            do_not_optimize(bitset);
+        });
+
+        // unaligned ends, so the partial blocks are included
+        run("fill_range", name, block_bits, size, size - 2, [&]
+        {
+            value = !value;
+            bitset.fill_in_range(value, 1, size - 1);
+            do_not_optimize(bitset);
+        });
+
+        // stride of the sieve of eratosthenes for 3 (the worst case for the stepped fills)
+        run("clear_step_3", name, block_bits, size, size / 3, [&]
+        {
+            bitset.fill_in_range(true, 0, size);
+            bitset.clear_in_range(0, size, 3);
+            do_not_optimize(bitset);
+        });
+
+        run("count", name, block_bits, size, size, [&] { do_not_optimize(bitset.count()); });
+
+        // the last bit only, so both have to scan the whole bitset
+        bitset.fill_in_range(false, 0, size);
+        bitset.set(true, size - 1);
+        run("any_scan", name, block_bits, size, size, [&] { do_not_optimize(bitset.any()); });
+        bitset.fill_in_range(true, 0, size);
+        bitset.set(false, size - 1);
+        run("all_scan", name, block_bits, size, size, [&] { do_not_optimize(bitset.all()); });
+    }
+
+    {
+        A left(size), right(size);
+        for (const uint64_t index : indices)
+        {
+            left.set(true, index);
+            right.set(true, (index ^ 1u) % size);
+        }
+        run("and", name, block_bits, size, size, [&] { left.and_with(right); do_not_optimize(left); });
+        run("or", name, block_bits, size, size, [&] { left.or_with(right); do_not_optimize(left); });
+        run("xor", name, block_bits, size, size, [&] { left.xor_with(right); do_not_optimize(left); });
+    }
+
+    {
+        A bitset(size);
+        benchmark_random random;
+        for (uint64_t i = 0; i < size / iterate_density; ++i)
+            bitset.set(true, random() % size);
+        run("iterate", name, block_bits, size, size, [&]
+        {
+            uint64_t sum = 0;
+            auto function = [&sum](const uint64_t index) { sum += index; };
+            bitset.for_each_set_bit(function);
+            do_not_optimize(sum);
+        });
+    }
+
+    if constexpr (A::growable)
+    {
+        // capped, appending 2^31 bits one by one takes seconds per iteration
+        const uint64_t bits = size < (1ull << 26) ? size : (1ull << 26);
+        run("push_back", name, block_bits, bits, bits, [&]
+        {
+            A bitset(0);
+            for (uint64_t i = 0; i < bits; ++i)
+                bitset.push_back(i & 1u);
+            do_not_optimize(bitset);
+        });
+    }
+}
+
+template <std::size_t... Sizes>
+static void run_all(std::index_sequence<Sizes...>)
+{
+    (run_suite<c_adapter>(Sizes), ...);
+    (run_suite<cpp_adapter<uint8_t>>(Sizes), ...);
+    (run_suite<cpp_adapter<uint64_t>>(Sizes), ...);
+    (run_suite<std_bitset_adapter<Sizes>>(Sizes), ...);
+    (run_suite<vector_bool_adapter>(Sizes), ...);
+#ifdef BENCHMARK_BOOST
+    (run_suite<boost_adapter>(Sizes), ...);
+#endif
+}
+
+int main(const int argc, char** argv)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const char* argument = argv[i];
+        if (!std::strcmp(argument, "--json"))
+            options.json = true;
+        else if (!std::strncmp(argument, "--filter=", 9))
+            options.filter = argument + 9;
+        else if (!std::strncmp(argument, "--min-time=", 11))
+            options.min_time = std::strtod(argument + 11, nullptr);
+        else if (!std::strncmp(argument, "--repetitions=", 14))
+            options.repetitions = std::strtoull(argument + 14, nullptr, 10);
+        else if (!std::strncmp(argument, "--max-bits=", 11))
+            options.max_bits = std::strtoull(argument + 11, nullptr, 10);
+        else
+        {
+            std::cerr << "usage: " << argv[0] << " [--json] [--filter=substring] [--min-time=seconds] [--repetitions=count] [--max-bits=bits]\n";
+            return 1;
+        }
+    }
+    if (!options.repetitions)
+        options.repetitions = 1;
+
+    if (!options.json)
+        std::cout << "benchmark,implementation,block_bits,size_bits,elements,iterations,ns_per_iteration,ns_per_element\n";
+
+    run_all(benchmark_sizes{});
+    return 0;
+}
@@ -0,0 +1,451 @@
+// for std::memset
+#include <cstring>
+
+// for std::log
+#include <cmath>
+
+// for shorter type names
+#include <cstdint>
+
+// for C++ I/O
+#include <iostream>
+#include <iomanip>
+
+// for std::pair
+#include <utility>
+
+// for std::tie
+#include <tuple>
+
+// for std::vector
+#include <vector>
+
+// for timing functions
+#include <chrono>
+
+// for std::strtoull
+#include <cstdlib>
+
+// for the ANSI escape codes and the process priority on Windows consoles
+#ifdef _WIN32
+#include <Windows.h>
+#endif
+
+// adjust as needed
+#include "BitSet.h"
+#include "BitSet.hpp"
+
+template <typename T>
+inline std::enable_if_t<std::is_integral_v<T>, std::pair<T*, std::size_t>> primes_sieve_of_eratosthenes_bitset_c(const T& up_limit, const bool& use_prime_num_approx, const uint64_t& mem_to_alloc)
+{
+    // If limit is less than 2, return empty array
+    if (up_limit < 2)
+        return {nullptr, 0};
+
+    // Initialize variables
+    // use BitSet class to save memory (and time) for large limits (up to 8 times less memory usage and 8 times faster access)
+
+    DynamicBitSet primes_b;
+    bitset_dynamic_init(&primes_b, up_limit + 1);
+
+    T primes_size = (mem_to_alloc) ? mem_to_alloc : ((use_prime_num_approx) ? static_cast<T>(up_limit / std::log(up_limit)) : up_limit);
+    T* primes = new T[primes_size];
+    *primes = 2;
+    T index = 1;
+
+    // setting the first two elements to 'false' (not prime) and the third element to 'true' (prime).
+
+    // All other even numbers are not primes (optimization), using pointer arithmetic to set bits
+    // (pattern is truncated to the block type selected with BITSET_BLOCK_TYPE)
+    bitset_fill_block_in_range_begin_end(UNIVERSAL_BITSET(&primes_b), (bitset_block_t)0xAAAAAAAAAAAAAAAAull, 1, primes_b.storage_size);
+    bitset_set_block(UNIVERSAL_BITSET(&primes_b), (bitset_block_t)0xAAAAAAAAAAAAAAACull, 0);
+    //std::fill(bits + 1, bits + up_limit / 64 + 1, 0b1010101010101010101010101010101010101010101010101010101010101010);
+    
+    // Main sieve loop
+    T i = 3;
+    for (; i * i <= up_limit; i += 2)
+    {
+        if (bitset_get(UNIVERSAL_BITSET(&primes_b), i))
+        {
+            *(primes + index++) = i;
+            /*for (T j = i * i; j <= up_limit; j += i)
+                primes_b.set(false, j);*/
+            bitset_clear_in_range_begin_end_step(UNIVERSAL_BITSET(&primes_b), i * i, up_limit, i);
+        }
+    }
+
+    // Copy the remaining primes (even bits are never set, so only the set bits from i onwards are visited)
+    for (uint64_t prime = bitset_find_next(UNIVERSAL_BITSET(&primes_b), i - 1); prime != BITSET_NPOS; prime = bitset_find_next(UNIVERSAL_BITSET(&primes_b), prime))
+        *(primes + index++) = static_cast<T>(prime);
+
+    bitset_dynamic_destroy(&primes_b);
+
+    // Return primes and their count
+    return { primes, primes_size };
+}
+
+template <typename T>
+inline std::enable_if_t<std::is_integral_v<T>, std::pair<T*, std::size_t>> primes_sieve_of_eratosthenes_bitset_cpp(const T& up_limit, const bool& use_prime_num_approx, const uint64_t& mem_to_alloc)
+{
+    // If limit is less than 2, return empty array
+    if (up_limit < 2)
+        return {nullptr, 0};
+
+    // Initialize variables
+    // use BitSet class to save memory (and time) for large limits (up to 8 times less memory usage and 8 times faster access)
+
+    CDynamicBitSet<uint8_t> primes_b(up_limit + 1);
+
+    T primes_size = (mem_to_alloc) ? mem_to_alloc : ((use_prime_num_approx) ? static_cast<T>(up_limit / std::log(up_limit)) : up_limit);
+    T* primes = new T[primes_size];
+    *primes = 2;
+    T index = 1;
+
+    // setting the first two elements to 'false' (not prime) and the third element to 'true' (prime).
+
+    // All other even numbers are not primes (optimization), using pointer arithmetic to set bits
+    primes_b.fill_chunk_in_range(0b10101010, 1, primes_b.storage_size);
+    primes_b.set_chunk(0b10101100, 0);
+    //std::fill(bits + 1, bits + up_limit / 64 + 1, 0b1010101010101010101010101010101010101010101010101010101010101010);
+    
+    // Main sieve loop
+    T i = 3;
+    for (; i * i <= up_limit; i += 2)
+    {
+        if (primes_b.get(i))
+        {
+            *(primes + index++) = i;
+            /*for (T j = i * i; j <= up_limit; j += i)
+                primes_b.set(false, j);*/
+            primes_b.clear_in_range(i * i, up_limit, i);
+        }
+    }
+
+    // Copy the remaining primes (even bits are never set, so only the set bits from i onwards are visited)
+    for (uint64_t prime = primes_b.find_next(i - 1); prime != primes_b.npos; prime = primes_b.find_next(prime))
+        *(primes + index++) = static_cast<T>(prime);
+
+    // Return primes and their count
+    return { primes, primes_size };
+}
+
+/*
+ * Segmented sieve of Eratosthenes, reports the primes in increasing order through a callback.
+ *
+ * Only odd numbers are stored (bit j of a segment is the number low + 2 * j) and the sieve runs over one
+ * reusable segment sized to stay in cache, so the memory usage is bounded by the segment and the base primes
+ * up to sqrt(up_limit), also for limits in the 10^11 range. Every base prime keeps the offset of its next odd
+ * multiple, so it resumes in the next segment without recomputing the starting point.
+ *
+ * Arguments:
+ *  - up_limit: The upper limit for the primes (inclusive).
+ *  - callback: Called with every prime found (prime, context).
+ *  - context: Pointer passed to the callback.
+ *  - segment_bits: (Optional) Size of the segment in bits, by default 256 KiB (L2 sized).
+ *
+ * Returns:
+ *  - The number of primes found.
+ */
+
+struct primes_segment_context
+{
+    bitset_index_callback callback;
+    void* context;
+    uint64_t low;
+};
+
+inline void primes_segment_report(const uint64_t index, void* const context)
+{
+    const primes_segment_context* const segment = static_cast<const primes_segment_context*>(context);
+    segment->callback(segment->low + 2u * index, segment->context);
+}
+
+inline uint64_t primes_segmented_sieve_bitset_c(const uint64_t up_limit, const bitset_index_callback callback, void* const context, const uint64_t segment_bits = 256 * 1024 * 8)
+{
+    // If limit is less than 2, there are no primes
+    if (up_limit < 2)
+        return 0;
+
+    callback(2, context);
+    uint64_t count = 1;
+
+    // Odd base primes up to sqrt(up_limit), sieved with the plain odd-only mapping (bit j is 2 * j + 1)
+    uint64_t root = static_cast<uint64_t>(std::sqrt(static_cast<double>(up_limit)));
+    while (root * root > up_limit)
+        --root;
+    while ((root + 1) * (root + 1) <= up_limit)
+        ++root;
+
+    DynamicBitSet base_b;
+    bitset_dynamic_init(&base_b, root / 2 + 1);
+    bitset_set_all(UNIVERSAL_BITSET(&base_b));
+    bitset_clear(UNIVERSAL_BITSET(&base_b), 0);
+
+    // base primes and the index of their next odd multiple (relative to the whole odd-only sieve)
+    uint64_t* base_primes = new uint64_t[root / 2 + 1];
+    uint64_t* next_multiple = new uint64_t[root / 2 + 1];
+    uint64_t base_count = 0;
+    for (uint64_t j = bitset_find_first(UNIVERSAL_BITSET(&base_b)); j != BITSET_NPOS; j = bitset_find_next(UNIVERSAL_BITSET(&base_b), j))
+    {
+        const uint64_t prime = 2 * j + 1;
+        if (prime * prime <= root)
+            bitset_clear_in_range_begin_end_step(UNIVERSAL_BITSET(&base_b), (prime * prime) / 2, base_b.size, prime);
+        *(base_primes + base_count) = prime;
+        *(next_multiple + base_count++) = (prime * prime) / 2;
+    }
+    bitset_dynamic_destroy(&base_b);
+
+    // Reusable segment, odd numbers [low, low + 2 * segment_b.size)
+    DynamicBitSet segment_b;
+    bitset_dynamic_init(&segment_b, segment_bits);
+    const uint64_t total_bits = (up_limit - 1) / 2 + 1;
+
+    for (uint64_t first = 0; first < total_bits; first += segment_bits)
+    {
+        const uint64_t bits = total_bits - first < segment_bits ? total_bits - first : segment_bits;
+        // shrinking the last segment keeps the capacity, so this never reallocates
+        bitset_dynamic_resize(&segment_b, bits);
+        bitset_set_all(UNIVERSAL_BITSET(&segment_b));
+        if (!first)
+            bitset_clear(UNIVERSAL_BITSET(&segment_b), 0); // 1 is not a prime
+
+        // odd multiples of an odd prime are prime bits apart in the odd-only mapping
+        for (uint64_t k = 0; k < base_count; ++k)
+        {
+            const uint64_t prime = *(base_primes + k);
+            uint64_t next = *(next_multiple + k);
+            if (next >= first + bits)
+                continue;
+            bitset_clear_in_range_begin_end_step(UNIVERSAL_BITSET(&segment_b), next - first, bits, prime);
+            next += (first + bits - next + prime - 1) / prime * prime;
+            *(next_multiple + k) = next;
+        }
+
+        count += bitset_count(UNIVERSAL_BITSET(&segment_b));
+        primes_segment_context segment = { callback, context, 2 * first + 1 };
+        bitset_for_each_set_bit(UNIVERSAL_BITSET(&segment_b), primes_segment_report, &segment);
+    }
+
+    bitset_dynamic_destroy(&segment_b);
+    delete[] base_primes;
+    delete[] next_multiple;
+
+    return count;
+}
+
+template <typename F>
+inline uint64_t primes_segmented_sieve_bitset_cpp(const uint64_t up_limit, F&& callback, const uint64_t segment_bits = 256 * 1024 * 8)
+{
+    // If limit is less than 2, there are no primes
+    if (up_limit < 2)
+        return 0;
+
+    callback(uint64_t(2));
+    uint64_t count = 1;
+
+    // Odd base primes up to sqrt(up_limit), sieved with the plain odd-only mapping (bit j is 2 * j + 1)
+    uint64_t root = static_cast<uint64_t>(std::sqrt(static_cast<double>(up_limit)));
+    while (root * root > up_limit)
+        --root;
+    while ((root + 1) * (root + 1) <= up_limit)
+        ++root;
+
+    CDynamicBitSet<uint64_t> base_b(root / 2 + 1);
+    base_b.set();
+    base_b.clear(0);
+
+    // base primes and the index of their next odd multiple (relative to the whole odd-only sieve)
+    std::vector<std::pair<uint64_t, uint64_t>> base_primes;
+    for (uint64_t j = base_b.find_first(); j != base_b.npos; j = base_b.find_next(j))
+    {
+        const uint64_t prime = 2 * j + 1;
+        if (prime * prime <= root)
+            base_b.clear_in_range((prime * prime) / 2, base_b.size, prime);
+        base_primes.emplace_back(prime, (prime * prime) / 2);
+    }
+
+    // Reusable segment, odd numbers [low, low + 2 * segment_b.size)
+    CDynamicBitSet<uint64_t> segment_b(segment_bits);
+    const uint64_t total_bits = (up_limit - 1) / 2 + 1;
+
+    for (uint64_t first = 0; first < total_bits; first += segment_bits)
+    {
+        const uint64_t bits = total_bits - first < segment_bits ? total_bits - first : segment_bits;
+        // shrinking the last segment keeps the capacity, so this never reallocates
+        segment_b.resize(bits);
+        segment_b.set();
+        if (!first)
+            segment_b.clear(0); // 1 is not a prime
+
+        // odd multiples of an odd prime are prime bits apart in the odd-only mapping
+        for (auto& [prime, next] : base_primes)
+        {
+            if (next >= first + bits)
+                continue;
+            segment_b.clear_in_range(next - first, bits, prime);
+            next += (first + bits - next + prime - 1) / prime * prime;
+        }
+
+        count += segment_b.count();
+        const uint64_t low = 2 * first + 1;
+        segment_b.for_each_set_bit([&](const uint64_t index) { callback(low + 2 * index); });
+    }
+
+    return count;
+}
+
+/*
+ * Sieve of Eratosthenes algorithm for finding all primes up to a given limit.
+ * 
+ * Arguments:
+ *  - up_limit: The upper limit for the primes.
+ *  - use_prime_num_approx: If true, use the prime number approximation (pi(x) <= x / ln(x)) to calculate the size of the array to store the primes.
+ *                          Otherwise, use the upper limit as the size of the array.
+ *  - mem_to_alloc: (Optional) The amount of memory to allocate for the array of primes.
+ *                  If not provided (or 0), the function will allocate memory based on the specified limit or approximation.
+ * 
+ * Returns:
+ *  - A pair consisting of a pointer to the array of primes and the number of primes found.
+ */
+
+template <typename T>
+inline std::enable_if_t<std::is_integral_v<T>, std::pair<T*, std::size_t>> primes_sieve_of_eratosthenes(const T& up_limit, const bool use_prime_num_approx, const uint64_t mem_to_alloc)
+{
+    // If limit is less than 2, return empty array
+    if (up_limit < 2)
+        return {nullptr, 0};
+
+    // Initialize variables
+    // use BitSet class to save memory (and time) for large limits (up to 8 times less memory usage and 8 times faster access)
+    bool *primes_b = new bool[up_limit + 1];
+    T primes_size = (mem_to_alloc) ? mem_to_alloc : ((use_prime_num_approx) ? static_cast<T>(up_limit / std::log(up_limit)) : up_limit);
+    T* primes = new T[primes_size];
+    *primes = 2;
+    T index = 1;
+
+    // setting the first two elements to 'false' (not prime) and the third element to 'true' (prime).
+    *primes_b = *(primes_b + 1) = false;
+    *(primes_b + 2) = true;
+
+    std::memset(primes_b, true, up_limit + 1);
+
+    //std::fill(bits + 1, bits + up_limit / 64 + 1, 0b1010101010101010101010101010101010101010101010101010101010101010);
+    
+    // Main sieve loop
+    T i = 3;
+    for (; i * i <= up_limit; i += 2)
+    {
+        if (*(primes_b + i))
+        {
+            *(primes + index++) = i;
+            for (T j = i * i; j <= up_limit; j += i)
+                *(primes_b + j) = false;
+        }
+    }
+
+    // Copy the remaining primes
+    if (!(i % 2))
+        ++i;
+    for (; i <= up_limit; i += 2)
+    {
+        if (*(primes_b + i))
+            *(primes + index++) = i;
+    }
+
+
+    delete[] primes_b;
+
+    // Return primes and their count
+    return { primes, primes_size };
+}
+// stores the primes reported by primes_segmented_sieve_bitset_c, context is a pointer to the output cursor
+inline void primes_store(const uint64_t prime, void* const context)
+{
+    uint64_t** const cursor = static_cast<uint64_t**>(context);
+    *(*cursor)++ = prime;
+}
+
+/**
+ * Runs a sieve and returns its time
+ * @param function The sieve to time
+ * @return Elapsed time in seconds (steady clock)
+ */
+template <typename F>
+inline double time_sieve(F&& function)
+{
+    const auto start = std::chrono::steady_clock::now();
+    function();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(const int argc, char** argv)
+{
+    // Disable synchronization between C and C++ standard streams
+    //std::ios_base::sync_with_stdio(false);
+    std::cin.tie(nullptr);
+    std::cout.tie(nullptr);
+
+#ifdef _WIN32
+    // Enable virtual terminal processing for ANSI escape codes
+    DWORD org_mode;
+    GetConsoleMode(GetStdHandle(STD_OUTPUT_HANDLE), &org_mode);
+    SetConsoleMode(GetStdHandle(STD_OUTPUT_HANDLE), org_mode | ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+
+    // set high priority for the process
+    SetPriorityClass(GetCurrentProcess(), HIGH_PRIORITY_CLASS);
+#endif
+
+    std::cout << std::fixed << std::setprecision(10);
+
+    // usage: example_primes_time [runs] [up_limit]
+    const uint64_t am_runs = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10;
+    const uint64_t up_limit = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 100000000ull;
+    if (!am_runs)
+        return 0;
+
+    uint64_t *primes, primes_count;
+
+    double avg_time = 0,
+        avg_time_bitset_c = 0,
+        avg_time_bitset_cpp = 0,
+        avg_time_segmented_c = 0,
+        avg_time_segmented_cpp = 0;
+
+    for (uint64_t i = 0; i < am_runs; ++i)
+    {
+        if (i)
+            std::cout << "\033[6A";
+        std::cout << "Iteration: " << i + 1 << '\n';
+
+        // include 1st one least optimized
+        avg_time += time_sieve([&] { std::tie(primes, primes_count) = primes_sieve_of_eratosthenes(up_limit, false, 0); });
+        delete[] primes;
+
+        avg_time_bitset_c += time_sieve([&] { std::tie(primes, primes_count) = primes_sieve_of_eratosthenes_bitset_c(up_limit, false, 0); });
+        delete[] primes;
+
+        avg_time_bitset_cpp += time_sieve([&] { std::tie(primes, primes_count) = primes_sieve_of_eratosthenes_bitset_cpp(up_limit, false, 0); });
+        delete[] primes;
+
+        primes = new uint64_t[up_limit / 2 + 1];
+        uint64_t* cursor = primes;
+        avg_time_segmented_c += time_sieve([&] { primes_count = primes_segmented_sieve_bitset_c(up_limit, primes_store, &cursor); });
+        delete[] primes;
+
+        primes = new uint64_t[up_limit / 2 + 1];
+        cursor = primes;
+        avg_time_segmented_cpp += time_sieve([&] { primes_count = primes_segmented_sieve_bitset_cpp(up_limit, [&cursor](const uint64_t prime) { *cursor++ = prime; }); });
+        delete[] primes;
+
+        std::cout << "Average time for sieve of eratosthenes:                   " << avg_time / (i + 1) << '\n'
+            << "Average time for sieve of eratosthenes (bitset, C API):   " << avg_time_bitset_c / (i + 1) << '\n'
+            << "Average time for sieve of eratosthenes (bitset, C++ API): " << avg_time_bitset_cpp / (i + 1) << '\n'
+            << "Average time for segmented sieve (bitset, C API):         " << avg_time_segmented_c / (i + 1) << '\n'
+            << "Average time for segmented sieve (bitset, C++ API):       " << avg_time_segmented_cpp / (i + 1) << '\n';
+    }
+
+#ifdef _WIN32
+    SetConsoleMode(GetStdHandle(STD_OUTPUT_HANDLE), org_mode);
+#endif
+    return 0;
+}
@@ -0,0 +1,74 @@
+#include "BitSet.h"
+
+#include <pthread.h>
+#include <stdio.h>
+
+#define THREADS 4
+#define BITS 100000u
+
+static int failures = 0;
+
+#define CHECK(condition) \
+    do \
+    { \
+        if (!(condition)) \
+        { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            ++failures; \
+        } \
+    } while (0)
+
+typedef struct
+{
+    AtomicBitSet* bitset;
+    uint64_t won;
+} worker;
+
+// every thread races for every bit, exactly one test_and_set per bit may see it cleared
+static void* race(void* const argument)
+{
+    worker* const self = (worker*)argument;
+    for (uint64_t i = 0; i < BITS; ++i)
+        self->won += !bitset_atomic_test_and_set(self->bitset, i, memory_order_acq_rel);
+    return NULL;
+}
+
+int main(void)
+{
+#ifdef BITSET_ATOMICS
+    AtomicBitSet bitset;
+    bitset_atomic_init(&bitset, BITS);
+    CHECK(bitset.data != NULL && bitset_atomic_count(&bitset) == 0);
+
+    pthread_t threads[THREADS];
+    worker workers[THREADS];
+    for (int i = 0; i < THREADS; ++i)
+    {
+        workers[i].bitset = &bitset;
+        workers[i].won = 0;
+        CHECK(pthread_create(threads + i, NULL, race, workers + i) == 0);
+    }
+    uint64_t won = 0;
+    for (int i = 0; i < THREADS; ++i)
+    {
+        pthread_join(threads[i], NULL);
+        won += workers[i].won;
+    }
+    CHECK(won == BITS);
+    CHECK(bitset_atomic_count(&bitset) == BITS);
+
+    bitset_atomic_clear(&bitset, 7, memory_order_release);
+    bitset_atomic_flip(&bitset, 8, memory_order_acq_rel);
+    CHECK(!bitset_atomic_get(&bitset, 7, memory_order_acquire) && !bitset_atomic_get(&bitset, 8, memory_order_acquire));
+    CHECK(bitset_atomic_test_and_clear(&bitset, 9, memory_order_acq_rel) && !bitset_atomic_test_and_clear(&bitset, 9, memory_order_acq_rel));
+    CHECK(bitset_atomic_fetch_and_block(&bitset, 0, 1, memory_order_acq_rel) == UINT64_MAX);
+    CHECK(bitset_atomic_count(&bitset) == BITS - 3 - 64);
+    bitset_atomic_destroy(&bitset);
+#else
+    fprintf(stderr, "C11 atomics are not available, skipped\n");
+#endif
+
+    if (failures)
+        fprintf(stderr, "%d checks failed\n", failures);
+    return failures ? 1 : 0;
+}
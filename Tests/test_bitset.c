@@ -0,0 +1,280 @@
+#include "BitSet.h"
+
+#include <stdio.h>
+
+static int failures = 0;
+
+#define CHECK(condition) \
+    do \
+    { \
+        if (!(condition)) \
+        { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            ++failures; \
+        } \
+    } while (0)
+
+static void test_dynamic(void)
+{
+    DynamicBitSet bitset;
+    bitset_dynamic_init(&bitset, 1000);
+    CHECK(bitset.data && bitset.size == 1000);
+    bitset_set(UNIVERSAL_BITSET(&bitset), 3);
+    bitset_set(UNIVERSAL_BITSET(&bitset), 999);
+    CHECK(bitset_get(UNIVERSAL_BITSET(&bitset), 3) && !bitset_get(UNIVERSAL_BITSET(&bitset), 4));
+    CHECK(bitset_count(UNIVERSAL_BITSET(&bitset)) == 2);
+    CHECK(bitset_find_first(UNIVERSAL_BITSET(&bitset)) == 3 && bitset_find_next(UNIVERSAL_BITSET(&bitset), 3) == 999);
+    CHECK(bitset_count_in_range(UNIVERSAL_BITSET(&bitset), 4, 999) == 0);
+
+    for (uint64_t i = 0; i < 5000; ++i)
+        bitset_dynamic_push_back(&bitset, i % 3 == 0);
+    CHECK(bitset.size == 6000 && bitset_count(UNIVERSAL_BITSET(&bitset)) == 2 + 1667);
+    bitset_dynamic_resize(&bitset, 8);
+    bitset_dynamic_shrink_to_fit(&bitset);
+    CHECK(bitset.size == 8 && bitset.capacity == bitset.storage_size && bitset_count(UNIVERSAL_BITSET(&bitset)) == 1);
+
+    DynamicBitSet other;
+    bitset_dynamic_init_block(&other, 8, BITSET_BLOCK_MAX);
+    bitset_and(UNIVERSAL_BITSET(&other), UNIVERSAL_BITSET(&bitset));
+    CHECK(bitset_count(UNIVERSAL_BITSET(&other)) == 1);
+    bitset_dynamic_destroy(&other);
+    bitset_dynamic_destroy(&bitset);
+}
+
+static void test_compressed(void)
+{
+    CompressedBitSet bitset, copy, result;
+    bitset_compressed_init(&bitset, (uint64_t)1 << 32);
+    for (uint64_t i = 0; i < ((uint64_t)1 << 32); i += 1000003)
+        bitset_compressed_set(&bitset, i);
+    bitset_compressed_update_range(&bitset, 100000, 900000, BITSET_OPERATION_OR);
+    bitset_compressed_optimize(&bitset);
+    CHECK(bitset_compressed_get(&bitset, 500000) && bitset_compressed_get(&bitset, 2000006) && !bitset_compressed_get(&bitset, 2000007));
+    const uint64_t count = bitset_compressed_count(&bitset);
+    CHECK(count == 800000 + 4295);
+
+    bitset_compressed_init(&copy, 0);
+    bitset_compressed_copy(&copy, &bitset);
+    bitset_compressed_clear(&copy, 500000);
+    CHECK(bitset_compressed_count(&copy) == count - 1);
+    CHECK(bitset_compressed_binary_count(&bitset, &copy, BITSET_OPERATION_XOR) == 1);
+
+    bitset_compressed_init(&result, 0);
+    bitset_compressed_binary_operation(&result, &bitset, &copy, BITSET_OPERATION_ANDNOT);
+    CHECK(bitset_compressed_count(&result) == 1 && bitset_compressed_get(&result, 500000));
+    bitset_compressed_destroy(&result);
+    bitset_compressed_destroy(&copy);
+    bitset_compressed_destroy(&bitset);
+}
+
+static void test_stream(void)
+{
+    DynamicBitSet bitset, loaded;
+    bitset_dynamic_init(&bitset, 100000);
+    bitset_fill_in_range_begin_end(UNIVERSAL_BITSET(&bitset), true, 1000, 50000);
+    bitset_set(UNIVERSAL_BITSET(&bitset), 99999);
+
+    for (int encoding = BITSET_STREAM_RAW; encoding <= BITSET_STREAM_WAH; ++encoding)
+    {
+        FILE* const file = tmpfile();
+        CHECK(file != NULL);
+        if (!file)
+            return;
+        CHECK(bitset_write(UNIVERSAL_BITSET(&bitset), bitset_stream_file_sink, file, (bitset_stream_encoding)encoding));
+        rewind(file);
+        bitset_dynamic_init(&loaded, 0);
+        CHECK(bitset_dynamic_read(&loaded, bitset_stream_file_source, file));
+        CHECK(loaded.size == bitset.size && bitset_count(UNIVERSAL_BITSET(&loaded)) == 49001);
+        CHECK(bitset_get(UNIVERSAL_BITSET(&loaded), 99999) && !bitset_get(UNIVERSAL_BITSET(&loaded), 999));
+        bitset_dynamic_destroy(&loaded);
+        fclose(file);
+    }
+    bitset_dynamic_destroy(&bitset);
+}
+
+static void test_rank_select(void)
+{
+    DynamicBitSet bitset;
+    bitset_dynamic_init(&bitset, 1 << 20);
+    for (uint64_t i = 0; i < (1 << 20); i += 7)
+        bitset_set(UNIVERSAL_BITSET(&bitset), i);
+
+    BitSetRankIndex index;
+    CHECK(bitset_rank_index_init(&index, UNIVERSAL_BITSET(&bitset)));
+    CHECK(bitset_rank(&index, 0) == 0 && bitset_rank(&index, 8) == 2 && bitset_rank(&index, 700001) == 100001);
+    CHECK(bitset_select(&index, 0) == 0 && bitset_select(&index, 100000) == 700000);
+    bitset_rank_index_destroy(&index);
+    bitset_dynamic_destroy(&bitset);
+}
+
+static void test_bloom(void)
+{
+    BloomFilter filter;
+    bitset_bloom_init(&filter, 10000, 0.01);
+    for (uint64_t key = 0; key < 10000; ++key)
+        bitset_bloom_insert(&filter, key * 2654435761u);
+
+    bool found = true;
+    uint64_t false_positives = 0;
+    for (uint64_t key = 0; key < 10000; ++key)
+    {
+        found = found && bitset_bloom_contains(&filter, key * 2654435761u);
+        false_positives += bitset_bloom_contains(&filter, key * 2654435761u + 1u);
+    }
+    CHECK(found);
+    CHECK(false_positives < 500);
+    bitset_bloom_destroy(&filter);
+}
+
+static void test_cow(void)
+{
+    CowBitSet bitset, snapshot;
+    CHECK(bitset_cow_init(&bitset, 1 << 20));
+    bitset_cow_fill_in_range_begin_end(&bitset, true, 0, 1 << 19);
+    CHECK(bitset_cow_snapshot(&snapshot, &bitset));
+    CHECK(bitset_cow_shared_pages(&bitset) > 0);
+
+    bitset_cow_clear(&bitset, 5);
+    bitset_cow_set(&bitset, (1 << 20) - 1);
+    CHECK(!bitset_cow_get(&bitset, 5) && bitset_cow_get(&snapshot, 5));
+    CHECK(bitset_cow_count(&bitset) == (1 << 19) && bitset_cow_count(&snapshot) == (1 << 19));
+    bitset_cow_destroy(&snapshot);
+    bitset_cow_destroy(&bitset);
+}
+
+static void test_matrix(void)
+{
+    BitMatrix matrix, transposed;
+    bitset_matrix_init(&matrix, 100, 300);
+    for (uint64_t row = 0; row < 100; ++row)
+        bitset_matrix_set_value(&matrix, true, row, row * 3);
+    bitset_matrix_init(&transposed, 300, 100);
+    CHECK(bitset_matrix_transpose(&transposed, &matrix));
+    CHECK(bitset_matrix_get(&transposed, 297, 99) && !bitset_matrix_get(&transposed, 298, 99));
+
+    uint64_t counts[300];
+    bitset_matrix_count_rows(&transposed, counts);
+    uint64_t total = 0;
+    for (uint64_t row = 0; row < 300; ++row)
+        total += counts[row];
+    CHECK(total == 100 && counts[3] == 1 && counts[4] == 0);
+    bitset_matrix_destroy(&transposed);
+    bitset_matrix_destroy(&matrix);
+}
+
+#ifdef BITSET_MAPPED_FILES
+static void test_mapped_file(void)
+{
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/bitset_test_%ld.bin", (long)getpid());
+
+    DynamicBitSet bitset, mapped;
+    bitset_dynamic_init(&bitset, 12288);
+    bitset_set(UNIVERSAL_BITSET(&bitset), 12287);
+    CHECK(bitset_save_file(UNIVERSAL_BITSET(&bitset), path));
+    CHECK(bitset_dynamic_map_file(&mapped, path, BITSET_MAP_COPY_ON_WRITE | BITSET_MAP_VERIFY));
+    CHECK(mapped.size == 12288 && bitset_get(UNIVERSAL_BITSET(&mapped), 12287));
+
+    // a mapped view cannot grow, failed appends leave it unchanged
+    bitset_dynamic_push_back(&mapped, true);
+    CHECK(mapped.size == 12288);
+    bitset_dynamic_destroy(&mapped);
+    bitset_dynamic_destroy(&bitset);
+    remove(path);
+}
+#endif
+
+#ifdef BITSET_SHARED_MEMORY
+static void test_shared_memory(void)
+{
+    char name[64];
+    snprintf(name, sizeof(name), "/bitset_test_%ld", (long)getpid());
+
+    DynamicBitSet source, owner, reader;
+    bitset_dynamic_init(&source, 777);
+    bitset_set(UNIVERSAL_BITSET(&source), 700);
+    CHECK(bitset_dynamic_create_shared(&owner, name, UNIVERSAL_BITSET(&source)));
+    CHECK(bitset_dynamic_attach_shared(&reader, name, BITSET_MAP_READ_ONLY | BITSET_MAP_VERIFY));
+    bitset_set(UNIVERSAL_BITSET(&owner), 1);
+    CHECK(bitset_get(UNIVERSAL_BITSET(&reader), 1) && bitset_get(UNIVERSAL_BITSET(&reader), 700));
+    bitset_dynamic_destroy(&reader);
+    bitset_dynamic_destroy(&owner);
+    CHECK(bitset_unlink_shared(name));
+    bitset_dynamic_destroy(&source);
+}
+#endif
+
+#ifdef BITSET_HUGE_PAGES
+static void test_huge_pages(void)
+{
+    static const bitset_allocator allocator = BITSET_HUGE_PAGE_ALLOCATOR;
+    DynamicBitSet bitset;
+    bitset_dynamic_init_allocator(&bitset, (uint64_t)64 << 23, &allocator);
+    CHECK(bitset.data != NULL);
+    if (!bitset.data)
+        return;
+    bitset_set(UNIVERSAL_BITSET(&bitset), 3);
+    bitset_set(UNIVERSAL_BITSET(&bitset), ((uint64_t)64 << 23) - 1);
+    bitset_dynamic_resize(&bitset, 8);
+    bitset_dynamic_shrink_to_fit(&bitset);
+    CHECK(bitset.size == 8 && bitset_count(UNIVERSAL_BITSET(&bitset)) == 1);
+    bitset_dynamic_destroy(&bitset);
+}
+#endif
+
+static void test_pool(void)
+{
+    bitset_pool pool;
+    bitset_pool_init(&pool, NULL);
+    const bitset_allocator allocator = { bitset_pool_allocate, bitset_pool_reallocate, bitset_pool_deallocate, &pool };
+    DynamicBitSet bitset;
+    bitset_dynamic_init_allocator(&bitset, 10, &allocator);
+    for (uint64_t i = 0; i < 100000; ++i)
+        bitset_dynamic_push_back(&bitset, true);
+    CHECK(bitset_count(UNIVERSAL_BITSET(&bitset)) == 100000);
+    bitset_dynamic_destroy(&bitset);
+    bitset_pool_destroy(&pool);
+}
+
+#ifdef BITSET_ATOMICS
+static void test_atomic(void)
+{
+    AtomicBitSet bitset;
+    bitset_atomic_init(&bitset, 1000);
+    CHECK(bitset.data != NULL);
+    CHECK(!bitset_atomic_test_and_set(&bitset, 10, memory_order_acq_rel));
+    CHECK(bitset_atomic_test_and_set(&bitset, 10, memory_order_acq_rel));
+    const uint64_t indices[] = { 1, 2, 999 };
+    bitset_atomic_set_many(&bitset, indices, 3, memory_order_relaxed);
+    CHECK(bitset_atomic_count(&bitset) == 4 && bitset_atomic_get(&bitset, 999, memory_order_acquire));
+    bitset_atomic_destroy(&bitset);
+}
+#endif
+
+int main(void)
+{
+    test_dynamic();
+    test_compressed();
+    test_stream();
+    test_rank_select();
+    test_bloom();
+    test_cow();
+    test_matrix();
+#ifdef BITSET_MAPPED_FILES
+    test_mapped_file();
+#endif
+#ifdef BITSET_SHARED_MEMORY
+    test_shared_memory();
+#endif
+#ifdef BITSET_HUGE_PAGES
+    test_huge_pages();
+#endif
+    test_pool();
+#ifdef BITSET_ATOMICS
+    test_atomic();
+#endif
+
+    if (failures)
+        fprintf(stderr, "%d checks failed\n", failures);
+    return failures ? 1 : 0;
+}
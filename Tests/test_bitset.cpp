@@ -0,0 +1,153 @@
+#include "BitSet.h"
+#include "BitSet.hpp"
+
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+static int failures = 0;
+
+#define CHECK(condition) \
+    do \
+    { \
+        if (!(condition)) \
+        { \
+            std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            ++failures; \
+        } \
+    } while (0)
+
+static void test_dynamic()
+{
+    CDynamicBitSet<uint64_t> bitset(1000);
+    bitset.set(3);
+    bitset.set(999);
+    CHECK(bitset.get(3) && !bitset.get(4) && bitset.count() == 2);
+    CHECK(bitset.find_first() == 3 && bitset.find_next(3) == 999);
+
+    for (uint64_t i = 0; i < 5000; ++i)
+        bitset.push_back(i % 3 == 0);
+    CHECK(bitset.size == 6000 && bitset.count() == 2 + 1667);
+    bitset.resize(8);
+    bitset.shrink_to_fit();
+    CHECK(bitset.size == 8 && bitset.capacity == bitset.storage_size && bitset.count() == 1);
+
+    CDynamicBitSet<uint64_t> other(8, ~uint64_t(0));
+    other &= bitset;
+    CHECK(other.count() == 1);
+}
+
+static void test_expressions()
+{
+    CDynamicBitSet<uint64_t> a(300), b(300), c(300);
+    a.set_in_range(0, 200);
+    b.set_in_range(100, 300);
+    c.set(150);
+    const CDynamicBitSet<uint64_t> result = (a.lazy() & b.lazy()) ^ c.lazy();
+    CHECK(result.count() == 99 && !result.get(150));
+    CHECK(a.and_count(b) == 100 && a.intersects(b) && !a.is_subset_of(b));
+}
+
+static void test_fixed()
+{
+    CBitSet<130> bitset;
+    bitset.set(129);
+    bitset.set(0);
+    CHECK(bitset.count() == 2 && bitset.get(129));
+}
+
+static void test_view()
+{
+    CDynamicBitSet<uint64_t> bitset(256);
+    auto view = bitset.view(64, 64);
+    view.set(true, 0);
+    view.set(true, 63);
+    CHECK(bitset.get(64) && bitset.get(127) && bitset.count() == 2);
+}
+
+static void test_atomic()
+{
+    CAtomicBitSet bitset(1u << 16);
+    std::vector<std::thread> threads;
+    for (int thread = 0; thread < 4; ++thread)
+        threads.emplace_back([&bitset, thread] {
+            for (uint64_t i = thread; i < (1u << 16); i += 4)
+                bitset.set(i);
+        });
+    for (std::thread& thread : threads)
+        thread.join();
+    CHECK(bitset.count() == (1u << 16));
+    CHECK(bitset.test_and_clear(5) && !bitset.test_and_clear(5));
+}
+
+static void test_rank_select()
+{
+    CDynamicBitSet<uint64_t> bitset(1u << 20);
+    bitset.set_in_range(0, 1u << 20, 7);
+    const CBitSetRankIndex<CDynamicBitSet<uint64_t>> index(bitset);
+    CHECK(index.rank(8) == 2 && index.rank(700001) == 100001);
+    CHECK(index.select(100000) == 700000);
+}
+
+static void test_bloom()
+{
+    CBloomFilter filter(10000, 0.01);
+    for (uint64_t key = 0; key < 10000; ++key)
+        filter.insert(key * 2654435761u);
+    bool found = true;
+    for (uint64_t key = 0; key < 10000; ++key)
+        found = found && filter.contains(key * 2654435761u);
+    CHECK(found);
+}
+
+static void test_cow()
+{
+    CCowBitSet bitset(1u << 20);
+    bitset.fill_in_range(true, 0, 1u << 19);
+    const CCowBitSet snapshot = bitset.snapshot();
+    bitset.clear(5);
+    CHECK(!bitset.get(5) && snapshot.get(5));
+    CHECK(bitset.count() == (1u << 19) - 1 && snapshot.count() == (1u << 19));
+}
+
+static void test_matrix()
+{
+    CBitMatrix matrix(100, 300);
+    for (uint64_t row = 0; row < 100; ++row)
+        matrix.set(true, row, row * 3);
+    const CBitMatrix transposed = matrix.transpose();
+    CHECK(transposed.get(297, 99) && !transposed.get(298, 99));
+    CHECK(matrix.column(3).count() == 1);
+}
+
+#ifdef BITSET_HUGE_PAGES
+static void test_huge_pages()
+{
+    static const bitset_allocator allocator = BITSET_HUGE_PAGE_ALLOCATOR;
+    CDynamicBitSet<uint64_t, CBitSetAllocator<uint64_t>> bitset(uint64_t(64) << 23, CBitSetAllocator<uint64_t>(&allocator));
+    bitset.set(3);
+    bitset.resize(8);
+    bitset.shrink_to_fit();
+    CHECK(bitset.size == 8 && bitset.count() == 1);
+}
+#endif
+
+int main()
+{
+    test_dynamic();
+    test_expressions();
+    test_fixed();
+    test_view();
+    test_atomic();
+    test_rank_select();
+    test_bloom();
+    test_cow();
+    test_matrix();
+#ifdef BITSET_HUGE_PAGES
+    test_huge_pages();
+#endif
+
+    if (failures)
+        std::fprintf(stderr, "%d checks failed\n", failures);
+    return failures ? 1 : 0;
+}
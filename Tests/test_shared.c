@@ -0,0 +1,99 @@
+#include "BitSet.h"
+
+#include <stdio.h>
+#if defined(BITSET_SHARED_MEMORY) && defined(BITSET_ATOMICS)
+#include <sys/wait.h>
+#endif
+
+#define PROCESSES 4
+#define BITS 200000u
+
+static int failures = 0;
+
+#define CHECK(condition) \
+    do \
+    { \
+        if (!(condition)) \
+        { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            ++failures; \
+        } \
+    } while (0)
+
+#if defined(BITSET_SHARED_MEMORY) && defined(BITSET_ATOMICS)
+// attaches to the segment and races for every bit, returns the number of bits this process set first
+static uint64_t race(const char* const name)
+{
+    AtomicBitSet bitset;
+    if (!bitset_atomic_attach_shared(&bitset, name))
+        return UINT64_MAX;
+    uint64_t won = 0;
+    for (uint64_t i = 0; i < BITS; ++i)
+        won += !bitset_atomic_test_and_set(&bitset, i, memory_order_acq_rel);
+    bitset_atomic_detach_shared(&bitset);
+    return won;
+}
+#endif
+
+int main(void)
+{
+#if defined(BITSET_SHARED_MEMORY) && defined(BITSET_ATOMICS)
+    char name[64];
+    snprintf(name, sizeof(name), "/bitset_test_shared_%ld", (long)getpid());
+
+    DynamicBitSet source, owner;
+    bitset_dynamic_init(&source, BITS);
+    CHECK(bitset_dynamic_create_shared(&owner, name, UNIVERSAL_BITSET(&source)));
+    bitset_dynamic_destroy(&source);
+    if (failures)
+        return 1;
+
+    // every child reports the number of bits it won through its own pipe
+    pid_t children[PROCESSES];
+    int pipes[PROCESSES][2];
+    for (int i = 0; i < PROCESSES; ++i)
+    {
+        CHECK(pipe(pipes[i]) == 0);
+        children[i] = fork();
+        CHECK(children[i] >= 0);
+        if (children[i] == 0)
+        {
+            close(pipes[i][0]);
+            const uint64_t won = race(name);
+            const bool written = write(pipes[i][1], &won, sizeof(won)) == (ssize_t)sizeof(won);
+            _exit(written ? 0 : 1);
+        }
+        close(pipes[i][1]);
+    }
+
+    uint64_t won = 0;
+    for (int i = 0; i < PROCESSES; ++i)
+    {
+        uint64_t child_won = UINT64_MAX;
+        CHECK(read(pipes[i][0], &child_won, sizeof(child_won)) == (ssize_t)sizeof(child_won));
+        CHECK(child_won != UINT64_MAX);
+        close(pipes[i][0]);
+        int status = 0;
+        CHECK(waitpid(children[i], &status, 0) == children[i] && WIFEXITED(status) && WEXITSTATUS(status) == 0);
+        won += child_won;
+    }
+
+    // each bit was set first by exactly one process, and every bit is visible through the owner's view
+    CHECK(won == BITS);
+    CHECK(bitset_count(UNIVERSAL_BITSET(&owner)) == BITS);
+
+    AtomicBitSet bitset;
+    CHECK(bitset_atomic_attach_shared(&bitset, name));
+    CHECK(bitset_atomic_count(&bitset) == BITS);
+    bitset_atomic_detach_shared(&bitset);
+
+    bitset_dynamic_destroy(&owner);
+    CHECK(bitset_unlink_shared(name));
+#else
+    fprintf(stderr, "shared memory or C11 atomics are not available, skipped\n");
+#endif
+
+    if (failures)
+        fprintf(stderr, "%d checks failed\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,81 @@
+#define BITSET_STATS_IMPLEMENTATION
+#include "BitSet.h"
+
+#include <stdio.h>
+
+static int failures = 0;
+
+#define CHECK(condition) \
+    do \
+    { \
+        if (!(condition)) \
+        { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            ++failures; \
+        } \
+    } while (0)
+
+uint64_t count_in_other_unit(void);
+
+static uint64_t traced_begins = 0, traced_ends = 0;
+
+static void trace_begin(const char* const name, const uint64_t bytes, void* const context)
+{
+    (void)name;
+    (void)context;
+    traced_begins += bytes >= BITSET_TRACE_THRESHOLD;
+}
+
+static void trace_end(const char* const name, const uint64_t bytes, void* const context)
+{
+    (void)name;
+    (void)context;
+    traced_ends += bytes >= BITSET_TRACE_THRESHOLD;
+}
+
+int main(void)
+{
+#ifndef BITSET_ENABLE_STATS
+    fprintf(stderr, "BITSET_ENABLE_STATS is not defined\n");
+    return 1;
+#else
+    bitset_stats_reset();
+    bitset_global_stats.trace_begin = trace_begin;
+    bitset_global_stats.trace_end = trace_end;
+
+    DynamicBitSet bitset;
+    bitset_dynamic_init(&bitset, 8u << 20);
+    bitset_set(UNIVERSAL_BITSET(&bitset), 5);
+    bitset_fill_in_range_begin_end(UNIVERSAL_BITSET(&bitset), true, 0, 8u << 20);
+    CHECK(bitset_count(UNIVERSAL_BITSET(&bitset)) == (8u << 20));
+    for (uint64_t i = 0; i < 100000; ++i)
+        bitset_dynamic_push_back(&bitset, true);
+    bitset_dynamic_destroy(&bitset);
+
+    // the counters are shared by every translation unit of the program
+    const uint64_t access_calls = bitset_global_stats.families[BITSET_STATS_ACCESS].calls;
+    CHECK(count_in_other_unit() == 2);
+    CHECK(bitset_global_stats.families[BITSET_STATS_ACCESS].calls == access_calls + 2);
+
+    CHECK(bitset_global_stats.families[BITSET_STATS_FILL].calls >= 1);
+    CHECK(bitset_global_stats.families[BITSET_STATS_COUNT].calls >= 2);
+    CHECK(bitset_global_stats.families[BITSET_STATS_RESIZE].reallocations >= 1);
+    CHECK(traced_begins >= 2 && traced_begins == traced_ends);
+
+    FILE* const file = tmpfile();
+    CHECK(file != NULL);
+    if (file)
+    {
+        bitset_stats_print(file);
+        CHECK(ftell(file) > 0);
+        fclose(file);
+    }
+
+    bitset_stats_reset();
+    CHECK(bitset_global_stats.families[BITSET_STATS_ACCESS].calls == 0);
+
+    if (failures)
+        fprintf(stderr, "%d checks failed\n", failures);
+    return failures ? 1 : 0;
+#endif
+}
@@ -0,0 +1,13 @@
+#include "BitSet.h"
+
+// operations of a second translation unit, counted in the bitset_global_stats of test_stats.c
+uint64_t count_in_other_unit(void)
+{
+    DynamicBitSet bitset;
+    bitset_dynamic_init(&bitset, 1000);
+    bitset_set(UNIVERSAL_BITSET(&bitset), 1);
+    bitset_set(UNIVERSAL_BITSET(&bitset), 2);
+    const uint64_t count = bitset_count(UNIVERSAL_BITSET(&bitset));
+    bitset_dynamic_destroy(&bitset);
+    return count;
+}